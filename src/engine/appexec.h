@@ -2,11 +2,14 @@
 #define _APPEXEC_H_
 
 #include <string>
+#include <stdint.h>
 
 namespace fuzzer {
 
 namespace execution {
 
+class ComparisonLog;
+
 enum TerminationReason {
     Term_Normal,
     Term_SegmentationFault, 
@@ -16,6 +19,21 @@ enum TerminationReason {
     Term_Other
 };
 
+///
+/// \brief  Describes how an application terminated, for the log.
+///
+inline const char * DescribeTermination(TerminationReason Reason)
+{
+    switch(Reason) {
+    case Term_Normal:               return "normal exit";
+    case Term_SegmentationFault:    return "access violation";
+    case Term_BoundsError:          return "array bounds exceeded";
+    case Term_UnalignedAccess:      return "misaligned data access";
+    case Term_StackOverflow:        return "stack overflow";
+    default:                        return "abnormal termination";
+    }
+}
+
 ///
 /// \brief  Interface for launch and control an application.
 ///
@@ -65,6 +83,48 @@ public:
     /// \brief  Sets command line arguments
     ///
     virtual void SetCommandLine(const std::string &) = 0;
+
+    ///
+    /// \brief  Checksum of the coverage reached by the last run.
+    ///
+    /// \return false if the application isn't instrumented for coverage.
+    ///
+    virtual bool GetCoverageChecksum(uint64_t & Checksum)
+    {
+        (void) Checksum;
+        return false;
+    }
+
+    ///
+    /// \brief  Comparison operands logged by the last run.
+    ///
+    /// \return nullptr if the application doesn't log comparisons.
+    ///
+    virtual const ComparisonLog * GetComparisonLog()
+    {
+        return nullptr;
+    }
+
+    ///
+    /// \brief  Records the state of the running application, so that
+    ///         Restore() can return to it.
+    ///
+    /// \return false if the executer doesn't support snapshots.
+    ///
+    virtual bool Snapshot()
+    {
+        return false;
+    }
+
+    ///
+    /// \brief  Returns the application to the state of the last Snapshot().
+    ///
+    /// \return false if it can't be restored, it has to be relaunched.
+    ///
+    virtual bool Restore()
+    {
+        return false;
+    }
 };
 
 } // namespace execution
@@ -23,6 +23,18 @@ bool ArraySource::read(void * dst, size_t count)
     return true;
 }
 
+size_t ArraySource::receive(void * dst, size_t min, size_t max)
+{
+    const size_t remaining = _size - _offset;
+    if (remaining < min) {
+        return 0;
+    }
+    const size_t count = remaining < max ? remaining : max;
+    memcpy(dst, _data + _offset, count);
+    _offset += count;
+    return count;
+}
+
 
 } // namespace runtime
 
@@ -24,6 +24,11 @@ public:
     ///
     virtual bool read(void * dst, size_t count);
 
+    ///
+    /// \brief  reads up to \p max of the remaining bytes.
+    ///
+    virtual size_t receive(void * dst, size_t min, size_t max);
+
 protected:
     const uint8_t * _data;
     size_t          _size;
@@ -1,11 +1,20 @@
 #include "buffer.h"
 #include "endian.h"
+#include <cstring>
 
 namespace fuzzer {
 
 namespace runtime {
 
-Buffer::Buffer(std::vector<uint8_t> & dst) : _dst(dst)
+Buffer::Buffer(std::vector<uint8_t> & dst) :
+    _dst(dst),
+    _splices(nullptr)
+{
+}
+
+Buffer::Buffer(std::vector<uint8_t> & dst, std::vector<Splice> & splices) :
+    _dst(dst),
+    _splices(&splices)
 {
 }
 
@@ -20,6 +29,45 @@ bool Buffer::write(const void * dst, size_t count)
     return true;
 }
 
+uint8_t * Buffer::allocate(size_t count)
+{
+    size_t offset = _dst.size();
+    _dst.resize(offset + count);
+    return _dst.data() + offset;
+}
+
+void Buffer::splice(const void * data, size_t count)
+{
+    if (!_splices) {
+        write(data, count);
+    } else if (count) {
+        Splice splice;
+        splice.offset       = _dst.size();
+        splice.piece.base   = data;
+        splice.piece.length = count;
+        _splices->push_back(splice);
+    }
+}
+
+void Buffer::pieces(const std::vector<uint8_t> & data, const std::vector<Splice> & splices,
+    std::vector<io::Piece> & pieces)
+{
+    size_t offset = 0;
+    for(size_t i = 0; i <= splices.size(); ++i) {
+        const size_t end = i < splices.size() ? splices[i].offset : data.size();
+        if (end > offset) {
+            io::Piece piece;
+            piece.base      = data.data() + offset;
+            piece.length    = end - offset;
+            pieces.push_back(piece);
+            offset = end;
+        }
+        if (i < splices.size()) {
+            pieces.push_back(splices[i].piece);
+        }
+    }
+}
+
 } // namespace runtime
 
 } // namespace fuzzer
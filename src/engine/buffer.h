@@ -9,6 +9,17 @@ namespace fuzzer {
 
 namespace runtime {
 
+///
+/// \struct Splice
+/// \brief  Static bytes that a buffer refers to instead of copying them,
+///         they follow the first \p offset bytes of its vector.
+///
+struct Splice
+{
+    size_t      offset;
+    io::Piece   piece;
+};
+
 ///
 /// \class  Buffer
 ///
@@ -18,10 +29,38 @@ public:
     /// construction
     Buffer(std::vector<uint8_t> &);
 
+    ///
+    /// \brief  Buffer that keeps spliced data in \p splices, instead of
+    ///         copying it into the vector.
+    ///
+    Buffer(std::vector<uint8_t> &, std::vector<Splice> & splices);
+
     virtual bool write(const void * dst, size_t count);
 
+    ///
+    /// \brief  Appends \p count uninitialized bytes and returns a pointer to
+    ///         them, allowing data to be converted directly into the buffer.
+    ///         The pointer is invalidated by the next write.
+    ///
+    uint8_t * allocate(size_t count);
+
+    ///
+    /// \brief  Appends \p count bytes that outlive the output of the
+    ///         buffer, such as the PatternBuffer blocks. They are spliced
+    ///         if the buffer keeps splices, and copied otherwise.
+    ///
+    void splice(const void * data, size_t count);
+
+    ///
+    /// \brief  The pieces of \p data with \p splices in place, for a gather
+    ///         write. The pieces refer to \p data.
+    ///
+    static void pieces(const std::vector<uint8_t> & data, const std::vector<Splice> & splices,
+        std::vector<io::Piece> & pieces);
+
 protected:
     std::vector<uint8_t> &  _dst;
+    std::vector<Splice> *   _splices;
 };
 
 } // namespace runtime
@@ -0,0 +1,74 @@
+#include "bufferedsource.h"
+#include <algorithm>
+#include <cstring>
+
+namespace fuzzer {
+
+namespace io {
+
+BufferedSource::BufferedSource(Source & source, size_t capacity) :
+    _source(source),
+    _buffer(capacity ? capacity : 1),
+    _begin(0),
+    _end(0)
+{
+    _big_endian = source.is_big_endian();
+}
+
+bool BufferedSource::require(size_t count)
+{
+    while(available() < count) {
+        if (_begin + count > _buffer.size()) {
+            /// move the unread bytes to the front, and grow if they still
+            /// don't fit
+            const size_t unread = available();
+            memmove(_buffer.data(), _buffer.data() + _begin, unread);
+            _begin  = 0;
+            _end    = unread;
+            if (count > _buffer.size()) {
+                _buffer.resize(std::max(count, 2 * _buffer.size()));
+            }
+        }
+        /// read ahead as much as fits, but wait only for what is missing
+        const size_t received = _source.receive(_buffer.data() + _end,
+            count - available(), _buffer.size() - _end);
+        if (!received) {
+            return false;
+        }
+        _end += received;
+    }
+    return true;
+}
+
+void BufferedSource::consume(size_t count)
+{
+    _begin += std::min(count, available());
+    if (_begin == _end) {
+        _begin = _end = 0;
+    }
+}
+
+bool BufferedSource::read(void * dst, size_t count)
+{
+    if (!require(count)) {
+        return false;
+    }
+    memcpy(dst, data(), count);
+    consume(count);
+    return true;
+}
+
+size_t BufferedSource::receive(void * dst, size_t min, size_t max)
+{
+    if (!require(min)) {
+        return 0;
+    }
+    const size_t count = std::min(max, available());
+    memcpy(dst, data(), count);
+    consume(count);
+    return count;
+}
+
+} // namespace io
+
+} // namespace fuzzer
@@ -0,0 +1,61 @@
+#ifndef _BUFFEREDSOURCE_H_
+#define _BUFFEREDSOURCE_H_
+
+#include "source.h"
+#include <vector>
+
+namespace fuzzer {
+
+namespace io {
+
+///
+/// \class  BufferedSource
+/// \brief  Reads ahead from another source into a receive buffer, so that
+///         parsers can look at the received bytes in place instead of
+///         copying them out field by field.
+///
+class BufferedSource : public Source
+{
+public:
+    static const size_t DefaultCapacity = 64 * 1024;
+
+    ///
+    /// \brief  Constructor, the byte order is taken from \p source.
+    ///
+    explicit BufferedSource(Source & source, size_t capacity = DefaultCapacity);
+
+    ///
+    /// \brief  Makes at least \p count unread bytes available at data(),
+    ///         growing the buffer if needed. Pointers returned by data()
+    ///         before the call are invalidated.
+    ///
+    /// \return false if the source fails before \p count bytes are read.
+    ///
+    bool require(size_t count);
+
+    /// the unread bytes, valid until the next call to require() or read()
+    const uint8_t * data() const { return _buffer.data() + _begin; }
+
+    /// number of unread bytes in the buffer
+    size_t available() const { return _end - _begin; }
+
+    ///
+    /// \brief  Marks \p count bytes at data() as read.
+    ///
+    void consume(size_t count);
+
+    virtual bool read(void * dst, size_t count);
+    virtual size_t receive(void * dst, size_t min, size_t max);
+
+protected:
+    Source &                _source;
+    std::vector<uint8_t>    _buffer;
+    size_t                  _begin;     //< first unread byte
+    size_t                  _end;       //< end of the received bytes
+};
+
+} // namespace io
+
+} // namespace fuzzer
+
+#endif
@@ -6,6 +6,7 @@
 #include <string>
 #include <map>
 #include "parser.h"
+#include "buffer.h"
 #include <memory>
 
 namespace fuzzer {
@@ -170,6 +171,8 @@ struct Value {
 
     std::shared_ptr<std::string>            stringValue;
     std::shared_ptr<std::vector<uint8_t> >  opaqueValue;
+    /// static data of the opaque value, see runtime::Buffer::splice()
+    std::shared_ptr<std::vector<runtime::Splice> >  opaqueSplices;
 };
 
 } // namespace bytecode
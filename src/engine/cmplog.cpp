@@ -0,0 +1,27 @@
+#include "cmplog.h"
+
+namespace fuzzer {
+
+namespace execution {
+
+const char * ComparisonLog::EnvironmentVariable = "FUZZENGINE_CMPLOG_SHM";
+
+ComparisonLog::ComparisonLog() : _memory(sizeof(fuzzengine_cmplog))
+{
+}
+
+void ComparisonLog::clear()
+{
+    reinterpret_cast<fuzzengine_cmplog *>(_memory.data())->count = 0;
+}
+
+size_t ComparisonLog::size() const
+{
+    /// the count keeps growing when the table is full
+    const size_t count = table()->count;
+    return count < FUZZENGINE_CMPLOG_ENTRIES ? count : FUZZENGINE_CMPLOG_ENTRIES;
+}
+
+} // namespace execution
+
+} // namespace fuzzer
@@ -0,0 +1,53 @@
+#ifndef _CMPLOG_H_
+#define _CMPLOG_H_
+
+#include "cmplogtable.h"
+#include "sharedmemory.h"
+#include <stddef.h>
+
+namespace fuzzer {
+
+namespace execution {
+
+///
+/// \class  ComparisonLog
+/// \brief  Shared memory table of comparison operands, filled by the
+///         SanitizerCoverage trace-cmp callbacks of an instrumented target,
+///         see cmplogtable.h. The name of the mapping is passed to the
+///         target in the environment variable EnvironmentVariable.
+///
+class ComparisonLog
+{
+public:
+    static const char * EnvironmentVariable;
+
+    ///
+    /// \brief  Creates a new, uniquely named table. Throws a
+    ///         std::runtime_error if the mapping can't be created.
+    ///
+    ComparisonLog();
+
+    /// name of the mapping, as passed to the target
+    const std::string & name() const { return _memory.name(); }
+
+    ///
+    /// \brief  Empties the table before a run.
+    ///
+    void clear();
+
+    /// number of logged comparisons
+    size_t size() const;
+
+    const fuzzengine_cmp & operator[](size_t index) const { return table()->entries[index]; }
+
+private:
+    const fuzzengine_cmplog * table() const { return reinterpret_cast<const fuzzengine_cmplog *>(_memory.data()); }
+
+    SharedMemory    _memory;
+};
+
+} // namespace execution
+
+} // namespace fuzzer
+
+#endif
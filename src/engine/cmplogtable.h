@@ -0,0 +1,42 @@
+#ifndef _CMPLOGTABLE_H_
+#define _CMPLOGTABLE_H_
+
+/*
+ * Layout of the comparison log shared with instrumented targets. Plain C so
+ * that the target side runtime can include it.
+ */
+
+#include <stdint.h>
+
+#define FUZZENGINE_CMPLOG_ENTRIES   4096
+
+/* the second operand is a compile time constant */
+#define FUZZENGINE_CMP_CONST        0x01
+
+/*
+ * Operands of one comparison. arg1 and arg2 hold the values zero extended
+ * to 64 bits, size is the operand width in bytes.
+ */
+struct fuzzengine_cmp
+{
+    uint64_t    arg1;
+    uint64_t    arg2;
+    uint32_t    site;       /* return address of the callback, truncated */
+    uint8_t     size;
+    uint8_t     flags;
+    uint16_t    reserved;
+};
+
+/*
+ * The target reserves an entry with an atomic increment of count, entries
+ * past FUZZENGINE_CMPLOG_ENTRIES are dropped. The engine sets count to zero
+ * before each run.
+ */
+struct fuzzengine_cmplog
+{
+    volatile uint32_t       count;
+    uint32_t                reserved;
+    struct fuzzengine_cmp   entries[FUZZENGINE_CMPLOG_ENTRIES];
+};
+
+#endif
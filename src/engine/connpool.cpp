@@ -0,0 +1,228 @@
+#include "connpool.h"
+#include <chrono>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#ifdef WIN32
+#include <ws2tcpip.h>
+#else
+#include <sys/socket.h>
+#include <netdb.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+using namespace std;
+
+namespace fuzzer {
+
+namespace network {
+
+/// longest wait before the connects are refilled, in ms
+static const size_t PollInterval = 10;
+
+static void CloseSocket(Socket_t sock)
+{
+#ifdef WIN32
+    closesocket(sock);
+#else
+    close(sock);
+#endif
+}
+
+ConnectionPool::ConnectionPool(const std::string & Host, uint16_t Port, size_t Size) :
+    _size(Size ? Size : 1),
+    _polling(0),
+    _generation(0)
+{
+    stringstream portString;
+    portString << Port;
+
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family     = AF_UNSPEC;
+    hints.ai_socktype   = SOCK_STREAM;
+    hints.ai_protocol   = IPPROTO_TCP;
+    addrinfo * result;
+    if (getaddrinfo(Host.c_str(), portString.str().c_str(), &hints, &result) != 0) {
+        throw std::runtime_error("getaddrinfo failed.");
+    }
+    const uint8_t * address = reinterpret_cast<const uint8_t *>(result->ai_addr);
+    _address.assign(address, address + result->ai_addrlen);
+    _family = result->ai_family;
+    freeaddrinfo(result);
+}
+
+ConnectionPool::~ConnectionPool()
+{
+    Reset();
+}
+
+void ConnectionPool::Reset()
+{
+    lock_guard<mutex> lock(_mutex);
+    for(size_t i = 0; i < _pending.size(); ++i) {
+        CloseSocket(_pending[i]);
+    }
+    _pending.clear();
+    _ready.clear();
+    /// the connects being polled are closed when the poll returns
+    ++_generation;
+}
+
+size_t ConnectionPool::ready()
+{
+    lock_guard<mutex> lock(_mutex);
+    return _ready.size();
+}
+
+shared_ptr<TcpSocket> ConnectionPool::Take(size_t TimeOut)
+{
+    const chrono::steady_clock::time_point deadline =
+        chrono::steady_clock::now() + chrono::milliseconds(TimeOut);
+    unique_lock<mutex> lock(_mutex);
+    for(;;) {
+        Refill();
+        while(!_ready.empty()) {
+            shared_ptr<TcpSocket> sock = _ready.front();
+            _ready.pop_front();
+            /// start its replacement
+            Refill();
+            if (sock->connected()) {
+                return sock;
+            }
+        }
+        const chrono::steady_clock::time_point now = chrono::steady_clock::now();
+        if (now >= deadline) {
+            return nullptr;
+        }
+        const size_t remaining = static_cast<size_t>(
+            chrono::duration_cast<chrono::milliseconds>(deadline - now).count());
+        Poll(remaining < PollInterval ? remaining : PollInterval, lock);
+    }
+}
+
+void ConnectionPool::Refill()
+{
+    while(_pending.size() + _polling + _ready.size() < _size) {
+        Socket_t sock = socket(_family, SOCK_STREAM, IPPROTO_TCP);
+#ifdef WIN32
+        if (sock == INVALID_SOCKET) {
+            return;
+        }
+        unsigned long mode = 1;
+        if (ioctlsocket(sock, FIONBIO, &mode) != 0) {
+            closesocket(sock);
+            return;
+        }
+        if (connect(sock, reinterpret_cast<const sockaddr *>(&_address[0]), (int) _address.size()) == 0) {
+            _ready.push_back(make_shared<TcpSocket>(sock));
+        } else if (WSAGetLastError() == WSAEWOULDBLOCK) {
+            _pending.push_back(sock);
+        } else {
+            closesocket(sock);
+            return;
+        }
+#else
+        if (sock < 0) {
+            return;
+        }
+        if (fcntl(sock, F_SETFL, fcntl(sock, F_GETFL) | O_NONBLOCK) != 0) {
+            close(sock);
+            return;
+        }
+        if (connect(sock, reinterpret_cast<const sockaddr *>(&_address[0]), _address.size()) == 0) {
+            _ready.push_back(make_shared<TcpSocket>(sock));
+        } else if (errno == EINPROGRESS) {
+            _pending.push_back(sock);
+        } else {
+            close(sock);
+            return;
+        }
+#endif
+    }
+}
+
+void ConnectionPool::Poll(size_t TimeOut, unique_lock<mutex> & lock)
+{
+    /// the connects are owned by this thread until the lock is taken again
+    vector<Socket_t> pending;
+    pending.swap(_pending);
+    _polling += pending.size();
+    const uint64_t generation = _generation;
+    lock.unlock();
+
+    vector<bool> done(pending.size(), false), established(pending.size(), false);
+    size_t failures = 0;
+    if (pending.empty()) {
+        /// the connects failed at once, retry after the interval
+        this_thread::sleep_for(chrono::milliseconds(TimeOut));
+    } else {
+#ifdef WIN32
+        /// a fd_set holds FD_SETSIZE sockets, the rest are polled next time
+        const size_t count = pending.size() < FD_SETSIZE ? pending.size() : FD_SETSIZE;
+        fd_set writable, failed;
+        FD_ZERO(&writable);
+        FD_ZERO(&failed);
+        for(size_t i = 0; i < count; ++i) {
+            FD_SET(pending[i], &writable);
+            FD_SET(pending[i], &failed);
+        }
+        timeval tv;
+        tv.tv_sec   = static_cast<long>(TimeOut / 1000);
+        tv.tv_usec  = static_cast<long>((TimeOut % 1000) * 1000);
+        if (select(0, NULL, &writable, &failed, &tv) > 0) {
+            for(size_t i = 0; i < count; ++i) {
+                done[i]         = FD_ISSET(pending[i], &writable) || FD_ISSET(pending[i], &failed);
+                established[i]  = FD_ISSET(pending[i], &writable) != 0;
+            }
+        }
+#else
+        vector<pollfd> fds(pending.size());
+        for(size_t i = 0; i < pending.size(); ++i) {
+            fds[i].fd       = pending[i];
+            fds[i].events   = POLLOUT;
+            fds[i].revents  = 0;
+        }
+        if (poll(&fds[0], fds.size(), static_cast<int>(TimeOut)) > 0) {
+            for(size_t i = 0; i < pending.size(); ++i) {
+                if (fds[i].revents) {
+                    int error = 0;
+                    socklen_t length = sizeof(error);
+                    done[i]         = true;
+                    established[i]  = getsockopt(pending[i], SOL_SOCKET, SO_ERROR, &error, &length) == 0 && error == 0;
+                }
+            }
+        }
+#endif
+        for(size_t i = 0; i < pending.size(); ++i) {
+            failures += done[i] && !established[i];
+        }
+        if (failures == pending.size()) {
+            /// not listening yet, don't retry at once
+            this_thread::sleep_for(chrono::milliseconds(TimeOut));
+        }
+    }
+
+    lock.lock();
+    _polling -= pending.size();
+    /// after a Reset() the connects belong to the previous launch
+    const bool current = generation == _generation;
+    for(size_t i = 0; i < pending.size(); ++i) {
+        if (current && !done[i]) {
+            _pending.push_back(pending[i]);
+        } else if (current && established[i]) {
+            _ready.push_back(make_shared<TcpSocket>(pending[i]));
+        } else {
+            CloseSocket(pending[i]);
+        }
+    }
+}
+
+} // namespace network
+
+} // namespace fuzzer
@@ -0,0 +1,84 @@
+#ifndef _CONNPOOL_H_
+#define _CONNPOOL_H_
+
+#include "tcp.h"
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace fuzzer {
+
+namespace network {
+
+///
+/// \class  ConnectionPool
+/// \brief  Connections to a listening target, established ahead of use.
+///         Connects are non-blocking and run side by side, every connection
+///         that is taken is replaced by a new connect, so that the pool
+///         keeps \p Size connections established or in progress. The pool
+///         can be shared by several threads, which wait for their connects
+///         without holding the lock.
+///
+class ConnectionPool
+{
+public:
+    ///
+    /// \brief  Resolves \p Host, throws a std::runtime_error if it can't be
+    ///         resolved. Nothing is connected until the pool is used.
+    ///
+    ConnectionPool(const std::string & Host, uint16_t Port, size_t Size);
+
+    ///
+    /// \brief  Destructor, closes the connections.
+    ///
+    ~ConnectionPool();
+
+    ///
+    /// \brief  Takes an established connection, connections that the
+    ///         target closed while they waited in the pool are dropped.
+    ///
+    /// \param [in] TimeOut     Operation timeout in ms.
+    ///
+    /// \return The connection, or nullptr if none was established in time.
+    ///
+    std::shared_ptr<TcpSocket> Take(size_t TimeOut);
+
+    ///
+    /// \brief  Closes the connections, for example after the target was
+    ///         relaunched.
+    ///
+    void Reset();
+
+    /// number of established connections
+    size_t ready();
+
+private:
+    ConnectionPool(const ConnectionPool &);
+    ConnectionPool & operator=(const ConnectionPool &);
+
+    /// starts connects until the pool is full
+    void Refill();
+
+    ///
+    /// \brief  Waits at most \p TimeOut ms for the connects in progress,
+    ///         \p lock is released meanwhile.
+    ///
+    void Poll(size_t TimeOut, std::unique_lock<std::mutex> & lock);
+
+    std::vector<uint8_t>                        _address;   //< sockaddr of the target
+    int                                         _family;
+    size_t                                      _size;
+    std::vector<Socket_t>                       _pending;   //< connects in progress
+    size_t                                      _polling;   //< connects being polled, not in _pending
+    uint64_t                                    _generation;//< of Reset()
+    std::deque<std::shared_ptr<TcpSocket> >     _ready;
+    std::mutex                                  _mutex;
+};
+
+} // namespace network
+
+} // namespace fuzzer
+
+#endif
@@ -0,0 +1,40 @@
+#include "coverage.h"
+#include <cstring>
+
+namespace fuzzer {
+
+namespace execution {
+
+const char * CoverageMap::EnvironmentVariable = "FUZZENGINE_SHM";
+
+CoverageMap::CoverageMap() : _memory(MapSize)
+{
+}
+
+CoverageMap::~CoverageMap()
+{
+}
+
+void CoverageMap::clear()
+{
+    memset(data(), 0, MapSize);
+}
+
+uint64_t CoverageMap::checksum() const
+{
+    /// FNV-1a over 64 bit words, most of the map is zero
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for(size_t offset = 0; offset < MapSize; offset += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, data() + offset, sizeof(word));
+        if (word) {
+            hash ^= word ^ offset;
+            hash *= 0x100000001b3ULL;
+        }
+    }
+    return hash;
+}
+
+} // namespace execution
+
+} // namespace fuzzer
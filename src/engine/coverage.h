@@ -0,0 +1,61 @@
+#ifndef _COVERAGE_H_
+#define _COVERAGE_H_
+
+#include "sharedmemory.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+namespace fuzzer {
+
+namespace execution {
+
+///
+/// \class  CoverageMap
+/// \brief  Shared memory map of edge hit counts, written by a target that
+///         is instrumented with SanitizerCoverage and links
+///         src/harness/coverage.c. The name of the mapping is passed to the
+///         target in the environment variable EnvironmentVariable.
+///
+class CoverageMap
+{
+public:
+    static const size_t MapSize = 1 << 16;
+    static const char * EnvironmentVariable;
+
+    ///
+    /// \brief  Creates a new, uniquely named mapping. Throws a
+    ///         std::runtime_error if the mapping can't be created.
+    ///
+    CoverageMap();
+    ~CoverageMap();
+
+    /// name of the mapping, as passed to the target
+    const std::string & name() const { return _memory.name(); }
+
+    uint8_t * data() { return _memory.data(); }
+    const uint8_t * data() const { return _memory.data(); }
+
+    ///
+    /// \brief  Clears the map before a run.
+    ///
+    void clear();
+
+    ///
+    /// \brief  Hash of the map, equal for runs that reach the same edges
+    ///         the same number of times.
+    ///
+    uint64_t checksum() const;
+
+private:
+    CoverageMap(const CoverageMap &);
+    CoverageMap & operator=(const CoverageMap &);
+
+    SharedMemory    _memory;
+};
+
+} // namespace execution
+
+} // namespace fuzzer
+
+#endif
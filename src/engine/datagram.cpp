@@ -0,0 +1,292 @@
+#include "datagram.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+#ifdef WIN32
+#include <ws2tcpip.h>
+#else
+#include <sys/socket.h>
+#include <netdb.h>
+#include <poll.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+using namespace std;
+
+namespace fuzzer {
+
+namespace network {
+
+///////////////////////////////////////////////////////////////////////////////
+//                                  DatagramSocket                           //
+///////////////////////////////////////////////////////////////////////////////
+
+DatagramSocket::DatagramSocket(const std::string & Host, uint16_t Port) :
+    _timeout(2000),
+    _offset(0)
+{
+    stringstream portString;
+    portString << Port;
+
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family     = AF_UNSPEC;
+    hints.ai_socktype   = SOCK_DGRAM;
+    hints.ai_protocol   = IPPROTO_UDP;
+    addrinfo * result;
+    if (getaddrinfo(Host.c_str(), portString.str().c_str(), &hints, &result) != 0) {
+        throw std::runtime_error("getaddrinfo failed.");
+    }
+    _sock = socket(result->ai_family, SOCK_DGRAM, IPPROTO_UDP);
+#ifdef WIN32
+    if (_sock == INVALID_SOCKET) {
+#else
+    if (_sock < 0) {
+#endif
+        freeaddrinfo(result);
+        throw std::runtime_error("Failed to create socket.");
+    }
+    /// connected, so that only the target's datagrams are received
+    if (connect(_sock, result->ai_addr, (int) result->ai_addrlen) != 0) {
+        freeaddrinfo(result);
+#ifdef WIN32
+        closesocket(_sock);
+#else
+        close(_sock);
+#endif
+        throw std::runtime_error("Failed to connect.");
+    }
+    freeaddrinfo(result);
+}
+
+DatagramSocket::~DatagramSocket()
+{
+#ifdef WIN32
+    closesocket(_sock);
+#else
+    close(_sock);
+#endif
+}
+
+bool DatagramSocket::write(const void * Source, size_t count)
+{
+    if (_out.size() + count > MaxDatagram) {
+        return false;
+    }
+    const uint8_t * ptr = static_cast<const uint8_t *>(Source);
+    _out.insert(_out.end(), ptr, ptr + count);
+    return true;
+}
+
+bool DatagramSocket::flush()
+{
+    if (_out.empty()) {
+        return true;
+    }
+    const int res = ::send(_sock, reinterpret_cast<const char *>(&_out[0]), (int) _out.size(), 0);
+    const bool sent = res == static_cast<int>(_out.size());
+    _out.clear();
+    return sent;
+}
+
+void DatagramSocket::reset()
+{
+    _out.clear();
+    _in.clear();
+    _offset = 0;
+}
+
+bool DatagramSocket::wait(size_t TimeOut)
+{
+#ifdef WIN32
+    fd_set set;
+    FD_ZERO(&set);
+    FD_SET(_sock, &set);
+    timeval tv;
+    tv.tv_sec   = static_cast<long>(TimeOut / 1000);
+    tv.tv_usec  = static_cast<long>((TimeOut % 1000) * 1000);
+    return select(0, &set, NULL, NULL, &tv) > 0;
+#else
+    pollfd fd;
+    fd.fd       = _sock;
+    fd.events   = POLLIN;
+    fd.revents  = 0;
+    return poll(&fd, 1, static_cast<int>(TimeOut)) > 0;
+#endif
+}
+
+bool DatagramSocket::next()
+{
+    if (!wait(_timeout)) {
+        throw io::IoException("Read operation timed out.");
+    }
+    _in.resize(MaxDatagram);
+    const int res = recv(_sock, reinterpret_cast<char *>(&_in[0]), (int) _in.size(), 0);
+    if (res < 0) {
+        /// also an ICMP port unreachable for the previous datagram
+        _in.clear();
+        return false;
+    }
+    _in.resize(res);
+    _offset = 0;
+    return true;
+}
+
+bool DatagramSocket::read(void * Dst, size_t count)
+{
+    return receive(Dst, count, count) == count;
+}
+
+size_t DatagramSocket::receive(void * Dst, size_t min, size_t max)
+{
+    if (!flush()) {
+        return 0;
+    }
+    uint8_t * ptr = static_cast<uint8_t *>(Dst);
+    size_t received = 0;
+    do {
+        if (_offset == _in.size() && !next()) {
+            return 0;
+        }
+        const size_t count = std::min(_in.size() - _offset, max - received);
+        memcpy(ptr + received, &_in[_offset], count);
+        _offset     += count;
+        received    += count;
+    } while(received < min);
+    return received;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//                                  DatagramBatch                            //
+///////////////////////////////////////////////////////////////////////////////
+
+DatagramBatch::DatagramBatch(DatagramSocket & socket, size_t Capacity) :
+    _socket(socket),
+    _capacity(Capacity ? Capacity : 1)
+{
+}
+
+bool DatagramBatch::write(const void * Source, size_t count)
+{
+    const size_t begin = _ends.empty() ? 0 : _ends.back();
+    if (full() || _data.size() - begin + count > DatagramSocket::MaxDatagram) {
+        return false;
+    }
+    const uint8_t * ptr = static_cast<const uint8_t *>(Source);
+    _data.insert(_data.end(), ptr, ptr + count);
+    return true;
+}
+
+bool DatagramBatch::flush()
+{
+    if (full()) {
+        return false;
+    }
+    _ends.push_back(_data.size());
+    return true;
+}
+
+bool DatagramBatch::read(void *, size_t)
+{
+    return false;
+}
+
+void DatagramBatch::clear()
+{
+    _data.clear();
+    _ends.clear();
+    _lengths.clear();
+}
+
+const uint8_t * DatagramBatch::response(size_t index, size_t & size) const
+{
+    size = _lengths[index];
+    return &_received[index * MaxResponse];
+}
+
+size_t DatagramBatch::send()
+{
+    size_t sent = 0;
+    if (_ends.empty()) {
+        return sent;
+    }
+#ifdef __linux__
+    /// one sendmmsg for the batch, unless the socket buffer fills up
+    std::vector<mmsghdr> messages(_ends.size());
+    std::vector<iovec> buffers(_ends.size());
+    memset(&messages[0], 0, messages.size() * sizeof(mmsghdr));
+    for(size_t i = 0; i < _ends.size(); ++i) {
+        const size_t begin = i ? _ends[i - 1] : 0;
+        buffers[i].iov_base = _data.data() + begin;
+        buffers[i].iov_len  = _ends[i] - begin;
+        messages[i].msg_hdr.msg_iov     = &buffers[i];
+        messages[i].msg_hdr.msg_iovlen  = 1;
+    }
+    while(sent < messages.size()) {
+        const int res = sendmmsg(_socket.handle(), &messages[sent], static_cast<unsigned int>(messages.size() - sent), 0);
+        if (res < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        sent += res;
+    }
+#else
+    for(; sent < _ends.size(); ++sent) {
+        const size_t begin = sent ? _ends[sent - 1] : 0;
+        const int length = static_cast<int>(_ends[sent] - begin);
+        if (::send(_socket.handle(), reinterpret_cast<const char *>(_data.data() + begin), length, 0) != length) {
+            break;
+        }
+    }
+#endif
+    return sent;
+}
+
+size_t DatagramBatch::collect(size_t TimeOut)
+{
+    const chrono::steady_clock::time_point deadline =
+        chrono::steady_clock::now() + chrono::milliseconds(TimeOut);
+    _received.resize(_ends.size() * MaxResponse);
+    while(_lengths.size() < _ends.size()) {
+        const chrono::steady_clock::time_point now = chrono::steady_clock::now();
+        if (now >= deadline || !_socket.wait(static_cast<size_t>(
+            chrono::duration_cast<chrono::milliseconds>(deadline - now).count())))
+        {
+            break;
+        }
+        const size_t first = _lengths.size();
+#ifdef __linux__
+        /// everything that has arrived, with one recvmmsg
+        const size_t count = _ends.size() - first;
+        std::vector<mmsghdr> messages(count);
+        std::vector<iovec> buffers(count);
+        memset(&messages[0], 0, count * sizeof(mmsghdr));
+        for(size_t i = 0; i < count; ++i) {
+            buffers[i].iov_base = &_received[(first + i) * MaxResponse];
+            buffers[i].iov_len  = MaxResponse;
+            messages[i].msg_hdr.msg_iov     = &buffers[i];
+            messages[i].msg_hdr.msg_iovlen  = 1;
+        }
+        const int res = recvmmsg(_socket.handle(), &messages[0], static_cast<unsigned int>(count), MSG_DONTWAIT, nullptr);
+        for(int i = 0; i < res; ++i) {
+            _lengths.push_back(messages[i].msg_len < MaxResponse ? messages[i].msg_len : MaxResponse);
+        }
+#else
+        const int res = recv(_socket.handle(), reinterpret_cast<char *>(&_received[first * MaxResponse]), (int) MaxResponse, 0);
+        if (res >= 0) {
+            _lengths.push_back(static_cast<size_t>(res) < MaxResponse ? res : MaxResponse);
+        }
+#endif
+    }
+    return _lengths.size();
+}
+
+} // namespace network
+
+} // namespace fuzzer
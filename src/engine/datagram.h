@@ -0,0 +1,159 @@
+#ifndef _DATAGRAM_H_
+#define _DATAGRAM_H_
+
+#include "tcp.h"
+#include "io.h"
+#include <string>
+#include <vector>
+
+namespace fuzzer {
+
+namespace network {
+
+///
+/// \class  DatagramSocket
+/// \brief  UDP socket connected to a target. The writes up to a flush, or
+///         up to the next read, form one datagram. Reads consume the
+///         received datagrams in order, a datagram that is used up is
+///         followed by the next one.
+///
+class DatagramSocket : public io::Ipc
+{
+public:
+    /// largest UDP payload
+    static const size_t MaxDatagram = 65507;
+
+    ///
+    /// \brief  Connects to \p Host, throws a std::runtime_error if the
+    ///         socket can't be created or connected.
+    ///
+    DatagramSocket(const std::string & Host, uint16_t Port);
+
+    ///
+    /// \brief  Destructor, performs the required cleanup
+    ///
+    ~DatagramSocket();
+
+    ///
+    /// \brief  Appends to the datagram that is sent on the next flush.
+    ///
+    virtual bool write(const void * Source, size_t count);
+
+    ///
+    /// \brief  Sends the datagram, if anything was written.
+    ///
+    virtual bool flush();
+
+    ///
+    /// \brief  Reads from the received datagrams, sending the pending one
+    ///         first. Throws a IoException on timeout.
+    ///
+    virtual bool read(void * Dst, size_t count);
+
+    ///
+    /// \brief  Reads at least \p min bytes, and whatever else is left of
+    ///         the current datagram up to \p max.
+    ///
+    virtual size_t receive(void * Dst, size_t min, size_t max);
+
+    /// timeout of the reads, in ms
+    void SetTimeout(size_t TimeOut) { _timeout = TimeOut; }
+
+    ///
+    /// \brief  Drops the pending datagram and what is left of the received
+    ///         one, so that a test case starts afresh.
+    ///
+    void reset();
+
+    Socket_t handle() const { return _sock; }
+
+    ///
+    /// \brief  Waits at most \p TimeOut ms for the socket to be readable.
+    ///
+    bool wait(size_t TimeOut);
+
+private:
+    DatagramSocket(const DatagramSocket &);
+    DatagramSocket & operator=(const DatagramSocket &);
+
+    /// receives the next datagram
+    bool next();
+
+    Socket_t                _sock;
+    size_t                  _timeout;
+    std::vector<uint8_t>    _out;       //< pending datagram
+    std::vector<uint8_t>    _in;        //< received datagram
+    size_t                  _offset;    //< read from _in
+};
+
+///
+/// \class  DatagramBatch
+/// \brief  Independent datagrams that are sent together, with a single
+///         sendmmsg() where available, and their responses, collected with
+///         recvmmsg(). The datagrams are written like to any destination,
+///         each flush ends one. Reads fail, a test case in a batch can't
+///         depend on a response.
+///
+///         The responses are in the order they were received, which needn't
+///         be the order of the datagrams. Longer responses than
+///         MaxResponse are truncated.
+///
+class DatagramBatch : public io::Ipc
+{
+public:
+    /// largest response that is kept
+    static const size_t MaxResponse = 4096;
+
+    DatagramBatch(DatagramSocket & socket, size_t Capacity);
+
+    /// appends to the current datagram
+    virtual bool write(const void * Source, size_t count);
+
+    /// ends the current datagram, false if the batch is full
+    virtual bool flush();
+
+    /// always fails, see the class description
+    virtual bool read(void * Dst, size_t count);
+
+    /// number of datagrams
+    size_t size() const { return _ends.size(); }
+    bool full() const { return _ends.size() >= _capacity; }
+
+    ///
+    /// \brief  Sends the datagrams.
+    ///
+    /// \return The number of datagrams sent.
+    ///
+    size_t send();
+
+    ///
+    /// \brief  Collects responses until there is one per datagram, or for
+    ///         at most \p TimeOut ms.
+    ///
+    /// \return The number of responses.
+    ///
+    size_t collect(size_t TimeOut);
+
+    /// number of responses
+    size_t responses() const { return _lengths.size(); }
+
+    /// response \p index, \p size is set to its length
+    const uint8_t * response(size_t index, size_t & size) const;
+
+    /// drops the datagrams and responses
+    void clear();
+
+private:
+    DatagramSocket &        _socket;
+    size_t                  _capacity;
+    std::vector<uint8_t>    _data;          //< the datagrams, back to back
+    std::vector<size_t>     _ends;          //< end of each datagram in _data
+    std::vector<uint8_t>    _received;      //< MaxResponse bytes per response
+    std::vector<size_t>     _lengths;       //< of the responses
+};
+
+} // namespace network
+
+} // namespace fuzzer
+
+#endif
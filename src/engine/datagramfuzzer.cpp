@@ -0,0 +1,117 @@
+#include "datagramfuzzer.h"
+#include "ioerror.h"
+#include <iostream>
+
+using namespace std;
+
+namespace fuzzer {
+
+namespace runtime {
+
+///
+/// \brief  Constructor
+///
+DatagramFuzzer::DatagramFuzzer(network::DatagramSocket & socket, execution::IApplicationExecuter * app) :
+    _socket(socket),
+    _app(app)
+{
+}
+
+void DatagramFuzzer::Launch()
+{
+    if (_app && !_app->IsAlive() && !_app->Launch()) {
+        std::cout << "Failed to launch application." << std::endl;
+    }
+}
+
+bool DatagramFuzzer::Died()
+{
+    if (!_app || _app->IsAlive()) {
+        return false;
+    }
+    int statusCode;
+    execution::TerminationReason reason;
+    _app->GetStatusCode(statusCode, reason);
+    std::cout << "App exited with " << statusCode << std::endl;
+    return true;
+}
+
+void DatagramFuzzer::Execute(const bytecode::Script & script)
+{
+    try {
+        _vm.Execute( script );
+        if (!_ipc->flush()) {
+            throw io::IoException("Failed to send datagram.");
+        }
+    } catch(io::IoException & err) {
+        /// error while communicating with peer
+        std::cout << "Caught I/O exception: " << err.what() << std::endl;
+    } catch(std::runtime_error & err) {
+        std::cout << "Caught runtime error: " << err.what() << std::endl;
+    } catch(...) {
+        /// caught an exception while executing the script
+        std::cout << "Caught unknown exception." << std::endl;
+    }
+}
+
+///
+/// \brief  Performs random fuzzing
+///
+void DatagramFuzzer::RunHavoc(const bytecode::Script & script, uint64_t Seed,
+    size_t Worker, uint64_t Cases)
+{
+    Compile(script);
+    HavocScheduler scheduler(script, Seed, Worker);
+    for(uint64_t i = 0; i < Cases; ++i) {
+        scheduler.next();
+        /// the description regenerates the case with HavocScheduler::apply
+        std::cout << scheduler.describe() << std::endl;
+        Launch();
+        /// responses to the previous case aren't read by this one
+        _socket.reset();
+        Attach(&_socket);
+        Execute(script);
+        Attach(nullptr);
+        Died();
+    }
+}
+
+///
+/// \brief  Performs random fuzzing in batches
+///
+void DatagramFuzzer::RunBatched(const bytecode::Script & script, size_t Batch,
+    size_t ResponseTimeout, uint64_t Seed, size_t Worker, uint64_t Cases)
+{
+    Compile(script);
+    HavocScheduler scheduler(script, Seed, Worker);
+    network::DatagramBatch batch(_socket, Batch);
+    for(uint64_t i = 0; i < Cases;) {
+        Launch();
+        batch.clear();
+        Attach(&batch);
+        for(; i < Cases && !batch.full(); ++i) {
+            scheduler.next();
+            std::cout << scheduler.describe() << std::endl;
+            const size_t datagrams = batch.size();
+            Execute(script);
+            if (batch.size() == datagrams) {
+                /// the case failed before it was complete, it is sent as it is
+                batch.flush();
+            }
+        }
+        Attach(nullptr);
+
+        const size_t sent = batch.send();
+        if (sent < batch.size()) {
+            std::cout << "Sent " << sent << " of " << batch.size() << " datagrams." << std::endl;
+        }
+        batch.collect(ResponseTimeout);
+        if (Died()) {
+            std::cout << "The application died during the last " << batch.size() << " test cases." << std::endl;
+        }
+    }
+}
+
+} // namespace runtime
+
+} // namespace fuzzer
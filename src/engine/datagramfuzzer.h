@@ -0,0 +1,64 @@
+#ifndef _DATAGRAMFUZZER_H_
+#define _DATAGRAMFUZZER_H_
+
+#include "fuzzer.h"
+#include "datagram.h"
+#include "appexec.h"
+#include "script.h"
+#include "havoc.h"
+
+namespace fuzzer {
+
+namespace runtime {
+
+///
+/// \class  DatagramFuzzer
+/// \brief  Fuzzes datagram based servers, such as DNS, SNMP and CoAP. The
+///         output of a script up to a read, or to its end, is one datagram.
+///         The application, if one is given, is launched when it isn't
+///         running and its crashes are reported.
+///
+class DatagramFuzzer : public Fuzzer
+{
+public:
+    ///
+    /// \brief  Constructor
+    ///
+    DatagramFuzzer(network::DatagramSocket &, execution::IApplicationExecuter * app = nullptr);
+
+    ///
+    /// \brief  Performs random fuzzing one test case at a time, the script
+    ///         can read the responses.
+    ///
+    void RunHavoc(const bytecode::Script &, uint64_t Seed, size_t Worker = 0,
+        uint64_t Cases = ~0ULL);
+
+    ///
+    /// \brief  Performs random fuzzing \p Batch test cases at a time. Each
+    ///         case is one datagram, the batch is sent with a single
+    ///         sendmmsg() and the responses are collected for at most
+    ///         \p ResponseTimeout ms. The script can't read, and a crash is
+    ///         attributed to the whole batch.
+    ///
+    void RunBatched(const bytecode::Script &, size_t Batch, size_t ResponseTimeout,
+        uint64_t Seed, size_t Worker = 0, uint64_t Cases = ~0ULL);
+
+private:
+    /// launches the application if it isn't running
+    void Launch();
+
+    /// true if the application has died, which is reported
+    bool Died();
+
+    /// runs the script once, writing to the attached ipc
+    void Execute(const bytecode::Script &);
+
+    network::DatagramSocket &           _socket;
+    execution::IApplicationExecuter *   _app;
+};
+
+} // namespace runtime
+
+} // namespace fuzzer
+
+#endif
@@ -14,6 +14,21 @@ Destination::~Destination()
 {
 }
 
+bool Destination::writev(const Piece * pieces, size_t count)
+{
+    for(size_t i = 0; i < count; ++i) {
+        if (pieces[i].length && !write(pieces[i].base, pieces[i].length)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Destination::flush()
+{
+    return true;
+}
+
 void Destination::write_big_endian()
 {
     _big_endian = true;
@@ -33,33 +48,40 @@ void Destination::writeU8(uint8_t value)
 
 void Destination::writeU16(uint16_t value)
 {
-    value = host16_to_be(value);
-    if (!write(&value, sizeof(uint16_t))) {
-        throw IoException("Failed to write U16.");
+    if (_big_endian) {
+        EndianWriter<ORDER_BIG_ENDIAN>(*this).writeU16(value);
+    } else {
+        EndianWriter<ORDER_LITTLE_ENDIAN>(*this).writeU16(value);
     }
 }
 
 void Destination::writeU24(uint32_t value)
 {
-    throw IoException("Failed to write U24.");
+    if (_big_endian) {
+        EndianWriter<ORDER_BIG_ENDIAN>(*this).writeU24(value);
+    } else {
+        EndianWriter<ORDER_LITTLE_ENDIAN>(*this).writeU24(value);
+    }
 }
 
 void Destination::writeU32(uint32_t value)
 {
-    value = host32_to_be(value);
-    if (!write(&value, sizeof(uint32_t))) {
-        throw IoException("Failed to write U32.");
+    if (_big_endian) {
+        EndianWriter<ORDER_BIG_ENDIAN>(*this).writeU32(value);
+    } else {
+        EndianWriter<ORDER_LITTLE_ENDIAN>(*this).writeU32(value);
     }
 }
 
 void Destination::writeU64(uint64_t value)
 {
-    value = host64_to_be(value);
-    if (!write(&value, sizeof(uint64_t))) {
-        throw IoException("Failed to write U64.");
+    if (_big_endian) {
+        EndianWriter<ORDER_BIG_ENDIAN>(*this).writeU64(value);
+    } else {
+        EndianWriter<ORDER_LITTLE_ENDIAN>(*this).writeU64(value);
     }
 }
 
 }
 
-}
\ No newline at end of file
+}
@@ -2,11 +2,25 @@
 #define _DESTINATION_H_
 
 #include <stdint.h>
+#include <stddef.h>
+#include "endian.h"
+#include "ioerror.h"
 
 namespace fuzzer {
 
 namespace io {
 
+///
+/// \struct Piece
+/// \brief  Contiguous part of a scattered payload, laid out like a POSIX
+///         struct iovec.
+///
+struct Piece
+{
+    const void *    base;
+    size_t          length;
+};
+
 ///
 /// \class  Destination
 /// \brief
@@ -23,6 +37,7 @@ public:
 
     void write_big_endian();
     void write_little_endian();
+    bool is_big_endian() const { return _big_endian; }
 
     void writeU8(uint8_t);
     void writeU16(uint16_t);
@@ -35,12 +50,79 @@ public:
     ///
     virtual bool write(const void * dst, size_t count) = 0;
 
+    ///
+    /// \brief  Write a scattered payload. Destinations that support gather
+    ///         writes override this, the default writes one piece at a time.
+    ///
+    virtual bool writev(const Piece * pieces, size_t count);
+
+    ///
+    /// \brief  Ends a message. Destinations that collect the writes into
+    ///         messages, such as datagrams, send it now. The default does
+    ///         nothing.
+    ///
+    virtual bool flush();
+
 protected:
     bool _big_endian;
 };
 
+///
+/// \class  EndianWriter
+/// \brief  Writes integers to a destination in a byte order that is fixed at
+///         compile time, ignoring the runtime setting of the destination.
+///
+template<ByteOrder Order>
+class EndianWriter
+{
+public:
+    explicit EndianWriter(Destination & dst) : _dst(dst)
+    {
+    }
+
+    void writeU8(uint8_t value)
+    {
+        put(&value, sizeof(value), "Failed to write U8.");
+    }
+
+    void writeU16(uint16_t value)
+    {
+        value = Endian<Order>::convert16(value);
+        put(&value, sizeof(value), "Failed to write U16.");
+    }
+
+    void writeU24(uint32_t value)
+    {
+        uint8_t bytes[3];
+        Endian<Order>::store24(bytes, value);
+        put(bytes, sizeof(bytes), "Failed to write U24.");
+    }
+
+    void writeU32(uint32_t value)
+    {
+        value = Endian<Order>::convert32(value);
+        put(&value, sizeof(value), "Failed to write U32.");
+    }
+
+    void writeU64(uint64_t value)
+    {
+        value = Endian<Order>::convert64(value);
+        put(&value, sizeof(value), "Failed to write U64.");
+    }
+
+protected:
+    void put(const void * data, size_t count, const char * error)
+    {
+        if (!_dst.write(data, count)) {
+            throw IoException(error);
+        }
+    }
+
+    Destination & _dst;
+};
+
 } // namespace io
 
 } // namespace fuzzer
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,292 @@
+#include "dictionary.h"
+#include "script.h"
+#include "templateitem.h"
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace fuzzer {
+
+namespace runtime {
+
+///
+/// \brief  Header of a saved table, followed by the tokens and the bytes.
+///
+struct DictionaryHeader {
+    char        magic[8];
+    uint32_t    count;      //< number of tokens
+    uint32_t    bytes;      //< size of the token bytes
+};
+
+static const char DictionaryMagic[8] = {'F', 'Z', 'D', 'I', 'C', 'T', '0', '1'};
+
+static uint64_t Hash(const void * data, size_t size)
+{
+    /// FNV-1a
+    const uint8_t * bytes = static_cast<const uint8_t *>(data);
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for(size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+static std::runtime_error Malformed(size_t line)
+{
+    std::stringstream ss;
+    ss << "Malformed dictionary entry on line " << line << ".";
+    return std::runtime_error(ss.str());
+}
+
+static int HexValue(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    return (tolower(static_cast<unsigned char>(c)) - 'a') + 10;
+}
+
+Dictionary::Dictionary() :
+    _table(nullptr),
+    _bytes(nullptr),
+    _count(0),
+    _total(0)
+{
+}
+
+void Dictionary::load(const char * filename)
+{
+    std::shared_ptr<io::MappedFile> file = std::make_shared<io::MappedFile>(filename);
+    const DictionaryHeader * header = reinterpret_cast<const DictionaryHeader *>(file->data());
+    if (file->size() < sizeof(DictionaryHeader) || memcmp(header->magic, DictionaryMagic, sizeof(DictionaryMagic))) {
+        /// AFL text format, the tokens are copied into the table
+        parse(reinterpret_cast<const char *>(file->data()), file->size());
+        return;
+    }
+    if (!empty()) {
+        throw std::runtime_error("A saved dictionary must be loaded first.");
+    }
+    const uint64_t expected = sizeof(DictionaryHeader) + static_cast<uint64_t>(header->count) * sizeof(Token) + header->bytes;
+    if (expected != file->size()) {
+        throw std::runtime_error("Invalid dictionary size.");
+    }
+    const Token * table = reinterpret_cast<const Token *>(file->data() + sizeof(DictionaryHeader));
+    for(size_t i = 0; i < header->count; ++i) {
+        if (!table[i].size || table[i].size > MaxTokenSize ||
+            static_cast<uint64_t>(table[i].offset) + table[i].size > header->bytes) {
+            throw std::runtime_error("Invalid dictionary token.");
+        }
+    }
+    /// the tokens are used in place
+    _file   = file;
+    _table  = table;
+    _bytes  = reinterpret_cast<const uint8_t *>(table + header->count);
+    _count  = header->count;
+    _total  = header->bytes;
+    _tokens.clear();
+    _blob.clear();
+    index();
+}
+
+void Dictionary::save(const char * filename) const
+{
+    FILE * file = fopen(filename, "wb");
+    if (!file) {
+        throw std::runtime_error("Failed to open file for writing.");
+    }
+    DictionaryHeader header;
+    memcpy(header.magic, DictionaryMagic, sizeof(DictionaryMagic));
+    header.count    = static_cast<uint32_t>(_count);
+    header.bytes    = static_cast<uint32_t>(_total);
+    const bool written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+        (!_count || fwrite(_table, sizeof(Token), _count, file) == _count) &&
+        (!_total || fwrite(_bytes, 1, _total, file) == _total);
+    if (fclose(file) != 0 || !written) {
+        throw std::runtime_error("Failed to write dictionary.");
+    }
+}
+
+void Dictionary::parse(const char * text, size_t size)
+{
+    size_t line = 0;
+    for(size_t pos = 0; pos < size;) {
+        const char * begin = text + pos;
+        const char * end = static_cast<const char *>(memchr(begin, '\n', size - pos));
+        if (!end) {
+            end = text + size;
+        }
+        pos = (end - text) + 1;
+        ++line;
+
+        while(begin < end && isspace(static_cast<unsigned char>(*begin))) {
+            ++begin;
+        }
+        while(end > begin && isspace(static_cast<unsigned char>(end[-1]))) {
+            --end;
+        }
+        if (begin == end || *begin == '#') {
+            continue;
+        }
+        /// optional name and @level, followed by '='
+        if (*begin != '"') {
+            while(begin < end && (isalnum(static_cast<unsigned char>(*begin)) || *begin == '_')) {
+                ++begin;
+            }
+            if (begin < end && *begin == '@') {
+                for(++begin; begin < end && isdigit(static_cast<unsigned char>(*begin)); ++begin);
+            }
+            while(begin < end && isspace(static_cast<unsigned char>(*begin))) {
+                ++begin;
+            }
+            if (begin == end || *begin != '=') {
+                throw Malformed(line);
+            }
+            for(++begin; begin < end && isspace(static_cast<unsigned char>(*begin)); ++begin);
+        }
+        if (end - begin < 2 || *begin != '"' || end[-1] != '"') {
+            throw Malformed(line);
+        }
+        /// the quoted value, with \\, \" and \xNN escapes
+        std::string token;
+        for(++begin, --end; begin < end;) {
+            const char c = *begin++;
+            if (c < 32 || c > 126) {
+                throw Malformed(line);
+            }
+            if (c != '\\') {
+                token += c;
+            } else if (begin < end && (*begin == '\\' || *begin == '"')) {
+                token += *begin++;
+            } else if (end - begin >= 3 && *begin == 'x' &&
+                isxdigit(static_cast<unsigned char>(begin[1])) && isxdigit(static_cast<unsigned char>(begin[2]))) {
+                token += static_cast<char>((HexValue(begin[1]) << 4) | HexValue(begin[2]));
+                begin += 3;
+            } else {
+                throw Malformed(line);
+            }
+        }
+        if (token.size() > MaxTokenSize) {
+            throw Malformed(line);
+        }
+        add(token.data(), token.size());
+    }
+}
+
+void Dictionary::harvest(const bytecode::Script & script)
+{
+    for(size_t i = 0; i < script._methods.size(); ++i) {
+        const std::vector<std::string> & strings = script._methods[i]->constant_strings;
+        for(size_t j = 0; j < strings.size(); ++j) {
+            add(strings[j].data(), strings[j].size());
+        }
+    }
+    for(auto it = script._templates.begin(); it != script._templates.end(); ++it) {
+        const std::vector<Item> & items = it->second->items();
+        const bool big_endian = it->second->is_big_endian();
+        for(size_t i = 0; i < items.size(); ++i) {
+            const Item & item = items[i];
+            uint64_t value;
+            size_t width;
+            switch(item.type) {
+            case Item::WORD:    value = item.u.word; width = 2; break;
+            case Item::WORD24:  value = item.u.dword; width = 3; break;
+            case Item::DWORD:
+            case Item::FLOAT:   value = item.u.dword; width = 4; break;
+            case Item::QWORD:
+            case Item::DOUBLE:  value = item.u.qword; width = 8; break;
+            case Item::BUFFER:
+                if (item.u.buffer.width == 1) {
+                    add(item.u.buffer.data, item.u.buffer.count);
+                }
+                continue;
+            default:
+                /// single bytes are covered by the interesting values
+                continue;
+            }
+            uint8_t bytes[8];
+            for(size_t b = 0; b < width; ++b) {
+                bytes[big_endian ? (width - 1 - b) : b] = static_cast<uint8_t>(value >> (8 * b));
+            }
+            add(bytes, width);
+        }
+    }
+}
+
+bool Dictionary::contains(const void * data, size_t size, uint64_t hash) const
+{
+    auto range = _hashes.equal_range(hash);
+    for(auto it = range.first; it != range.second; ++it) {
+        if (length(it->second) == size && !memcmp(this->data(it->second), data, size)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Dictionary::add(const void * data, size_t size)
+{
+    if (!size || size > MaxTokenSize) {
+        return false;
+    }
+    const uint64_t hash = Hash(data, size);
+    if (contains(data, size, hash)) {
+        return false;
+    }
+    materialize();
+    if (_blob.size() + size > 0xffffffffULL) {
+        throw std::runtime_error("Dictionary too large.");
+    }
+    Token token;
+    token.offset    = static_cast<uint32_t>(_blob.size());
+    token.size      = static_cast<uint32_t>(size);
+    _blob.insert(_blob.end(), static_cast<const uint8_t *>(data), static_cast<const uint8_t *>(data) + size);
+    _tokens.push_back(token);
+    _hashes.insert(std::make_pair(hash, _tokens.size() - 1));
+    update();
+    return true;
+}
+
+void Dictionary::materialize()
+{
+    if (!_file) {
+        return;
+    }
+    _tokens.assign(_table, _table + _count);
+    _blob.assign(_bytes, _bytes + _total);
+    _file.reset();
+    update();
+}
+
+void Dictionary::update()
+{
+    _table  = _tokens.data();
+    _bytes  = _blob.data();
+    _count  = _tokens.size();
+    _total  = _blob.size();
+}
+
+void Dictionary::index()
+{
+    _hashes.clear();
+    for(size_t i = 0; i < _count; ++i) {
+        _hashes.insert(std::make_pair(Hash(data(i), length(i)), i));
+    }
+}
+
+void AttachDictionary(const bytecode::Script & script, const std::shared_ptr<const Dictionary> & dictionary)
+{
+    for(auto it = script._templates.begin(); it != script._templates.end(); ++it) {
+        std::vector<Mutator *> mutators = it->second->GetMutators();
+        for(size_t i = 0; i < mutators.size(); ++i) {
+            mutators[i]->dictionary(dictionary);
+        }
+    }
+}
+
+} // namespace runtime
+
+} // namespace fuzzer
@@ -0,0 +1,114 @@
+#ifndef _DICTIONARY_H_
+#define _DICTIONARY_H_
+
+#include "mappedfile.h"
+#include "mutator.h"
+#include <stdint.h>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace fuzzer {
+
+namespace bytecode {
+struct Script;
+}
+
+namespace runtime {
+
+///
+/// \class  Dictionary
+/// \brief  Tokens such as protocol keywords and magic numbers that the
+///         mutators insert or overwrite with. The table is two flat arrays,
+///         token offsets and sizes followed by the token bytes, so a saved
+///         table is used straight from a memory mapping.
+///
+class Dictionary
+{
+public:
+    /// longest token, longer entries are rejected like in AFL
+    static const size_t MaxTokenSize = 128;
+
+    /// a token in the table
+    struct Token {
+        uint32_t    offset;     //< offset of the bytes
+        uint32_t    size;       //< size in bytes
+    };
+
+    Dictionary();
+
+    ///
+    /// \brief  Loads a table written by save(), or an AFL -x dictionary with
+    ///         one name="value" entry per line. Throws a std::runtime_error
+    ///         if the file can't be read or an entry is malformed.
+    ///
+    void load(const char * filename);
+
+    ///
+    /// \brief  Writes the table, in host byte order.
+    ///
+    void save(const char * filename) const;
+
+    ///
+    /// \brief  Adds the constant strings of the methods and the constants of
+    ///         the templates, in the byte order of the template.
+    ///
+    void harvest(const bytecode::Script &);
+
+    ///
+    /// \brief  Adds a token, false if it is empty, too long or known.
+    ///
+    bool add(const void * data, size_t size);
+
+    /// number of tokens
+    size_t size() const { return _count; }
+    bool empty() const { return _count == 0; }
+
+    const uint8_t * data(size_t index) const { return _bytes + _table[index].offset; }
+    size_t length(size_t index) const { return _table[index].size; }
+
+    ///
+    /// \brief  Reads a token that is as wide as \p U in both byte orders.
+    ///
+    template<class U>
+    void value(size_t index, U & little, U & big) const
+    {
+        const uint8_t * bytes = data(index);
+        little = big = 0;
+        for(size_t i = 0; i < sizeof(U); ++i) {
+            little  = static_cast<U>(little | (static_cast<U>(bytes[i]) << (8 * i)));
+            big     = static_cast<U>(big | (static_cast<U>(bytes[sizeof(U) - 1 - i]) << (8 * i)));
+        }
+    }
+
+private:
+    /// copies a mapped table so that tokens can be added
+    void materialize();
+    /// points the views at the vectors
+    void update();
+    /// fills the duplicate index
+    void index();
+    bool contains(const void * data, size_t size, uint64_t hash) const;
+    void parse(const char * text, size_t size);
+
+    std::shared_ptr<io::MappedFile>             _file;      //< mapped table, if any
+    const Token *                               _table;
+    const uint8_t *                             _bytes;
+    size_t                                      _count;
+    size_t                                      _total;     //< size of the token bytes
+    std::vector<Token>                          _tokens;
+    std::vector<uint8_t>                        _blob;
+    std::unordered_multimap<uint64_t, size_t>   _hashes;    //< finds duplicates
+};
+
+///
+/// \brief  Hands \p dictionary to every mutator in the templates of the
+///         script. Mutators that don't use tokens ignore it.
+///
+void AttachDictionary(const bytecode::Script &, const std::shared_ptr<const Dictionary> &);
+
+} // namespace runtime
+
+} // namespace fuzzer
+
+#endif
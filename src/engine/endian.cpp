@@ -0,0 +1,118 @@
+#include "endian.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define HAVE_SSSE3_SHUFFLE
+#define HAVE_AVX2_SHUFFLE
+#elif defined(__SSSE3__) || defined(__AVX__)
+#include <tmmintrin.h>
+#define HAVE_SSSE3_SHUFFLE
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define HAVE_NEON_REV
+#endif
+
+namespace fuzzer {
+
+namespace io {
+
+///
+/// \brief  Shuffle masks reversing the bytes within each 2, 4 and 8 byte lane.
+///
+#if defined(HAVE_SSSE3_SHUFFLE)
+static const uint8_t ShuffleMasks[3][16] = {
+    { 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14 },
+    { 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12 },
+    { 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8 }
+};
+
+///
+/// \brief  Swaps whole 16 (or 32 with AVX2) byte blocks, returns the number
+///         of bytes processed.
+///
+static size_t swap_blocks(uint8_t * dst, const uint8_t * src, size_t bytes, int mask)
+{
+    size_t offset = 0;
+#if defined(HAVE_AVX2_SHUFFLE)
+    const __m128i half = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ShuffleMasks[mask]));
+    const __m256i wide = _mm256_broadcastsi128_si256(half);
+    for(; (offset + 32) <= bytes; offset += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + offset));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + offset), _mm256_shuffle_epi8(v, wide));
+    }
+#endif
+    const __m128i shuffle = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ShuffleMasks[mask]));
+    for(; (offset + 16) <= bytes; offset += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + offset));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + offset), _mm_shuffle_epi8(v, shuffle));
+    }
+    return offset;
+}
+#elif defined(HAVE_NEON_REV)
+static size_t swap_blocks(uint8_t * dst, const uint8_t * src, size_t bytes, int mask)
+{
+    size_t offset = 0;
+    for(; (offset + 16) <= bytes; offset += 16) {
+        uint8x16_t v = vld1q_u8(src + offset);
+        switch(mask) {
+        case 0:     v = vrev16q_u8(v); break;
+        case 1:     v = vrev32q_u8(v); break;
+        default:    v = vrev64q_u8(v); break;
+        }
+        vst1q_u8(dst + offset, v);
+    }
+    return offset;
+}
+#else
+static size_t swap_blocks(uint8_t *, const uint8_t *, size_t, int)
+{
+    return 0;
+}
+#endif
+
+void swap_array16(void * dst, const void * src, size_t count)
+{
+    uint8_t * out       = static_cast<uint8_t *>(dst);
+    const uint8_t * in  = static_cast<const uint8_t *>(src);
+    const size_t bytes  = count * sizeof(uint16_t);
+
+    /// remaining elements are swapped one at a time
+    for(size_t offset = swap_blocks(out, in, bytes, 0); offset < bytes; offset += sizeof(uint16_t)) {
+        uint16_t value;
+        memcpy(&value, in + offset, sizeof(value));
+        value = swap16(value);
+        memcpy(out + offset, &value, sizeof(value));
+    }
+}
+
+void swap_array32(void * dst, const void * src, size_t count)
+{
+    uint8_t * out       = static_cast<uint8_t *>(dst);
+    const uint8_t * in  = static_cast<const uint8_t *>(src);
+    const size_t bytes  = count * sizeof(uint32_t);
+
+    for(size_t offset = swap_blocks(out, in, bytes, 1); offset < bytes; offset += sizeof(uint32_t)) {
+        uint32_t value;
+        memcpy(&value, in + offset, sizeof(value));
+        value = swap32(value);
+        memcpy(out + offset, &value, sizeof(value));
+    }
+}
+
+void swap_array64(void * dst, const void * src, size_t count)
+{
+    uint8_t * out       = static_cast<uint8_t *>(dst);
+    const uint8_t * in  = static_cast<const uint8_t *>(src);
+    const size_t bytes  = count * sizeof(uint64_t);
+
+    for(size_t offset = swap_blocks(out, in, bytes, 2); offset < bytes; offset += sizeof(uint64_t)) {
+        uint64_t value;
+        memcpy(&value, in + offset, sizeof(value));
+        value = swap64(value);
+        memcpy(out + offset, &value, sizeof(value));
+    }
+}
+
+} // namespace io
+
+} // namespace fuzzer
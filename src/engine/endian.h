@@ -2,137 +2,206 @@
 #define _ENDIAN_H_
 
 #include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#ifdef _MSC_VER
+#include <stdlib.h>
+#endif
 
 namespace fuzzer {
 
 namespace io {
 
-#if defined(_M_IX86) || defined(__i386__)
+#if defined(_M_IX86) || defined(__i386__) || defined(_M_X64) || defined(__x86_64__)
 #define ARCH_LITTLE_ENDIAN                  /* x86 is little endian */
 #define UNALIGNED_ACCESS_ALLOWED            /* x86 allows for unaligned memory accesses */
+#elif defined(_M_ARM64) || defined(__aarch64__)
+#define ARCH_LITTLE_ENDIAN                  /* AArch64 is little endian */
+#define UNALIGNED_ACCESS_ALLOWED            /* AArch64 allows for unaligned memory accesses */
+#elif defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define ARCH_LITTLE_ENDIAN
+#elif defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#define ARCH_BIG_ENDIAN
 #else
 #error "platform not supported."
 #endif
 
-#define swap32(x) ((((x) >> 24) & 0xff) | (((x) >> 8) & 0xff00) | (((x) << 8) & 0xff0000) | ((x) << 24))
-#define swap64(x)  ((((x) & 0xff00000000000000ull) >> 56)             \
-    | (((x) & 0x00ff000000000000ull) >> 40)                                 \
-    | (((x) & 0x0000ff0000000000ull) >> 24)                                 \
-    | (((x) & 0x000000ff00000000ull) >> 8)                                  \
-    | (((x) & 0x00000000ff000000ull) << 8)                                  \
-    | (((x) & 0x0000000000ff0000ull) << 24)                                 \
-    | (((x) & 0x000000000000ff00ull) << 40)                                 \
-    | (((x) & 0x00000000000000ffull) << 56))
-
-#define swap16(x)       ((((x) & 0xff) << 8) | ((x) >> 8))
-
 ///////////////////////////////////////////////////////////////////////////////
-//                              Big endian to host                           //
+//                                  Byte swapping                            //
 ///////////////////////////////////////////////////////////////////////////////
-inline uint16_t be_to_host16(uint16_t x)
+
+inline uint16_t swap16(uint16_t x)
 {
-#ifdef ARCH_LITTLE_ENDIAN
-    // from big to little
-    return swap16(x);
+#if defined(_MSC_VER)
+    return _byteswap_ushort(x);
+#elif defined(__GNUC__) || defined(__clang__)
+    return __builtin_bswap16(x);
 #else
-    // from big to big
-    return x;
+    return static_cast<uint16_t>(((x & 0xff) << 8) | (x >> 8));
 #endif
 }
 
-inline uint32_t be_to_host32(uint32_t x)
+inline uint32_t swap32(uint32_t x)
 {
-#ifdef ARCH_LITTLE_ENDIAN
-    // from big to little
-    return swap32(x);
+#if defined(_MSC_VER)
+    return _byteswap_ulong(x);
+#elif defined(__GNUC__) || defined(__clang__)
+    return __builtin_bswap32(x);
 #else
-    // from big to big
-    return x;
+    return ((x >> 24) & 0xff) | ((x >> 8) & 0xff00) | ((x << 8) & 0xff0000) | (x << 24);
 #endif
 }
 
-inline uint64_t be_to_host64(uint64_t x)
+inline uint64_t swap64(uint64_t x)
 {
-#ifdef ARCH_LITTLE_ENDIAN
-    // from big to little
-    return swap64(x);
+#if defined(_MSC_VER)
+    return _byteswap_uint64(x);
+#elif defined(__GNUC__) || defined(__clang__)
+    return __builtin_bswap64(x);
 #else
-    // from big to big
-    return x;
+    return (static_cast<uint64_t>(swap32(static_cast<uint32_t>(x))) << 32) |
+        swap32(static_cast<uint32_t>(x >> 32));
 #endif
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-//                              Little endian to host                        //
+//                              Compile time byte order                      //
 ///////////////////////////////////////////////////////////////////////////////
 
-inline uint16_t le_to_host16(uint16_t x)
-{
-#ifdef ARCH_LITTLE_ENDIAN
-    // from little to little
-    return x;
-#else
-    // from litte to big
-    return swap16(x);
-#endif
-}
+///
+/// \enum   ByteOrder
+/// \brief  Byte order of data on the wire.
+///
+enum ByteOrder {
+    ORDER_BIG_ENDIAN,
+    ORDER_LITTLE_ENDIAN
+};
 
-inline uint32_t le_to_host32(uint32_t x)
-{
 #ifdef ARCH_LITTLE_ENDIAN
-    // from little to little
-    return x;
+static const ByteOrder HostByteOrder = ORDER_LITTLE_ENDIAN;
 #else
-    // from litte to big
-    return swap32(x);
+static const ByteOrder HostByteOrder = ORDER_BIG_ENDIAN;
 #endif
-}
 
-inline uint64_t le_to_host64(uint64_t x)
+///
+/// \class  Endian
+/// \brief  Converts between host byte order and the byte order \p Order. The
+///         conversion is symmetric, so the same function is used both when
+///         reading and when writing. Resolved at compile time, no branches.
+///
+template<ByteOrder Order>
+struct Endian
 {
-#ifdef ARCH_LITTLE_ENDIAN
-    // from little to little
-    return x;
-#else
-    // from litte to big
-    return swap64(x);
-#endif
-}
+    static const bool swap = (Order != HostByteOrder);
+
+    static inline uint16_t convert16(uint16_t x) { return swap ? swap16(x) : x; }
+    static inline uint32_t convert32(uint32_t x) { return swap ? swap32(x) : x; }
+    static inline uint64_t convert64(uint64_t x) { return swap ? swap64(x) : x; }
+
+    ///
+    /// \brief  Stores the lower 24 bits of \p x in three bytes at \p dst.
+    ///
+    static inline void store24(uint8_t * dst, uint32_t x)
+    {
+        if (Order == ORDER_BIG_ENDIAN) {
+            dst[0] = static_cast<uint8_t>(x >> 16);
+            dst[1] = static_cast<uint8_t>(x >> 8);
+            dst[2] = static_cast<uint8_t>(x);
+        } else {
+            dst[0] = static_cast<uint8_t>(x);
+            dst[1] = static_cast<uint8_t>(x >> 8);
+            dst[2] = static_cast<uint8_t>(x >> 16);
+        }
+    }
+
+    ///
+    /// \brief  Loads a 24 bit value from three bytes at \p src.
+    ///
+    static inline uint32_t load24(const uint8_t * src)
+    {
+        if (Order == ORDER_BIG_ENDIAN) {
+            return (static_cast<uint32_t>(src[0]) << 16) | (static_cast<uint32_t>(src[1]) << 8) | src[2];
+        } else {
+            return (static_cast<uint32_t>(src[2]) << 16) | (static_cast<uint32_t>(src[1]) << 8) | src[0];
+        }
+    }
+};
 
 ///////////////////////////////////////////////////////////////////////////////
-//                              Host to big endian                           //
+//                              Bulk conversion                              //
 ///////////////////////////////////////////////////////////////////////////////
 
-inline uint16_t host16_to_be(uint16_t x)
+///
+/// \brief  Byte swaps \p count elements from \p src into \p dst. The buffers
+///         may be unaligned and may be the same buffer, but must not
+///         otherwise overlap. Vectorized where the target supports it.
+///
+void swap_array16(void * dst, const void * src, size_t count);
+void swap_array32(void * dst, const void * src, size_t count);
+void swap_array64(void * dst, const void * src, size_t count);
+
+///
+/// \brief  Converts \p count host order elements to/from byte order \p Order.
+///
+template<ByteOrder Order>
+inline void convert_array16(void * dst, const void * src, size_t count)
 {
-#ifdef ARCH_LITTLE_ENDIAN
-    return swap16(x);
-#else
-    // from big to big
-    return x;
-#endif
+    if (Endian<Order>::swap) {
+        swap_array16(dst, src, count);
+    } else if (dst != src) {
+        memcpy(dst, src, count * sizeof(uint16_t));
+    }
 }
 
-inline uint32_t host32_to_be(uint32_t x)
+template<ByteOrder Order>
+inline void convert_array32(void * dst, const void * src, size_t count)
 {
-#ifdef ARCH_LITTLE_ENDIAN
-    return swap32(x);
-#else
-    // from big to big
-    return x;
-#endif
+    if (Endian<Order>::swap) {
+        swap_array32(dst, src, count);
+    } else if (dst != src) {
+        memcpy(dst, src, count * sizeof(uint32_t));
+    }
 }
 
-inline uint64_t host64_to_be(uint64_t x)
+template<ByteOrder Order>
+inline void convert_array64(void * dst, const void * src, size_t count)
 {
-#ifdef ARCH_LITTLE_ENDIAN
-    return swap64(x);
-#else
-    // from big to big
-    return x;
-#endif
+    if (Endian<Order>::swap) {
+        swap_array64(dst, src, count);
+    } else if (dst != src) {
+        memcpy(dst, src, count * sizeof(uint64_t));
+    }
 }
 
+///////////////////////////////////////////////////////////////////////////////
+//                              Big endian to host                           //
+///////////////////////////////////////////////////////////////////////////////
+inline uint16_t be_to_host16(uint16_t x) { return Endian<ORDER_BIG_ENDIAN>::convert16(x); }
+inline uint32_t be_to_host32(uint32_t x) { return Endian<ORDER_BIG_ENDIAN>::convert32(x); }
+inline uint64_t be_to_host64(uint64_t x) { return Endian<ORDER_BIG_ENDIAN>::convert64(x); }
+
+///////////////////////////////////////////////////////////////////////////////
+//                              Little endian to host                        //
+///////////////////////////////////////////////////////////////////////////////
+inline uint16_t le_to_host16(uint16_t x) { return Endian<ORDER_LITTLE_ENDIAN>::convert16(x); }
+inline uint32_t le_to_host32(uint32_t x) { return Endian<ORDER_LITTLE_ENDIAN>::convert32(x); }
+inline uint64_t le_to_host64(uint64_t x) { return Endian<ORDER_LITTLE_ENDIAN>::convert64(x); }
+
+///////////////////////////////////////////////////////////////////////////////
+//                              Host to big endian                           //
+///////////////////////////////////////////////////////////////////////////////
+inline uint16_t host16_to_be(uint16_t x) { return Endian<ORDER_BIG_ENDIAN>::convert16(x); }
+inline uint32_t host32_to_be(uint32_t x) { return Endian<ORDER_BIG_ENDIAN>::convert32(x); }
+inline uint64_t host64_to_be(uint64_t x) { return Endian<ORDER_BIG_ENDIAN>::convert64(x); }
+
+///////////////////////////////////////////////////////////////////////////////
+//                              Host to little endian                        //
+///////////////////////////////////////////////////////////////////////////////
+inline uint16_t host16_to_le(uint16_t x) { return Endian<ORDER_LITTLE_ENDIAN>::convert16(x); }
+inline uint32_t host32_to_le(uint32_t x) { return Endian<ORDER_LITTLE_ENDIAN>::convert32(x); }
+inline uint64_t host64_to_le(uint64_t x) { return Endian<ORDER_LITTLE_ENDIAN>::convert64(x); }
+
 } // namespace io
 
 } // namespace fuzzer
@@ -1,15 +1,24 @@
 #include "filefuzzer.h"
 #include "filemutator.h"
+#include "inputtostate.h"
+#include "plugin.h"
 #include "buffer.h"
+#include "rope.h"
 #include "tmpfile.h"
+#include <algorithm>
 #include <iostream>
+#include <memory>
 
 namespace fuzzer {
 
 namespace runtime {
 
 FileFuzzer::FileFuzzer(execution::IApplicationExecuter & executer) :
-    _executer(executer)
+    _executer(executer),
+    _strata(0),
+    _seed(0),
+    _worker(0),
+    _workers(1)
 {
 }
 
@@ -18,51 +27,167 @@ FileFuzzer::~FileFuzzer()
     // empty
 }
 
+void FileFuzzer::SetSampling(size_t strata, uint64_t seed, size_t worker, size_t workers)
+{
+    _strata     = strata;
+    _seed       = seed;
+    _worker     = worker;
+    _workers    = workers;
+}
+
+void FileFuzzer::SetDictionary(const std::shared_ptr<const Dictionary> & dictionary)
+{
+    _dictionary = dictionary;
+}
+
+void FileFuzzer::AddPlugin(const std::string & name)
+{
+    const fuzzengine_mutator * mutator = PluginRegistry::instance().find(name, FUZZENGINE_PLUGIN_FILE);
+    if (!mutator) {
+        throw std::runtime_error("Unknown plugin mutator.");
+    }
+    _plugins.push_back(mutator);
+}
+
+bool FileFuzzer::Execute(const std::string & path, int timeout, bool & exited, execution::TerminationReason & reason)
+{
+    /// pass the filename as argument to the program under test
+    _executer.SetCommandLine(path);
+
+    exited = false;
+    if (!_executer.Launch()) {
+        std::cerr << "failed to launch \"" << path << "\"" << std::endl;
+        return false;
+    }
+
+    if (!_executer.Wait(timeout)) {
+        // process didn't terminate within the timeout period
+        if (!_executer.Terminate()) {
+            std::cerr << "failed to terminate process." << std::endl;
+            return false;
+        }
+        // we killed the process
+        return true;
+    }
+    // the process terminated
+    int code;
+    if (!_executer.GetStatusCode(code, reason)) {
+        std::cerr << "Failed to get status code." << std::endl;
+        return false;
+    }
+    exited = true;
+    return true;
+}
+
 bool FileFuzzer::Run(const char * filename, int timeout)
 {
     FileMutator mutator(filename);
-    while(!mutator.finished())
+    if (_dictionary) {
+        mutator.dictionary(_dictionary);
+    }
+    if (_strata) {
+        mutator.sample(_strata, _seed, _worker, _workers);
+    }
+
+    /// coverage and comparisons of the unmodified file
+    std::unique_ptr<InputToStateMutator> solver;
+    _executer.SetCommandLine(filename);
+    if (_executer.Launch()) {
+        if (_executer.Wait(timeout)) {
+            uint64_t checksum;
+            if (_executer.GetCoverageChecksum(checksum)) {
+                mutator.baseline(checksum);
+            }
+            if (const execution::ComparisonLog * log = _executer.GetComparisonLog()) {
+                std::shared_ptr<io::MappedFile> seed = std::make_shared<io::MappedFile>(filename);
+                solver.reset(new InputToStateMutator(seed->data(), seed->size(), seed));
+                solver->add(*log);
+            }
+        } else {
+            _executer.Terminate();
+        }
+    }
+
+    /// replace compared operands first, magic values and checksums guard
+    /// the rest of the file
+    for(; solver && !solver->finished(); solver->mutate())
     {
-        if (!mutator.mutate()) {
+        std::vector<uint8_t> payload;
+        Buffer buffer(payload);
+        solver->evaluate(buffer);
+        fuzzer::TmpFile tmpfile(payload, filename);
+
+        bool exited;
+        execution::TerminationReason reason;
+        if (!Execute(tmpfile.filename(), timeout, exited, reason)) {
             return false;
         }
-        std::vector<uint8_t> payload;   //< fuzzed payload
-        Buffer buffer(payload);         //< wrapper
-        mutator.evaluate(buffer);       //< create fuzzed payload
+        std::string state;
+        if (exited && reason != execution::Term_Normal && solver->state(state)) {
+            std::cout << "crash in \"" << filename << "\" state = {" << state << "}" << std::endl;
+        }
+    }
+
+    for(; !mutator.finished(); mutator.mutate())
+    {
+        Rope payload;                   //< fuzzed payload, shares the seed
+        if (!mutator.variant(payload)) {
+            continue;
+        }
 
         /// now save the payload to a temporary file
         fuzzer::TmpFile tmpfile(payload, filename);
 
-        /// pass the filename as argument to the program under test
-        _executer.SetCommandLine(tmpfile.filename());
-
-        if (!_executer.Launch()) {
-            std::cerr << "failed to launch \"" << filename << "\"" << std::endl;
+        bool exited;
+        execution::TerminationReason reason;
+        if (!Execute(tmpfile.filename(), timeout, exited, reason)) {
             return false;
         }
-
-        if (!_executer.Wait(timeout)) {
-            // process didn't terminate within the timeout period
-            if (!_executer.Terminate()) {
-                std::cerr << "failed to terminate process." << std::endl;
+        if (!exited) {
+            continue;
+        }
+        uint64_t checksum;
+        if (reason == execution::Term_Normal && _executer.GetCoverageChecksum(checksum)) {
+            mutator.coverage(checksum);
+        }
+        if (reason != execution::Term_Normal) {
+            std::string state;
+            if (!mutator.state(state)) {
+                std::cerr << "failed to get mutator state." << std::endl;
                 return false;
             }
-            // we killed the process
-        } else {
-            // the process terminated
-            int code;
+            std::cout << "crash in \"" << filename << "\" state = {" << state << "}" << std::endl;
+        }
+    }
+
+    for(size_t i = 0; i < _plugins.size(); ++i) {
+        if (!RunPlugin(*_plugins[i], filename, timeout)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool FileFuzzer::RunPlugin(const fuzzengine_mutator & ops, const char * filename, int timeout)
+{
+    std::shared_ptr<io::MappedFile> seed = std::make_shared<io::MappedFile>(filename);
+    const size_t arena = std::max<size_t>(PluginMutator::DefaultArena, 4 * seed->size());
+    PluginMutator mutator(ops, seed->data(), seed->size(), seed, _seed, PluginMutator::DefaultBatch, arena);
+
+    /// the variants are written straight from the arena of the batch
+    while(size_t count = mutator.next()) {
+        for(size_t i = 0; i < count; ++i) {
+            size_t size;
+            const uint8_t * data = mutator.variant(i, size);
+            fuzzer::TmpFile tmpfile(Rope(data, size), filename);
+
+            bool exited;
             execution::TerminationReason reason;
-            if (!_executer.GetStatusCode(code, reason)) {
-                std::cerr << "Failed to get status code." << std::endl;
+            if (!Execute(tmpfile.filename(), timeout, exited, reason)) {
                 return false;
             }
-            if (reason != execution::Term_Normal) {
-                std::string state;
-                if (!mutator.state(state)) {
-                    std::cerr << "failed to get mutator state." << std::endl;
-                    return false;
-                }
-                std::cout << "crash in \"" << filename << "\" state = {" << state << "}" << std::endl;
+            if (exited && reason != execution::Term_Normal) {
+                std::cout << "crash in \"" << filename << "\" state = {" << mutator.state(i) << "}" << std::endl;
             }
         }
     }
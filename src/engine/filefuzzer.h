@@ -2,6 +2,12 @@
 #define _FILEFUZZER_H_
 
 #include "appexec.h"
+#include "cmplog.h"
+#include "dictionary.h"
+#include "pluginabi.h"
+#include <memory>
+#include <string>
+#include <vector>
 
 namespace fuzzer {
 
@@ -24,12 +30,51 @@ public:
     virtual ~FileFuzzer();
 
     ///
-    /// \brief  Runs the fuzz testing on a single file
+    /// \brief  Runs the fuzz testing on a single file. If the executer logs
+    ///         comparisons, the operands compared by the unmodified file are
+    ///         replaced first.
     ///
     bool Run(const char * filename, int timeout = 5000);
 
+    ///
+    /// \brief  Samples the offsets of the files instead of walking them,
+    ///         see FileMutator::sample(). A \p strata of zero walks them.
+    ///
+    void SetSampling(size_t strata, uint64_t seed, size_t worker = 0, size_t workers = 1);
+
+    ///
+    /// \brief  Tokens for the dictionary stages of the files.
+    ///
+    void SetDictionary(const std::shared_ptr<const Dictionary> &);
+
+    ///
+    /// \brief  Runs the variants of a plugin mutator after the built in
+    ///         stages, see PluginRegistry. Throws a std::runtime_error if
+    ///         no mutator named \p name is registered for files.
+    ///
+    void AddPlugin(const std::string & name);
+
 private:
+    ///
+    /// \brief  Runs the application on \p path. \p exited is false if the
+    ///         application was killed after the timeout.
+    ///
+    /// \return false if the application can't be run.
+    ///
+    bool Execute(const std::string & path, int timeout, bool & exited, execution::TerminationReason & reason);
+
+    ///
+    /// \brief  Runs the variants of a plugin mutator in batches.
+    ///
+    bool RunPlugin(const fuzzengine_mutator &, const char * filename, int timeout);
+
     execution::IApplicationExecuter & _executer;    //< executes the actual application
+    size_t      _strata;                            //< zero unless sampling
+    uint64_t    _seed;
+    size_t      _worker;
+    size_t      _workers;
+    std::shared_ptr<const Dictionary> _dictionary;
+    std::vector<const fuzzengine_mutator *> _plugins;
 };
 
 } // namespace runtime
@@ -1,37 +1,128 @@
 #include "filemutator.h"
+#include "buffer.h"
 #include <cstdio>
+#include <cstring>
 #include <sstream>
+#include <stdexcept>
 
 namespace fuzzer {
 
 namespace runtime {
 
-FileMutator::FileMutator(const char * filename) :
-    _name(filename),
-    _phase(BIT_INVERSE),
-    _offset(0)
+static const char * PhaseNames[] = {
+    "flip1",
+    "flip2",
+    "flip4",
+    "bitinverse",
+    "flip16",
+    "flip32",
+    "arith8",
+    "arith16",
+    "arith32",
+    "interest8",
+    "interest16",
+    "interest32",
+    "dictoverwrite",
+    "dictinsert",
+    "byteremoval",
+    "done"
+};
+
+static const int8_t Interesting8[] = {
+    -128, -1, 0, 1, 16, 32, 64, 100, 127
+};
+
+static const int16_t Interesting16[] = {
+    -32768, -129, 128, 255, 256, 512, 1000, 1024, 4096, 32767
+};
+
+static const int32_t Interesting32[] = {
+    -2147483647 - 1, -100663046, -32769, 32768, 65535, 65536, 100663045, 2147483647
+};
+
+static const size_t Interesting8Count   = sizeof(Interesting8) / sizeof(Interesting8[0]);
+static const size_t Interesting16Count  = Interesting8Count + sizeof(Interesting16) / sizeof(Interesting16[0]);
+static const size_t Interesting32Count  = Interesting16Count + sizeof(Interesting32) / sizeof(Interesting32[0]);
+
+///
+/// \brief  Interesting values of all widths up to and including the current
+///         one, a 16 bit stage also tests the 8 bit values and so on.
+///
+static uint32_t InterestingValue(size_t index)
 {
-    FILE * file = fopen(filename, "rb");
-    if (!file) {
-        throw std::runtime_error("Failed to open file for reading.");
+    if (index < Interesting8Count) {
+        return static_cast<uint32_t>(static_cast<int32_t>(Interesting8[index]));
+    } else if (index < Interesting16Count) {
+        return static_cast<uint32_t>(static_cast<int32_t>(Interesting16[index - Interesting8Count]));
     }
+    return static_cast<uint32_t>(Interesting32[index - Interesting16Count]);
+}
 
-    fseek(file, 0, SEEK_END);
-    long size = ftell(file);
-    rewind(file);
+///
+/// \brief  True if the change \p diff (old ^ new) is produced by one of
+///         the flip stages.
+///
+static bool CouldBeBitflip(uint32_t diff)
+{
+    if (!diff) {
+        return true;
+    }
+    size_t shift = 0;
+    while(!(diff & 1)) {
+        ++shift;
+        diff >>= 1;
+    }
+    /// walking 1, 2 and 4 bit flips
+    if (diff == 1 || diff == 3 || diff == 15) {
+        return true;
+    }
+    /// byte, word and dword flips are byte aligned
+    if (shift & 7) {
+        return false;
+    }
+    return diff == 0xff || diff == 0xffff || diff == 0xffffffff;
+}
 
-    if (!size) {
-        fclose(file);
-        throw std::runtime_error("Empty file.");
+static uint32_t Load(const uint8_t * src, size_t size, bool bigEndian)
+{
+    uint32_t value = 0;
+    for(size_t i = 0; i < size; ++i) {
+        value |= static_cast<uint32_t>(src[bigEndian ? (size - 1 - i) : i]) << (8 * i);
     }
+    return value;
+}
 
-    _data.resize(size);
-    if (fread(&_data[0], size, 1, file) != 1) {
-        fclose(file);
-        throw std::runtime_error("Failed to read file contents.");
+static void Store(uint8_t * dst, uint32_t value, size_t size, bool bigEndian)
+{
+    for(size_t i = 0; i < size; ++i) {
+        dst[bigEndian ? (size - 1 - i) : i] = static_cast<uint8_t>(value >> (8 * i));
     }
+}
 
-    fclose(file);
+FileMutator::FileMutator(const char * filename) :
+    _file(std::make_shared<io::MappedFile>(filename)),
+    _data(_file->data()),
+    _size(_file->size()),
+    _seed(_file->data(), _file->size(), _file),
+    _name(filename),
+    _phase(FLIP_BIT1),
+    _offset(0),
+    _step(0),
+    _hasBaseline(false),
+    _baseline(0),
+    _sampled(false),
+    _seedValue(0),
+    _strata(0),
+    _worker(0),
+    _workers(1),
+    _levels(0),
+    _level(0),
+    _root(0),
+    _child(0),
+    _sample(0),
+    _samples(0),
+    _share(0)
+{
 }
 
 FileMutator::~FileMutator()
@@ -45,78 +136,597 @@ bool FileMutator::finished()
 
 void FileMutator::reset()
 {
-    _phase  = BIT_INVERSE;
+    _phase  = FLIP_BIT1;
     _offset = 0;
+    _step   = 0;
+    if (_sampled) {
+        _level      = 0;
+        _root       = _worker;
+        _child      = 0;
+        _samples    = 0;
+        if (!next(true)) {
+            _phase = DONE;
+        } else {
+            enter(FLIP_BIT1);
+        }
+    }
 }
 
-bool FileMutator::mutate()
+///
+/// \brief  splitmix64 finalizer. A draw only depends on the seed and the
+///         region, so any worker can recompute it without shared state.
+///
+static uint64_t Mix(uint64_t x)
 {
-    if (finished()) {
-        return false;
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+void FileMutator::sample(size_t strata, uint64_t seed, size_t worker, size_t workers)
+{
+    if (!strata || !workers || worker >= workers) {
+        throw std::runtime_error("Invalid sampling parameters.");
     }
-    switch(_phase) {
-    case BIT_INVERSE:
-        if ((++_offset) == _data.size()) {
-            _phase = BYTE_REMOVAL;
+    _sampled    = true;
+    _seedValue  = seed;
+    _strata     = strata < _size ? strata : _size;
+    _worker     = worker;
+    _workers    = workers;
+
+    /// refine until the largest region is a single byte
+    size_t largest = (_size + _strata - 1) / _strata;
+    for(_levels = 0; largest > 1; ++_levels) {
+        largest = (largest + 1) / 2;
+    }
+    _share = 0;
+    for(size_t root = worker; root < _strata; root += workers) {
+        size_t begin, end;
+        region(root, begin, end);
+        _share += end - begin;
+    }
+    reset();
+}
+
+void FileMutator::region(size_t root, size_t & begin, size_t & end) const
+{
+    /// the first size % strata regions are one byte larger
+    const size_t size = _size / _strata;
+    const size_t rest = _size % _strata;
+    begin   = root * size + (root < rest ? root : rest);
+    end     = begin + size + (root < rest ? 1 : 0);
+}
+
+bool FileMutator::draw(size_t level, size_t root, size_t child, size_t & offset) const
+{
+    size_t begin, end;
+    region(root, begin, end);
+    uint64_t key = Mix(_seedValue ^ Mix(root));
+    offset = begin + static_cast<size_t>(key % (end - begin));
+    bool drawn = true;
+    /// descend to the region, keeping the parent's offset where it falls inside
+    for(size_t l = 1; l <= level; ++l) {
+        const size_t mid = begin + (end - begin) / 2;
+        const size_t bit = (child >> (level - l)) & 1;
+        if (bit) {
+            begin = mid;
+        } else {
+            end = mid;
         }
-        break;
-    case BYTE_REMOVAL:
-        if ((++_offset) == _data.size()) {
-            _phase = DONE;
+        if (begin == end) {
+            return false;
+        }
+        key = Mix(key ^ bit);
+        drawn = (offset < begin || offset >= end);
+        if (drawn) {
+            offset = begin + static_cast<size_t>(key % (end - begin));
+        }
+    }
+    return drawn;
+}
+
+bool FileMutator::next(bool first)
+{
+    for(;;) {
+        if (!first && ++_child >= (static_cast<size_t>(1) << _level)) {
+            _child = 0;
+            _root += _workers;
+            if (_root >= _strata) {
+                _root = _worker;
+                ++_level;
+            }
+        }
+        first = false;
+        if (_root >= _strata || _level > _levels) {
             return false;
         }
-        break;
-    case DONE:
+        if (draw(_level, _root, _child, _sample)) {
+            return true;
+        }
+    }
+}
+
+bool FileMutator::enter(Phase phase)
+{
+    _phase  = phase;
+    _step   = 0;
+    if (phase <= FLIP_BIT4) {
+        /// the bit offsets that start in the sampled byte
+        _offset = _sample * 8;
+    } else {
+        _offset = _sample;
+    }
+    return _offset < units(phase);
+}
+
+size_t FileMutator::units(Phase phase) const
+{
+    const size_t size = _size;
+    switch(phase) {
+    case FLIP_BIT1:     return size * 8;
+    case FLIP_BIT2:     return size * 8 - 1;
+    case FLIP_BIT4:     return size * 8 - 3;
+    case BIT_INVERSE:
+    case ARITH8:
+    case INTEREST8:
+    case BYTE_REMOVAL:  return size;
+    case FLIP_WORD:
+    case ARITH16:
+    case INTEREST16:    return size >= 2 ? size - 1 : 0;
+    case FLIP_DWORD:
+    case ARITH32:
+    case INTEREST32:    return size >= 4 ? size - 3 : 0;
+    case DICT_OVERWRITE:
+    case DICT_INSERT:
+        if (!_dictionary || _dictionary->empty()) {
+            return 0;
+        }
+        /// tokens are also inserted after the last byte
+        return phase == DICT_INSERT ? size + 1 : size;
+    default:            return 0;
+    }
+}
+
+size_t FileMutator::steps(Phase phase) const
+{
+    switch(phase) {
+    case ARITH8:        return ArithMax * 2;
+    case ARITH16:
+    case ARITH32:       return ArithMax * 4;    //< both byte orders
+    case INTEREST8:     return Interesting8Count;
+    case INTEREST16:    return Interesting16Count * 2;
+    case INTEREST32:    return Interesting32Count * 2;
+    case DICT_OVERWRITE:
+    case DICT_INSERT:   return _dictionary ? _dictionary->size() : 0;
+    default:            return 1;
+    }
+}
+
+size_t FileMutator::width(Phase phase)
+{
+    switch(phase) {
+    case FLIP_WORD:
+    case ARITH16:
+    case INTEREST16:    return 2;
+    case FLIP_DWORD:
+    case ARITH32:
+    case INTEREST32:    return 4;
+    default:            return 1;
+    }
+}
+
+void FileMutator::baseline(uint64_t checksum)
+{
+    _hasBaseline    = true;
+    _baseline       = checksum;
+    _inert.assign((_size + EffectorBlock - 1) / EffectorBlock, 0);
+}
+
+void FileMutator::coverage(uint64_t checksum)
+{
+    if (!_hasBaseline || _phase != BIT_INVERSE) {
+        return;
+    }
+    const uint8_t bit = static_cast<uint8_t>(1 << (_offset % EffectorBlock));
+    if (checksum == _baseline) {
+        _inert[_offset / EffectorBlock] |= bit;
+    } else {
+        _inert[_offset / EffectorBlock] &= ~bit;
+    }
+}
+
+bool FileMutator::effective(size_t offset, size_t size) const
+{
+    if (!_hasBaseline) {
+        return true;
+    }
+    const size_t last = (offset + size - 1) / EffectorBlock;
+    for(size_t block = offset / EffectorBlock; block <= last; ++block) {
+        /// the last block may be partial
+        const size_t begin = block * EffectorBlock;
+        const size_t bytes = (_size - begin) < EffectorBlock ? (_size - begin) : EffectorBlock;
+        const uint8_t all = static_cast<uint8_t>((1 << bytes) - 1);
+        if ((_inert[block] & all) != all) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void FileMutator::dictionary(const std::shared_ptr<const Dictionary> & dictionary)
+{
+    _dictionary = dictionary;
+}
+
+bool FileMutator::inert() const
+{
+    if (_phase <= BIT_INVERSE || _phase >= DICT_INSERT) {
         return false;
     }
-    return true;
+    if (_phase == DICT_OVERWRITE) {
+        const size_t length = _dictionary->length(_step);
+        return _offset + length <= _size && !effective(_offset, length);
+    }
+    return !effective(_offset, width(_phase));
 }
 
-void FileMutator::evaluate(Buffer & buffer)
+void FileMutator::advance()
 {
+    if (++_step < steps(_phase)) {
+        return;
+    }
+    _step = 0;
+    if (_sampled) {
+        if (_phase <= FLIP_BIT4 && ++_offset < units(_phase) && _offset < (_sample + 1) * 8) {
+            return;
+        }
+        /// the remaining stages at the sampled offset, then the next offset
+        for(size_t phase = _phase + 1; phase < DONE; ++phase) {
+            if (enter(static_cast<Phase>(phase))) {
+                return;
+            }
+        }
+        ++_samples;
+        if (!next(false)) {
+            _phase  = DONE;
+            _offset = 0;
+            return;
+        }
+        enter(FLIP_BIT1);
+        return;
+    }
+    if (++_offset < units(_phase)) {
+        return;
+    }
+    /// next phase with anything to do
+    _offset = 0;
+    do {
+        _phase = static_cast<Phase>(_phase + 1);
+    } while(_phase != DONE && !units(_phase));
+}
+
+bool FileMutator::mutate()
+{
+    if (finished()) {
+        return false;
+    }
+    Patch patch;
+    do {
+        advance();
+        if (!finished() && _phase != DICT_OVERWRITE && inert()) {
+            /// skip all steps at an inert offset, tokens differ in length
+            /// so the dictionary stage checks each of them
+            _step = steps(_phase) - 1;
+        }
+    } while(!finished() && !this->patch(patch));
+    return !finished();
+}
+
+bool FileMutator::patch(Patch & patch) const
+{
+    if (inert()) {
+        return false;
+    }
+    const uint8_t * data = _data;
+    patch.offset    = _offset;
+    patch.removed   = 1;
+    patch.size      = 1;
+    patch.token     = nullptr;
+
     switch(_phase) {
+    case FLIP_BIT1:
+    case FLIP_BIT2:
+    case FLIP_BIT4:
+        {
+            /// the offset is a bit offset, the flipped bits may span two bytes
+            const size_t bits = (_phase == FLIP_BIT1) ? 1 : (_phase == FLIP_BIT2 ? 2 : 4);
+            const size_t first = _offset >> 3;
+            const size_t last = (_offset + bits - 1) >> 3;
+            patch.offset    = first;
+            patch.removed   = last - first + 1;
+            patch.size      = patch.removed;
+            patch.bytes[0]  = data[first];
+            if (patch.size > 1) {
+                patch.bytes[1] = data[last];
+            }
+            for(size_t bit = _offset; bit < _offset + bits; ++bit) {
+                patch.bytes[(bit >> 3) - first] ^= static_cast<uint8_t>(0x80 >> (bit & 7));
+            }
+            return true;
+        }
     case BIT_INVERSE:
+    case FLIP_WORD:
+    case FLIP_DWORD:
+        {
+            const size_t size = (_phase == BIT_INVERSE) ? 1 : (_phase == FLIP_WORD ? 2 : 4);
+            patch.removed   = size;
+            patch.size      = size;
+            for(size_t i = 0; i < size; ++i) {
+                patch.bytes[i] = static_cast<uint8_t>(~data[_offset + i]);
+            }
+            return true;
+        }
+    case ARITH8:
+    case ARITH16:
+    case ARITH32:
         {
-            if (_offset > 0) { //< write unmodified data before
-                buffer.write(&_data[0], _offset);
+            const size_t size = (_phase == ARITH8) ? 1 : (_phase == ARITH16 ? 2 : 4);
+            const bool bigEndian = (_step >= ArithMax * 2);
+            const size_t step = _step % (ArithMax * 2);
+            const uint32_t delta = static_cast<uint32_t>(step / 2) + 1;
+            const uint32_t mask = (size == 4) ? 0xffffffff : ((1u << (8 * size)) - 1);
+            const uint32_t old = Load(data + _offset, size, bigEndian);
+            const uint32_t value = ((step & 1) ? (old - delta) : (old + delta)) & mask;
+            if (CouldBeBitflip(old ^ value)) {
+                return false;
+            }
+            /// the narrower stage already covers changes that don't carry
+            if (size == 2 && !((old ^ value) & 0xff00)) {
+                return false;
             }
-            uint8_t fuzzed = ~_data[_offset];
-            buffer.write(&fuzzed, sizeof(fuzzed));
-            if ((_offset + 1) < _data.size()) { //< write unmodified data after
-                buffer.write(&_data[_offset + 1], _data.size() - _offset - 1);
+            if (size == 4 && !((old ^ value) & 0xffff0000)) {
+                return false;
             }
-            break;
+            patch.removed   = size;
+            patch.size      = size;
+            Store(patch.bytes, value, size, bigEndian);
+            return true;
         }
-    case BYTE_REMOVAL:
+    case INTEREST8:
+    case INTEREST16:
+    case INTEREST32:
         {
-            if (_offset > 0) { //< write unmodified data before
-                buffer.write(&_data[0], _offset);
+            const size_t size = (_phase == INTEREST8) ? 1 : (_phase == INTEREST16 ? 2 : 4);
+            const size_t count = steps(_phase) / (size == 1 ? 1 : 2);
+            const bool bigEndian = (_step >= count);
+            const uint32_t mask = (size == 4) ? 0xffffffff : ((1u << (8 * size)) - 1);
+            const uint32_t old = Load(data + _offset, size, bigEndian);
+            const uint32_t value = InterestingValue(_step % count) & mask;
+            if (CouldBeBitflip(old ^ value)) {
+                return false;
+            }
+            /// the little endian steps already wrote symmetric values
+            if (bigEndian) {
+                uint8_t little[4];
+                Store(little, value, size, false);
+                Store(patch.bytes, value, size, true);
+                if (!memcmp(little, patch.bytes, size)) {
+                    return false;
+                }
             }
-            // ignore byte, write data after
-            if ((_offset + 1) < _data.size()) { //< write unmodified data after
-                buffer.write(&_data[_offset + 1], _data.size() - _offset - 1);
+            patch.removed   = size;
+            patch.size      = size;
+            Store(patch.bytes, value, size, bigEndian);
+            return true;
+        }
+    case DICT_OVERWRITE:
+        {
+            const size_t length = _dictionary->length(_step);
+            const uint8_t * token = _dictionary->data(_step);
+            if (_offset + length > _size || !memcmp(data + _offset, token, length)) {
+                return false;
             }
-            break;
+            patch.removed   = length;
+            patch.size      = length;
+            patch.token     = token;
+            return true;
         }
+    case DICT_INSERT:
+        patch.removed   = 0;
+        patch.size      = _dictionary->length(_step);
+        patch.token     = _dictionary->data(_step);
+        return true;
+    case BYTE_REMOVAL:
+        patch.size = 0;
+        return true;
     default:
-        break;
+        return false;
     }
 }
 
+size_t FileMutator::batchStride() const
+{
+    switch(_phase) {
+    case DICT_INSERT:   return _size + _dictionary->length(_step);
+    case BYTE_REMOVAL:  return _size - 1;
+    default:            return _size;
+    }
+}
+
+bool FileMutator::variant(Rope & rope) const
+{
+    Patch patch;
+    if (_phase == DONE || !this->patch(patch)) {
+        return false;
+    }
+    rope = _seed;
+    rope.erase(patch.offset, patch.removed);
+    rope.insert(patch.offset, patch.data(), patch.size);
+    return true;
+}
+
+void FileMutator::evaluate(Buffer & buffer)
+{
+    Patch patch;
+    if (finished() || !this->patch(patch)) {
+        return;
+    }
+    if (patch.offset > 0) { //< write unmodified data before
+        buffer.write(_data, patch.offset);
+    }
+    buffer.write(patch.data(), patch.size);
+    const size_t after = patch.offset + patch.removed;
+    if (after < _size) { //< write unmodified data after
+        buffer.write(_data + after, _size - after);
+    }
+}
+
+size_t FileMutator::batch(std::vector<uint8_t> & dst, size_t count)
+{
+    dst.clear();
+    if (finished() || !count) {
+        return 0;
+    }
+    const size_t stride = batchStride();
+    const size_t size = _size;
+    /// variants of the seed's size only differ in the patched bytes
+    const bool replicate = (stride == size);
+    dst.resize(count * stride);
+
+    if (replicate) {
+        /// replicate the seed, doubling the copied part each time
+        memcpy(dst.data(), _data, size);
+        size_t copied = size;
+        while(copied < dst.size()) {
+            size_t n = copied < (dst.size() - copied) ? copied : (dst.size() - copied);
+            memcpy(dst.data() + copied, dst.data(), n);
+            copied += n;
+        }
+    }
+
+    size_t produced = 0;
+    while(produced < count && !finished() && batchStride() == stride) {
+        uint8_t * slot = dst.data() + produced * stride;
+        Patch patch;
+        this->patch(patch);
+        if (!replicate) {
+            const size_t after = patch.offset + patch.removed;
+            memcpy(slot, _data, patch.offset);
+            memcpy(slot + patch.offset + patch.size, _data + after, size - after);
+        }
+        memcpy(slot + patch.offset, patch.data(), patch.size);
+        ++produced;
+        mutate();
+    }
+    dst.resize(produced * stride);
+    return produced;
+}
+
+double FileMutator::progress() const
+{
+    if (_phase == DONE) {
+        return 1.0;
+    }
+    if (_sampled) {
+        return _share ? static_cast<double>(_samples) / static_cast<double>(_share) : 1.0;
+    }
+    double done = 0, total = 0;
+    for(size_t phase = FLIP_BIT1; phase < DONE; ++phase) {
+        const double variants = static_cast<double>(units(static_cast<Phase>(phase))) * steps(static_cast<Phase>(phase));
+        if (phase < static_cast<size_t>(_phase)) {
+            done += variants;
+        } else if (phase == static_cast<size_t>(_phase)) {
+            done += static_cast<double>(_offset) * steps(_phase) + _step;
+        }
+        total += variants;
+    }
+    return total > 0 ? done / total : 1.0;
+}
+
 bool FileMutator::state(std::string & state)
 {
     std::stringstream ss;
-    
+
     ss << "file: \"" << _name << "\",";
-    switch(_phase) {
-    case BIT_INVERSE:       ss << "bitinverse, offset=" << _offset; break;
-    case BYTE_REMOVAL:      ss << "byteremoval, offset=" << _offset; break;
-    case DONE:              ss << "done"; break;
+    if (_phase == DONE) {
+        ss << "done";
+    } else {
+        ss << PhaseNames[_phase] << ", offset=" << _offset << ", step=" << _step;
+        if (_sampled) {
+            ss << ", strata=" << _strata << ", seed=" << _seedValue
+               << ", worker=" << _worker << "/" << _workers
+               << ", level=" << _level << ", region=" << _root << "/" << _child
+               << ", samples=" << _samples;
+        }
     }
     state = ss.str();
     return true;
 }
 
+bool FileMutator::resume(Phase phase, size_t offset, size_t step)
+{
+    if (phase == DONE) {
+        _phase  = DONE;
+        _offset = 0;
+        _step   = 0;
+        return true;
+    }
+    if (phase > DONE || offset >= units(phase) || step >= steps(phase)) {
+        return false;
+    }
+    if (_sampled && ((phase <= FLIP_BIT4) ? (offset >> 3) : offset) != _sample) {
+        return false;
+    }
+    _phase  = phase;
+    _offset = offset;
+    _step   = step;
+    /// continue with the first variant that isn't skipped
+    Patch patch;
+    if (!this->patch(patch)) {
+        mutate();
+    }
+    return true;
+}
+
+bool FileMutator::restore(const std::string & state)
+{
+    /// the part after the file name
+    size_t pos = state.rfind("\",");
+    std::string stage = (pos == std::string::npos) ? state : state.substr(pos + 2);
+    for(size_t i = 0; i <= DONE; ++i) {
+        const size_t length = strlen(PhaseNames[i]);
+        if (stage.compare(0, length, PhaseNames[i]) || (stage.size() > length && stage[length] != ',')) {
+            continue;
+        }
+        unsigned long long offset = 0, step = 0;
+        if (i != DONE && sscanf(stage.c_str() + length, ", offset=%llu, step=%llu", &offset, &step) < 1) {
+            return false;
+        }
+        const size_t sampling = stage.find(", strata=");
+        if (i != DONE && sampling != std::string::npos) {
+            unsigned long long strata, seed, worker, workers, level, root, child, samples;
+            if (sscanf(stage.c_str() + sampling, ", strata=%llu, seed=%llu, worker=%llu/%llu, level=%llu, region=%llu/%llu, samples=%llu",
+                &strata, &seed, &worker, &workers, &level, &root, &child, &samples) != 8) {
+                return false;
+            }
+            sample(static_cast<size_t>(strata), seed, static_cast<size_t>(worker), static_cast<size_t>(workers));
+            if (level > _levels || root >= _strata || (root % _workers) != _worker || child >= (1ULL << level)) {
+                return false;
+            }
+            _level      = static_cast<size_t>(level);
+            _root       = static_cast<size_t>(root);
+            _child      = static_cast<size_t>(child);
+            _samples    = samples;
+            if (!draw(_level, _root, _child, _sample)) {
+                return false;
+            }
+        }
+        return resume(static_cast<Phase>(i), static_cast<size_t>(offset), static_cast<size_t>(step));
+    }
+    return false;
+}
+
 } // namespace runtime
 
 } // namespace fuzzer
@@ -2,17 +2,52 @@
 #define _FILEMUTATOR_H_
 
 #include "mutator.h"
+#include "dictionary.h"
+#include "mappedfile.h"
+#include "rope.h"
+#include <memory>
+#include <string>
+#include <vector>
 
 namespace fuzzer {
 
 namespace runtime {
 
 ///
-/// \brief  Mutates files
+/// \brief  Mutates files. Walks the deterministic stages in order, each
+///         stage visits every offset of the file and applies a fixed
+///         number of steps to it. Variants that an earlier stage already
+///         produced are skipped. Files too large to walk can be sampled
+///         instead, see sample().
 ///
 class FileMutator : public Mutator
 {
 public:
+    enum Phase {
+        FLIP_BIT1,      //< walking single bit flips
+        FLIP_BIT2,      //< walking two bit flips
+        FLIP_BIT4,      //< walking four bit flips
+        BIT_INVERSE,    //< inverse each byte
+        FLIP_WORD,      //< inverse two bytes
+        FLIP_DWORD,     //< inverse four bytes
+        ARITH8,         //< add/subtract 1-35 to each byte
+        ARITH16,        //< add/subtract 1-35 to each word, both byte orders
+        ARITH32,        //< add/subtract 1-35 to each dword, both byte orders
+        INTEREST8,      //< interesting byte values
+        INTEREST16,     //< interesting word values, both byte orders
+        INTEREST32,     //< interesting dword values, both byte orders
+        DICT_OVERWRITE, //< overwrite with each dictionary token
+        DICT_INSERT,    //< insert each dictionary token
+        BYTE_REMOVAL,   //< remove byte
+        DONE,           //< fuzzing done
+    };
+
+    /// largest value added or subtracted by the arithmetic stages
+    static const uint32_t ArithMax = 35;
+
+    /// bytes per effector map entry
+    static const size_t EffectorBlock = 8;
+
     ///
     /// \brief  Constructor
     ///
@@ -41,32 +76,174 @@ public:
     virtual void reset();
 
     ///
-    /// \brief  Unsupported
+    /// \brief  Writes the current variant of the file
     ///
     virtual void evaluate(Buffer &);
 
     ///
-    /// \brief
+    /// \brief  Describes the stage, offset and step, the string is accepted
+    ///         by restore().
     ///
     virtual bool state(std::string &);
 
+    ///
+    /// \brief  Continues from a state returned by state().
+    ///
+    bool restore(const std::string &);
+
+    ///
+    /// \brief  Continues from \p offset and \p step within \p phase.
+    ///
+    bool resume(Phase phase, size_t offset, size_t step = 0);
+
+    ///
+    /// \brief  Writes up to \p count consecutive variants to \p dst, starting
+    ///         with the current one, and advances past them. The seed is
+    ///         replicated with block copies and only the changed bytes are
+    ///         written per variant. All variants in a batch have the same
+    ///         size, so a batch ends early where the size changes.
+    ///
+    /// \return The number of variants written, each batchStride() bytes.
+    ///
+    size_t batch(std::vector<uint8_t> & dst, size_t count);
+
+    /// size of the current variant
+    size_t batchStride() const;
+
+    ///
+    /// \brief  The current variant as a rope over the mapped file. Costs
+    ///         O(log n) whatever the size of the file, and the pieces can be
+    ///         written without copying the file.
+    ///
+    bool variant(Rope &) const;
+
+    ///
+    /// \brief  Sets the coverage checksum of a run with the unmodified file,
+    ///         which enables the effector map.
+    ///
+    void baseline(uint64_t checksum);
+
+    ///
+    /// \brief  Reports the coverage checksum of a run with the current
+    ///         variant. During BIT_INVERSE, bytes that leave the coverage
+    ///         unchanged are marked as inert. The word, dword, arithmetic
+    ///         and interesting value stages then skip variants that only
+    ///         touch inert blocks of EffectorBlock bytes.
+    ///
+    void coverage(uint64_t checksum);
+
+    ///
+    /// \brief  True unless every block in [offset, offset + size) is inert.
+    ///         Blocks without reports are never inert.
+    ///
+    bool effective(size_t offset, size_t size) const;
+
+    ///
+    /// \brief  Enables the dictionary stages, which overwrite each offset
+    ///         with each token and insert each token at each offset. Set it
+    ///         before the walk reaches them.
+    ///
+    virtual void dictionary(const std::shared_ptr<const Dictionary> &);
+
+    ///
+    /// \brief  Samples offsets instead of walking them, for seeds that are
+    ///         too large to walk. The file is split into \p strata regions
+    ///         and an offset is drawn from each. Every following level
+    ///         halves the regions and draws an offset in each half that has
+    ///         none yet, so the whole file is covered at the chosen density
+    ///         before any region is refined, and the last level has visited
+    ///         every offset once. All stages run at a sampled offset before
+    ///         the next one is drawn.
+    ///
+    ///         The draws only depend on \p seed and the region, so a state()
+    ///         can be restored anywhere. Worker \p worker of \p workers
+    ///         takes every workers'th of the top level regions, the workers
+    ///         never sample the same offset.
+    ///
+    void sample(size_t strata, uint64_t seed, size_t worker = 0, size_t workers = 1);
+
+    ///
+    /// \brief  Fraction of the variants produced so far. In sampled mode,
+    ///         the fraction of this worker's offsets that are done.
+    ///
+    double progress() const;
+
+    bool sampled() const { return _sampled; }
+    /// the offset sampled last
+    size_t sampleOffset() const { return _sample; }
+
+    Phase phase() const { return _phase; }
+    size_t offset() const { return _offset; }
+    size_t step() const { return _step; }
+
 protected:
-    enum Phase {
-        BIT_INVERSE,    //< inverse each bit
-        BYTE_REMOVAL,   //< remove byte
-        DONE,           //< fuzzing done
+    ///
+    /// \brief  Bytes that differ from the seed for a single variant. The
+    ///         \p removed bytes at \p offset are replaced with \p size bytes.
+    ///
+    struct Patch {
+        size_t          offset;
+        size_t          removed;
+        size_t          size;
+        uint8_t         bytes[4];
+        const uint8_t * token;      //< dictionary token, used instead of bytes
+
+        const uint8_t * data() const { return token ? token : bytes; }
     };
 
+    /// number of offsets visited by a phase
+    size_t units(Phase) const;
+    /// number of steps applied at each offset
+    size_t steps(Phase) const;
+
+    /// bytes changed by the byte aligned phases
+    static size_t width(Phase);
+
+    /// moves to the next step, offset or phase
+    void advance();
+    /// moves to the first unit of \p phase at the sampled offset
+    bool enter(Phase);
+    /// bounds of a top level region
+    void region(size_t root, size_t & begin, size_t & end) const;
+    /// the offset drawn in a region, false if it was drawn by a parent
+    bool draw(size_t level, size_t root, size_t child, size_t & offset) const;
+    /// moves to the next region with a new offset, false when all are done
+    bool next(bool first);
+    /// true if the effector map rules out the current offset
+    bool inert() const;
+    /// computes the current variant, false if an earlier stage produced it
+    bool patch(Patch &) const;
+
 protected:
 
-    std::vector<uint8_t>    _data;      //< original file data
+    std::shared_ptr<io::MappedFile> _file;
+    const uint8_t *         _data;      //< original file data
+    size_t                  _size;
+    Rope                    _seed;      //< rope over the file data
     std::string             _name;      //< file name
     Phase                   _phase;     //< current phase
     size_t                  _offset;    //< current offset
+    size_t                  _step;      //< current step at the offset
+    bool                    _hasBaseline;
+    uint64_t                _baseline;  //< coverage of the unmodified file
+    std::vector<uint8_t>    _inert;     //< one bit per inert byte, per block
+    bool                    _sampled;   //< sampling instead of walking
+    uint64_t                _seedValue; //< seeds the draws
+    size_t                  _strata;    //< top level regions
+    size_t                  _worker;
+    size_t                  _workers;
+    size_t                  _levels;    //< last refinement level
+    size_t                  _level;     //< current refinement level
+    size_t                  _root;      //< current top level region
+    size_t                  _child;     //< current region below _root
+    size_t                  _sample;    //< current sampled offset
+    uint64_t                _samples;   //< sampled offsets done
+    uint64_t                _share;     //< offsets in this worker's regions
+    std::shared_ptr<const Dictionary> _dictionary;
 };
 
 } // namespace runtime
 
 } // namespace fuzzer
 
-#endif
\ No newline at end of file
+#endif
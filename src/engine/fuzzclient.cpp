@@ -0,0 +1,193 @@
+#include "fuzzclient.h"
+#include "ioerror.h"
+#include <iostream>
+
+using namespace std;
+
+namespace fuzzer {
+
+namespace runtime {
+
+ServerTarget::ServerTarget(execution::IApplicationExecuter & app, network::ConnectionPool & pool) :
+    _app(app),
+    _pool(pool),
+    _launch(0),
+    _running(false),
+    _workers(0)
+{
+}
+
+ServerTarget::~ServerTarget()
+{
+    Stop();
+}
+
+shared_ptr<network::TcpSocket> ServerTarget::Connect(size_t TimeOut, uint64_t & Launch)
+{
+    {
+        lock_guard<mutex> lock(_mutex);
+        if (!_running || !_app.IsAlive()) {
+            /// the connections to the previous launch are useless
+            _app.Terminate();
+            _app.Wait();
+            _pool.Reset();
+            if (!_app.Launch()) {
+                std::cout << "Failed to launch application." << std::endl;
+            }
+            ++_launch;
+            _running = true;
+        }
+        Launch = _launch;
+    }
+    /// the workers connect side by side
+    return _pool.Take(TimeOut);
+}
+
+bool ServerTarget::Died(uint64_t Launch)
+{
+    lock_guard<mutex> lock(_mutex);
+    if (Launch != _launch || !_running) {
+        return true;
+    }
+    if (_app.IsAlive()) {
+        return false;
+    }
+    int statusCode = 0;
+    execution::TerminationReason reason = execution::Term_Other;
+    _app.GetStatusCode(statusCode, reason);
+    std::cout << "App exited with " << statusCode << ", " << execution::DescribeTermination(reason) << std::endl;
+    _running = false;
+    return true;
+}
+
+void ServerTarget::Join()
+{
+    lock_guard<mutex> lock(_mutex);
+    ++_workers;
+}
+
+void ServerTarget::Leave()
+{
+    {
+        lock_guard<mutex> lock(_mutex);
+        if (--_workers > 0) {
+            return;
+        }
+    }
+    Stop();
+}
+
+void ServerTarget::Stop()
+{
+    lock_guard<mutex> lock(_mutex);
+    if (_running) {
+        _app.Terminate();
+        _app.Wait();
+        _pool.Reset();
+        _running = false;
+    }
+}
+
+namespace {
+
+/// joins the target for the lifetime of a run
+class RunScope
+{
+public:
+    explicit RunScope(ServerTarget & target) : _target(target) { _target.Join(); }
+    ~RunScope() { _target.Leave(); }
+
+private:
+    RunScope(const RunScope &);
+    RunScope & operator=(const RunScope &);
+
+    ServerTarget &  _target;
+};
+
+} // namespace
+
+///
+/// \brief  Constructor
+///
+FuzzClient::FuzzClient(ServerTarget & target) :
+    _target(target)
+{
+}
+
+void FuzzClient::Execute(const bytecode::Script & script, size_t ConnectTimeout)
+{
+    uint64_t launch;
+    shared_ptr<network::TcpSocket> sock = _target.Connect(ConnectTimeout, launch);
+    if (!sock) {
+        std::cout << "No connection to the application." << std::endl;
+        _target.Died(launch);
+        return;
+    }
+    Attach(sock.get());
+    try {
+        _vm.Execute( script );
+    } catch(io::IoException & err) {
+        /// error while communicating with peer
+        std::cout << "Caught I/O exception: " << err.what() << std::endl;
+    } catch(std::runtime_error & err) {
+        std::cout << "Caught runtime error: " << err.what() << std::endl;
+    } catch(...) {
+        /// caught an exception while executing the script
+        std::cout << "Caught unknown exception." << std::endl;
+    }
+    Attach(nullptr);
+    sock.reset();
+    _target.Died(launch);
+}
+
+///
+/// \brief  Performs the fuzzing
+///
+void FuzzClient::Run(const bytecode::Script & script, size_t ConnectTimeout)
+{
+    Compile(script);
+    RunScope scope(_target);
+
+    /// For each template
+    for(map<string, shared_ptr<Template> >::const_iterator it = script._templates.begin();
+        it != script._templates.end();
+        it++)
+    {
+        /// For each mutator
+        vector<runtime::Mutator *> mutators = it->second->GetMutators();
+        for(size_t i = 0; i < mutators.size(); ++i) {
+            if (runtime::Mutator * mutator = mutators[i]) {
+                /// For each mutation
+                mutator->reset();
+                do {
+                    Execute(script, ConnectTimeout);
+                    /// continue with next mutation
+                    mutator->mutate();
+                } while(!mutator->finished());
+
+                std::cout << "Mutator is done." << std::endl;
+            }
+        }
+    }
+}
+
+///
+/// \brief  Performs random fuzzing
+///
+void FuzzClient::RunHavoc(const bytecode::Script & script, size_t ConnectTimeout,
+    uint64_t Seed, size_t Worker, uint64_t Cases)
+{
+    Compile(script);
+    RunScope scope(_target);
+    HavocScheduler scheduler(script, Seed, Worker);
+    for(uint64_t i = 0; i < Cases; ++i) {
+        scheduler.next();
+        /// the description regenerates the case with HavocScheduler::apply
+        std::cout << scheduler.describe() << std::endl;
+        Execute(script, ConnectTimeout);
+    }
+}
+
+} // namespace runtime
+
+} // namespace fuzzer
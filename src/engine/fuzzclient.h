@@ -0,0 +1,112 @@
+#ifndef _FUZZCLIENT_H_
+#define _FUZZCLIENT_H_
+
+#include "fuzzer.h"
+#include "connpool.h"
+#include "appexec.h"
+#include "script.h"
+#include "havoc.h"
+#include <memory>
+#include <mutex>
+
+namespace fuzzer {
+
+namespace runtime {
+
+///
+/// \class  ServerTarget
+/// \brief  A long-lived server application, fuzzed over connections from a
+///         ConnectionPool. It is shared by the FuzzClient workers, the first
+///         one that finds it dead reports it and it is relaunched when the
+///         next connection is taken.
+///
+class ServerTarget
+{
+public:
+    ServerTarget(execution::IApplicationExecuter &, network::ConnectionPool &);
+
+    ///
+    /// \brief  Destructor, stops the application.
+    ///
+    ~ServerTarget();
+
+    ///
+    /// \brief  Takes a connection to the application, launching it first if
+    ///         it isn't running. \p Launch is set to the number of the
+    ///         launch that the connection belongs to.
+    ///
+    /// \return The connection, or nullptr if none was established in time.
+    ///
+    std::shared_ptr<network::TcpSocket> Connect(size_t TimeOut, uint64_t & Launch);
+
+    ///
+    /// \brief  Checks if the application of launch \p Launch has died, the
+    ///         first check that finds it dead reports how it exited.
+    ///
+    bool Died(uint64_t Launch);
+
+    ///
+    /// \brief  Registers a worker that runs test cases, Leave() stops the
+    ///         application once the last worker is done. FuzzClient joins
+    ///         for each run, whoever starts several workers joins around
+    ///         them so that it isn't stopped in between.
+    ///
+    void Join();
+    void Leave();
+
+    ///
+    /// \brief  Terminates the application and drops the connections to it.
+    ///
+    void Stop();
+
+private:
+    execution::IApplicationExecuter &   _app;
+    network::ConnectionPool &           _pool;
+    std::mutex                          _mutex;
+    uint64_t                            _launch;    //< number of the current launch
+    bool                                _running;
+    size_t                              _workers;   //< between Join() and Leave()
+};
+
+///
+/// \class  FuzzClient
+/// \brief  Client side for fuzzing servers, each test case runs the script
+///         over a connection of its own. Test cases run concurrently by
+///         running a FuzzClient per thread, each with its own script and
+///         worker index, against the same ServerTarget.
+///
+class FuzzClient : public Fuzzer
+{
+public:
+    ///
+    /// \brief  Constructor
+    ///
+    FuzzClient(ServerTarget &);
+
+    ///
+    /// \brief  Performs the fuzzing, the application is stopped when the
+    ///         last FuzzClient of the target is done.
+    ///
+    void Run(const bytecode::Script &, size_t ConnectTimeout);
+
+    ///
+    /// \brief  Performs random fuzzing, \p Cases test cases scheduled by a
+    ///         HavocScheduler with master seed \p Seed. Each case is logged
+    ///         with its id before it runs. The application is stopped as
+    ///         by Run().
+    ///
+    void RunHavoc(const bytecode::Script &, size_t ConnectTimeout,
+        uint64_t Seed, size_t Worker = 0, uint64_t Cases = ~0ULL);
+
+private:
+    /// runs the script once over a new connection
+    void Execute(const bytecode::Script &, size_t ConnectTimeout);
+
+    ServerTarget &  _target;
+};
+
+} // namespace runtime
+
+} // namespace  fuzzer
+
+#endif
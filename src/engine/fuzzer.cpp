@@ -11,7 +11,7 @@ namespace fuzzer
 ///
 /// \brief  Constructor
 ///
-Fuzzer::Fuzzer() : _ipc(nullptr)
+Fuzzer::Fuzzer() : _ipc(nullptr), _novelty(nullptr)
 {
     /// register input/output hooks
     _vm.RegisterHandler("out", this);
@@ -24,12 +24,65 @@ Fuzzer::Fuzzer() : _ipc(nullptr)
     _vm.RegisterHandler("trace", this);
     _vm.RegisterHandler("writeln", this);
     _vm.RegisterHandler("readln", this);
+    _vm.RegisterHandler("read", this);
+    _vm.RegisterHandler("expect", this);
+    _vm.RegisterHandler("match", this);
 }
 
 Fuzzer::~Fuzzer()
 {
 }
 
+void Fuzzer::Attach(io::Ipc * ipc)
+{
+    _ipc = ipc;
+    _receive.reset();
+    _recorder.reset();
+    if (ipc && _novelty) {
+        _recorder.reset(new runtime::ResponseRecorder(*ipc, *_novelty));
+        _receive.reset(new io::BufferedSource(*_recorder));
+    } else if (ipc) {
+        _receive.reset(new io::BufferedSource(*ipc));
+    }
+}
+
+void Fuzzer::Compile(const bytecode::Script & script)
+{
+    for(std::map<std::string, bytecode::Response>::const_iterator it = script._responses.begin();
+        it != script._responses.end();
+        ++it)
+    {
+        _responses[it->first] = it->second.input;
+    }
+    for(size_t m = 0; m < script._methods.size(); ++m) {
+        const bytecode::Method & method = *script._methods[m];
+        for(size_t i = 1; i < method.ins.size(); ++i) {
+            const bytecode::Instruction & call = method.ins[i];
+            const bytecode::Instruction & argument = method.ins[i - 1];
+            if (call.opcode != bytecode::OP_CALLEXT || call.count != 1 || argument.opcode != bytecode::OP_PUSHSTRING) {
+                continue;
+            }
+            const std::string & name = method.constant_strings[call.name];
+            if (name == "expect") {
+                GetPattern(method.constant_strings[argument.idx], runtime::Pattern::LITERAL);
+            } else if (name == "match") {
+                GetPattern(method.constant_strings[argument.idx], runtime::Pattern::REGEX);
+            }
+        }
+    }
+}
+
+const runtime::Pattern & Fuzzer::GetPattern(const std::string & pattern, runtime::Pattern::Syntax syntax)
+{
+    std::map<std::string, std::shared_ptr<const runtime::Pattern> > & patterns =
+        syntax == runtime::Pattern::LITERAL ? _literals : _regexes;
+    std::shared_ptr<const runtime::Pattern> & compiled = patterns[pattern];
+    if (!compiled) {
+        compiled = std::make_shared<runtime::Pattern>(pattern, syntax);
+    }
+    return *compiled;
+}
+
 template<class T>
 T convert(const bytecode::Value & value)
 {
@@ -52,12 +105,22 @@ bytecode::Value fromUnsigned(uint64_t value)
 
 bytecode::Value Fuzzer::Output(const std::string & name, const bytecode::Value & value)
 {
+    if (_novelty) {
+        _novelty->sent();
+    }
     if (name == "out8")         { _ipc->writeU8(convert<uint8_t>(value));   }
     else if (name == "out16")   { _ipc->writeU16(convert<uint16_t>(value)); }
     else if (name == "out32")   { _ipc->writeU32(convert<uint32_t>(value)); }
     else if (name == "out64")   { _ipc->writeU64(convert<uint64_t>(value)); }
     else if (name == "out")     {
-        if (value.type == bytecode::Value::OPAQUE) { /// Write vector with binary data
+        if (value.type == bytecode::Value::OPAQUE && value.opaqueSplices) {
+            /// large fills are written from the shared blocks, not copied
+            std::vector<io::Piece> pieces;
+            runtime::Buffer::pieces(*value.opaqueValue, *value.opaqueSplices, pieces);
+            if (!_ipc->writev(pieces.data(), pieces.size())) {
+                throw io::IoException("Failed to write opaque value.");
+            }
+        } else if (value.type == bytecode::Value::OPAQUE) { /// Write vector with binary data
             if (value.opaqueValue && !value.opaqueValue->empty()) {
                 if (!_ipc->write(&(*value.opaqueValue)[0], value.opaqueValue->size())) {
                     throw io::IoException("Failed to write opaque value.");
@@ -73,10 +136,10 @@ bytecode::Value Fuzzer::Output(const std::string & name, const bytecode::Value &
 
 bytecode::Value Fuzzer::Input(const std::string & name)
 {
-    if (name == "in8")          { return fromUnsigned(_ipc->readU8());   }
-    else if (name == "in16")    { return fromUnsigned(_ipc->readU16()); }
-    else if (name == "in32")    { return fromUnsigned(_ipc->readU32()); }
-    else if (name == "in64")    { return fromUnsigned(_ipc->readU64()); }
+    if (name == "in8")          { return fromUnsigned(_receive->readU8());   }
+    else if (name == "in16")    { return fromUnsigned(_receive->readU16()); }
+    else if (name == "in32")    { return fromUnsigned(_receive->readU32()); }
+    else if (name == "in64")    { return fromUnsigned(_receive->readU64()); }
     else                        { throw std::runtime_error("Unsupported input call."); }
 }
 
@@ -105,8 +168,12 @@ bytecode::Value Fuzzer::Call(bytecode::VirtualMachine & vm,
         return Trace(func_name, arguments);
     } else if (func_name == "readln") {
         return ReadLine(arguments);
+    } else if (func_name == "read") {
+        return Read(arguments);
     } else if (func_name == "writeln") {
         return WriteLine(arguments);
+    } else if (func_name == "expect" || func_name == "match") {
+        return Scan(func_name, arguments);
     }
     throw std::runtime_error("Unexpected function call.");
 }
@@ -138,6 +205,9 @@ bytecode::Value Fuzzer::WriteLine(const std::vector<bytecode::Value> & arguments
         throw std::runtime_error("writeln() expects a string argument.");
     }
     const std::string str = *arguments[0].stringValue;
+    if (_novelty) {
+        _novelty->sent();
+    }
 
     if (!_ipc->write(str.c_str(), str.size()) || !_ipc->write("\r\n", 2)) {
         throw io::IoException("Failed to write line.");
@@ -145,12 +215,28 @@ bytecode::Value Fuzzer::WriteLine(const std::vector<bytecode::Value> & arguments
     return bytecode::Value();
 }
 
+bytecode::Value Fuzzer::Read(const std::vector<bytecode::Value> & arguments)
+{
+    if (arguments.size() != 1 || arguments[0].type != bytecode::Value::STRING || !arguments[0].stringValue) {
+        throw std::runtime_error("read() expects the name of a response.");
+    }
+    std::map<std::string, std::shared_ptr<io::Input> >::const_iterator it = _responses.find(*arguments[0].stringValue);
+    if (it == _responses.end()) {
+        throw std::runtime_error("Unknown response.");
+    }
+    /// the templates echo the captured fields of the last response
+    if (!it->second->read(*_receive)) {
+        throw io::IoException("Failed to read the response.");
+    }
+    return bytecode::Value();
+}
+
 bytecode::Value Fuzzer::ReadLine(const std::vector<bytecode::Value> & arguments)
 {
     std::string line;
     bool cr = false;
     for(;;) {
-        char c = (char) _ipc->readU8();
+        char c = (char) _receive->readU8();
         if (c == '\r') {
             if (cr) {
                 throw io::IoException("Mailformed line, duplicate CR.");
@@ -175,6 +261,45 @@ bytecode::Value Fuzzer::ReadLine(const std::vector<bytecode::Value> & arguments)
     throw std::runtime_error("Should never happen.");
 }
 
+///
+/// \brief  expect("literal") and match("regex"), reads until the pattern
+///         is found and returns what was read, including the match.
+///
+bytecode::Value Fuzzer::Scan(const std::string & name,
+    const std::vector<bytecode::Value> & arguments)
+{
+    if (arguments.size() != 1 || arguments[0].type != bytecode::Value::STRING || !arguments[0].stringValue) {
+        throw std::runtime_error(name + "() expects a single string argument.");
+    }
+    const runtime::Pattern & pattern = GetPattern(*arguments[0].stringValue,
+        name == "expect" ? runtime::Pattern::LITERAL : runtime::Pattern::REGEX);
+
+    /// scan the receive buffer in place, only new bytes are scanned
+    uint32_t state = runtime::Pattern::Start;
+    size_t scanned = 0;
+    for(;;) {
+        const size_t available = _receive->available();
+        if (scanned < available) {
+            const size_t end = pattern.scan(_receive->data() + scanned, available - scanned, state);
+            if (end != runtime::Pattern::npos) {
+                const size_t length = scanned + end;
+                bytecode::Value v;
+                v.type = bytecode::Value::STRING;
+                v.stringValue = make_shared<string>(reinterpret_cast<const char *>(_receive->data()), length);
+                _receive->consume(length);
+                return v;
+            }
+            scanned = available;
+        }
+        if (scanned >= MaxScan) {
+            throw io::IoException("Pattern not found in the response.");
+        }
+        if (!_receive->require(scanned + 1)) {
+            throw io::IoException("Connection closed before the pattern was found.");
+        }
+    }
+}
+
 #if 0
 ///
 /// \brief  Run the fuzzer
@@ -4,8 +4,13 @@
 #include "vm.h"
 #include "script.h"
 #include "io.h"
+#include "bufferedsource.h"
+#include "pattern.h"
+#include "novelty.h"
 
 #include <list>
+#include <map>
+#include <memory>
 #include <string>
 
 namespace fuzzer
@@ -17,10 +22,26 @@ namespace fuzzer
 class Fuzzer : public bytecode::IRuntimeHandler
 {
 public:
+    /// bytes scanned by expect() and match() before they give up
+    static const size_t MaxScan = 64 * 1024;
+
     Fuzzer();
     virtual ~Fuzzer();
 
+    ///
+    /// \brief  Compiles the constant patterns of expect() and match() in
+    ///         \p script, so that they aren't compiled while it runs, and
+    ///         makes its responses available to read().
+    ///
+    void Compile(const bytecode::Script &);
+
 protected:
+    ///
+    /// \brief  Uses \p ipc for the script, reads go through a receive
+    ///         buffer so that patterns can be matched in place. With
+    ///         response feedback the received bytes are also recorded.
+    ///
+    void Attach(io::Ipc * ipc);
 
     virtual bytecode::Value Call(bytecode::VirtualMachine &, const std::string &,
         const std::vector<bytecode::Value> &);
@@ -29,11 +50,22 @@ protected:
     bytecode::Value Trace(const std::string &, const std::vector<bytecode::Value> & arguments);
     bytecode::Value WriteLine(const std::vector<bytecode::Value> & arguments);
     bytecode::Value ReadLine(const std::vector<bytecode::Value> & arguments);
+    bytecode::Value Read(const std::vector<bytecode::Value> & arguments);
+    bytecode::Value Scan(const std::string &, const std::vector<bytecode::Value> & arguments);
+
+    /// the compiled pattern, compiled now if it isn't a constant
+    const runtime::Pattern & GetPattern(const std::string &, runtime::Pattern::Syntax);
 
 protected:
 
     bytecode::VirtualMachine _vm;
     io::Ipc * _ipc;
+    runtime::ResponseNovelty * _novelty;            //< records the responses, optional
+    std::unique_ptr<runtime::ResponseRecorder> _recorder;
+    std::unique_ptr<io::BufferedSource> _receive;   //< reads from _ipc
+    std::map<std::string, std::shared_ptr<const runtime::Pattern> > _literals;
+    std::map<std::string, std::shared_ptr<const runtime::Pattern> > _regexes;
+    std::map<std::string, std::shared_ptr<io::Input> > _responses;  //< read by read()
 };
 
 } // namespace fuzzer
@@ -14,18 +14,81 @@ namespace runtime {
 FuzzServer::FuzzServer(
     network::TcpServer & network, execution::IApplicationExecuter & app) :
     _network(network),
-    _app(app)
+    _app(app),
+    _pool(nullptr),
+    _instance(nullptr),
+    _listener(&network),
+    _target(&app),
+    _calibration(0),
+    _persistence(RELAUNCH),
+    _maxCases(0),
+    _launched(false),
+    _cases(0),
+    _snapshot(false),
+    _replaying(false),
+    _replayed(0)
 {
+    _vm.RegisterHandler("snapshot", this);
+}
+
+void FuzzServer::SetPersistence(Persistence persistence, size_t MaxCases)
+{
+    _persistence    = persistence;
+    _maxCases       = MaxCases;
+}
+
+void FuzzServer::SetWarmPool(WarmPool * pool)
+{
+    _pool = pool;
+}
+
+bytecode::Value FuzzServer::Call(bytecode::VirtualMachine & vm,
+    const std::string & func_name,
+    const std::vector<bytecode::Value> & arguments)
+{
+    if (_replaying) {
+        /// the application is at the snapshot already
+        if (func_name == "snapshot") {
+            _replaying = false;
+            return bytecode::Value();
+        }
+        if (_replayed == _recorded.size()) {
+            throw std::runtime_error("The script diverged before snapshot().");
+        }
+        return _recorded[_replayed++];
+    }
+    if (func_name == "snapshot") {
+        if (_launched && !_snapshot && _target->Snapshot()) {
+            _snapshot = true;
+            /// the responses before the snapshot aren't part of the test case
+            if (_novelty) {
+                _novelty->begin();
+            }
+        }
+        return bytecode::Value();
+    }
+    bytecode::Value value = Fuzzer::Call(vm, func_name, arguments);
+    if (!_snapshot) {
+        _recorded.push_back(value);
+    }
+    return value;
+}
+
+void FuzzServer::EnableResponseFeedback(size_t CalibrationRuns)
+{
+    _responses.reset(new ResponseNovelty());
+    _novelty        = _responses.get();
+    _calibration    = CalibrationRuns;
 }
 
 shared_ptr<network::TcpSocket> FuzzServer::WaitForIncoming(size_t Timeout)
 {
     static const size_t interval = 25;
     for(size_t time = 0; time < Timeout; time += interval) {
-        if (!_app.IsAlive()) {
+        if (!_target->IsAlive()) {
             return nullptr;
         }
-        shared_ptr<network::TcpSocket> sock = _network.Accept(interval);
+        shared_ptr<network::TcpSocket> sock = _listener->Accept(interval);
         if (sock) {
             return sock;
         }
@@ -33,19 +96,133 @@ shared_ptr<network::TcpSocket> FuzzServer::WaitForIncoming(size_t Timeout)
     return nullptr;
 }
 
-const char * TerminationReason(int Code)
+void FuzzServer::Stop()
 {
-    switch(Code) {
-    case EXCEPTION_ACCESS_VIOLATION:
-        return "access violation";
-    case EXCEPTION_ARRAY_BOUNDS_EXCEEDED:
-        return "array bounds exceeded";
-    case EXCEPTION_DATATYPE_MISALIGNMENT:
-        return "misaligned data access";
-    case EXCEPTION_STACK_OVERFLOW:
-        return "stack overflow.";
-    default:
-        return "unknown";
+    Attach(nullptr);
+    _launched   = false;
+    _snapshot   = false;
+    if (_instance) {
+        _instance->connection = std::move(_session);
+        /// the pool terminates it in the background, only a crash is reported
+        if (!_target->IsAlive()) {
+            int statusCode = 0;
+            execution::TerminationReason reason = execution::Term_Other;
+            _target->GetStatusCode(statusCode, reason);
+            std::cout << "App exited with " << statusCode << ", " << execution::DescribeTermination(reason) << std::endl;
+        }
+        _pool->Release(_instance);
+        _instance = nullptr;
+        return;
+    }
+    /// terminated before the connection is closed, so that it doesn't
+    /// connect again in the meantime
+    _app.Terminate();
+    _app.Wait();
+    _session.reset();
+    int statusCode = 0;
+    execution::TerminationReason reason = execution::Term_Other;
+    _app.GetStatusCode(statusCode, reason);
+    std::cout << "App exited with " << statusCode << ", " << execution::DescribeTermination(reason) << std::endl;
+}
+
+///
+/// \brief  Runs the script against the application once.
+///
+void FuzzServer::Execute(const bytecode::Script & script, size_t ConnectTimeout)
+{
+    if (_novelty) {
+        _novelty->begin();
+    }
+    if (_launched && !_target->IsAlive()) {
+        /// crashed after the previous test case had finished
+        std::cout << "App died after the previous test case." << std::endl;
+        Stop();
+    }
+    const bool resumed = _launched && _session;
+    if (!_launched && _pool) {
+        /// the application is launched and connected already
+        _instance = _pool->Take(ConnectTimeout);
+        if (!_instance) {
+            std::cout << "No application ready in the warm pool." << std::endl;
+            return;
+        }
+        _listener   = &_instance->server();
+        _target     = &_instance->app();
+        _session    = std::move(_instance->connection);
+        _launched   = true;
+        _cases      = 0;
+        Attach(_session.get());
+    } else if (!_launched) {
+        _listener   = &_network;
+        _target     = &_app;
+        /// Launch the application so that it can connect to the server
+        if (!_app.Launch()) {
+            /// failed to launch application, throw exception
+            std::cout << "Failed to launch application." << std::endl;
+        }
+        _launched   = true;
+        _cases      = 0;
+    }
+    if (!_session) {
+        /// Wait for a incoming connection
+        _session = WaitForIncoming(ConnectTimeout);
+        if (!_session) {
+            /// no incoming connection, the application is relaunched for the next case
+            std::cout << "No connection from the application." << std::endl;
+            Stop();
+            return;
+        }
+        /// We have a incoming connection, use this as IPC between the fuzzer and
+        /// the launched application.
+        Attach(_session.get());
+    } else if (resumed) {
+        /// the previous case may have left responses unread, they would be
+        /// read as this case's
+        _session->discard();
+        Attach(_session.get());
+    }
+    _replaying = _snapshot;
+    _replayed  = 0;
+    if (!_snapshot) {
+        _recorded.clear();
+    }
+
+    bool failed = true;
+    try {
+        _vm.Execute( script );
+        /// The script finished execution
+        failed = false;
+    } catch(io::IoException & err) {
+        /// error while communicating with peer
+        std::cout << "Caught I/O exception: " << err.what() << std::endl;
+    } catch(std::runtime_error & err) {
+        std::cout << "Caught runtime error: " << err.what() << std::endl;
+    } catch(...) {
+        /// caught an exception while executing the script
+        std::cout << "Caught unknown exception." << std::endl;
+    }
+    ++_cases;
+    _replaying = false;
+
+    if (_snapshot && !failed && _target->IsAlive() && (!_maxCases || _cases < _maxCases)) {
+        /// back to the snapshot, with the connection as it was. The socket
+        /// buffers aren't part of the snapshot, what the case left unread
+        /// is dropped
+        if (_target->Restore()) {
+            _session->discard();
+            Attach(_session.get());
+            return;
+        }
+        std::cout << "Failed to restore the snapshot." << std::endl;
+        Stop();
+        return;
+    }
+    if (_persistence == RELAUNCH || !_target->IsAlive() || (_maxCases && _cases >= _maxCases)) {
+        Stop();
+    } else if (_persistence == RECONNECT || failed) {
+        /// the state of the session is unknown after an error
+        Attach(nullptr);
+        _session.reset();
     }
 }
 
@@ -55,6 +232,8 @@ const char * TerminationReason(int Code)
 void FuzzServer::Run(const bytecode::Script & script,
     size_t ConnectTimeout)
 {
+    Compile(script);
+
     /// For each template
     for(map<string, shared_ptr<Template> >::const_iterator it = script._templates.begin();
         it != script._templates.end();
@@ -67,46 +246,7 @@ void FuzzServer::Run(const bytecode::Script & script,
                 /// For each mutation
                 mutator->reset();
                 do {
-                    /// Launch the application so that it can connect to the server
-                    if (!_app.Launch()) {
-                        /// failed to launch application, throw exception
-                        std::cout << "Failed to launch application." << std::endl;
-                    }
-                    /// Wait for a incoming connection
-                    shared_ptr<network::TcpSocket> sock = WaitForIncoming(ConnectTimeout);
-                    if (!sock) {
-                        /// no incoming connection, terminate the application and report the issue
-                        _app.Terminate();
-                        _app.Wait();
-                    } else {
-                        /// We have a incoming connection, use this as IPC between the fuzzer and
-                        /// the launched application.
-                        this->_ipc = sock.get();
-
-                        try {
-                            _vm.Execute( script );
-                            _app.Terminate();
-                            _app.Wait();
-                            /// The script finished execution
-                            int statusCode;
-                            execution::TerminationReason reason;
-                            _app.GetStatusCode(statusCode, reason);
-                            std::cout << "App exited with " << statusCode << ", " << TerminationReason(statusCode) << std::endl;
-                        } catch(io::IoException & err) {
-                            /// error while communicating with peer
-                            std::cout << "Caught I/O exception: " << err.what() << std::endl;
-                        } catch(std::runtime_error & err) {
-                            std::cout << "Caught runtime error: " << err.what() << std::endl;
-                        } catch(...) {
-                            /// caught an exception while executing the script
-                            std::cout << "Caught unknown exception." << std::endl;
-                        }
-                        _app.Terminate();
-                        _app.Wait();
-                        int statusCode;
-                        execution::TerminationReason reason;
-                        _app.GetStatusCode(statusCode, reason);
-                    }
+                    Execute(script, ConnectTimeout);
                     /// continue with next mutation
                     mutator->mutate();
                 } while(!mutator->finished());
@@ -115,8 +255,43 @@ void FuzzServer::Run(const bytecode::Script & script,
             }
         }
     }
+    if (_launched) {
+        Stop();
+    }
+}
+
+///
+/// \brief  Performs random fuzzing
+///
+void FuzzServer::RunHavoc(const bytecode::Script & script, size_t ConnectTimeout,
+    uint64_t Seed, size_t Worker, uint64_t Cases)
+{
+    Compile(script);
+    HavocScheduler scheduler(script, Seed, Worker);
+    if (_responses) {
+        /// the responses to the unmodified templates give the volatile bytes
+        scheduler.park();
+        for(size_t i = 0; i < _calibration; ++i) {
+            Execute(script, ConnectTimeout);
+            _responses->calibrate();
+        }
+    }
+    for(uint64_t i = 0; i < Cases; ++i) {
+        scheduler.next();
+        /// the description regenerates the case with HavocScheduler::apply
+        std::cout << scheduler.describe() << std::endl;
+        Execute(script, ConnectTimeout);
+        if (_responses && _responses->end()) {
+            scheduler.promote();
+            std::cout << "new response fingerprint 0x" << std::hex << _responses->fingerprint() << std::dec
+                      << ", " << scheduler.promoted() << " promoted" << std::endl;
+        }
+    }
+    if (_launched) {
+        Stop();
+    }
 }
 
 } // namespace runtime
 
-} // namespace fuzzer
\ No newline at end of file
+} // namespace fuzzer
@@ -5,6 +5,8 @@
 #include "tcp.h"
 #include "appexec.h"
 #include "script.h"
+#include "havoc.h"
+#include "warmpool.h"
 #include <memory>
 
 namespace fuzzer {
@@ -18,6 +20,15 @@ namespace runtime {
 class FuzzServer : public Fuzzer
 {
 public:
+    ///
+    /// \brief  How long the application is kept running.
+    ///
+    enum Persistence {
+        RELAUNCH,   //< launched for every test case
+        RECONNECT,  //< kept running, it connects again for every test case
+        SESSION     //< kept running and connected, the test cases share the connection
+    };
+
     ///
     /// \brief  Constructor
     ///
@@ -28,12 +39,77 @@ public:
     ///
     void Run(const bytecode::Script &, size_t ConnectTimeout);
 
+    ///
+    /// \brief  Performs random fuzzing, \p Cases test cases scheduled by a
+    ///         HavocScheduler with master seed \p Seed. Each case is logged
+    ///         with its id before it runs.
+    ///
+    void RunHavoc(const bytecode::Script &, size_t ConnectTimeout,
+        uint64_t Seed, size_t Worker = 0, uint64_t Cases = ~0ULL);
+
+    ///
+    /// \brief  Enables feedback from the responses for targets without
+    ///         coverage, see ResponseNovelty. RunHavoc first runs the
+    ///         unmodified script \p CalibrationRuns times to find the
+    ///         volatile bytes, then promotes the cases with responses that
+    ///         weren't seen before.
+    ///
+    void EnableResponseFeedback(size_t CalibrationRuns = 3);
+
+    ///
+    /// \brief  Keeps the application running between the test cases. It is
+    ///         relaunched when it crashes, when it doesn't connect within
+    ///         the timeout, and after \p MaxCases test cases if it isn't 0.
+    ///         A SESSION that fails with an error is closed, and the
+    ///         application is expected to connect again.
+    ///
+    void SetPersistence(Persistence, size_t MaxCases = 0);
+
+    ///
+    /// \brief  Takes the applications from \p pool instead of launching
+    ///         the application passed to the constructor, so that launching
+    ///         and terminating them is done in the background.
+    ///
+    void SetWarmPool(WarmPool * pool);
+
+protected:
+    ///
+    /// \brief  Handles snapshot(), which records the state of the
+    ///         application if its executer supports it. After a test case
+    ///         the application is restored to the snapshot instead of being
+    ///         relaunched, and the calls up to snapshot() are replayed with
+    ///         their recorded results. Mutations before snapshot() have no
+    ///         effect once it has been taken.
+    ///
+    virtual bytecode::Value Call(bytecode::VirtualMachine &, const std::string &,
+        const std::vector<bytecode::Value> &);
+
 private:
-    
+    /// runs the script once, launching the application if it isn't running
+    void Execute(const bytecode::Script &, size_t ConnectTimeout);
+
+    /// terminates the application and reports how it exited
+    void Stop();
+
     std::shared_ptr<network::TcpSocket> WaitForIncoming(size_t Timeout);
 
     network::TcpServer &                _network;
     execution::IApplicationExecuter &   _app;
+    WarmPool *                          _pool;
+    WarmPool::Instance *                _instance;      //< taken from the pool
+    network::TcpServer *                _listener;      //< of the running application
+    execution::IApplicationExecuter *   _target;        //< the running application
+    std::unique_ptr<ResponseNovelty>    _responses;
+    size_t                              _calibration;
+    Persistence                         _persistence;
+    size_t                              _maxCases;
+    bool                                _launched;
+    size_t                              _cases;         //< since the last launch
+    std::shared_ptr<network::TcpSocket> _session;
+    bool                                _snapshot;      //< taken of the running application
+    bool                                _replaying;     //< the calls before snapshot()
+    std::vector<bytecode::Value>        _recorded;      //< results of the calls before snapshot()
+    size_t                              _replayed;
 };
 
 } // namespace runtime
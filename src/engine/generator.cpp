@@ -1,7 +1,13 @@
 #include "generator.h"
 #include "parser.h"
 #include "integermutator.h"
+#include "lazycapture.h"
+#include "plugin.h"
 #include "stringmutator.h"
+#include "structuremutator.h"
+#include "urimutator.h"
+#include "vectormutator.h"
+#include <limits>
 #include <sstream>
 
 using namespace std;
@@ -17,6 +23,7 @@ namespace bytecode {
 shared_ptr<Script> Generator::ParseScript(parser::Tokenizer & tokenizer)
 {
     shared_ptr<Script> script = make_shared<Script>();
+    _script = script;
     Symbol_t token = tokenizer.Peek();
     while(token != T_EOF) {
         if (token == T_TEMPLATE) { // template x = []
@@ -32,6 +39,18 @@ shared_ptr<Script> Generator::ParseScript(parser::Tokenizer & tokenizer)
                 throw std::runtime_error("Duplicate template declarations.");
             }
             script->_templates[name] = tp;
+        } else if (token == T_RESPONSE) { // response x = []
+            tokenizer.GetSym();
+            Expect(T_IDENT, tokenizer);
+            const std::string name = tokenizer.SymbolTable().Retrive(tokenizer.SymIndex());
+            Expect(T_ASSIGN, tokenizer);
+            Response response = ParseResponse(tokenizer);
+            Expect(T_SEMICOLON, tokenizer);
+
+            if (script->_responses.find(name) != script->_responses.end()) {
+                throw std::runtime_error("Duplicate response declarations.");
+            }
+            script->_responses[name] = response;
         } else if (token == T_FUNCTION) { // function x() {}
             script->_methods.push_back(ParseMethod(tokenizer, script));
         } else {
@@ -39,6 +58,7 @@ shared_ptr<Script> Generator::ParseScript(parser::Tokenizer & tokenizer)
         }
         token = tokenizer.Peek();
     }
+    _script.reset();
     return script;
 }
 
@@ -125,6 +145,21 @@ void Generator::ParseStatement(parser::Tokenizer & tokenizer,
     }
 }
 
+///
+/// \brief  Parses the optional initial value of a string, ("...")
+///
+const char * Generator::ParseInitialString(parser::Tokenizer & tokenizer)
+{
+    const char * str = 0;
+    if (tokenizer.Peek() == T_LEFT_PAREN) {
+        Expect(T_LEFT_PAREN, tokenizer);
+        Expect(T_STRING, tokenizer);
+        str = tokenizer.SymbolTable().Retrive(tokenizer.SymIndex());
+        Expect(T_RIGHT_PAREN, tokenizer);
+    }
+    return str;
+}
+
 void Generator::ParseExpression(parser::Tokenizer & tokenizer,
     std::shared_ptr<Method> method,
     std::shared_ptr<Script> script)
@@ -227,8 +262,11 @@ void Generator::ParseFactor(parser::Tokenizer & tokenizer,
             }
         }
     } else if (sym == T_INTEGER) {
+        if (tokenizer.IntValue() > static_cast<uint64_t>(std::numeric_limits<int>::max())) {
+            throw std::runtime_error("Integer constant is out of range.");
+        }
         method->ins.push_back(push_int(method->constant_ints.size()));
-        method->constant_ints.push_back(tokenizer.IntValue());
+        method->constant_ints.push_back(static_cast<int>(tokenizer.IntValue()));
     } else if (sym == T_STRING) {
         SymbolTable::SymIndex name = tokenizer.SymIndex();
         if (const char * str = tokenizer.SymbolTable().Retrive(name)) {
@@ -264,12 +302,116 @@ std::shared_ptr<runtime::Template> Generator::ParseTemplate(
     parser::Tokenizer & tokenizer)
 {
     std::shared_ptr<runtime::Template> tp = std::make_shared<runtime::Template>();
+    std::vector<std::shared_ptr<runtime::Template> > donors;
+    const bool structure = tokenizer.Peek() == T_KEYWORD_STRUCTURE;
+    if (structure) {
+        /// structure(a, b) [ ... ], the item list is mutated too, spliced
+        /// with the earlier templates a and b
+        tokenizer.GetSym();
+        if (tokenizer.Peek() == T_LEFT_PAREN) {
+            Expect(T_LEFT_PAREN, tokenizer);
+            do {
+                Expect(T_IDENT, tokenizer);
+                const std::string name = tokenizer.SymbolTable().Retrive(tokenizer.SymIndex());
+                std::map<std::string, std::shared_ptr<runtime::Template> >::const_iterator donor;
+                if (!_script || (donor = _script->_templates.find(name)) == _script->_templates.end()) {
+                    throw std::runtime_error("Unknown template.");
+                }
+                donors.push_back(donor->second);
+                if (tokenizer.Peek() != T_COMMA) {
+                    break;
+                }
+                tokenizer.GetSym();
+            } while(1);
+            Expect(T_RIGHT_PAREN, tokenizer);
+        }
+    }
     Expect(T_LEFT_SQUARE_BRACKET, tokenizer);
     ParseTemplateExpressions(tp, tokenizer, false);
     Expect(T_RIGHT_SQUARE_BRACKET, tokenizer);
+    if (structure) {
+        runtime::StructureMutator * mutator = new runtime::StructureMutator(*tp);
+        for(size_t i = 0; i < donors.size(); ++i) {
+            mutator->donor(donors[i]);
+        }
+        /// writes the base items until the fuzzer walks it
+        mutator->seek(mutator->count());
+        tp->structure(mutator);
+    }
     return tp;
 }
 
+///
+/// \brief  Parses the fields of a response, the named ones are captured
+///         [ u16 length, array(length, 64) token, u32 ]
+///
+Response Generator::ParseResponse(parser::Tokenizer & tokenizer)
+{
+    Response response;
+    response.input = std::make_shared<io::Input>();
+    /// echoed after the receive buffer moved on
+    response.input->retain(true);
+    Expect(T_LEFT_SQUARE_BRACKET, tokenizer);
+    do {
+        size_t id = 0;
+        const Symbol_t type = tokenizer.GetSym();
+        switch(type) {
+        case T_KEYWORD_U8:
+        case T_KEYWORD_U16:
+        case T_KEYWORD_U24:
+        case T_KEYWORD_U32:
+        case T_KEYWORD_U64:
+            {
+                const bool capture = tokenizer.Peek() == T_IDENT;
+                switch(type) {
+                case T_KEYWORD_U8:  id = response.input->u8(capture); break;
+                case T_KEYWORD_U16: id = response.input->u16(capture); break;
+                case T_KEYWORD_U24: id = response.input->u24(capture); break;
+                case T_KEYWORD_U32: id = response.input->u32(capture); break;
+                default:            id = response.input->u64(capture); break;
+                }
+            }
+            break;
+        case T_KEYWORD_ARRAY:
+            {
+                /// array(length, max), length is a previous named field
+                Expect(T_LEFT_PAREN, tokenizer);
+                Expect(T_IDENT, tokenizer);
+                std::map<std::string, size_t>::const_iterator length =
+                    response.fields.find(tokenizer.SymbolTable().Retrive(tokenizer.SymIndex()));
+                if (length == response.fields.end()) {
+                    throw std::runtime_error("Unknown response field.");
+                }
+                Expect(T_COMMA, tokenizer);
+                Expect(T_INTEGER, tokenizer);
+                const uint64_t max = tokenizer.IntValue();
+                Expect(T_RIGHT_PAREN, tokenizer);
+                if (max > std::numeric_limits<size_t>::max()) {
+                    throw std::runtime_error("Invalid array bounds.");
+                }
+                id = response.input->varray(length->second, static_cast<size_t>(max), tokenizer.Peek() == T_IDENT);
+            }
+            break;
+        default:
+            throw std::runtime_error("Expected a type.");
+        }
+        if (tokenizer.Peek() == T_IDENT) {
+            tokenizer.GetSym();
+            const std::string name = tokenizer.SymbolTable().Retrive(tokenizer.SymIndex());
+            if (response.fields.find(name) != response.fields.end()) {
+                throw std::runtime_error("Duplicate response field.");
+            }
+            response.fields[name] = id;
+        }
+        if (tokenizer.Peek() != T_COMMA) {
+            break;
+        }
+        tokenizer.GetSym();
+    } while(1);
+    Expect(T_RIGHT_SQUARE_BRACKET, tokenizer);
+    return response;
+}
+
 void Generator::ParseTemplateExpressions(
     std::shared_ptr<runtime::Template> tp,
     parser::Tokenizer & tokenizer,
@@ -297,18 +439,18 @@ void Generator::ParseTemplateExpressions(
     } while(1);
 }
 
-static void AddFuzzedUInteger(Symbol_t sym, int value, std::shared_ptr<runtime::Template> tp)
+static void AddFuzzedUInteger(Symbol_t sym, uint64_t value, std::shared_ptr<runtime::Template> tp)
 {
     switch(sym) {
-    case T_KEYWORD_BYTE:    tp->lazy(new runtime::UnsignedMutator<uint8_t>(value)); break;
-    case T_KEYWORD_WORD:    tp->lazy(new runtime::UnsignedMutator<uint16_t>(value)); break;
-    case T_KEYWORD_DWORD:   tp->lazy(new runtime::UnsignedMutator<uint32_t>(value)); break;
+    case T_KEYWORD_BYTE:    tp->lazy(new runtime::UnsignedMutator<uint8_t>(static_cast<uint8_t>(value))); break;
+    case T_KEYWORD_WORD:    tp->lazy(new runtime::UnsignedMutator<uint16_t>(static_cast<uint16_t>(value))); break;
+    case T_KEYWORD_DWORD:   tp->lazy(new runtime::UnsignedMutator<uint32_t>(static_cast<uint32_t>(value))); break;
     case T_KEYWORD_QWORD:   tp->lazy(new runtime::UnsignedMutator<uint64_t>(value)); break;
     default:                break;
     }
 }
 
-static void AddUInteger(Symbol_t sym, int value, std::shared_ptr<runtime::Template> tp)
+static void AddUInteger(Symbol_t sym, uint64_t value, std::shared_ptr<runtime::Template> tp)
 {
     switch(sym) {
     case T_KEYWORD_BYTE:    tp->u8(static_cast<uint8_t>(value)); break;
@@ -319,6 +461,74 @@ static void AddUInteger(Symbol_t sym, int value, std::shared_ptr<runtime::Templa
     }
 }
 
+template<class T>
+static void AddArray(size_t lower, size_t upper, bool fuzzed, std::shared_ptr<runtime::Template> tp)
+{
+    if (fuzzed) {
+        tp->lazy(new runtime::VectorMutator<T>(lower, upper));
+    } else {
+        /// fixed size arrays are zero filled
+        std::vector<T> data(lower);
+        tp->array<T>(data.data(), data.size());
+    }
+}
+
+/// signed constant, range checked for the type
+template<class T>
+static int64_t ParseSigned(parser::Tokenizer & tokenizer)
+{
+    return Parser::ParseSigned(tokenizer, std::numeric_limits<T>::min(), std::numeric_limits<T>::max());
+}
+
+static int64_t ParseSignedConstant(Symbol_t sym, parser::Tokenizer & tokenizer)
+{
+    switch(sym) {
+    case T_KEYWORD_S8:      return ParseSigned<int8_t>(tokenizer);
+    case T_KEYWORD_S16:     return ParseSigned<int16_t>(tokenizer);
+    case T_KEYWORD_S32:     return ParseSigned<int32_t>(tokenizer);
+    default:                return ParseSigned<int64_t>(tokenizer);
+    }
+}
+
+static void AddFuzzedSInteger(Symbol_t sym, int64_t value, std::shared_ptr<runtime::Template> tp)
+{
+    switch(sym) {
+    case T_KEYWORD_S8:      tp->lazy(new runtime::SignedMutator<int8_t>(static_cast<int8_t>(value))); break;
+    case T_KEYWORD_S16:     tp->lazy(new runtime::SignedMutator<int16_t>(static_cast<int16_t>(value))); break;
+    case T_KEYWORD_S32:     tp->lazy(new runtime::SignedMutator<int32_t>(static_cast<int32_t>(value))); break;
+    case T_KEYWORD_S64:     tp->lazy(new runtime::SignedMutator<int64_t>(static_cast<int64_t>(value))); break;
+    default:                break;
+    }
+}
+
+static void AddSInteger(Symbol_t sym, int64_t value, std::shared_ptr<runtime::Template> tp)
+{
+    switch(sym) {
+    case T_KEYWORD_S8:      tp->u8(static_cast<uint8_t>(value)); break;
+    case T_KEYWORD_S16:     tp->u16(static_cast<uint16_t>(value)); break;
+    case T_KEYWORD_S32:     tp->u32(static_cast<uint32_t>(value)); break;
+    case T_KEYWORD_S64:     tp->u64(static_cast<uint64_t>(value)); break;
+    default:                break;
+    }
+}
+
+static void AddFloat(Symbol_t sym, double value, bool fuzzed, std::shared_ptr<runtime::Template> tp)
+{
+    if (sym == T_TYPE_FLOAT) {
+        if (fuzzed) {
+            tp->lazy(new runtime::FloatMutator<float>(static_cast<float>(value)));
+        } else {
+            tp->f32(static_cast<float>(value));
+        }
+    } else {
+        if (fuzzed) {
+            tp->lazy(new runtime::FloatMutator<double>(value));
+        } else {
+            tp->f64(value);
+        }
+    }
+}
+
 void Generator::ParseExpression(parser::Tokenizer & tokenizer,
     std::shared_ptr<runtime::Template> tp,
     bool fuzzed)
@@ -331,7 +541,7 @@ void Generator::ParseExpression(parser::Tokenizer & tokenizer,
     case T_KEYWORD_QWORD:
         {
             tokenizer.GetSym();
-            int value = 0;
+            uint64_t value = 0;
             if (tokenizer.Peek() == T_LEFT_PAREN) {
                 /// [ word(...) , ... 
                 Expect(T_LEFT_PAREN, tokenizer);
@@ -342,25 +552,117 @@ void Generator::ParseExpression(parser::Tokenizer & tokenizer,
             return fuzzed ? AddFuzzedUInteger(type_sym, value, tp) : AddUInteger(type_sym, value, tp);
         }
         break;
-    case T_KEYWORD_CSTRING:
-    case T_KEYWORD_LINE:
+    case T_KEYWORD_S8:
+    case T_KEYWORD_S16:
+    case T_KEYWORD_S32:
+    case T_KEYWORD_S64:
         {
-            /// Null terminated string
             tokenizer.GetSym();
-            const char * str = 0;
+            int64_t value = 0;
             if (tokenizer.Peek() == T_LEFT_PAREN) {
+                /// [ s16(-1) , ...
                 Expect(T_LEFT_PAREN, tokenizer);
-                Expect(T_STRING, tokenizer);
-                str = tokenizer.SymbolTable().Retrive(tokenizer.SymIndex());
+                value = ParseSignedConstant(type_sym, tokenizer);
                 Expect(T_RIGHT_PAREN, tokenizer);
             }
+            return fuzzed ? AddFuzzedSInteger(type_sym, value, tp) : AddSInteger(type_sym, value, tp);
+        }
+        break;
+    case T_TYPE_FLOAT:
+    case T_TYPE_DOUBLE:
+        {
+            tokenizer.GetSym();
+            double value = 0;
+            if (tokenizer.Peek() == T_LEFT_PAREN) {
+                /// [ float(-1.5) , ...
+                Expect(T_LEFT_PAREN, tokenizer);
+                bool negative = false;
+                if (tokenizer.Peek() == T_SUB) {
+                    Expect(T_SUB, tokenizer);
+                    negative = true;
+                }
+                Symbol_t sym = tokenizer.GetSym();
+                if (sym == T_REAL) {
+                    value = tokenizer.RealValue();
+                } else if (sym == T_INTEGER) {
+                    value = tokenizer.IntValue();
+                } else {
+                    throw std::runtime_error("Expected a floating point value.");
+                }
+                if (negative) {
+                    value = -value;
+                }
+                Expect(T_RIGHT_PAREN, tokenizer);
+            }
+            return AddFloat(type_sym, value, fuzzed, tp);
+        }
+        break;
+    case T_KEYWORD_CSTRING:
+    case T_KEYWORD_LINE:
+    case T_KEYWORD_UTF8:
+        {
+            /// Null terminated string
+            tokenizer.GetSym();
+            const char * str = ParseInitialString(tokenizer);
             if (type_sym == T_KEYWORD_CSTRING) {
                 tp->lazy(new runtime::AsciiStringMutator(runtime::AsciiStringMutator::CSTRING, str));
-            } else {
+            } else if (type_sym == T_KEYWORD_LINE) {
                 tp->lazy(new runtime::AsciiStringMutator(runtime::AsciiStringMutator::LINE, str));
+            } else {
+                tp->lazy(new runtime::Utf8StringMutator(runtime::Utf8StringMutator::CSTRING, str));
             }
         }
+        break;
     case T_KEYWORD_PASCAL_STRING:
+        {
+            /// pascalstring<word>("..."), the length prefix defaults to a byte
+            tokenizer.GetSym();
+            runtime::AsciiStringMutator::Representation representation = runtime::AsciiStringMutator::PASCAL8;
+            if (tokenizer.Peek() == T_LESS) {
+                Expect(T_LESS, tokenizer);
+                switch(tokenizer.GetSym()) {
+                case T_KEYWORD_BYTE:    representation = runtime::AsciiStringMutator::PASCAL8; break;
+                case T_KEYWORD_WORD:    representation = runtime::AsciiStringMutator::PASCAL16; break;
+                case T_KEYWORD_DWORD:   representation = runtime::AsciiStringMutator::PASCAL32; break;
+                case T_KEYWORD_QWORD:   representation = runtime::AsciiStringMutator::PASCAL64; break;
+                default:
+                    throw std::runtime_error("Expected a type.");
+                }
+                Expect(T_GRT, tokenizer);
+            }
+            const char * str = ParseInitialString(tokenizer);
+            tp->lazy(new runtime::AsciiStringMutator(representation, str));
+        }
+        break;
+    case T_KEYWORD_URI:
+        {
+            /// uri("http://host/path?query"), written without framing
+            tokenizer.GetSym();
+            const char * str = ParseInitialString(tokenizer);
+            tp->lazy(new runtime::UriMutator(runtime::UriMutator::RAW, str));
+        }
+        break;
+    case T_KEYWORD_PLUGIN:
+        {
+            /// plugin("name", "seed"), a mutator registered by a plugin
+            tokenizer.GetSym();
+            Expect(T_LEFT_PAREN, tokenizer);
+            Expect(T_STRING, tokenizer);
+            const std::string name = tokenizer.SymbolTable().Retrive(tokenizer.SymIndex());
+            std::shared_ptr<std::string> seed = std::make_shared<std::string>();
+            if (tokenizer.Peek() == T_COMMA) {
+                Expect(T_COMMA, tokenizer);
+                Expect(T_STRING, tokenizer);
+                *seed = tokenizer.SymbolTable().Retrive(tokenizer.SymIndex());
+            }
+            Expect(T_RIGHT_PAREN, tokenizer);
+            const fuzzengine_mutator * mutator = runtime::PluginRegistry::instance().find(name, FUZZENGINE_PLUGIN_FIELD);
+            if (!mutator) {
+                throw std::runtime_error("Unknown plugin mutator.");
+            }
+            tp->lazy(new runtime::PluginMutator(*mutator,
+                reinterpret_cast<const uint8_t *>(seed->data()), seed->size(), seed));
+        }
         break;
     case T_KEYWORD_ARRAY:
         {
@@ -374,8 +676,8 @@ void Generator::ParseExpression(parser::Tokenizer & tokenizer,
             Expect(T_GRT, tokenizer);
             Expect(T_LEFT_PAREN, tokenizer);
             Expect(T_INTEGER, tokenizer);
-            int lower = tokenizer.IntValue();
-            int upper = lower;
+            uint64_t lower = tokenizer.IntValue();
+            uint64_t upper = lower;
             if (tokenizer.Peek() == T_SUB) {
                 if (!fuzzed) {
                     throw std::runtime_error("Variable length arrays are only allowed for fuzzed arrays.");
@@ -385,13 +687,37 @@ void Generator::ParseExpression(parser::Tokenizer & tokenizer,
                 upper = tokenizer.IntValue();
             }
             Expect(T_RIGHT_PAREN, tokenizer);
-            if (fuzzed) {
-                
-            } else {
-                
+            if (upper < lower || upper > std::numeric_limits<size_t>::max()) {
+                throw std::runtime_error("Invalid array bounds.");
+            }
+            switch(type) {
+            case T_KEYWORD_BYTE:    AddArray<uint8_t>(lower, upper, fuzzed, tp); break;
+            case T_KEYWORD_WORD:    AddArray<uint16_t>(lower, upper, fuzzed, tp); break;
+            case T_KEYWORD_DWORD:   AddArray<uint32_t>(lower, upper, fuzzed, tp); break;
+            case T_KEYWORD_QWORD:   AddArray<uint64_t>(lower, upper, fuzzed, tp); break;
+            default:                break;
             }
             break;
         }
+    case T_IDENT:
+        {
+            /// response.field, captured by the last read("response")
+            tokenizer.GetSym();
+            const std::string name = tokenizer.SymbolTable().Retrive(tokenizer.SymIndex());
+            Expect(T_DOT, tokenizer);
+            Expect(T_IDENT, tokenizer);
+            const std::string field = tokenizer.SymbolTable().Retrive(tokenizer.SymIndex());
+            if (!_script || _script->_responses.find(name) == _script->_responses.end()) {
+                throw std::runtime_error("Unknown response.");
+            }
+            const Response & response = _script->_responses[name];
+            std::map<std::string, size_t>::const_iterator it = response.fields.find(field);
+            if (it == response.fields.end()) {
+                throw std::runtime_error("Unknown response field.");
+            }
+            tp->lazy(new runtime::LazyCapture(response.input, it->second));
+        }
+        break;
     default:
         throw std::runtime_error("Unexpected token.");
     }
@@ -21,6 +21,7 @@ public:
     std::shared_ptr<bytecode::Script> ParseScript(parser::Tokenizer &);
     std::shared_ptr<bytecode::Method> ParseMethod(parser::Tokenizer &, std::shared_ptr<Script>);
     std::shared_ptr<runtime::Template> ParseTemplate(parser::Tokenizer &);
+    Response ParseResponse(parser::Tokenizer &);
 protected:
     void ParseStatement(parser::Tokenizer &, std::shared_ptr<Method>, std::shared_ptr<Script>);
     void ParseExpression(parser::Tokenizer & tokenizer, std::shared_ptr<Method>, std::shared_ptr<Script>);
@@ -29,6 +30,9 @@ protected:
     void Expect(parser::Symbol_t, parser::Tokenizer &);
     void ParseExpression(parser::Tokenizer & tokenizer, std::shared_ptr<runtime::Template>, bool);
     void ParseTemplateExpressions(std::shared_ptr<runtime::Template>, parser::Tokenizer & tokenizer, bool fuzzed);
+    const char * ParseInitialString(parser::Tokenizer & tokenizer);
+
+    std::shared_ptr<Script> _script;    //< being parsed, templates refer to its responses
 };
 
 } // namespace bytecode
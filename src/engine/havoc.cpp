@@ -0,0 +1,210 @@
+#include "havoc.h"
+#include <sstream>
+#include <stdexcept>
+
+namespace fuzzer {
+
+namespace runtime {
+
+static uint64_t SplitMix(uint64_t & x)
+{
+    uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static inline uint64_t Rotl(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+Xoshiro256::Xoshiro256(uint64_t seed)
+{
+    for(size_t i = 0; i < 4; ++i) {
+        _s[i] = SplitMix(seed);
+    }
+}
+
+uint64_t Xoshiro256::next()
+{
+    const uint64_t result = Rotl(_s[1] * 5, 7) * 9;
+    const uint64_t t = _s[1] << 17;
+    _s[2] ^= _s[0];
+    _s[3] ^= _s[1];
+    _s[1] ^= _s[2];
+    _s[0] ^= _s[3];
+    _s[2] ^= t;
+    _s[3] = Rotl(_s[3], 45);
+    return result;
+}
+
+uint64_t Xoshiro256::below(uint64_t bound)
+{
+    /// reject the values that would bias the modulo
+    const uint64_t threshold = (0 - bound) % bound;
+    for(;;) {
+        const uint64_t value = next();
+        if (value >= threshold) {
+            return value % bound;
+        }
+    }
+}
+
+HavocScheduler::HavocScheduler(const bytecode::Script & script, uint64_t seed, size_t worker, size_t stack) :
+    _target(0),
+    _parent(0),
+    _derived(false),
+    _seed(seed),
+    _worker(worker),
+    _stack(stack ? stack : 1),
+    _index(0),
+    _current(0)
+{
+    if (worker >= (static_cast<uint64_t>(1) << (64 - WorkerShift))) {
+        throw std::runtime_error("Invalid worker index.");
+    }
+    /// the map is ordered by name, so every worker sees the same order
+    for(auto it = script._templates.begin(); it != script._templates.end(); ++it) {
+        Target target;
+        target.name     = it->first;
+        target.mutators = it->second->GetMutators();
+        if (!target.mutators.empty()) {
+            _targets.push_back(target);
+        }
+    }
+}
+
+uint64_t HavocScheduler::CaseId(size_t worker, uint64_t index)
+{
+    return (static_cast<uint64_t>(worker) << WorkerShift) | (index & ((static_cast<uint64_t>(1) << WorkerShift) - 1));
+}
+
+uint64_t HavocScheduler::CaseSeed(uint64_t seed, uint64_t id)
+{
+    uint64_t x = seed;
+    x = SplitMix(x) ^ id;
+    return SplitMix(x);
+}
+
+uint64_t HavocScheduler::next()
+{
+    const uint64_t id = CaseId(_worker, _index++);
+    if (_promoted.empty()) {
+        apply(id);
+        return id;
+    }
+
+    Xoshiro256 random(CaseSeed(_seed, id) ^ 0x5bd1e995);
+    if (!random.below(2)) {
+        apply(id);
+        return id;
+    }
+    /// build on a promoted case, with its template and mutations
+    const Promoted & parent = _promoted[static_cast<size_t>(random.below(_promoted.size()))];
+    park();
+    _current    = id;
+    _target     = parent.target;
+    _parent     = parent.id;
+    _derived    = true;
+    _mutations  = parent.mutations;
+    const Target & target = _targets[_target];
+    _name = target.name;
+    for(size_t i = 0; i < _mutations.size(); ++i) {
+        apply(target, _mutations[i]);
+    }
+    const size_t stack = 1 + static_cast<size_t>(random.below(_stack));
+    for(size_t i = 0; i < stack; ++i) {
+        Mutation mutation;
+        mutation.mutator = static_cast<size_t>(random.below(target.mutators.size()));
+        const size_t count = target.mutators[mutation.mutator]->count();
+        mutation.position = static_cast<size_t>(random.below(count ? count : 64));
+        apply(target, mutation);
+        _mutations.push_back(mutation);
+    }
+    return id;
+}
+
+void HavocScheduler::park()
+{
+    for(size_t i = 0; i < _targets.size(); ++i) {
+        const std::vector<Mutator *> & mutators = _targets[i].mutators;
+        for(size_t j = 0; j < mutators.size(); ++j) {
+            if (mutators[j]->count()) {
+                mutators[j]->seek(mutators[j]->count());
+            } else {
+                /// can't seek, the start writes the initial value
+                mutators[j]->reset();
+            }
+        }
+    }
+}
+
+void HavocScheduler::promote()
+{
+    if (_name.empty()) {
+        return;
+    }
+    Promoted promoted;
+    promoted.id         = _current;
+    promoted.target     = _target;
+    promoted.mutations  = _mutations;
+    _promoted.push_back(promoted);
+}
+
+void HavocScheduler::apply(const Target & target, const Mutation & mutation)
+{
+    Mutator * mutator = target.mutators[mutation.mutator];
+    if (mutator->count()) {
+        mutator->seek(mutation.position);
+    } else {
+        /// can't seek, step from the start instead
+        mutator->reset();
+        for(size_t step = 0; step < mutation.position && mutator->mutate(); ++step);
+    }
+}
+
+bool HavocScheduler::apply(uint64_t id)
+{
+    _current = id;
+    _derived = false;
+    _mutations.clear();
+    _name.clear();
+    if (_targets.empty()) {
+        return false;
+    }
+    park();
+
+    Xoshiro256 random(CaseSeed(_seed, id));
+    _target = static_cast<size_t>(random.below(_targets.size()));
+    const Target & target = _targets[_target];
+    _name = target.name;
+    const size_t stack = 1 + static_cast<size_t>(random.below(_stack));
+    for(size_t i = 0; i < stack; ++i) {
+        Mutation mutation;
+        mutation.mutator = static_cast<size_t>(random.below(target.mutators.size()));
+        const size_t count = target.mutators[mutation.mutator]->count();
+        mutation.position = static_cast<size_t>(random.below(count ? count : 64));
+        apply(target, mutation);
+        _mutations.push_back(mutation);
+    }
+    return true;
+}
+
+std::string HavocScheduler::describe() const
+{
+    std::stringstream ss;
+    ss << "havoc: seed=0x" << std::hex << _seed << ", case=0x" << _current;
+    if (_derived) {
+        ss << ", parent=0x" << _parent;
+    }
+    ss << std::dec << ", template=\"" << _name << "\", mutations=";
+    for(size_t i = 0; i < _mutations.size(); ++i) {
+        ss << (i ? "," : "") << _mutations[i].mutator << ":" << _mutations[i].position;
+    }
+    return ss.str();
+}
+
+} // namespace runtime
+
+} // namespace fuzzer
@@ -0,0 +1,156 @@
+#ifndef _HAVOC_H_
+#define _HAVOC_H_
+
+#include "script.h"
+#include "mutator.h"
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace fuzzer {
+
+namespace runtime {
+
+///
+/// \class  Xoshiro256
+/// \brief  xoshiro256** generator. Small and fast, each worker owns its own
+///         so nothing is shared or locked.
+///
+class Xoshiro256
+{
+public:
+    /// the state is expanded from \p seed with splitmix64
+    explicit Xoshiro256(uint64_t seed);
+
+    uint64_t next();
+
+    /// uniform value in [0, bound), \p bound must not be zero
+    uint64_t below(uint64_t bound);
+
+private:
+    uint64_t    _s[4];
+};
+
+///
+/// \class  HavocScheduler
+/// \brief  Random scheduling over the templates of a script. A test case
+///         picks a template and stacks up to a number of mutations, each
+///         moving one of its mutators to a random position.
+///
+///         Every case has a 64 bit id, the worker in the upper bits and a
+///         counter below. The generator of a case is seeded with a hash of
+///         the master seed and the id, so any case can be regenerated from
+///         the master seed and its id, on any worker and in any order.
+///
+///         Cases found interesting by feedback can be promoted. Half of the
+///         following cases then stack their mutations on a promoted case,
+///         these depend on the promoted cases and are reproduced from the
+///         mutations in their description instead.
+///
+class HavocScheduler
+{
+public:
+    /// bits of a case id that count the cases of a worker
+    static const unsigned WorkerShift = 40;
+
+    ///
+    /// \brief  Constructor
+    ///
+    /// \param [in] script  Templates and mutators to schedule.
+    /// \param [in] seed    Master seed of the run.
+    /// \param [in] worker  Index of this worker.
+    /// \param [in] stack   Largest number of stacked mutations per case.
+    ///
+    HavocScheduler(const bytecode::Script & script, uint64_t seed, size_t worker = 0, size_t stack = 4);
+
+    /// id of case \p index of \p worker
+    static uint64_t CaseId(size_t worker, uint64_t index);
+
+    /// seed of the generator of case \p id
+    static uint64_t CaseSeed(uint64_t seed, uint64_t id);
+
+    ///
+    /// \brief  Applies the next case of this worker.
+    ///
+    /// \return The id of the case.
+    ///
+    uint64_t next();
+
+    ///
+    /// \brief  Applies case \p id. All mutators are finished first so that
+    ///         they write their initial value, then the picked ones are
+    ///         moved to their mutations. Returns false if the script has no
+    ///         mutators.
+    ///
+    bool apply(uint64_t id);
+
+    ///
+    /// \brief  Finishes all mutators, so that the templates are generated
+    ///         from their initial values. Mutators that can't seek are reset.
+    ///
+    void park();
+
+    ///
+    /// \brief  Promotes the last case, later cases may build on it.
+    ///
+    void promote();
+
+    /// number of promoted cases
+    size_t promoted() const { return _promoted.size(); }
+
+    ///
+    /// \brief  Describes the last case as master seed, case id, template
+    ///         and the mutations as mutator:position.
+    ///
+    std::string describe() const;
+
+    uint64_t seed() const { return _seed; }
+    /// id of the last applied case
+    uint64_t current() const { return _current; }
+    /// name of the template picked by the last case
+    const std::string & name() const { return _name; }
+
+private:
+    ///
+    /// \brief  A template with mutators.
+    ///
+    struct Target {
+        std::string                 name;
+        std::vector<Mutator *>      mutators;
+    };
+
+    /// a mutation of the last case
+    struct Mutation {
+        size_t  mutator;    //< index in the template
+        size_t  position;
+    };
+
+    /// a promoted case
+    struct Promoted {
+        uint64_t                id;
+        size_t                  target;
+        std::vector<Mutation>   mutations;
+    };
+
+    /// moves a mutator of \p target to the position of \p mutation
+    void apply(const Target & target, const Mutation & mutation);
+
+    std::vector<Target>     _targets;
+    std::vector<Mutation>   _mutations;
+    std::vector<Promoted>   _promoted;
+    size_t                  _target;    //< index of the template of the last case
+    uint64_t                _parent;    //< promoted case the last case built on
+    bool                    _derived;
+    uint64_t                _seed;      //< master seed
+    size_t                  _worker;
+    size_t                  _stack;
+    uint64_t                _index;     //< cases applied by this worker
+    uint64_t                _current;   //< id of the last case
+    std::string             _name;
+};
+
+} // namespace runtime
+
+} // namespace fuzzer
+
+#endif
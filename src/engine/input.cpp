@@ -1,19 +1,57 @@
 #include "input.h"
+#include "endian.h"
+#include <cstring>
+#include <stdexcept>
 #include <vector>
 
 namespace fuzzer {
 
 namespace io {
 
+///
+/// \brief  Step of a compiled input program. A FETCH makes the next run of
+///         fixed size fields available, the fields are then decoded without
+///         further checks.
+///
+struct InputStep {
+    enum Op {
+        FETCH,
+        U8,
+        U16,
+        U24,
+        U32,
+        U64,
+        VARRAY
+    } op;
+    size_t  item;
+    size_t  size;       //< FETCH: bytes in the run
+};
+
 ///
 /// \brief  Hidden implementation class
 /// 
 class Input::Implementation
 {
 public:
-    ~Implementation();
-    bool getUnsigned(size_t index, uint32_t & value);
+    Implementation() : _compiled(false), _complete(false), _retain(false) {}
+
+    bool getUnsigned(size_t index, uint64_t & value) const;
+    void compile();
+
+    /// the first \p end bytes of the message, nullptr if the source fails
+    const uint8_t * fetch(Source &, BufferedSource *, size_t end);
+
+    template<ByteOrder Order>
+    bool run(Source &, BufferedSource *);
+
     std::vector<InputItem>  _items;
+    std::vector<InputStep>  _program;
+    std::vector<size_t>     _offsets;   //< offset of each array in the message
+    std::vector<uint8_t>    _arena;     //< the message, unless buffered
+    std::vector<uint8_t>    _retained;  //< the captured arrays, if retained
+    bool                    _compiled;
+    bool                    _complete;  //< the last read succeeded
+    bool                    _retain;
 };
 
 Input::Input()
@@ -26,91 +64,198 @@ Input::~Input()
     delete _impl;
 }
 
-Input::Implementation::~Implementation()
-{
-    for(size_t i = 0; i < _items.size(); ++i) {
-        InputItem & item = _items[i];
-        if (item.type == InputItem::VARRAY) {
-            if (item.u.varray.data) {
-                delete [] item.u.varray.data;
-            }
-        }
-    }
-}
-
-bool Input::Implementation::getUnsigned(size_t index, uint32_t & value)
+bool Input::Implementation::getUnsigned(size_t index, uint64_t & value) const
 {
     if (index >= _items.size()) {
         return false;
     }
-    InputItem & item = _items[index];
+    const InputItem & item = _items[index];
     switch(item.type) {
     case InputItem::BYTE:   value = item.u.byte; return true;
     case InputItem::WORD:   value = item.u.word; return true;
+    case InputItem::WORD24:
     case InputItem::DWORD:  value = item.u.dword; return true;
+    case InputItem::QWORD:  value = item.u.qword; return true;
     default:            return false;
     }
 }
 
-const InputItem * Input::get(size_t id) const
+void Input::Implementation::compile()
 {
-    if (id >= _impl->_items.size()) {
-        return false;
+    _program.clear();
+    _offsets.assign(_items.size(), 0);
+    size_t fetch = ~size_t(0);      //< FETCH of the current run
+    for(size_t i = 0; i < _items.size(); ++i) {
+        InputStep step;
+        step.item = i;
+        step.size = 0;
+        switch(_items[i].type) {
+        case InputItem::BYTE:   step.op = InputStep::U8;  step.size = 1; break;
+        case InputItem::WORD:   step.op = InputStep::U16; step.size = 2; break;
+        case InputItem::WORD24: step.op = InputStep::U24; step.size = 3; break;
+        case InputItem::DWORD:  step.op = InputStep::U32; step.size = 4; break;
+        case InputItem::QWORD:  step.op = InputStep::U64; step.size = 8; break;
+        case InputItem::VARRAY: step.op = InputStep::VARRAY; break;
+        default:
+            throw std::runtime_error("Unsupported input field.");
+        }
+        if (step.op == InputStep::VARRAY) {
+            /// the array fetches itself, the next field starts a new run
+            fetch = ~size_t(0);
+        } else {
+            if (fetch == ~size_t(0)) {
+                InputStep run;
+                run.op      = InputStep::FETCH;
+                run.item    = 0;
+                run.size    = 0;
+                fetch = _program.size();
+                _program.push_back(run);
+            }
+            _program[fetch].size += step.size;
+        }
+        _program.push_back(step);
     }
-    return &_impl->_items[id];
+    _compiled = true;
 }
 
-bool Input::read(Source & source)
+const uint8_t * Input::Implementation::fetch(Source & source, BufferedSource * buffered, size_t end)
 {
-#if 0
-    if(_impl == nullptr) {
-        return false;
+    if (buffered) {
+        return buffered->require(end) ? buffered->data() : nullptr;
+    }
+    const size_t size = _arena.size();
+    if (end > size) {
+        _arena.resize(end);
+        if (!source.read(&_arena[size], end - size)) {
+            return nullptr;
+        }
     }
+    return _arena.data();
+}
 
-    for(size_t i = 0, count = _impl->_items.size(); i < count; ++i) {
-        InputItem & item = _impl->_items[i];
-        switch(item.type) {
-        case InputItem::BYTE:   if (!source.readU8(item.u.byte)) { return false; } break;
-        case InputItem::WORD:   if (!source.u16(item.u.word)) { return false; } break;
-        case InputItem::DWORD:  if (!source.u32(item.u.dword)) { return false; } break;
-        case InputItem::QWORD:  if (!source.u64(item.u.qword)) { return false; } break;
-        case InputItem::VARRAY:
+template<ByteOrder Order>
+bool Input::Implementation::run(Source & source, BufferedSource * buffered)
+{
+    const uint8_t * base = nullptr;     //< start of the message
+    size_t pos = 0;                     //< offset of the next field
+    _arena.clear();
+    for(size_t i = 0, count = _program.size(); i < count; ++i) {
+        const InputStep & step = _program[i];
+        InputItem & item = _items[step.item];
+        switch(step.op) {
+        case InputStep::FETCH:
+            if (!(base = fetch(source, buffered, pos + step.size))) {
+                return false;
+            }
+            break;
+        case InputStep::U8:
+            item.u.byte = base[pos];
+            pos += 1;
+            break;
+        case InputStep::U16:
+            memcpy(&item.u.word, base + pos, 2);
+            item.u.word = Endian<Order>::convert16(item.u.word);
+            pos += 2;
+            break;
+        case InputStep::U24:
+            item.u.dword = Endian<Order>::load24(base + pos);
+            pos += 3;
+            break;
+        case InputStep::U32:
+            memcpy(&item.u.dword, base + pos, 4);
+            item.u.dword = Endian<Order>::convert32(item.u.dword);
+            pos += 4;
+            break;
+        case InputStep::U64:
+            memcpy(&item.u.qword, base + pos, 8);
+            item.u.qword = Endian<Order>::convert64(item.u.qword);
+            pos += 8;
+            break;
+        case InputStep::VARRAY:
             {
                 // variable length array where the length field was transfered earlier
-                if (item.u.varray.ref_id < i) {
-                    uint32_t count;
-                    if (!_impl->getUnsigned(item.u.varray.ref_id, count)) {
-                        return false;
-                    }
-                    if ((count > item.u.varray.max) || 
-                        (count > static_cast<uint32_t>(std::numeric_limits<int32_t>::max())))
-                    {
-                        return false;
-                    }
-                    if (count) {
-                        item.u.varray.data = new (std::nothrow) uint8_t[count];
-                        if (!source.read(item.u.varray.data, static_cast<int32_t>(count))) {
-                            delete [] item.u.varray.data;
-                            item.u.varray.data  = 0;
-                            item.u.varray.count = 0;
-                            return false;
-                        }
-                        item.u.varray.count = count;
-                    } else {
-                        item.u.varray.count = 0;
-                        item.u.varray.data  = nullptr;
-                    }
-                } else {
+                uint64_t length;
+                if (!getUnsigned(item.u.varray.ref_id, length) || length > item.u.varray.max) {
+                    return false;
+                }
+                const size_t size = static_cast<size_t>(length);
+                if (size && !(base = fetch(source, buffered, pos + size))) {
                     return false;
                 }
-                break;
+                item.u.varray.count = size;
+                _offsets[step.item] = pos;
+                pos += size;
             }
+            break;
         }
     }
-#endif
+
+    /// the message is complete, base no longer moves
+    size_t retained = 0;
+    for(size_t i = 0; i < _items.size(); ++i) {
+        InputItem & item = _items[i];
+        if (item.type == InputItem::VARRAY) {
+            item.u.varray.data = (item._capture && item.u.varray.count) ? base + _offsets[i] : nullptr;
+            retained += item.u.varray.data ? item.u.varray.count : 0;
+        }
+    }
+    if (_retain && retained) {
+        _retained.resize(retained);
+        uint8_t * dst = _retained.data();
+        for(size_t i = 0; i < _items.size(); ++i) {
+            InputItem & item = _items[i];
+            if (item.type == InputItem::VARRAY && item.u.varray.data) {
+                memcpy(dst, item.u.varray.data, item.u.varray.count);
+                item.u.varray.data = dst;
+                dst += item.u.varray.count;
+            }
+        }
+    }
+    if (buffered) {
+        buffered->consume(pos);
+    }
     return true;
 }
 
+const InputItem * Input::get(size_t id) const
+{
+    if (id >= _impl->_items.size()) {
+        return nullptr;
+    }
+    return &_impl->_items[id];
+}
+
+bool Input::read(Source & source)
+{
+    if(_impl == nullptr) {
+        return false;
+    }
+    if (!_impl->_compiled) {
+        _impl->compile();
+    }
+    BufferedSource * buffered = dynamic_cast<BufferedSource *>(&source);
+    _impl->_complete = false;
+    _impl->_complete = source.is_big_endian() ?
+        _impl->run<ORDER_BIG_ENDIAN>(source, buffered) :
+        _impl->run<ORDER_LITTLE_ENDIAN>(source, buffered);
+    return _impl->_complete;
+}
+
+bool Input::complete() const
+{
+    return _impl->_complete;
+}
+
+void Input::retain(bool retain)
+{
+    _impl->_retain = retain;
+}
+
+bool Input::retains() const
+{
+    return _impl->_retain;
+}
+
 size_t Input::u8(bool capture)
 {
     size_t id = _impl->_items.size();
@@ -118,6 +263,7 @@ size_t Input::u8(bool capture)
     item.type       = InputItem::BYTE;
     item._capture   = capture;
     _impl->_items.push_back(item);
+    _impl->_compiled = false;
 
     return id;
 }
@@ -129,6 +275,7 @@ size_t Input::u16(bool capture)
     item.type       = InputItem::WORD;
     item._capture   = capture;
     _impl->_items.push_back(item);
+    _impl->_compiled = false;
 
     return id;
 }
@@ -140,6 +287,7 @@ size_t Input::u24(bool capture)
     item.type       = InputItem::WORD24;
     item._capture   = capture;
     _impl->_items.push_back(item);
+    _impl->_compiled = false;
 
     return id;
 }
@@ -151,6 +299,7 @@ size_t Input::u32(bool capture)
     item.type       = InputItem::DWORD;
     item._capture   = capture;
     _impl->_items.push_back(item);
+    _impl->_compiled = false;
 
     return id;
 }
@@ -162,6 +311,7 @@ size_t Input::u64(bool capture)
     item.type       = InputItem::QWORD;
     item._capture   = capture;
     _impl->_items.push_back(item);
+    _impl->_compiled = false;
 
     return id;
 }
@@ -169,13 +319,18 @@ size_t Input::u64(bool capture)
 size_t Input::varray(size_t ref_id, size_t max, bool capture)
 {
     size_t id = _impl->_items.size();
+    if (ref_id >= id || _impl->_items[ref_id].type == InputItem::VARRAY) {
+        throw std::runtime_error("The length of an array must be a previous integer field.");
+    }
     InputItem item;
     item.type               = InputItem::VARRAY;
     item.u.varray.max       = max;
     item.u.varray.ref_id    = ref_id;
-    item.u.varray.data      = 0;
+    item.u.varray.count     = 0;
+    item.u.varray.data      = nullptr;
     item._capture           = capture;
     _impl->_items.push_back(item);
+    _impl->_compiled = false;
 
     return id;
 }
@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include "source.h"
+#include "bufferedsource.h"
 
 namespace fuzzer {
 
@@ -29,10 +30,10 @@ struct InputItem {
         float               spf;
         double              dpf;
         struct {
-            size_t  ref_id;
-            size_t  count;
-            size_t  max;
-            void *  data;
+            size_t          ref_id;
+            size_t          count;
+            size_t          max;
+            const uint8_t * data;   //< nullptr unless captured
         } varray;
     } u;
 
@@ -45,6 +46,13 @@ struct InputItem {
 ////        The interface schedules the reading of various fields from
 ////        which can be captured for later use.
 ///
+///         The fields are compiled into a program that fetches each run of
+///         fixed size fields at once. Read from a BufferedSource, captured
+///         arrays point into its receive buffer and are valid until the
+///         next read from the source. Other sources are read into an arena
+///         owned by the input, valid until the next read(). Retained
+///         arrays are copied out of either, see retain().
+///
 class Input
 {
 public:
@@ -57,15 +65,34 @@ public:
     size_t u32(bool capture = true);
     size_t u64(bool capture = true);
 
-    /// variable length array, id is from a previous captured value
+    ///
+    /// \brief  Variable length array, \p id is a previous integer field
+    ///         holding the length. Throws a std::runtime_error if it isn't.
+    ///
     size_t varray(size_t id, size_t max, bool capture = true);
 
-    /// read the data from the source
+    ///
+    /// \brief  Reads the fields from the source, in its byte order.
+    ///
+    /// \return false if the source fails or an array is longer than its
+    ///         maximum.
+    ///
     virtual bool read(Source &);
 
+    ///
+    /// \brief  Copies the captured arrays into storage owned by the input
+    ///         once a message is complete, so that they stay valid until
+    ///         the next read() however the source is read in between.
+    ///
+    void retain(bool);
+    bool retains() const;
+
     /// interface for accessing captured values
     const InputItem * get(size_t id) const;
 
+    /// true if the last read() succeeded
+    bool complete() const;
+
 protected:
     class Implementation;
     Implementation * _impl;
@@ -0,0 +1,154 @@
+#include "inputtostate.h"
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+namespace fuzzer {
+
+namespace runtime {
+
+bool InputToStateMutator::Replacement::operator<(const Replacement & other) const
+{
+    if (offset != other.offset) {
+        return offset < other.offset;
+    }
+    if (size != other.size) {
+        return size < other.size;
+    }
+    return memcmp(bytes, other.bytes, size) < 0;
+}
+
+bool InputToStateMutator::Replacement::operator==(const Replacement & other) const
+{
+    return offset == other.offset && size == other.size && !memcmp(bytes, other.bytes, size);
+}
+
+InputToStateMutator::InputToStateMutator(const uint8_t * data, size_t size, std::shared_ptr<const void> owner) :
+    _owner(owner),
+    _data(data),
+    _size(size),
+    _index(0)
+{
+}
+
+void InputToStateMutator::add(const execution::ComparisonLog & log)
+{
+    for(size_t i = 0, count = log.size(); i < count; ++i) {
+        const fuzzengine_cmp & cmp = log[i];
+        collect(cmp.arg1, cmp.arg2, cmp.size);
+    }
+    normalize();
+}
+
+void InputToStateMutator::add(uint64_t arg1, uint64_t arg2, size_t size)
+{
+    collect(arg1, arg2, size);
+    normalize();
+}
+
+void InputToStateMutator::collect(uint64_t arg1, uint64_t arg2, size_t size)
+{
+    if (arg1 == arg2 || !size || size > sizeof(uint64_t)) {
+        return;
+    }
+    uint8_t little1[8], little2[8], big1[8], big2[8];
+    for(size_t i = 0; i < size; ++i) {
+        little1[i]          = static_cast<uint8_t>(arg1 >> (8 * i));
+        little2[i]          = static_cast<uint8_t>(arg2 >> (8 * i));
+        big1[size - 1 - i]  = little1[i];
+        big2[size - 1 - i]  = little2[i];
+    }
+    /// either operand may come from the payload
+    replace(little1, little2, size);
+    replace(little2, little1, size);
+    if (size > 1) {
+        replace(big1, big2, size);
+        replace(big2, big1, size);
+    }
+}
+
+void InputToStateMutator::normalize()
+{
+    /// the same operands are usually compared many times
+    std::sort(_replacements.begin(), _replacements.end());
+    _replacements.erase(std::unique(_replacements.begin(), _replacements.end()), _replacements.end());
+}
+
+void InputToStateMutator::replace(const uint8_t * from, const uint8_t * to, size_t size)
+{
+    if (_size < size) {
+        return;
+    }
+    const uint8_t * end = _data + _size - size + 1;
+    size_t matches = 0;
+    for(const uint8_t * pos = _data; pos < end && matches < MaxMatches; ++pos) {
+        pos = static_cast<const uint8_t *>(memchr(pos, from[0], end - pos));
+        if (!pos) {
+            break;
+        }
+        if (!memcmp(pos, from, size)) {
+            Replacement replacement;
+            replacement.offset  = pos - _data;
+            replacement.size    = static_cast<uint8_t>(size);
+            memcpy(replacement.bytes, to, size);
+            _replacements.push_back(replacement);
+            ++matches;
+        }
+    }
+}
+
+bool InputToStateMutator::mutate()
+{
+    if (finished()) {
+        return false;
+    }
+    ++_index;
+    return !finished();
+}
+
+bool InputToStateMutator::finished()
+{
+    return _index >= _replacements.size();
+}
+
+void InputToStateMutator::reset()
+{
+    _index = 0;
+}
+
+void InputToStateMutator::evaluate(Buffer & buffer)
+{
+    if (finished()) {
+        buffer.write(_data, _size);
+        return;
+    }
+    const Replacement & replacement = _replacements[_index];
+    const size_t after = replacement.offset + replacement.size;
+    if (replacement.offset) {
+        buffer.write(_data, replacement.offset);
+    }
+    buffer.write(replacement.bytes, replacement.size);
+    if (after < _size) {
+        buffer.write(_data + after, _size - after);
+    }
+}
+
+bool InputToStateMutator::state(std::string & state)
+{
+    if (finished()) {
+        return false;
+    }
+    const Replacement & replacement = _replacements[_index];
+    std::stringstream ss;
+    ss << "cmplog: offset=" << replacement.offset << ", bytes=";
+    for(size_t i = 0; i < replacement.size; ++i) {
+        static const char hex[] = "0123456789abcdef";
+        ss << hex[replacement.bytes[i] >> 4] << hex[replacement.bytes[i] & 15];
+    }
+    state = ss.str();
+    return true;
+}
+
+} // namespace runtime
+
+} // namespace fuzzer
@@ -0,0 +1,97 @@
+#ifndef _INPUTTOSTATE_H_
+#define _INPUTTOSTATE_H_
+
+#include "mutator.h"
+#include "cmplog.h"
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace fuzzer {
+
+namespace runtime {
+
+///
+/// \class  InputToStateMutator
+/// \brief  Solves comparisons against magic values and checksums. For each
+///         logged comparison, the operands are searched for in the payload
+///         in both byte orders, and every match is replaced with the other
+///         operand in the same byte order. Each replacement is a mutation.
+///
+class InputToStateMutator : public Mutator
+{
+public:
+    /// largest number of matches replaced per operand and byte order
+    static const size_t MaxMatches = 16;
+
+    ///
+    /// \brief  Constructor
+    ///
+    /// \param [in] data    The payload, it isn't copied.
+    /// \param [in] owner   Keeps the payload alive, may be empty.
+    ///
+    InputToStateMutator(const uint8_t * data, size_t size,
+        std::shared_ptr<const void> owner = std::shared_ptr<const void>());
+
+    ///
+    /// \brief  Adds the replacements for the comparisons of a run with the
+    ///         payload.
+    ///
+    void add(const execution::ComparisonLog &);
+
+    ///
+    /// \brief  Adds the replacements for a comparison of \p size bytes.
+    ///
+    void add(uint64_t arg1, uint64_t arg2, size_t size);
+
+    virtual bool mutate();
+    virtual bool finished();
+    virtual void reset();
+
+    ///
+    /// \brief  Writes the payload with the current replacement.
+    ///
+    virtual void evaluate(Buffer &);
+
+    ///
+    /// \brief  Describes the current replacement.
+    ///
+    bool state(std::string &);
+
+    /// number of mutations
+    size_t count() const { return _replacements.size(); }
+    /// index of the current mutation
+    size_t position() const { return _index; }
+    /// jump to a mutation, seeking past the end finishes the mutator
+    void seek(size_t index) { _index = index; }
+
+protected:
+    struct Replacement {
+        size_t      offset;
+        uint8_t     size;
+        uint8_t     bytes[8];
+
+        bool operator<(const Replacement &) const;
+        bool operator==(const Replacement &) const;
+    };
+
+    /// adds the replacements of a comparison
+    void collect(uint64_t arg1, uint64_t arg2, size_t size);
+    /// replaces the matches of \p from with \p to
+    void replace(const uint8_t * from, const uint8_t * to, size_t size);
+    /// sorts the replacements and removes duplicates
+    void normalize();
+
+    std::shared_ptr<const void>     _owner;
+    const uint8_t *                 _data;
+    size_t                          _size;
+    std::vector<Replacement>        _replacements;  //< sorted and unique
+    size_t                          _index;
+};
+
+} // namespace runtime
+
+} // namespace fuzzer
+
+#endif
@@ -3,45 +3,127 @@
 
 #include "mutator.h"
 #include "buffer.h"
+#include "dictionary.h"
+#include <limits>
+#include <vector>
+#include <type_traits>
+#include <cstring>
 
 namespace fuzzer {
 
 namespace runtime {
 
 ///
-/// \class  UnsignedMutator
-/// \brief  Mutator for unsigned integers
+/// \class  InterestingValues
+/// \brief  Table of values that tend to trigger bugs for an integer type:
+///         boundaries, powers of two +-1 for every bit and their negations.
+///         The table is indexed, its size is known at compile time.
+///
+template<class T>
+struct InterestingValues
+{
+    typedef typename std::make_unsigned<T>::type Unsigned;
+
+    static const size_t Bits            = sizeof(T) * 8;
+    static const size_t BoundaryCount   = 7;
+    static const size_t PowerCount      = (Bits - 1) * 6;
+    static const size_t Count           = BoundaryCount + PowerCount;
+
+    static T at(size_t index)
+    {
+        if (index < BoundaryCount) {
+            switch(index) {
+            case 0:     return 0;
+            case 1:     return 1;
+            case 2:     return static_cast<T>(~Unsigned(0));            //< -1 or max
+            case 3:     return std::numeric_limits<T>::min();
+            case 4:     return std::numeric_limits<T>::max();
+            case 5:     return std::numeric_limits<T>::min() + 1;
+            default:    return std::numeric_limits<T>::max() - 1;
+            }
+        }
+        index -= BoundaryCount;
+        /// 2^k - 1, 2^k, 2^k + 1 and the two's complement negation of each
+        const Unsigned power = Unsigned(1) << ((index / 6) + 1);
+        Unsigned value;
+        switch(index % 3) {
+        case 0:     value = power - 1; break;
+        case 1:     value = power; break;
+        default:    value = power + 1; break;
+        }
+        if ((index % 6) >= 3) {
+            value = Unsigned(0) - value;
+        }
+        return static_cast<T>(value);
+    }
+};
+
+///
+/// \class  IntegerMutator
+/// \brief  Mutator for signed and unsigned integers. Walks a finite list made
+///         of values derived from the initial value and the allowed range,
+///         followed by the InterestingValues table for the type.
 ///
 template<class T>
-class UnsignedMutator : public Mutator
+class IntegerMutator : public Mutator
 {
 public:
-    UnsignedMutator(
-        T InitialValue, 
-        T Low = std::numeric_limits<T>::min(), 
-        T Upper = std::numeric_limits<T>::max()) : 
-        _current(InitialValue), _initial(InitialValue), _lower(Low), _upper(Upper)
+    typedef typename std::make_unsigned<T>::type Unsigned;
+
+    IntegerMutator(
+        T InitialValue,
+        T Low = std::numeric_limits<T>::min(),
+        T Upper = std::numeric_limits<T>::max()) :
+        _initial(InitialValue), _lower(Low), _upper(Upper), _index(0)
     {
+        const Unsigned initial  = static_cast<Unsigned>(InitialValue);
+        const Unsigned lower    = static_cast<Unsigned>(Low);
+        const Unsigned upper    = static_cast<Unsigned>(Upper);
+        const Unsigned sign     = Unsigned(1) << (sizeof(T) * 8 - 1);
+
+        /// the initial value and small changes to it
+        add(InitialValue);
+        add(static_cast<T>(initial + 1));
+        add(static_cast<T>(initial - 1));
+        /// sign flips
+        add(static_cast<T>(Unsigned(0) - initial));
+        add(static_cast<T>(~initial));
+        add(static_cast<T>(initial ^ sign));
+        /// range boundaries, inside and just outside
+        add(Low);
+        add(Upper);
+        add(static_cast<T>(lower + 1));
+        add(static_cast<T>(upper - 1));
+        add(static_cast<T>(lower - 1));
+        add(static_cast<T>(upper + 1));
+        /// the generic table
+        for(size_t i = 0; i < InterestingValues<T>::Count; ++i) {
+            add(InterestingValues<T>::at(i));
+        }
     }
 
     virtual bool mutate()
     {
-        _current += 1;
-        return true;
+        if (finished()) {
+            return false;
+        }
+        ++_index;
+        return !finished();
     }
 
     virtual bool finished()
     {
-        return false;
+        return _index >= _values.size();
     }
 
     virtual void evaluate(Buffer & buf)
     {
+        const Unsigned value = static_cast<Unsigned>(current());
         switch(sizeof(T)) {
-        case 1: buf.writeU8(static_cast<uint8_t>(_current)); break;
-        case 2: buf.writeU16(static_cast<uint16_t>(_current)); break;
-        case 4: buf.writeU32(static_cast<uint32_t>(_current)); break;
-        case 8: buf.writeU64(static_cast<uint64_t>(_current)); break;
+        case 1: buf.writeU8(static_cast<uint8_t>(value)); break;
+        case 2: buf.writeU16(static_cast<uint16_t>(value)); break;
+        case 4: buf.writeU32(static_cast<uint32_t>(value)); break;
+        case 8: buf.writeU64(static_cast<uint64_t>(value)); break;
         default:
             throw std::runtime_error("Incorrect type.");
         }
@@ -49,19 +131,230 @@ public:
 
     virtual void reset()
     {
+        _index = 0;
     }
 
-    T current() const { return _current; }
+    /// number of mutations
+    size_t count() const { return _values.size(); }
+
+    /// index of the current mutation
+    size_t position() const { return _index; }
+
+    /// jump to a mutation, seeking past the end finishes the mutator
+    void seek(size_t index) { _index = index; }
+
+    ///
+    /// \brief  Adds the tokens that are as wide as the type, read in both
+    ///         byte orders.
+    ///
+    virtual void dictionary(const std::shared_ptr<const Dictionary> & dictionary)
+    {
+        if (!dictionary) {
+            return;
+        }
+        for(size_t i = 0; i < dictionary->size(); ++i) {
+            if (dictionary->length(i) == sizeof(T)) {
+                Unsigned little, big;
+                dictionary->value(i, little, big);
+                add(static_cast<T>(little));
+                add(static_cast<T>(big));
+            }
+        }
+    }
+
+    T current() const { return _index < _values.size() ? _values[_index] : _initial; }
+
+protected:
+    void add(T value)
+    {
+        for(size_t i = 0; i < _values.size(); ++i) {
+            if (_values[i] == value) {
+                return;
+            }
+        }
+        _values.push_back(value);
+    }
+
+    T                   _initial;
+    T                   _lower;
+    T                   _upper;
+    std::vector<T>      _values;    //< unique values in test order
+    size_t              _index;     //< current value
+};
+
+///
+/// \class  UnsignedMutator
+/// \brief  Mutator for unsigned integers
+///
+template<class T>
+class UnsignedMutator : public IntegerMutator<T>
+{
+    static_assert(std::is_unsigned<T>::value, "UnsignedMutator requires an unsigned type.");
+public:
+    UnsignedMutator(
+        T InitialValue,
+        T Low = std::numeric_limits<T>::min(),
+        T Upper = std::numeric_limits<T>::max()) :
+        IntegerMutator<T>(InitialValue, Low, Upper)
+    {
+    }
+};
+
+///
+/// \class  SignedMutator
+/// \brief  Mutator for signed integers
+///
+template<class T>
+class SignedMutator : public IntegerMutator<T>
+{
+    static_assert(std::is_signed<T>::value, "SignedMutator requires a signed type.");
+public:
+    SignedMutator(
+        T InitialValue,
+        T Low = std::numeric_limits<T>::min(),
+        T Upper = std::numeric_limits<T>::max()) :
+        IntegerMutator<T>(InitialValue, Low, Upper)
+    {
+    }
+};
+
+///
+/// \class  FloatMutator
+/// \brief  Mutator for IEEE 754 single and double precision values. Walks
+///         zeros, infinities, NaNs, denormals, precision and integer
+///         conversion limits, and values derived from the initial value.
+///
+template<class T>
+class FloatMutator : public Mutator
+{
+    static_assert(std::is_floating_point<T>::value, "FloatMutator requires a floating point type.");
+public:
+    typedef typename std::conditional<sizeof(T) == 4, uint32_t, uint64_t>::type Bits;
+
+    explicit FloatMutator(T InitialValue) : _initial(InitialValue), _index(0)
+    {
+        typedef std::numeric_limits<T> limits;
+
+        add(InitialValue);
+        add(-InitialValue);
+        add(InitialValue * 2);
+        add(InitialValue / 2);
+
+        add(T(0));
+        add(-T(0));
+        add(T(1));
+        add(T(-1));
+        add(T(0.5));
+        add(limits::epsilon());
+        add(T(1) + limits::epsilon());
+        add(limits::min());                 //< smallest normal
+        add(limits::denorm_min());          //< smallest denormal
+        add(-limits::denorm_min());
+        add(limits::max());
+        add(limits::lowest());
+        add(limits::infinity());
+        add(-limits::infinity());
+        add(limits::quiet_NaN());
+        add(-limits::quiet_NaN());
+        add(limits::signaling_NaN());
+        /// limits of the exactly representable integers
+        add(T(uint64_t(1) << limits::digits));
+        add(T(uint64_t(1) << limits::digits) + T(1));
+        /// values that overflow when converted to integers
+        add(T(2147483647.0));
+        add(T(2147483648.0));
+        add(T(-2147483649.0));
+        add(T(4294967296.0));
+        add(T(9223372036854775808.0));
+        add(T(18446744073709551616.0));
+    }
+
+    virtual bool mutate()
+    {
+        if (finished()) {
+            return false;
+        }
+        ++_index;
+        return !finished();
+    }
+
+    virtual bool finished()
+    {
+        return _index >= _values.size();
+    }
+
+    virtual void evaluate(Buffer & buf)
+    {
+        const Bits bits = _index < _values.size() ? _values[_index] : toBits(_initial);
+        if (sizeof(T) == 4) {
+            buf.writeU32(static_cast<uint32_t>(bits));
+        } else {
+            buf.writeU64(static_cast<uint64_t>(bits));
+        }
+    }
+
+    virtual void reset()
+    {
+        _index = 0;
+    }
+
+    size_t count() const { return _values.size(); }
+    size_t position() const { return _index; }
+    void seek(size_t index) { _index = index; }
+
+    ///
+    /// \brief  Adds the tokens that are as wide as the type, read in both
+    ///         byte orders.
+    ///
+    virtual void dictionary(const std::shared_ptr<const Dictionary> & dictionary)
+    {
+        if (!dictionary) {
+            return;
+        }
+        for(size_t i = 0; i < dictionary->size(); ++i) {
+            if (dictionary->length(i) == sizeof(T)) {
+                Bits little, big;
+                dictionary->value(i, little, big);
+                add(little);
+                add(big);
+            }
+        }
+    }
+
+    /// bit pattern of the current value
+    Bits current() const { return _index < _values.size() ? _values[_index] : toBits(_initial); }
+
+protected:
+    static Bits toBits(T value)
+    {
+        Bits bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    void add(T value)
+    {
+        add(toBits(value));
+    }
+
+    /// values are compared by bit pattern, so -0.0 and NaNs are kept
+    void add(Bits bits)
+    {
+        for(size_t i = 0; i < _values.size(); ++i) {
+            if (_values[i] == bits) {
+                return;
+            }
+        }
+        _values.push_back(bits);
+    }
 
-private:
-    T   _initial;
-    T   _lower;
-    T   _upper;
-    T   _current;
+    T                   _initial;
+    std::vector<Bits>   _values;
+    size_t              _index;
 };
 
 } // namespace runtime
 
 } // namespace fuzzy
 
-#endif
\ No newline at end of file
+#endif
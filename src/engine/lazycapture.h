@@ -0,0 +1,74 @@
+#ifndef _LAZYCAPTURE_H_
+#define _LAZYCAPTURE_H_
+
+#include "lazy.h"
+#include "input.h"
+#include <memory>
+#include <stdexcept>
+
+namespace fuzzer {
+
+namespace runtime {
+
+///
+/// \class  LazyCapture
+/// \brief  Lazy evaluator for a field captured from the last response, so
+///         that session tokens, sequence numbers and nonces are echoed in
+///         the next message. Integers are written with their width in the
+///         byte order of the template, arrays as they were received.
+///         Until a response has been read, integers are written as zero
+///         and arrays are empty. Captured arrays must be retained by the
+///         input, the receive buffer is reused by the next read.
+///
+class LazyCapture : public LazyEvaluation
+{
+public:
+    ///
+    /// \brief  Constructor, throws a std::runtime_error if field \p id of
+    ///         \p input doesn't exist, isn't captured, or is an array that
+    ///         isn't retained.
+    ///
+    LazyCapture(const std::shared_ptr<const io::Input> & input, size_t id) :
+        _input(input),
+        _id(id)
+    {
+        const io::InputItem * item = _input->get(_id);
+        if (!item || !item->_capture) {
+            throw std::runtime_error("The input field isn't captured.");
+        }
+        if (item->type == io::InputItem::VARRAY && !_input->retains()) {
+            throw std::runtime_error("Captured arrays must be retained by the input.");
+        }
+    }
+
+    virtual void evaluate(Buffer & buffer)
+    {
+        const io::InputItem & item = *_input->get(_id);
+        const bool complete = _input->complete();
+        switch(item.type) {
+        case io::InputItem::BYTE:   buffer.writeU8(complete ? item.u.byte : 0); break;
+        case io::InputItem::WORD:   buffer.writeU16(complete ? item.u.word : 0); break;
+        case io::InputItem::WORD24: buffer.writeU24(complete ? item.u.dword : 0); break;
+        case io::InputItem::DWORD:  buffer.writeU32(complete ? item.u.dword : 0); break;
+        case io::InputItem::QWORD:  buffer.writeU64(complete ? item.u.qword : 0); break;
+        case io::InputItem::VARRAY:
+            /// retained by the input, valid until its next read()
+            if (complete && item.u.varray.count) {
+                buffer.write(item.u.varray.data, item.u.varray.count);
+            }
+            break;
+        default:
+            throw std::runtime_error("Unsupported input field.");
+        }
+    }
+
+protected:
+    std::shared_ptr<const io::Input>    _input;
+    size_t                              _id;
+};
+
+} // namespace runtime
+
+} // namespace fuzzer
+
+#endif
@@ -0,0 +1,526 @@
+#ifdef __linux__
+
+#include "linuxexec.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <dirent.h>
+#include <elf.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdexcept>
+#include <string.h>
+#include <sys/ptrace.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+extern char ** environ;
+
+namespace fuzzer {
+
+namespace execution {
+
+/// soft-dirty bit of a /proc/pid/pagemap entry
+static const uint64_t PageSoftDirty = 1ULL << 55;
+
+static bool ReadAll(int fd, void * dst, size_t count, uint64_t offset)
+{
+    uint8_t * ptr = static_cast<uint8_t *>(dst);
+    while(count > 0) {
+        const ssize_t res = pread(fd, ptr, count, static_cast<off_t>(offset));
+        if (res <= 0) {
+            if (res < 0 && errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        ptr     += res;
+        offset  += res;
+        count   -= res;
+    }
+    return true;
+}
+
+static bool WriteAll(int fd, const void * src, size_t count, uint64_t offset)
+{
+    const uint8_t * ptr = static_cast<const uint8_t *>(src);
+    while(count > 0) {
+        const ssize_t res = pwrite(fd, ptr, count, static_cast<off_t>(offset));
+        if (res <= 0) {
+            if (res < 0 && errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        ptr     += res;
+        offset  += res;
+        count   -= res;
+    }
+    return true;
+}
+
+static int OpenProc(pid_t pid, const char * name, int flags)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/%s", static_cast<int>(pid), name);
+    return open(path, flags | O_CLOEXEC);
+}
+
+/// number of threads of \p pid, 0 if it can't be read
+static size_t CountThreads(pid_t pid)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/task", static_cast<int>(pid));
+    DIR * dir = opendir(path);
+    if (!dir) {
+        return 0;
+    }
+    size_t count = 0;
+    while(const dirent * entry = readdir(dir)) {
+        count += entry->d_name[0] != '.';
+    }
+    closedir(dir);
+    return count;
+}
+
+/// the pagemap entries of the pages in [start, end)
+static bool ReadPagemap(int fd, uintptr_t start, uintptr_t end, std::vector<uint64_t> & entries)
+{
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    entries.resize((end - start) / page);
+    return entries.empty() ||
+        ReadAll(fd, &entries[0], entries.size() * sizeof(uint64_t), (start / page) * sizeof(uint64_t));
+}
+
+LinuxExecuter::LinuxExecuter(const std::string & Path) :
+    _path(Path),
+    _pid(-1),
+    _status(0),
+    _exited(false),
+    _signal(0),
+    _softDirty(false),
+    _restored(0),
+    _ring(nullptr),
+    _coverage(nullptr),
+    _comparisons(nullptr)
+{
+}
+
+LinuxExecuter::~LinuxExecuter()
+{
+    Terminate();
+    Wait(-1);
+    SetRing(nullptr);
+}
+
+void LinuxExecuter::SetCommandLine(const std::string & cmd)
+{
+    _arguments.clear();
+    std::string argument;
+    bool quoted = false, pending = false;
+    for(size_t i = 0; i < cmd.size(); ++i) {
+        const char c = cmd[i];
+        if (c == '"') {
+            quoted  = !quoted;
+            pending = true;
+        } else if (c == ' ' && !quoted) {
+            if (pending) {
+                _arguments.push_back(argument);
+            }
+            argument.clear();
+            pending = false;
+        } else {
+            argument.push_back(c);
+            pending = true;
+        }
+    }
+    if (pending) {
+        _arguments.push_back(argument);
+    }
+}
+
+bool LinuxExecuter::Launch()
+{
+    if (_path.empty()) {
+        return false;
+    }
+
+    /// the arguments are prepared before the fork
+    std::vector<char *> argv;
+    argv.push_back(const_cast<char *>(_path.c_str()));
+    for(size_t i = 0; i < _arguments.size(); ++i) {
+        argv.push_back(const_cast<char *>(_arguments[i].c_str()));
+    }
+    argv.push_back(nullptr);
+
+    /// the environment of the fuzzer, without the variables it was passed itself
+    const char * variables[] = {
+        io::RingIpc::EnvironmentVariable,
+        CoverageMap::EnvironmentVariable,
+        ComparisonLog::EnvironmentVariable,
+    };
+    std::vector<char *> envp;
+    for(char ** env = environ; *env; ++env) {
+        bool passed = false;
+        for(size_t i = 0; i < sizeof(variables) / sizeof(variables[0]) && !passed; ++i) {
+            const size_t length = strlen(variables[i]);
+            passed = strncmp(*env, variables[i], length) == 0 && (*env)[length] == '=';
+        }
+        if (!passed) {
+            envp.push_back(*env);
+        }
+    }
+    /// the child inherits the descriptor of the rings
+    std::string ring, coverage, comparisons;
+    const int ringfd = _ring ? _ring->descriptor() : -1;
+    if (_ring) {
+        _ring->clear();
+        ring = std::string(io::RingIpc::EnvironmentVariable) + "=" + _ring->name();
+        envp.push_back(const_cast<char *>(ring.c_str()));
+    }
+    /// and the names of the coverage map and the comparison log
+    if (_coverage) {
+        _coverage->clear();
+        coverage = std::string(CoverageMap::EnvironmentVariable) + "=" + _coverage->name();
+        envp.push_back(const_cast<char *>(coverage.c_str()));
+    }
+    if (_comparisons) {
+        _comparisons->clear();
+        comparisons = std::string(ComparisonLog::EnvironmentVariable) + "=" + _comparisons->name();
+        envp.push_back(const_cast<char *>(comparisons.c_str()));
+    }
+    envp.push_back(nullptr);
+
+    const pid_t pid = fork();
+    if (pid < 0) {
+        return false;
+    } else if (pid == 0) {
+        /// the rings are close-on-exec, so that other children don't hold them
+        if (ringfd >= 0 && fcntl(ringfd, F_SETFD, 0) != 0) {
+            _exit(127);
+        }
+        execve(_path.c_str(), &argv[0], &envp[0]);
+        _exit(127);
+    }
+    _pid        = pid;
+    _status     = 0;
+    _exited     = false;
+    _regions.clear();
+    return true;
+}
+
+void LinuxExecuter::SetRing(io::RingIpc * ring)
+{
+    if (ring && !ring->claim(this)) {
+        throw std::runtime_error("The ring is used by another executer.");
+    }
+    if (_ring && _ring != ring) {
+        _ring->release(this);
+    }
+    _ring = ring;
+}
+
+void LinuxExecuter::SetCoverageMap(CoverageMap * coverage)
+{
+    _coverage = coverage;
+}
+
+bool LinuxExecuter::GetCoverageChecksum(uint64_t & Checksum)
+{
+    if (!_coverage) {
+        return false;
+    }
+    Checksum = _coverage->checksum();
+    return true;
+}
+
+void LinuxExecuter::SetComparisonLog(ComparisonLog * comparisons)
+{
+    _comparisons = comparisons;
+}
+
+const ComparisonLog * LinuxExecuter::GetComparisonLog()
+{
+    return _comparisons;
+}
+
+bool LinuxExecuter::Terminate()
+{
+    if (!IsAlive()) {
+        return false;
+    }
+    return kill(_pid, SIGKILL) == 0;
+}
+
+bool LinuxExecuter::Wait(int TimeOut)
+{
+    if (_pid <= 0) {
+        return false;
+    }
+    if (TimeOut < 0) {
+        while(!_exited) {
+            int status;
+            const pid_t res = waitpid(_pid, &status, 0);
+            if (res == _pid && (WIFEXITED(status) || WIFSIGNALED(status))) {
+                _status = status;
+                _exited = true;
+            } else if (res < 0 && errno != EINTR) {
+                _exited = true;
+            }
+        }
+        return true;
+    }
+    for(int time = 0; IsAlive(); ++time) {
+        if (time >= TimeOut) {
+            return false;
+        }
+        const timespec ms = { 0, 1000000 };
+        nanosleep(&ms, nullptr);
+    }
+    return true;
+}
+
+bool LinuxExecuter::IsAlive()
+{
+    if (_pid <= 0 || _exited) {
+        return false;
+    }
+    int status;
+    const pid_t res = waitpid(_pid, &status, WNOHANG);
+    if (res == _pid && (WIFEXITED(status) || WIFSIGNALED(status))) {
+        _status = status;
+        _exited = true;
+    } else if (res < 0) {
+        _exited = true;
+    }
+    return !_exited;
+}
+
+bool LinuxExecuter::GetStatusCode(int & StatusCode, TerminationReason & Reason)
+{
+    if (IsAlive() || _pid <= 0) {
+        return false;
+    }
+    if (WIFSIGNALED(_status)) {
+        const int sig = WTERMSIG(_status);
+        StatusCode = 128 + sig;
+        switch(sig) {
+        case SIGSEGV:   Reason = Term_SegmentationFault; break;
+        case SIGBUS:    Reason = Term_UnalignedAccess; break;
+        default:        Reason = Term_Other; break;
+        }
+    } else {
+        StatusCode  = WEXITSTATUS(_status);
+        Reason      = Term_Normal;
+    }
+    return true;
+}
+
+bool LinuxExecuter::Attach()
+{
+    if (ptrace(PTRACE_SEIZE, _pid, nullptr, nullptr) != 0) {
+        return false;
+    }
+    if (ptrace(PTRACE_INTERRUPT, _pid, nullptr, nullptr) != 0) {
+        ptrace(PTRACE_DETACH, _pid, nullptr, nullptr);
+        return false;
+    }
+    _signal = 0;
+    for(;;) {
+        int status;
+        const pid_t res = waitpid(_pid, &status, __WALL);
+        if (res < 0 && errno == EINTR) {
+            continue;
+        }
+        if (res != _pid || !WIFSTOPPED(status)) {
+            /// it died before it stopped
+            if (res == _pid) {
+                _status = status;
+            }
+            _exited = true;
+            return false;
+        }
+        if ((status >> 16) != PTRACE_EVENT_STOP) {
+            /// a signal arrived first, it is delivered when detaching
+            _signal = WSTOPSIG(status);
+        }
+        /// the other threads would keep running, counted once the leader
+        /// is stopped since only another thread could start one now
+        if (CountThreads(_pid) != 1) {
+            Detach();
+            return false;
+        }
+        return true;
+    }
+}
+
+void LinuxExecuter::Detach()
+{
+    ptrace(PTRACE_DETACH, _pid, nullptr, reinterpret_cast<void *>(static_cast<uintptr_t>(_signal)));
+}
+
+bool LinuxExecuter::ReadMappings(std::vector<std::pair<uintptr_t, uintptr_t> > & mappings)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/maps", static_cast<int>(_pid));
+    FILE * maps = fopen(path, "r");
+    if (!maps) {
+        return false;
+    }
+    mappings.clear();
+    char line[512];
+    while(fgets(line, sizeof(line), maps)) {
+        unsigned long start, end;
+        char perms[5];
+        if (sscanf(line, "%lx-%lx %4s", &start, &end, perms) == 3 && perms[1] == 'w' && perms[3] == 'p') {
+            mappings.push_back(std::make_pair(static_cast<uintptr_t>(start), static_cast<uintptr_t>(end)));
+        }
+    }
+    fclose(maps);
+    std::sort(mappings.begin(), mappings.end());
+    return true;
+}
+
+bool LinuxExecuter::ClearSoftDirty()
+{
+    const int fd = OpenProc(_pid, "clear_refs", O_WRONLY);
+    if (fd < 0) {
+        return false;
+    }
+    const bool cleared = write(fd, "4", 1) == 1;
+    close(fd);
+    return cleared;
+}
+
+bool LinuxExecuter::Snapshot()
+{
+    if (!IsAlive() || !Attach()) {
+        return false;
+    }
+    _regions.clear();
+    bool ok = true;
+
+    _registers.resize(4096);
+    _fpregisters.resize(4096);
+    iovec regs      = { &_registers[0], _registers.size() };
+    iovec fpregs    = { &_fpregisters[0], _fpregisters.size() };
+    if (ptrace(PTRACE_GETREGSET, _pid, reinterpret_cast<void *>(NT_PRSTATUS), &regs) != 0 ||
+        ptrace(PTRACE_GETREGSET, _pid, reinterpret_cast<void *>(NT_PRFPREG), &fpregs) != 0)
+    {
+        ok = false;
+    }
+    _registers.resize(regs.iov_len);
+    _fpregisters.resize(fpregs.iov_len);
+
+    std::vector<std::pair<uintptr_t, uintptr_t> > mappings;
+    const int mem       = OpenProc(_pid, "mem", O_RDONLY);
+    const int pagemap   = OpenProc(_pid, "pagemap", O_RDONLY);
+    ok = ok && mem >= 0 && pagemap >= 0 && ReadMappings(mappings);
+
+    /// pages that were never written aren't soft-dirty either, if none of
+    /// the pages is the kernel doesn't track them
+    _softDirty = false;
+    std::vector<uint64_t> entries;
+    for(size_t i = 0; ok && i < mappings.size(); ++i) {
+        Region region;
+        region.start    = mappings[i].first;
+        region.end      = mappings[i].second;
+        region.data.resize(region.end - region.start);
+        ok = ReadAll(mem, &region.data[0], region.data.size(), region.start) &&
+            ReadPagemap(pagemap, region.start, region.end, entries);
+        for(size_t j = 0; ok && j < entries.size() && !_softDirty; ++j) {
+            _softDirty = (entries[j] & PageSoftDirty) != 0;
+        }
+        _regions.push_back(region);
+    }
+    if (mem >= 0) {
+        close(mem);
+    }
+    if (pagemap >= 0) {
+        close(pagemap);
+    }
+    _softDirty = ok && _softDirty && ClearSoftDirty();
+    if (!ok) {
+        _regions.clear();
+    }
+    Detach();
+    return ok;
+}
+
+bool LinuxExecuter::Restore()
+{
+    _restored = 0;
+    if (_regions.empty() || !IsAlive() || !Attach()) {
+        return false;
+    }
+
+    /// each region of the snapshot has to be mapped still
+    std::vector<std::pair<uintptr_t, uintptr_t> > mappings;
+    bool ok = ReadMappings(mappings);
+    for(size_t i = 0; ok && i < _regions.size(); ++i) {
+        uintptr_t covered = _regions[i].start;
+        for(size_t j = 0; j < mappings.size(); ++j) {
+            if (mappings[j].first <= covered && mappings[j].second > covered) {
+                covered = mappings[j].second;
+            }
+        }
+        ok = covered >= _regions[i].end;
+    }
+
+    const int mem       = OpenProc(_pid, "mem", O_RDWR);
+    const int pagemap   = OpenProc(_pid, "pagemap", O_RDONLY);
+    ok = ok && mem >= 0 && pagemap >= 0;
+
+    /// writes back the runs of dirty pages, or every page without soft-dirty tracking
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    std::vector<uint64_t> entries;
+    for(size_t i = 0; ok && i < _regions.size(); ++i) {
+        const Region & region = _regions[i];
+        const size_t pages = region.data.size() / page;
+        if (_softDirty) {
+            ok = ReadPagemap(pagemap, region.start, region.end, entries);
+        } else {
+            entries.assign(pages, PageSoftDirty);
+        }
+        for(size_t first = 0; ok && first < pages;) {
+            if (!(entries[first] & PageSoftDirty)) {
+                ++first;
+                continue;
+            }
+            size_t last = first + 1;
+            while(last < pages && (entries[last] & PageSoftDirty)) {
+                ++last;
+            }
+            ok = WriteAll(mem, &region.data[first * page], (last - first) * page, region.start + first * page);
+            _restored += last - first;
+            first = last;
+        }
+    }
+    if (mem >= 0) {
+        close(mem);
+    }
+    if (pagemap >= 0) {
+        close(pagemap);
+    }
+
+    if (ok) {
+        iovec regs      = { &_registers[0], _registers.size() };
+        iovec fpregs    = { &_fpregisters[0], _fpregisters.size() };
+        ok = ptrace(PTRACE_SETREGSET, _pid, reinterpret_cast<void *>(NT_PRSTATUS), &regs) == 0 &&
+            ptrace(PTRACE_SETREGSET, _pid, reinterpret_cast<void *>(NT_PRFPREG), &fpregs) == 0;
+        if (_softDirty) {
+            ClearSoftDirty();
+        }
+    }
+    Detach();
+    return ok;
+}
+
+} // namespace execution
+
+} // namespace fuzzer
+
+#endif // __linux__
@@ -0,0 +1,163 @@
+#ifndef _LINUXEXEC_H_
+#define _LINUXEXEC_H_
+
+#ifdef __linux__
+
+#include "appexec.h"
+#include "ringipc.h"
+#include "coverage.h"
+#include "cmplog.h"
+#include <sys/types.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace fuzzer {
+
+namespace execution {
+
+///
+/// \brief  Executes a Linux application, with snapshots of its state.
+///
+///         Snapshot() stops the application with ptrace, copies its private
+///         writable mappings and registers, and clears the soft-dirty bits
+///         of its pages. Restore() writes back only the pages that are
+///         soft-dirty since, and the registers, so that the application
+///         continues from the snapshot. The application isn't traced
+///         between the two.
+///
+///         Mappings created after the snapshot are left as they are. A
+///         snapshot mapping that was unmapped or shrunk can't be restored.
+///         Kernel state, such as file descriptors and socket buffers, isn't
+///         part of the snapshot. Only the thread group leader is stopped,
+///         so both fail while the application has more than one thread.
+///
+class LinuxExecuter : public IApplicationExecuter
+{
+public:
+    LinuxExecuter(const std::string & Path);
+
+    ///
+    /// \brief  Destructor
+    ///
+    ~LinuxExecuter();
+
+    ///
+    /// \brief  Sets the command line that should be passed to the
+    ///         application, arguments are separated by spaces and may be
+    ///         quoted with "".
+    ///
+    virtual void SetCommandLine(const std::string &);
+
+    ///
+    /// \brief  Launches the application
+    ///
+    virtual bool Launch();
+
+    ///
+    /// \brief  Terminate the application if it is currently running.
+    ///
+    virtual bool Terminate();
+
+    ///
+    /// \brief  Get the status code of the application, the exit code or
+    ///         128 and the number of the signal that terminated it.
+    ///
+    virtual bool GetStatusCode(int & StatusCode, TerminationReason & Reason);
+
+    ///
+    /// \brief  Wait for the application to terminate.
+    ///
+    /// \param [in] TimeOut     The maximum time to wait for the application
+    ///                         to terminate, in ms.
+    ///
+    virtual bool Wait(int TimeOut = -1);
+
+    ///
+    /// \brief  Returns the current application status running status.
+    ///
+    virtual bool IsAlive();
+
+    ///
+    /// \brief  Records the state of the application.
+    ///
+    virtual bool Snapshot();
+
+    ///
+    /// \brief  Returns the application to the state of the last Snapshot().
+    ///
+    virtual bool Restore();
+
+    /// pages written by the last Restore()
+    size_t restored() const { return _restored; }
+
+    ///
+    /// \brief  Passes \p ring to the application when it is launched, it is
+    ///         emptied first. A ring connects a single application, throws
+    ///         a std::runtime_error if another executer uses \p ring, so the
+    ///         applications of a WarmPool need a ring each. The ring has to
+    ///         outlive the executer.
+    ///
+    void SetRing(io::RingIpc * ring);
+
+    ///
+    /// \brief  Passes the coverage map to instrumented applications, the
+    ///         map is cleared before each launch.
+    ///
+    void SetCoverageMap(CoverageMap *);
+
+    ///
+    /// \brief  Checksum of the coverage map after the last run
+    ///
+    virtual bool GetCoverageChecksum(uint64_t & Checksum);
+
+    ///
+    /// \brief  Passes the comparison log to instrumented applications, the
+    ///         log is cleared before each launch.
+    ///
+    void SetComparisonLog(ComparisonLog *);
+
+    ///
+    /// \brief  Comparisons logged by the last run
+    ///
+    virtual const ComparisonLog * GetComparisonLog();
+
+private:
+    struct Region {
+        uintptr_t               start;
+        uintptr_t               end;
+        std::vector<uint8_t>    data;
+    };
+
+    /// stops the application with ptrace, fails unless it is single threaded
+    bool Attach();
+    void Detach();
+
+    /// private writable mappings of the application
+    bool ReadMappings(std::vector<std::pair<uintptr_t, uintptr_t> > & mappings);
+
+    /// clears the soft-dirty bits, false if the kernel doesn't track them
+    bool ClearSoftDirty();
+
+    std::string                 _path;
+    std::vector<std::string>    _arguments;
+    pid_t                       _pid;
+    int                         _status;
+    bool                        _exited;
+    int                         _signal;        //< delivered when detaching
+    std::vector<Region>         _regions;       //< of the snapshot
+    std::vector<uint8_t>        _registers;     //< general purpose, of the snapshot
+    std::vector<uint8_t>        _fpregisters;
+    bool                        _softDirty;     //< the kernel tracks dirty pages
+    size_t                      _restored;
+    io::RingIpc *               _ring;
+    CoverageMap *               _coverage;
+    ComparisonLog *             _comparisons;
+};
+
+} // namespace execution
+
+} // namespace fuzzer
+
+#endif // __linux__
+#endif // _LINUXEXEC_H_
@@ -0,0 +1,78 @@
+#include "mappedfile.h"
+#include <stdexcept>
+
+#ifdef WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fuzzer {
+
+namespace io {
+
+MappedFile::MappedFile(const char * filename) :
+    _filename(filename),
+    _data(nullptr),
+    _size(0)
+{
+#ifdef WIN32
+    _file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (_file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Failed to open file for reading.");
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(_file, &size) || !size.QuadPart) {
+        CloseHandle(_file);
+        throw std::runtime_error("Empty file.");
+    }
+    _mapping = CreateFileMappingA(_file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!_mapping) {
+        CloseHandle(_file);
+        throw std::runtime_error("Failed to map file.");
+    }
+    _data = static_cast<const uint8_t *>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!_data) {
+        CloseHandle(_mapping);
+        CloseHandle(_file);
+        throw std::runtime_error("Failed to map file.");
+    }
+    _size = static_cast<size_t>(size.QuadPart);
+#else
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open file for reading.");
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !st.st_size) {
+        close(fd);
+        throw std::runtime_error("Empty file.");
+    }
+    void * data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        throw std::runtime_error("Failed to map file.");
+    }
+    _data = static_cast<const uint8_t *>(data);
+    _size = static_cast<size_t>(st.st_size);
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#ifdef WIN32
+    UnmapViewOfFile(_data);
+    CloseHandle(_mapping);
+    CloseHandle(_file);
+#else
+    munmap(const_cast<uint8_t *>(_data), _size);
+#endif
+}
+
+} // namespace io
+
+} // namespace fuzzer
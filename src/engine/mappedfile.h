@@ -0,0 +1,48 @@
+#ifndef _MAPPEDFILE_H_
+#define _MAPPEDFILE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+namespace fuzzer {
+
+namespace io {
+
+///
+/// \class  MappedFile
+/// \brief  Read only memory mapping of a whole file. Pages are only read
+///         from disk when they are touched.
+///
+class MappedFile
+{
+public:
+    ///
+    /// \brief  Maps the file, throws a std::runtime_error if the file can't
+    ///         be opened or is empty.
+    ///
+    explicit MappedFile(const char * filename);
+    ~MappedFile();
+
+    const uint8_t * data() const { return _data; }
+    size_t size() const { return _size; }
+    const std::string & filename() const { return _filename; }
+
+private:
+    MappedFile(const MappedFile &);
+    MappedFile & operator=(const MappedFile &);
+
+    std::string     _filename;
+    const uint8_t * _data;
+    size_t          _size;
+#ifdef WIN32
+    void *          _file;
+    void *          _mapping;
+#endif
+};
+
+} // namespace io
+
+} // namespace fuzzer
+
+#endif
@@ -2,11 +2,14 @@
 #define _MUTATOR_H_
 
 #include "lazy.h"
+#include <memory>
 
 namespace fuzzer {
 
 namespace runtime {
 
+class Dictionary;
+
 ///
 /// \class  Mutator
 ///
@@ -27,6 +30,25 @@ public:
     /// \brief  Resets the mutator to it's initial state
     ///
     virtual void reset() = 0;
+
+    ///
+    /// \brief  Number of mutations, zero if the mutator can't seek.
+    ///
+    virtual size_t count() const { return 0; }
+
+    /// index of the current mutation
+    virtual size_t position() const { return 0; }
+
+    ///
+    /// \brief  Jumps to a mutation, seeking to count() finishes the mutator.
+    ///
+    virtual void seek(size_t) {}
+
+    ///
+    /// \brief  Tokens to insert or overwrite with, mutators that support a
+    ///         dictionary add mutations for them.
+    ///
+    virtual void dictionary(const std::shared_ptr<const Dictionary> &) {}
 };
 
 } // namespace runtime
@@ -0,0 +1,202 @@
+#include "novelty.h"
+#include "endian.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HAVE_SSE2_HASH
+#endif
+
+namespace fuzzer {
+
+namespace runtime {
+
+static const uint64_t HashKeys[4] = {
+    0xbe4ba423396cfeb8ULL, 0x1cad21f72c81017cULL, 0xdb979083e96dd4deULL, 0x1f67b3b7a4a44072ULL
+};
+
+static inline uint64_t Mix(uint64_t x)
+{
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+///
+/// \brief  Accumulates 32 byte blocks into four 64 bit lanes. Each lane adds
+///         the product of the halves of its keyed word and the neighbouring
+///         word, so two 64 bit lanes fit an SSE2 register.
+///
+#if defined(HAVE_SSE2_HASH)
+static void Accumulate(uint64_t acc[4], const uint8_t * data, size_t blocks)
+{
+    __m128i acc0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(acc));
+    __m128i acc1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(acc + 2));
+    const __m128i key0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(HashKeys));
+    const __m128i key1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(HashKeys + 2));
+    for(size_t i = 0; i < blocks; ++i, data += 32) {
+        const __m128i d0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+        const __m128i d1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 16));
+        const __m128i k0 = _mm_xor_si128(d0, key0);
+        const __m128i k1 = _mm_xor_si128(d1, key1);
+        acc0 = _mm_add_epi64(acc0, _mm_mul_epu32(k0, _mm_shuffle_epi32(k0, _MM_SHUFFLE(0, 3, 0, 1))));
+        acc1 = _mm_add_epi64(acc1, _mm_mul_epu32(k1, _mm_shuffle_epi32(k1, _MM_SHUFFLE(0, 3, 0, 1))));
+        acc0 = _mm_add_epi64(acc0, _mm_shuffle_epi32(d0, _MM_SHUFFLE(1, 0, 3, 2)));
+        acc1 = _mm_add_epi64(acc1, _mm_shuffle_epi32(d1, _MM_SHUFFLE(1, 0, 3, 2)));
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(acc), acc0);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(acc + 2), acc1);
+}
+#else
+static void Accumulate(uint64_t acc[4], const uint8_t * data, size_t blocks)
+{
+    for(size_t i = 0; i < blocks; ++i, data += 32) {
+        uint64_t words[4];
+        memcpy(words, data, sizeof(words));
+        for(size_t lane = 0; lane < 4; ++lane) {
+            words[lane] = io::le_to_host64(words[lane]);
+        }
+        for(size_t lane = 0; lane < 4; ++lane) {
+            const uint64_t keyed = words[lane] ^ HashKeys[lane];
+            acc[lane] += (keyed & 0xffffffffULL) * (keyed >> 32);
+            acc[lane] += words[lane ^ 1];
+        }
+    }
+}
+#endif
+
+uint64_t HashBytes(const uint8_t * data, size_t size)
+{
+    uint64_t acc[4] = { HashKeys[0], HashKeys[1], HashKeys[2], HashKeys[3] };
+    const size_t blocks = size / 32;
+    Accumulate(acc, data, blocks);
+    if (const size_t tail = size % 32) {
+        uint8_t last[32] = { 0 };
+        memcpy(last, data + blocks * 32, tail);
+        Accumulate(acc, last, 1);
+    }
+    uint64_t hash = size * 0x9e3779b97f4a7c15ULL;
+    for(size_t lane = 0; lane < 4; ++lane) {
+        hash = Mix(hash ^ acc[lane]);
+    }
+    return hash;
+}
+
+ResponseNovelty::ResponseNovelty() :
+    _message(0),
+    _receiving(false),
+    _calibrated(false),
+    _fingerprint(0)
+{
+}
+
+void ResponseNovelty::begin()
+{
+    /// keep the buffers, only their contents are reset
+    for(size_t i = 0; i < _responses.size(); ++i) {
+        _responses[i].clear();
+    }
+    _message    = 0;
+    _receiving  = false;
+}
+
+void ResponseNovelty::sent()
+{
+    /// writes before a response belong to the same message
+    if (_receiving) {
+        ++_message;
+        _receiving = false;
+    }
+}
+
+void ResponseNovelty::received(const uint8_t * data, size_t size)
+{
+    if (!size) {
+        return;
+    }
+    if (_message >= _responses.size()) {
+        _responses.resize(_message + 1);
+    }
+    _responses[_message].insert(_responses[_message].end(), data, data + size);
+    _receiving = true;
+}
+
+uint64_t ResponseNovelty::hash(size_t message)
+{
+    const std::vector<uint8_t> & response = _responses[message];
+    if (message >= _masks.size()) {
+        return HashBytes(response.data(), response.size());
+    }
+    const Mask & mask = _masks[message];
+    _scratch.assign(response.begin(), response.end());
+    /// the calibrated lengths hash alike, the masked bytes pad them
+    if (_scratch.size() >= mask.shortest && _scratch.size() < mask.longest) {
+        _scratch.resize(mask.longest, 0);
+    }
+    const size_t masked = std::min(_scratch.size(), mask.bytes.size());
+    for(size_t i = 0; i < masked; ++i) {
+        _scratch[i] &= mask.bytes[i];
+    }
+    return HashBytes(_scratch.data(), _scratch.size());
+}
+
+uint64_t ResponseNovelty::combine()
+{
+    const size_t messages = _responses.empty() ? 0 : std::min(_message + 1, _responses.size());
+    uint64_t fingerprint = Mix(messages);
+    for(size_t i = 0; i < messages; ++i) {
+        fingerprint = Mix(fingerprint ^ hash(i));
+    }
+    return fingerprint;
+}
+
+bool ResponseNovelty::end()
+{
+    _fingerprint = combine();
+    return _seen.insert(_fingerprint).second;
+}
+
+void ResponseNovelty::calibrate()
+{
+    const size_t messages = _responses.empty() ? 0 : std::min(_message + 1, _responses.size());
+    if (_calibrated) {
+        for(size_t i = 0; i < messages && i < _previous.size(); ++i) {
+            if (i >= _masks.size()) {
+                Mask mask;
+                mask.shortest   = ~size_t(0);
+                mask.longest    = 0;
+                _masks.resize(i + 1, mask);
+            }
+            const std::vector<uint8_t> & current = _responses[i];
+            const std::vector<uint8_t> & previous = _previous[i];
+            Mask & mask = _masks[i];
+            const size_t common = std::min(current.size(), previous.size());
+            const size_t longest = std::max(current.size(), previous.size());
+            mask.shortest   = std::min(mask.shortest, common);
+            mask.longest    = std::max(mask.longest, longest);
+            if (mask.bytes.size() < longest) {
+                mask.bytes.resize(longest, 0xff);
+            }
+            for(size_t j = 0; j < common; ++j) {
+                if (current[j] != previous[j]) {
+                    mask.bytes[j] = 0;
+                }
+            }
+            /// only one of the runs has these bytes
+            for(size_t j = common; j < longest; ++j) {
+                mask.bytes[j] = 0;
+            }
+        }
+    }
+    _previous.assign(_responses.begin(), _responses.begin() + messages);
+    _calibrated = true;
+
+    /// the masks may have changed, the calibrated runs are the baseline
+    _fingerprint = combine();
+    _seen.insert(_fingerprint);
+}
+
+} // namespace runtime
+
+} // namespace fuzzer
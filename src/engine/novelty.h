@@ -0,0 +1,132 @@
+#ifndef _NOVELTY_H_
+#define _NOVELTY_H_
+
+#include "source.h"
+#include <stdint.h>
+#include <unordered_set>
+#include <vector>
+
+namespace fuzzer {
+
+namespace runtime {
+
+///
+/// \brief  Hash of \p size bytes, vectorized where the target supports it.
+///         The result is the same on every target.
+///
+uint64_t HashBytes(const uint8_t * data, size_t size);
+
+///
+/// \class  ResponseNovelty
+/// \brief  Feedback for targets without coverage instrumentation. The
+///         responses of a test case are split into messages, the bytes
+///         received after each message that is sent, and each message is
+///         hashed with its volatile bytes masked. A test case is novel if
+///         the sequence of message hashes hasn't been seen before.
+///
+///         Volatile bytes, such as timestamps and nonces, are found by
+///         calibration: the same input is run repeatedly and the bytes
+///         that differ between the runs are masked. If the length of a
+///         message varies, the bytes between the shortest and the longest
+///         calibrated length are masked and the lengths in that range are
+///         equal. Bytes past the longest calibrated length are hashed, so
+///         a longer response, such as an appended error, is novel.
+///
+class ResponseNovelty
+{
+public:
+    ResponseNovelty();
+
+    /// starts a test case
+    void begin();
+
+    /// a message is sent, bytes received from now on are its response
+    void sent();
+
+    /// bytes received from the target
+    void received(const uint8_t * data, size_t size);
+
+    ///
+    /// \brief  Ends the test case.
+    ///
+    /// \return true if its fingerprint wasn't seen before.
+    ///
+    bool end();
+
+    ///
+    /// \brief  Ends a calibration run, the responses are compared with the
+    ///         previous calibration run and the bytes that differ masked.
+    ///         The fingerprint of the run is added to the seen ones.
+    ///
+    void calibrate();
+
+    /// fingerprint of the last test case
+    uint64_t fingerprint() const { return _fingerprint; }
+
+    /// number of distinct fingerprints
+    size_t size() const { return _seen.size(); }
+
+private:
+    ///
+    /// \brief  Volatile bytes of a message, zero where the byte is masked.
+    ///
+    struct Mask {
+        std::vector<uint8_t>    bytes;      //< up to the longest calibrated length
+        size_t                  shortest;   //< calibrated lengths
+        size_t                  longest;
+    };
+
+    uint64_t hash(size_t message);
+    uint64_t combine();
+
+    std::vector<std::vector<uint8_t> >  _responses;     //< of the current test case
+    std::vector<std::vector<uint8_t> >  _previous;      //< of the last calibration run
+    std::vector<Mask>                   _masks;
+    std::vector<uint8_t>                _scratch;       //< normalized message
+    size_t                              _message;       //< current message
+    bool                                _receiving;     //< bytes received since the last send
+    bool                                _calibrated;
+    uint64_t                            _fingerprint;
+    std::unordered_set<uint64_t>        _seen;
+};
+
+///
+/// \class  ResponseRecorder
+/// \brief  Source that passes the received bytes to a ResponseNovelty.
+///
+class ResponseRecorder : public io::Source
+{
+public:
+    ResponseRecorder(io::Source & source, ResponseNovelty & novelty) :
+        _source(source),
+        _novelty(novelty)
+    {
+        _big_endian = source.is_big_endian();
+    }
+
+    virtual bool read(void * dst, size_t count)
+    {
+        if (!_source.read(dst, count)) {
+            return false;
+        }
+        _novelty.received(static_cast<const uint8_t *>(dst), count);
+        return true;
+    }
+
+    virtual size_t receive(void * dst, size_t min, size_t max)
+    {
+        const size_t count = _source.receive(dst, min, max);
+        _novelty.received(static_cast<const uint8_t *>(dst), count);
+        return count;
+    }
+
+protected:
+    io::Source &        _source;
+    ResponseNovelty &   _novelty;
+};
+
+} // namespace runtime
+
+} // namespace fuzzer
+
+#endif
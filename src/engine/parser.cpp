@@ -1,5 +1,6 @@
 #include "parser.h"
 #include <sstream>
+#include <limits>
 
 namespace fuzzer {
 
@@ -135,6 +136,25 @@ std::shared_ptr<FuzzSequence> Parser::ParseFuzzySequence(Tokenizer & tokenizer)
     return sequence;
 }
 
+///
+/// \brief  Parses a integer with an optional minus sign
+///
+int64_t Parser::ParseSigned(Tokenizer & tokenizer, int64_t lower, int64_t upper)
+{
+    bool negative = false;
+    if (tokenizer.Peek() == T_SUB) {
+        Expect(T_SUB, tokenizer);
+        negative = true;
+    }
+    Expect(T_INTEGER, tokenizer);
+    /// compared as magnitudes, so that the minimum of int64_t is in range
+    const uint64_t magnitude = tokenizer.IntValue();
+    if (negative ? magnitude > uint64_t(0) - static_cast<uint64_t>(lower) : magnitude > static_cast<uint64_t>(upper)) {
+        throw std::runtime_error("Signed constant is out of range.");
+    }
+    return static_cast<int64_t>(negative ? uint64_t(0) - magnitude : magnitude);
+}
+
 std::shared_ptr<Expression> Parser::ParseConstant(Tokenizer & tokenizer,
     PrimitiveType primType)
 {   
@@ -172,6 +192,22 @@ std::shared_ptr<Expression> Parser::ParseConstant(Tokenizer & tokenizer,
         }
         constValue->u.u64 = static_cast<uint64_t>(tokenizer.IntValue());
         break;
+    case SIGNED8:
+        constValue->u.i8 = static_cast<int8_t>(ParseSigned(tokenizer,
+            std::numeric_limits<int8_t>::min(), std::numeric_limits<int8_t>::max()));
+        break;
+    case SIGNED16:
+        constValue->u.i16 = static_cast<int16_t>(ParseSigned(tokenizer,
+            std::numeric_limits<int16_t>::min(), std::numeric_limits<int16_t>::max()));
+        break;
+    case SIGNED32:
+        constValue->u.i32 = static_cast<int32_t>(ParseSigned(tokenizer,
+            std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max()));
+        break;
+    case SIGNED64:
+        constValue->u.i64 = ParseSigned(tokenizer,
+            std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max());
+        break;
     default:
         throw std::runtime_error("Suppport for type not implemented yet.");
         break;
@@ -245,8 +281,8 @@ std::shared_ptr<Vector> Parser::ParseVector(Tokenizer & tokenizer,
 {
     Expect( T_LESS, tokenizer );
     Expect( T_INTEGER, tokenizer );
-    int lower = tokenizer.IntValue();
-    int upper = lower;
+    uint64_t lower = tokenizer.IntValue();
+    uint64_t upper = lower;
     
     Symbol_t sym = tokenizer.GetSym();
     if (sym == T_GRT) {
@@ -266,8 +302,8 @@ std::shared_ptr<Vector> Parser::ParseVector(Tokenizer & tokenizer,
     }
     std::shared_ptr<Vector> vec = std::make_shared<Vector>();
     vec->_type  = type;
-    vec->_lower = lower;
-    vec->_upper = upper;
+    vec->_lower = static_cast<size_t>(lower);
+    vec->_upper = static_cast<size_t>(upper);
 
     return vec;
 }
@@ -27,8 +27,14 @@ public:
     std::shared_ptr<PropertyAccess> ParsePropertyAccess(Tokenizer &, const char *);
     std::shared_ptr<Vector> ParseVector(Tokenizer &, PrimitiveType);
 
+    ///
+    /// \brief  Parses an integer with an optional minus sign, throws a
+    ///         std::runtime_error if it is outside [lower, upper].
+    ///
+    static int64_t ParseSigned(Tokenizer &, int64_t lower, int64_t upper);
+
 protected:
-    void Expect(Symbol_t, Tokenizer &);
+    static void Expect(Symbol_t, Tokenizer &);
 };
 
 } // namespace parser
@@ -0,0 +1,419 @@
+#include "pattern.h"
+#include <algorithm>
+#include <bitset>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+
+namespace fuzzer {
+
+namespace runtime {
+
+static const size_t Unset = ~size_t(0);
+
+///
+/// \brief  NFA node, SPLIT nodes are epsilon transitions to both outs.
+///
+struct Pattern::Node
+{
+    enum Kind {
+        SET,
+        SPLIT,
+        ACCEPT
+    } kind;
+    std::bitset<256>    set;
+    size_t              out;
+    size_t              out1;
+};
+
+///
+/// \brief  Partial NFA, the holes are outs that aren't connected yet. A
+///         hole is a node and which of its outs.
+///
+struct Pattern::Fragment
+{
+    size_t                                  start;
+    std::vector<std::pair<size_t, bool> >   holes;
+};
+
+///
+/// \class  Pattern::Parser
+/// \brief  Recursive descent parser from a pattern to a Thompson NFA.
+///
+class Pattern::Parser
+{
+public:
+    Parser(const std::string & pattern, std::vector<Node> & nfa) :
+        _pattern(pattern),
+        _pos(0),
+        _nfa(nfa)
+    {
+    }
+
+    Fragment literal()
+    {
+        Fragment fragment = byte(static_cast<uint8_t>(_pattern[0]));
+        for(size_t i = 1; i < _pattern.size(); ++i) {
+            Fragment next = byte(static_cast<uint8_t>(_pattern[i]));
+            patch(fragment, next.start);
+            fragment.holes = next.holes;
+        }
+        return fragment;
+    }
+
+    Fragment regex()
+    {
+        Fragment fragment = alternation();
+        if (_pos != _pattern.size()) {
+            throw std::runtime_error("Unbalanced parenthesis in pattern.");
+        }
+        return fragment;
+    }
+
+    void patch(const Fragment & fragment, size_t target)
+    {
+        for(size_t i = 0; i < fragment.holes.size(); ++i) {
+            Node & node = _nfa[fragment.holes[i].first];
+            (fragment.holes[i].second ? node.out1 : node.out) = target;
+        }
+    }
+
+private:
+    bool peek(char c) const
+    {
+        return _pos < _pattern.size() && _pattern[_pos] == c;
+    }
+
+    size_t node(Node::Kind kind, const std::bitset<256> & set = std::bitset<256>())
+    {
+        Node node;
+        node.kind   = kind;
+        node.set    = set;
+        node.out    = Unset;
+        node.out1   = Unset;
+        _nfa.push_back(node);
+        return _nfa.size() - 1;
+    }
+
+    Fragment set(const std::bitset<256> & set)
+    {
+        Fragment fragment;
+        fragment.start = node(Node::SET, set);
+        fragment.holes.push_back(std::make_pair(fragment.start, false));
+        return fragment;
+    }
+
+    Fragment byte(uint8_t value)
+    {
+        std::bitset<256> bits;
+        bits.set(value);
+        return set(bits);
+    }
+
+    Fragment alternation()
+    {
+        Fragment fragment = concatenation();
+        while(peek('|')) {
+            ++_pos;
+            Fragment other = concatenation();
+            const size_t split = node(Node::SPLIT);
+            _nfa[split].out     = fragment.start;
+            _nfa[split].out1    = other.start;
+            fragment.start = split;
+            fragment.holes.insert(fragment.holes.end(), other.holes.begin(), other.holes.end());
+        }
+        return fragment;
+    }
+
+    Fragment concatenation()
+    {
+        if (_pos == _pattern.size() || peek('|') || peek(')')) {
+            throw std::runtime_error("Empty expression in pattern.");
+        }
+        Fragment fragment = repetition();
+        while(_pos < _pattern.size() && !peek('|') && !peek(')')) {
+            Fragment next = repetition();
+            patch(fragment, next.start);
+            fragment.holes = next.holes;
+        }
+        return fragment;
+    }
+
+    Fragment repetition()
+    {
+        Fragment fragment = atom();
+        while(peek('*') || peek('+') || peek('?')) {
+            const char op = _pattern[_pos++];
+            const size_t split = node(Node::SPLIT);
+            _nfa[split].out = fragment.start;
+            if (op == '?') {
+                fragment.start = split;
+            } else {
+                /// loop back through the split
+                patch(fragment, split);
+                fragment.holes.clear();
+                if (op == '*') {
+                    fragment.start = split;
+                }
+            }
+            fragment.holes.push_back(std::make_pair(split, true));
+        }
+        return fragment;
+    }
+
+    Fragment atom()
+    {
+        const char c = _pattern[_pos++];
+        switch(c) {
+        case '(':
+            {
+                Fragment fragment = alternation();
+                if (!peek(')')) {
+                    throw std::runtime_error("Unbalanced parenthesis in pattern.");
+                }
+                ++_pos;
+                return fragment;
+            }
+        case '[':
+            return set(characterClass());
+        case '.':
+            return set(std::bitset<256>().set());
+        case '\\':
+            return set(escape());
+        case '*':
+        case '+':
+        case '?':
+            throw std::runtime_error("Nothing to repeat in pattern.");
+        default:
+            return byte(static_cast<uint8_t>(c));
+        }
+    }
+
+    /// the set of an escape, the backslash is consumed
+    std::bitset<256> escape()
+    {
+        if (_pos == _pattern.size()) {
+            throw std::runtime_error("Incomplete escape in pattern.");
+        }
+        std::bitset<256> bits;
+        const char c = _pattern[_pos++];
+        switch(c) {
+        case 'd':
+            for(int i = '0'; i <= '9'; ++i) bits.set(i);
+            break;
+        case 'w':
+            for(int i = 0; i < 256; ++i) {
+                if ((i >= '0' && i <= '9') || (i >= 'a' && i <= 'z') || (i >= 'A' && i <= 'Z') || i == '_') {
+                    bits.set(i);
+                }
+            }
+            break;
+        case 's':
+            bits.set(' '); bits.set('\t'); bits.set('\r'); bits.set('\n'); bits.set('\v'); bits.set('\f');
+            break;
+        case 'r': bits.set('\r'); break;
+        case 'n': bits.set('\n'); break;
+        case 't': bits.set('\t'); break;
+        case 'x':
+            {
+                int value = 0;
+                for(int i = 0; i < 2; ++i) {
+                    const char h = _pos < _pattern.size() ? _pattern[_pos++] : 0;
+                    if (h >= '0' && h <= '9')       value = value * 16 + h - '0';
+                    else if (h >= 'a' && h <= 'f')  value = value * 16 + h - 'a' + 10;
+                    else if (h >= 'A' && h <= 'F')  value = value * 16 + h - 'A' + 10;
+                    else throw std::runtime_error("Invalid hex escape in pattern.");
+                }
+                bits.set(value);
+            }
+            break;
+        default:
+            bits.set(static_cast<uint8_t>(c));
+            break;
+        }
+        return bits;
+    }
+
+    /// [...], the bracket is consumed
+    std::bitset<256> characterClass()
+    {
+        std::bitset<256> bits;
+        const bool negate = peek('^');
+        if (negate) {
+            ++_pos;
+        }
+        bool first = true;
+        while(first || !peek(']')) {
+            if (_pos == _pattern.size()) {
+                throw std::runtime_error("Unterminated class in pattern.");
+            }
+            first = false;
+            const char c = _pattern[_pos++];
+            std::bitset<256> element;
+            if (c == '\\') {
+                element = escape();
+            } else {
+                element.set(static_cast<uint8_t>(c));
+            }
+            if (element.count() == 1 && peek('-') && _pos + 1 < _pattern.size() && _pattern[_pos + 1] != ']') {
+                /// range, from the single byte of the element
+                ++_pos;
+                size_t low = 0;
+                while(!element.test(low)) {
+                    ++low;
+                }
+                const char h = _pattern[_pos++];
+                const size_t high = h == '\\' ? 0 : static_cast<uint8_t>(h);
+                if (h == '\\' || high < low) {
+                    throw std::runtime_error("Invalid range in pattern.");
+                }
+                for(size_t i = low; i <= high; ++i) {
+                    element.set(i);
+                }
+            }
+            bits |= element;
+        }
+        ++_pos;
+        return negate ? ~bits : bits;
+    }
+
+    const std::string &     _pattern;
+    size_t                  _pos;
+    std::vector<Node> &     _nfa;
+};
+
+Pattern::Pattern(const std::string & pattern, Syntax syntax) :
+    _pattern(pattern),
+    _first(-1)
+{
+    if (pattern.empty()) {
+        throw std::runtime_error("Empty pattern.");
+    }
+    std::vector<Node> nfa;
+    Parser parser(pattern, nfa);
+    Fragment fragment = syntax == LITERAL ? parser.literal() : parser.regex();
+
+    Node accept;
+    accept.kind = Node::ACCEPT;
+    accept.out  = Unset;
+    accept.out1 = Unset;
+    nfa.push_back(accept);
+    parser.patch(fragment, nfa.size() - 1);
+    compile(nfa, fragment.start);
+}
+
+void Pattern::closure(const std::vector<Node> & nfa, size_t index, std::vector<bool> & seen, std::vector<size_t> & set)
+{
+    if (index == Unset || seen[index]) {
+        return;
+    }
+    seen[index] = true;
+    if (nfa[index].kind == Node::SPLIT) {
+        closure(nfa, nfa[index].out, seen, set);
+        closure(nfa, nfa[index].out1, seen, set);
+    } else {
+        set.push_back(index);
+    }
+}
+
+void Pattern::compile(const std::vector<Node> & nfa, size_t start)
+{
+    /// subset construction, every state also contains the start so that
+    /// a match can begin at any byte
+    std::vector<bool> seen(nfa.size());
+    std::vector<size_t> initial;
+    closure(nfa, start, seen, initial);
+    std::sort(initial.begin(), initial.end());
+
+    std::vector<std::vector<size_t> > states(1, initial);
+    std::map<std::vector<size_t>, uint32_t> ids;
+    ids[initial] = 0;
+    std::vector<bool> accepting(1, false);
+    for(size_t i = 0; i < initial.size(); ++i) {
+        if (nfa[initial[i]].kind == Node::ACCEPT) {
+            throw std::runtime_error("The pattern matches the empty string.");
+        }
+    }
+
+    for(size_t state = 0; state < states.size(); ++state) {
+        _table.resize(states.size() * 256, 0);
+        if (accepting[state]) {
+            /// scan() stops at an accepting state
+            continue;
+        }
+        for(int b = 0; b < 256; ++b) {
+            std::fill(seen.begin(), seen.end(), false);
+            std::vector<size_t> next;
+            for(size_t i = 0; i < initial.size(); ++i) {
+                seen[initial[i]] = true;
+                next.push_back(initial[i]);
+            }
+            const std::vector<size_t> & current = states[state];
+            for(size_t i = 0; i < current.size(); ++i) {
+                const Node & node = nfa[current[i]];
+                if (node.kind == Node::SET && node.set.test(b)) {
+                    closure(nfa, node.out, seen, next);
+                }
+            }
+            std::sort(next.begin(), next.end());
+
+            std::map<std::vector<size_t>, uint32_t>::const_iterator it = ids.find(next);
+            uint32_t id;
+            if (it == ids.end()) {
+                if (states.size() == MaxStates) {
+                    throw std::runtime_error("The pattern is too complex.");
+                }
+                id = static_cast<uint32_t>(states.size());
+                ids[next] = id;
+                states.push_back(next);
+                bool accept = false;
+                for(size_t i = 0; i < next.size(); ++i) {
+                    accept |= nfa[next[i]].kind == Node::ACCEPT;
+                }
+                accepting.push_back(accept);
+                _table.resize(states.size() * 256, 0);
+            } else {
+                id = it->second;
+            }
+            _table[state * 256 + b] = id | (accepting[id] ? Accept : 0);
+        }
+    }
+
+    /// a single byte leaving the start state is found with memchr
+    size_t leaving = 0;
+    for(int b = 0; b < 256; ++b) {
+        if (_table[b] != Start) {
+            ++leaving;
+            _first = b;
+        }
+    }
+    if (leaving != 1) {
+        _first = -1;
+    }
+}
+
+size_t Pattern::scan(const uint8_t * data, size_t size, uint32_t & state) const
+{
+    uint32_t current = state;
+    for(size_t i = 0; i < size;) {
+        if (current == Start && _first >= 0) {
+            const void * hit = memchr(data + i, _first, size - i);
+            if (!hit) {
+                break;
+            }
+            i = static_cast<const uint8_t *>(hit) - data;
+        }
+        const uint32_t next = _table[current * 256 + data[i++]];
+        if (next & Accept) {
+            state = Start;
+            return i;
+        }
+        current = next;
+    }
+    state = current;
+    return npos;
+}
+
+} // namespace runtime
+
+} // namespace fuzzer
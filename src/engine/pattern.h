@@ -0,0 +1,82 @@
+#ifndef _PATTERN_H_
+#define _PATTERN_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+namespace fuzzer {
+
+namespace runtime {
+
+///
+/// \class  Pattern
+/// \brief  Pattern compiled into a DFA that finds the first match in a
+///         byte stream. The stream is scanned in place, in chunks as it is
+///         received, with one table lookup per byte.
+///
+///         Regular expressions support literals, '.', classes ([a-z],
+///         [^\r\n]), the escapes \d \w \s \r \n \t \xNN, grouping,
+///         alternation and the * + ? quantifiers. Matches aren't anchored.
+///
+class Pattern
+{
+public:
+    enum Syntax {
+        LITERAL,
+        REGEX
+    };
+
+    /// largest number of DFA states
+    static const size_t MaxStates = 4096;
+    /// state before any byte has been scanned
+    static const uint32_t Start = 0;
+    /// returned by scan() if there is no match
+    static const size_t npos = ~size_t(0);
+
+    ///
+    /// \brief  Compiles the pattern, throws a std::runtime_error if it is
+    ///         malformed, matches the empty string or needs more than
+    ///         MaxStates states.
+    ///
+    Pattern(const std::string & pattern, Syntax syntax);
+
+    ///
+    /// \brief  Scans \p size bytes, continuing from \p state which is
+    ///         updated for the next chunk.
+    ///
+    /// \return The offset just past the end of the first match, or npos.
+    ///         The state is reset to Start after a match.
+    ///
+    size_t scan(const uint8_t * data, size_t size, uint32_t & state) const;
+
+    /// number of DFA states
+    size_t states() const { return _table.size() / 256; }
+
+    const std::string & pattern() const { return _pattern; }
+
+private:
+    struct Node;
+    struct Fragment;
+    class Parser;
+
+    void compile(const std::vector<Node> & nfa, size_t start);
+
+    /// adds \p index and the nodes reachable from it through SPLIT nodes
+    static void closure(const std::vector<Node> & nfa, size_t index,
+        std::vector<bool> & seen, std::vector<size_t> & set);
+
+    /// set in a transition to an accepting state
+    static const uint32_t Accept = 0x80000000;
+
+    std::string             _pattern;
+    std::vector<uint32_t>   _table;     //< 256 transitions per state
+    int                     _first;     //< the only byte leaving the start state, or -1
+};
+
+} // namespace runtime
+
+} // namespace fuzzer
+
+#endif
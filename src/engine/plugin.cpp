@@ -0,0 +1,214 @@
+#include "plugin.h"
+#include <sstream>
+#include <stdexcept>
+
+#ifdef WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+namespace fuzzer {
+
+namespace runtime {
+
+static void Unload(const void * library)
+{
+#ifdef WIN32
+    FreeLibrary((HMODULE) library);
+#else
+    dlclose(const_cast<void *>(library));
+#endif
+}
+
+PluginRegistry & PluginRegistry::instance()
+{
+    static PluginRegistry registry;
+    return registry;
+}
+
+PluginRegistry::PluginRegistry()
+{
+}
+
+size_t PluginRegistry::load(const char * filename)
+{
+    std::shared_ptr<const void> library;
+    fuzzengine_plugin_fn entry;
+#ifdef WIN32
+    HMODULE module = LoadLibraryA(filename);
+    if (!module) {
+        throw std::runtime_error("Failed to load plugin.");
+    }
+    library = std::shared_ptr<const void>(module, Unload);
+    entry = (fuzzengine_plugin_fn) GetProcAddress(module, FUZZENGINE_PLUGIN_ENTRY);
+#else
+    void * handle = dlopen(filename, RTLD_NOW | RTLD_LOCAL);
+    if (!handle) {
+        throw std::runtime_error("Failed to load plugin.");
+    }
+    library = std::shared_ptr<const void>(handle, Unload);
+    entry = (fuzzengine_plugin_fn) dlsym(handle, FUZZENGINE_PLUGIN_ENTRY);
+#endif
+    if (!entry) {
+        throw std::runtime_error("The plugin doesn't export " FUZZENGINE_PLUGIN_ENTRY "().");
+    }
+    size_t count = 0;
+    const fuzzengine_mutator * mutators = entry(FUZZENGINE_PLUGIN_ABI, &count);
+    if (!mutators) {
+        throw std::runtime_error("The plugin was built for another ABI.");
+    }
+    add(mutators, count, library);
+    return count;
+}
+
+void PluginRegistry::add(const fuzzengine_mutator * mutators, size_t count, std::shared_ptr<const void> owner)
+{
+    for(size_t i = 0; i < count; ++i) {
+        const fuzzengine_mutator & mutator = mutators[i];
+        if (!mutator.name || !mutator.create || !mutator.destroy || !mutator.produce) {
+            throw std::runtime_error("Incomplete plugin mutator.");
+        }
+        if (_mutators.find(mutator.name) != _mutators.end()) {
+            throw std::runtime_error("Plugin mutator registered twice.");
+        }
+    }
+    for(size_t i = 0; i < count; ++i) {
+        _mutators[mutators[i].name] = &mutators[i];
+    }
+    if (owner) {
+        _owners.push_back(owner);
+    }
+}
+
+const fuzzengine_mutator * PluginRegistry::find(const std::string & name, uint32_t target) const
+{
+    std::map<std::string, const fuzzengine_mutator *>::const_iterator it = _mutators.find(name);
+    if (it == _mutators.end() || !(it->second->targets & target)) {
+        return nullptr;
+    }
+    return it->second;
+}
+
+PluginMutator::PluginMutator(const fuzzengine_mutator & ops, const uint8_t * seed, size_t size,
+    std::shared_ptr<const void> owner, uint64_t rng, size_t batch, size_t arena) :
+    _ops(ops),
+    _owner(owner),
+    _seed(seed),
+    _size(size),
+    _rng(rng),
+    _state(nullptr),
+    _arena(arena),
+    _sizes(batch),
+    _offsets(batch),
+    _produced(0),
+    _current(0),
+    _first(1),
+    _finished(false)
+{
+    if (!batch || !arena) {
+        throw std::runtime_error("Empty plugin batch.");
+    }
+    create();
+}
+
+PluginMutator::~PluginMutator()
+{
+    if (_state) {
+        _ops.destroy(_state);
+    }
+}
+
+void PluginMutator::create()
+{
+    _state = _ops.create(_seed, _size, _rng);
+    if (!_state) {
+        throw std::runtime_error("Failed to create plugin mutator.");
+    }
+}
+
+size_t PluginMutator::next()
+{
+    if (_finished) {
+        return 0;
+    }
+    _first      += _produced;
+    _current    = 0;
+    _produced   = _ops.produce(_state, _arena.data(), _arena.size(), _sizes.data(), _sizes.size());
+    if (_produced > _sizes.size()) {
+        throw std::runtime_error("Plugin mutator produced too many variants.");
+    }
+    size_t offset = 0;
+    for(size_t i = 0; i < _produced; ++i) {
+        if (_sizes[i] > _arena.size() - offset) {
+            throw std::runtime_error("Plugin mutator wrote past the arena.");
+        }
+        _offsets[i] = offset;
+        offset += _sizes[i];
+    }
+    _finished = !_produced;
+    return _produced;
+}
+
+bool PluginMutator::mutate()
+{
+    if (_finished) {
+        return false;
+    }
+    if (_current + 1 < _produced) {
+        ++_current;
+        return true;
+    }
+    return next() != 0;
+}
+
+bool PluginMutator::finished()
+{
+    return _finished;
+}
+
+void PluginMutator::reset()
+{
+    /// the variants only depend on the seeds, a new state starts over
+    if (_state) {
+        _ops.destroy(_state);
+    }
+    _state      = nullptr;
+    _produced   = 0;
+    _current    = 0;
+    _first      = 1;
+    _finished   = false;
+    create();
+}
+
+void PluginMutator::evaluate(Buffer & buffer)
+{
+    if (!_produced) {
+        buffer.write(_seed, _size);
+        return;
+    }
+    size_t size;
+    const uint8_t * data = variant(_current, size);
+    buffer.write(data, size);
+}
+
+std::string PluginMutator::state(size_t index) const
+{
+    std::stringstream ss;
+    ss << "plugin: " << _ops.name << ", rng=" << _rng << ", variant=" << (_produced ? _first + index : 0);
+    return ss.str();
+}
+
+bool PluginMutator::state(std::string & state) const
+{
+    if (_finished) {
+        return false;
+    }
+    state = this->state(_current);
+    return true;
+}
+
+} // namespace runtime
+
+} // namespace fuzzer
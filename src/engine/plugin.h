@@ -0,0 +1,145 @@
+#ifndef _PLUGIN_H_
+#define _PLUGIN_H_
+
+#include "mutator.h"
+#include "pluginabi.h"
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace fuzzer {
+
+namespace runtime {
+
+///
+/// \class  PluginRegistry
+/// \brief  Process wide registry of custom mutators by name. Libraries are
+///         loaded before the scripts are parsed and stay loaded for the
+///         lifetime of the process.
+///
+class PluginRegistry
+{
+public:
+    static PluginRegistry & instance();
+
+    ///
+    /// \brief  Loads a plugin library and registers its mutators. Throws a
+    ///         std::runtime_error if the library can't be loaded, doesn't
+    ///         export fuzzengine_plugin() or was built for another ABI.
+    ///
+    /// \return The number of mutators registered.
+    ///
+    size_t load(const char * filename);
+
+    ///
+    /// \brief  Registers \p count mutators. \p owner keeps the table alive,
+    ///         it may be empty for a static table.
+    ///
+    void add(const fuzzengine_mutator * mutators, size_t count,
+        std::shared_ptr<const void> owner = std::shared_ptr<const void>());
+
+    ///
+    /// \brief  The mutator registered as \p name for \p target, one of the
+    ///         FUZZENGINE_PLUGIN_ targets, or nullptr.
+    ///
+    const fuzzengine_mutator * find(const std::string & name, uint32_t target) const;
+
+private:
+    PluginRegistry();
+    PluginRegistry(const PluginRegistry &);
+    PluginRegistry & operator=(const PluginRegistry &);
+
+    std::map<std::string, const fuzzengine_mutator *>   _mutators;
+    std::vector<std::shared_ptr<const void> >           _owners;
+};
+
+///
+/// \class  PluginMutator
+/// \brief  Mutator backed by a plugin. Variants are produced in batches
+///         into an arena that is allocated once, the plugin is called once
+///         per batch. The first mutation is the seed itself, like the
+///         initial value of the other mutators.
+///
+class PluginMutator : public Mutator
+{
+public:
+    static const size_t DefaultBatch = 64;
+    static const size_t DefaultArena = 64 * 1024;
+
+    ///
+    /// \brief  Constructor
+    ///
+    /// \param [in] seed    The seed, it isn't copied.
+    /// \param [in] owner   Keeps the seed alive, may be empty.
+    /// \param [in] rng     Seed of the random choices of the plugin.
+    /// \param [in] arena   Size of the arena, the largest variant.
+    ///
+    PluginMutator(const fuzzengine_mutator &, const uint8_t * seed, size_t size,
+        std::shared_ptr<const void> owner = std::shared_ptr<const void>(),
+        uint64_t rng = 0, size_t batch = DefaultBatch, size_t arena = DefaultArena);
+    ~PluginMutator();
+
+    virtual bool mutate();
+    virtual bool finished();
+    virtual void reset();
+
+    ///
+    /// \brief  Writes the current variant.
+    ///
+    virtual void evaluate(Buffer &);
+
+    /// index of the current variant, zero for the seed
+    size_t position() const { return _produced ? _first + _current : 0; }
+
+    ///
+    /// \brief  Produces the next batch with a single call to the plugin,
+    ///         the first variant of the batch becomes the current one.
+    ///
+    /// \return The number of variants in the batch, zero when finished.
+    ///
+    size_t next();
+
+    ///
+    /// \brief  Variant \p index of the batch, valid until the next batch.
+    ///
+    const uint8_t * variant(size_t index, size_t & size) const
+    {
+        size = _sizes[index];
+        return &_arena[_offsets[index]];
+    }
+
+    ///
+    /// \brief  Describes variant \p index of the batch.
+    ///
+    std::string state(size_t index) const;
+
+    /// describes the current variant
+    bool state(std::string &) const;
+
+private:
+    PluginMutator(const PluginMutator &);
+    PluginMutator & operator=(const PluginMutator &);
+
+    void create();
+
+    const fuzzengine_mutator &  _ops;
+    std::shared_ptr<const void> _owner;
+    const uint8_t *             _seed;
+    size_t                      _size;
+    uint64_t                    _rng;
+    void *                      _state;     //< state of the plugin
+    std::vector<uint8_t>        _arena;
+    std::vector<size_t>         _sizes;     //< size of each variant in the batch
+    std::vector<size_t>         _offsets;   //< offset of each variant in the arena
+    size_t                      _produced;  //< variants in the batch
+    size_t                      _current;   //< current variant in the batch
+    size_t                      _first;     //< index of the first variant in the batch
+    bool                        _finished;
+};
+
+} // namespace runtime
+
+} // namespace fuzzer
+
+#endif
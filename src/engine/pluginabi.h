@@ -0,0 +1,64 @@
+#ifndef _PLUGINABI_H_
+#define _PLUGINABI_H_
+
+/*
+ * Interface of custom mutators loaded from shared libraries. Plain C so
+ * that plugins can be built without the engine sources.
+ *
+ * A plugin exports fuzzengine_plugin(), which returns its table of
+ * mutators. Each mutator is created on a seed, the initial string of a
+ * template field or the contents of a file, and then produces variants in
+ * batches: the engine passes an arena and the plugin writes as many
+ * variants as fit back to back, with the size of each in sizes[]. A batch
+ * is one call through the boundary and no allocations on either side.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define FUZZENGINE_PLUGIN_ABI       1
+
+/* targets of a mutator */
+#define FUZZENGINE_PLUGIN_FIELD     0x01    /* template fields, plugin("name", "seed") */
+#define FUZZENGINE_PLUGIN_FILE      0x02    /* files, FileFuzzer::AddPlugin() */
+
+#ifdef _WIN32
+#define FUZZENGINE_PLUGIN_EXPORT    __declspec(dllexport)
+#else
+#define FUZZENGINE_PLUGIN_EXPORT    __attribute__((visibility("default")))
+#endif
+
+struct fuzzengine_mutator
+{
+    const char *    name;
+    uint32_t        targets;
+
+    /*
+     * Creates the state of a mutator on size bytes at seed, the seed stays
+     * valid until destroy. The variants must only depend on the seed and
+     * rng_seed, so that a crash can be reproduced. Returns NULL on failure.
+     */
+    void *  (*create)(const uint8_t * seed, size_t size, uint64_t rng_seed);
+
+    void    (*destroy)(void * state);
+
+    /*
+     * Writes up to count variants back to back into the capacity bytes at
+     * arena and the size of each to sizes. A variant that doesn't fit is
+     * left for the next call. Returns the number of variants written, zero
+     * when the mutator is finished. Returning zero with more variants left
+     * is an error, a single variant must fit in the arena.
+     */
+    size_t  (*produce)(void * state, uint8_t * arena, size_t capacity, size_t * sizes, size_t count);
+};
+
+/*
+ * Entry point, returns the mutators of the plugin and their number in
+ * count. abi is FUZZENGINE_PLUGIN_ABI of the engine, a plugin built for
+ * another version returns NULL.
+ */
+typedef const struct fuzzengine_mutator * (*fuzzengine_plugin_fn)(uint32_t abi, size_t * count);
+
+#define FUZZENGINE_PLUGIN_ENTRY     "fuzzengine_plugin"
+
+#endif
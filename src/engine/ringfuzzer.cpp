@@ -0,0 +1,87 @@
+#ifdef __linux__
+
+#include "ringfuzzer.h"
+#include "ioerror.h"
+#include <iostream>
+
+using namespace std;
+
+namespace fuzzer {
+
+namespace runtime {
+
+///
+/// \brief  Constructor
+///
+RingFuzzer::RingFuzzer(io::RingIpc & ring, execution::IApplicationExecuter * app) :
+    _ring(ring),
+    _app(app)
+{
+}
+
+void RingFuzzer::Launch()
+{
+    if (!_app || _app->IsAlive()) {
+        return;
+    }
+    /// nobody uses the rings while the application is dead
+    _ring.clear();
+    if (!_app->Launch()) {
+        std::cout << "Failed to launch application." << std::endl;
+    }
+}
+
+bool RingFuzzer::Died()
+{
+    if (!_app || _app->IsAlive()) {
+        return false;
+    }
+    int statusCode = 0;
+    execution::TerminationReason reason = execution::Term_Other;
+    _app->GetStatusCode(statusCode, reason);
+    std::cout << "App exited with " << statusCode << ", " << execution::DescribeTermination(reason) << std::endl;
+    return true;
+}
+
+void RingFuzzer::Execute(const bytecode::Script & script)
+{
+    Attach(&_ring);
+    try {
+        _vm.Execute( script );
+    } catch(io::IoException & err) {
+        /// error while communicating with peer
+        std::cout << "Caught I/O exception: " << err.what() << std::endl;
+    } catch(std::runtime_error & err) {
+        std::cout << "Caught runtime error: " << err.what() << std::endl;
+    } catch(...) {
+        /// caught an exception while executing the script
+        std::cout << "Caught unknown exception." << std::endl;
+    }
+    Attach(nullptr);
+}
+
+///
+/// \brief  Performs random fuzzing
+///
+void RingFuzzer::RunHavoc(const bytecode::Script & script, uint64_t Seed,
+    size_t Worker, uint64_t Cases)
+{
+    Compile(script);
+    HavocScheduler scheduler(script, Seed, Worker);
+    for(uint64_t i = 0; i < Cases; ++i) {
+        scheduler.next();
+        /// the description regenerates the case with HavocScheduler::apply
+        std::cout << scheduler.describe() << std::endl;
+        Launch();
+        /// responses to the previous case aren't read by this one
+        _ring.discard();
+        Execute(script);
+        Died();
+    }
+}
+
+} // namespace runtime
+
+} // namespace fuzzer
+
+#endif // __linux__
@@ -0,0 +1,59 @@
+#ifndef _RINGFUZZER_H_
+#define _RINGFUZZER_H_
+
+#ifdef __linux__
+
+#include "fuzzer.h"
+#include "ringipc.h"
+#include "appexec.h"
+#include "script.h"
+#include "havoc.h"
+
+namespace fuzzer {
+
+namespace runtime {
+
+///
+/// \class  RingFuzzer
+/// \brief  Fuzzes a target that links src/harness/ring.c, over the shared
+///         memory rings of a RingIpc instead of a socket. The target keeps
+///         running from one test case to the next, it is launched when it
+///         isn't running and its crashes are reported. The executer passes
+///         the rings to the target, see LinuxExecuter::SetRing().
+///
+class RingFuzzer : public Fuzzer
+{
+public:
+    ///
+    /// \brief  Constructor
+    ///
+    RingFuzzer(io::RingIpc &, execution::IApplicationExecuter * app = nullptr);
+
+    ///
+    /// \brief  Performs random fuzzing, \p Cases test cases scheduled by a
+    ///         HavocScheduler with master seed \p Seed. Each case is logged
+    ///         with its id before it runs.
+    ///
+    void RunHavoc(const bytecode::Script &, uint64_t Seed, size_t Worker = 0,
+        uint64_t Cases = ~0ULL);
+
+private:
+    /// launches the application with empty rings if it isn't running
+    void Launch();
+
+    /// true if the application has died, which is reported
+    bool Died();
+
+    /// runs the script once over the rings
+    void Execute(const bytecode::Script &);
+
+    io::RingIpc &                       _ring;
+    execution::IApplicationExecuter *   _app;
+};
+
+} // namespace runtime
+
+} // namespace fuzzer
+
+#endif // __linux__
+#endif
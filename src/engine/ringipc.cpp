@@ -0,0 +1,111 @@
+#ifdef __linux__
+
+#include "ringipc.h"
+#include "ioerror.h"
+#include <sstream>
+#include <stdexcept>
+#include <sys/mman.h>
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+
+namespace fuzzer {
+
+namespace io {
+
+const char * RingIpc::EnvironmentVariable = "FUZZENGINE_RING_FD";
+
+RingIpc::RingIpc() :
+    _timeout(2000),
+    _owner(nullptr)
+{
+    /// close-on-exec, only the target of the owner inherits the descriptor
+    _fd = static_cast<int>(syscall(SYS_memfd_create, "fuzzengine-ring", MFD_CLOEXEC));
+    if (_fd < 0) {
+        throw std::runtime_error("Failed to create the ring memory.");
+    }
+    if (ftruncate(_fd, sizeof(struct fuzzengine_rings)) != 0) {
+        close(_fd);
+        throw std::runtime_error("Failed to size the ring memory.");
+    }
+    void * map = mmap(NULL, sizeof(struct fuzzengine_rings), PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+    if (map == MAP_FAILED) {
+        close(_fd);
+        throw std::runtime_error("Failed to map the ring memory.");
+    }
+    _rings = static_cast<struct fuzzengine_rings *>(map);
+}
+
+RingIpc::~RingIpc()
+{
+    munmap(_rings, sizeof(struct fuzzengine_rings));
+    close(_fd);
+}
+
+bool RingIpc::write(const void * Source, size_t count)
+{
+    return fuzzengine_ring_send(&_rings->to_target, Source, count, static_cast<int>(_timeout)) == count;
+}
+
+bool RingIpc::read(void * Dst, size_t count)
+{
+    return receive(Dst, count, count) == count;
+}
+
+size_t RingIpc::receive(void * Dst, size_t min, size_t max)
+{
+    const size_t received = fuzzengine_ring_recv(&_rings->to_fuzzer, Dst, min, max, static_cast<int>(_timeout));
+    if (received < min) {
+        throw IoException("Read operation timed out.");
+    }
+    return received;
+}
+
+std::string RingIpc::name() const
+{
+    std::stringstream ss;
+    ss << _fd;
+    return ss.str();
+}
+
+void RingIpc::clear()
+{
+    /// only the distance between head and tail matters
+    fuzzengine_ring_store(&_rings->to_target.tail, _rings->to_target.head);
+    fuzzengine_ring_store(&_rings->to_fuzzer.tail, _rings->to_fuzzer.head);
+    fuzzengine_ring_store(&_rings->to_target.readers, 0);
+    fuzzengine_ring_store(&_rings->to_target.writers, 0);
+    fuzzengine_ring_store(&_rings->to_fuzzer.readers, 0);
+    fuzzengine_ring_store(&_rings->to_fuzzer.writers, 0);
+}
+
+void RingIpc::discard()
+{
+    /// read without waiting, which also wakes a target waiting for space
+    uint8_t stale[256];
+    while(fuzzengine_ring_recv(&_rings->to_fuzzer, stale, 0, sizeof(stale), 0) > 0) {
+    }
+}
+
+bool RingIpc::claim(const void * owner)
+{
+    if (_owner && _owner != owner) {
+        return false;
+    }
+    _owner = owner;
+    return true;
+}
+
+void RingIpc::release(const void * owner)
+{
+    if (_owner == owner) {
+        _owner = nullptr;
+    }
+}
+
+} // namespace io
+
+} // namespace fuzzer
+
+#endif // __linux__
@@ -0,0 +1,103 @@
+#ifndef _RINGIPC_H_
+#define _RINGIPC_H_
+
+#ifdef __linux__
+
+#include "io.h"
+#include "ringtable.h"
+#include <string>
+
+namespace fuzzer {
+
+namespace io {
+
+///
+/// \class  RingIpc
+/// \brief  Ipc over a pair of shared memory rings, see ringtable.h. The
+///         memory is a close-on-exec memfd, that the LinuxExecuter the
+///         rings are claimed by passes on to its target. The descriptor
+///         number is passed in the environment variable EnvironmentVariable
+///         and src/harness/ring.c attaches to it. Data isn't copied by the
+///         kernel, and a side only makes a system call when the other one
+///         sleeps.
+///
+class RingIpc : public Ipc
+{
+public:
+    static const char * EnvironmentVariable;
+
+    ///
+    /// \brief  Creates and maps the rings. Throws a std::runtime_error if
+    ///         the memory can't be created.
+    ///
+    RingIpc();
+
+    ///
+    /// \brief  Destructor, performs the required cleanup
+    ///
+    ~RingIpc();
+
+    ///
+    /// \brief  Writes to the target, waiting while the ring is full. Fails
+    ///         when the target doesn't read within the timeout.
+    ///
+    virtual bool write(const void * Source, size_t count);
+
+    ///
+    /// \brief  Reads from the target. Throws a IoException on timeout.
+    ///
+    virtual bool read(void * Dst, size_t count);
+
+    ///
+    /// \brief  Reads at least \p min bytes, and whatever else has been
+    ///         written up to \p max. Throws a IoException on timeout.
+    ///
+    virtual size_t receive(void * Dst, size_t min, size_t max);
+
+    /// timeout of the reads and writes, in ms
+    void SetTimeout(size_t TimeOut) { _timeout = TimeOut; }
+
+    /// descriptor number, as passed to the target
+    std::string name() const;
+
+    /// descriptor of the memory, inherited by the target only
+    int descriptor() const { return _fd; }
+
+    ///
+    /// \brief  Empties both rings, before a target is launched. Neither
+    ///         side may be using them.
+    ///
+    void clear();
+
+    ///
+    /// \brief  Drops what the target has written and wasn't read, so that
+    ///         a test case starts afresh while the target keeps running.
+    ///
+    void discard();
+
+    ///
+    /// \brief  Reserves the rings for \p owner, they connect the fuzzer to
+    ///         one target at a time. Returns false if another owner has
+    ///         them.
+    ///
+    bool claim(const void * owner);
+
+    /// gives up the rings, if \p owner has them
+    void release(const void * owner);
+
+private:
+    RingIpc(const RingIpc &);
+    RingIpc & operator=(const RingIpc &);
+
+    int                         _fd;
+    struct fuzzengine_rings *   _rings;
+    size_t                      _timeout;
+    const void *                _owner;
+};
+
+} // namespace io
+
+} // namespace fuzzer
+
+#endif // __linux__
+#endif // _RINGIPC_H_
@@ -0,0 +1,178 @@
+#ifndef _RINGTABLE_H_
+#define _RINGTABLE_H_
+
+/*
+ * Layout of the ring pair shared with harnesses, and the ring operations.
+ * Plain C so that the target side library can include it. Linux only, the
+ * sleeping side of a ring waits on a futex in the shared memory.
+ */
+
+#ifdef __linux__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+/* bytes in each direction, a power of two */
+#define FUZZENGINE_RING_SIZE        (1u << 16)
+
+/* polls of the other side before sleeping */
+#define FUZZENGINE_RING_SPIN        256
+
+/*
+ * Single producer, single consumer ring. head and tail count the bytes
+ * written and read, modulo 2^32. A side that has to wait sets its flag and
+ * sleeps on the other side's counter, which wakes it after an update when
+ * the flag is set. The counters are on separate cache lines.
+ */
+struct fuzzengine_ring
+{
+    volatile uint32_t   head;       /* written by the producer */
+    volatile uint32_t   readers;    /* the consumer sleeps on head */
+    uint8_t             pad0[56];
+    volatile uint32_t   tail;       /* written by the consumer */
+    volatile uint32_t   writers;    /* the producer sleeps on tail */
+    uint8_t             pad1[56];
+    uint8_t             data[FUZZENGINE_RING_SIZE];
+};
+
+/*
+ * The shared memory, a memfd whose descriptor number the target inherits
+ * in FUZZENGINE_RING_FD.
+ */
+struct fuzzengine_rings
+{
+    struct fuzzengine_ring  to_target;
+    struct fuzzengine_ring  to_fuzzer;
+};
+
+static inline uint32_t fuzzengine_ring_load(volatile uint32_t * word)
+{
+    return __atomic_load_n(word, __ATOMIC_SEQ_CST);
+}
+
+static inline void fuzzengine_ring_store(volatile uint32_t * word, uint32_t value)
+{
+    __atomic_store_n(word, value, __ATOMIC_SEQ_CST);
+}
+
+static inline void fuzzengine_ring_wake(volatile uint32_t * word)
+{
+    syscall(SYS_futex, word, FUTEX_WAKE, 1, NULL, NULL, 0);
+}
+
+/*
+ * Waits while *word equals value, at most timeout_ms ms or forever if it is
+ * negative. Returns -1 on timeout, 0 when it may have changed.
+ */
+static inline int fuzzengine_ring_await(volatile uint32_t * word, volatile uint32_t * flag,
+    uint32_t value, int timeout_ms)
+{
+    struct timespec timeout, * ptimeout = NULL;
+    int spin, res = 0;
+
+    for(spin = 0; spin < FUZZENGINE_RING_SPIN; ++spin) {
+        if (fuzzengine_ring_load(word) != value) {
+            return 0;
+        }
+    }
+    if (timeout_ms >= 0) {
+        timeout.tv_sec  = timeout_ms / 1000;
+        timeout.tv_nsec = (long) (timeout_ms % 1000) * 1000000L;
+        ptimeout        = &timeout;
+    }
+    fuzzengine_ring_store(flag, 1);
+    /* an update after the flag was set wakes us, one before it is seen here */
+    if (fuzzengine_ring_load(word) == value &&
+        syscall(SYS_futex, word, FUTEX_WAIT, value, ptimeout, NULL, 0) != 0 && errno == ETIMEDOUT)
+    {
+        res = -1;
+    }
+    fuzzengine_ring_store(flag, 0);
+    return res;
+}
+
+/* copies what fits of size bytes into the ring, returns the number copied */
+static inline size_t fuzzengine_ring_put(struct fuzzengine_ring * ring, const void * src, size_t size)
+{
+    const uint32_t head     = ring->head;
+    const size_t space      = FUZZENGINE_RING_SIZE - (uint32_t) (head - fuzzengine_ring_load(&ring->tail));
+    const size_t count      = size < space ? size : space;
+    const size_t offset     = head & (FUZZENGINE_RING_SIZE - 1);
+    const size_t first      = count < FUZZENGINE_RING_SIZE - offset ? count : FUZZENGINE_RING_SIZE - offset;
+
+    if (!count) {
+        return 0;
+    }
+    memcpy(ring->data + offset, src, first);
+    memcpy(ring->data, (const uint8_t *) src + first, count - first);
+    fuzzengine_ring_store(&ring->head, head + (uint32_t) count);
+    if (fuzzengine_ring_load(&ring->readers)) {
+        fuzzengine_ring_wake(&ring->head);
+    }
+    return count;
+}
+
+/* copies at most size bytes out of the ring, returns the number copied */
+static inline size_t fuzzengine_ring_get(struct fuzzengine_ring * ring, void * dst, size_t size)
+{
+    const uint32_t tail     = ring->tail;
+    const size_t available  = (uint32_t) (fuzzengine_ring_load(&ring->head) - tail);
+    const size_t count      = size < available ? size : available;
+    const size_t offset     = tail & (FUZZENGINE_RING_SIZE - 1);
+    const size_t first      = count < FUZZENGINE_RING_SIZE - offset ? count : FUZZENGINE_RING_SIZE - offset;
+
+    if (!count) {
+        return 0;
+    }
+    memcpy(dst, ring->data + offset, first);
+    memcpy((uint8_t *) dst + first, ring->data, count - first);
+    fuzzengine_ring_store(&ring->tail, tail + (uint32_t) count);
+    if (fuzzengine_ring_load(&ring->writers)) {
+        fuzzengine_ring_wake(&ring->tail);
+    }
+    return count;
+}
+
+/* writes size bytes, returns the number written, less on timeout */
+static inline size_t fuzzengine_ring_send(struct fuzzengine_ring * ring, const void * src, size_t size,
+    int timeout_ms)
+{
+    size_t sent = 0;
+    for(;;) {
+        sent += fuzzengine_ring_put(ring, (const uint8_t *) src + sent, size - sent);
+        if (sent == size) {
+            return sent;
+        }
+        /* full, wait for the consumer to read */
+        if (fuzzengine_ring_await(&ring->tail, &ring->writers, ring->head - FUZZENGINE_RING_SIZE, timeout_ms) < 0) {
+            return sent;
+        }
+    }
+}
+
+/* reads at least min and at most max bytes, returns the number read, less on timeout */
+static inline size_t fuzzengine_ring_recv(struct fuzzengine_ring * ring, void * dst, size_t min, size_t max,
+    int timeout_ms)
+{
+    size_t received = 0;
+    for(;;) {
+        received += fuzzengine_ring_get(ring, (uint8_t *) dst + received, max - received);
+        if (received >= min) {
+            return received;
+        }
+        /* empty, wait for the producer to write */
+        if (fuzzengine_ring_await(&ring->head, &ring->readers, ring->tail, timeout_ms) < 0) {
+            return received;
+        }
+    }
+}
+
+#endif /* __linux__ */
+
+#endif
@@ -0,0 +1,236 @@
+#include "rope.h"
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+
+namespace fuzzer {
+
+namespace runtime {
+
+///
+/// \brief  A piece of the rope and the subtree below it.
+///
+struct Rope::Node
+{
+    NodePtr                         left;
+    NodePtr                         right;
+    std::shared_ptr<const void>     owner;      //< keeps data alive
+    const uint8_t *                 data;
+    size_t                          length;     //< bytes in this piece
+    size_t                          size;       //< bytes in the subtree
+    size_t                          pieces;     //< pieces in the subtree
+    uint32_t                        priority;   //< treap heap order
+};
+
+///
+/// \brief  Priorities only affect the shape of the tree, not its contents,
+///         so a hashed counter is good enough and needs no locking.
+///
+static uint32_t NextPriority()
+{
+    static std::atomic<uint64_t> counter(0);
+    uint64_t x = counter.fetch_add(0x9e3779b97f4a7c15ULL, std::memory_order_relaxed);
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return static_cast<uint32_t>(x ^ (x >> 31));
+}
+
+Rope::Rope()
+{
+}
+
+Rope::Rope(const uint8_t * data, size_t size, std::shared_ptr<const void> owner)
+{
+    if (size) {
+        _root = leaf(owner, data, size);
+    }
+}
+
+Rope::NodePtr Rope::make(const NodePtr & left, const NodePtr & right,
+    const std::shared_ptr<const void> & owner, const uint8_t * data, size_t length, uint32_t priority)
+{
+    std::shared_ptr<Node> node = std::make_shared<Node>();
+    node->left      = left;
+    node->right     = right;
+    node->owner     = owner;
+    node->data      = data;
+    node->length    = length;
+    node->priority  = priority;
+    node->size      = length + (left ? left->size : 0) + (right ? right->size : 0);
+    node->pieces    = 1 + (left ? left->pieces : 0) + (right ? right->pieces : 0);
+    return node;
+}
+
+Rope::NodePtr Rope::make(const NodePtr & left, const NodePtr & right, const Node & piece)
+{
+    return make(left, right, piece.owner, piece.data, piece.length, piece.priority);
+}
+
+Rope::NodePtr Rope::leaf(const std::shared_ptr<const void> & owner, const uint8_t * data, size_t length)
+{
+    return make(NodePtr(), NodePtr(), owner, data, length, NextPriority());
+}
+
+///
+/// \brief  Splits at \p pos. \p node is taken by value, so \p left or
+///         \p right may be the variable it came from.
+///
+void Rope::split(NodePtr node, size_t pos, NodePtr & left, NodePtr & right)
+{
+    if (!node) {
+        left.reset();
+        right.reset();
+        return;
+    }
+    const size_t before = node->left ? node->left->size : 0;
+    if (pos <= before) {
+        NodePtr middle;
+        split(node->left, pos, left, middle);
+        right = make(middle, node->right, *node);
+    } else if (pos >= before + node->length) {
+        NodePtr middle;
+        split(node->right, pos - before - node->length, middle, right);
+        left = make(node->left, middle, *node);
+    } else {
+        /// cut the piece in two, both halves keep the priority
+        const size_t cut = pos - before;
+        left    = make(node->left, NodePtr(), node->owner, node->data, cut, node->priority);
+        right   = make(NodePtr(), node->right, node->owner, node->data + cut, node->length - cut, node->priority);
+    }
+}
+
+Rope::NodePtr Rope::merge(const NodePtr & left, const NodePtr & right)
+{
+    if (!left) {
+        return right;
+    } else if (!right) {
+        return left;
+    }
+    if (left->priority > right->priority) {
+        return make(left->left, merge(left->right, right), *left);
+    }
+    return make(merge(left, right->left), right->right, *right);
+}
+
+size_t Rope::size() const
+{
+    return _root ? _root->size : 0;
+}
+
+size_t Rope::count() const
+{
+    return _root ? _root->pieces : 0;
+}
+
+uint8_t Rope::at(size_t pos) const
+{
+    const Node * node = _root.get();
+    while(node) {
+        const size_t before = node->left ? node->left->size : 0;
+        if (pos < before) {
+            node = node->left.get();
+        } else if (pos < before + node->length) {
+            return node->data[pos - before];
+        } else {
+            pos -= before + node->length;
+            node = node->right.get();
+        }
+    }
+    throw std::out_of_range("Rope position out of range.");
+}
+
+void Rope::insert(size_t pos, const void * data, size_t size)
+{
+    if (!size) {
+        return;
+    }
+    /// inserted bytes are owned by their piece
+    std::shared_ptr<std::vector<uint8_t> > copy = std::make_shared<std::vector<uint8_t> >(
+        static_cast<const uint8_t *>(data), static_cast<const uint8_t *>(data) + size);
+    insert(pos, Rope(leaf(copy, copy->data(), size)));
+}
+
+void Rope::insert(size_t pos, const Rope & rope)
+{
+    if (pos > size()) {
+        throw std::out_of_range("Rope position out of range.");
+    }
+    NodePtr left, right;
+    split(_root, pos, left, right);
+    _root = merge(merge(left, rope._root), right);
+}
+
+void Rope::erase(size_t pos, size_t size)
+{
+    if (pos + size > this->size()) {
+        throw std::out_of_range("Rope range out of range.");
+    }
+    NodePtr left, middle, right;
+    split(_root, pos, left, middle);
+    split(middle, size, middle, right);
+    _root = merge(left, right);
+}
+
+void Rope::overwrite(size_t pos, const void * data, size_t size)
+{
+    erase(pos, size);
+    insert(pos, data, size);
+}
+
+void Rope::duplicate(size_t from, size_t size, size_t to)
+{
+    insert(to, substr(from, size));
+}
+
+Rope Rope::substr(size_t pos, size_t size) const
+{
+    if (pos + size > this->size()) {
+        throw std::out_of_range("Rope range out of range.");
+    }
+    NodePtr left, middle, right;
+    split(_root, pos, left, middle);
+    split(middle, size, middle, right);
+    return Rope(middle);
+}
+
+void Rope::pieces(const Node * node, std::vector<io::Piece> & dst)
+{
+    /// recursion depth is the treap height, O(log n) expected
+    while(node) {
+        pieces(node->left.get(), dst);
+        io::Piece piece;
+        piece.base      = node->data;
+        piece.length    = node->length;
+        dst.push_back(piece);
+        node = node->right.get();
+    }
+}
+
+void Rope::pieces(std::vector<io::Piece> & dst) const
+{
+    dst.reserve(dst.size() + count());
+    pieces(_root.get(), dst);
+}
+
+bool Rope::write(io::Destination & dst) const
+{
+    std::vector<io::Piece> list;
+    pieces(list);
+    return dst.writev(list.data(), list.size());
+}
+
+void Rope::flatten(std::vector<uint8_t> & dst) const
+{
+    std::vector<io::Piece> list;
+    pieces(list);
+    size_t offset = dst.size();
+    dst.resize(offset + size());
+    for(size_t i = 0; i < list.size(); ++i) {
+        memcpy(dst.data() + offset, list[i].base, list[i].length);
+        offset += list[i].length;
+    }
+}
+
+} // namespace runtime
+
+} // namespace fuzzer
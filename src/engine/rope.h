@@ -0,0 +1,107 @@
+#ifndef _ROPE_H_
+#define _ROPE_H_
+
+#include "destination.h"
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+namespace fuzzer {
+
+namespace runtime {
+
+///
+/// \class  Rope
+/// \brief  Persistent byte sequence made of pieces that refer to a seed or
+///         to inserted data. The pieces are kept in a treap ordered by
+///         position, so insert, erase and duplicate are O(log n) and never
+///         copy the seed. Nodes are immutable and shared, copying a rope is
+///         O(1) and edits to a copy leave the original unchanged.
+///
+class Rope
+{
+public:
+    /// empty rope
+    Rope();
+
+    ///
+    /// \brief  Rope over \p size bytes at \p data. \p owner keeps the data
+    ///         alive, it may be empty if the data outlives the rope.
+    ///
+    Rope(const uint8_t * data, size_t size, std::shared_ptr<const void> owner = std::shared_ptr<const void>());
+
+    /// total number of bytes
+    size_t size() const;
+    /// number of pieces, the length of the pieces() export
+    size_t count() const;
+    bool empty() const { return size() == 0; }
+
+    /// byte at \p pos, O(log n)
+    uint8_t at(size_t pos) const;
+
+    ///
+    /// \brief  Inserts a copy of \p size bytes at \p pos.
+    ///
+    void insert(size_t pos, const void * data, size_t size);
+
+    ///
+    /// \brief  Inserts \p rope at \p pos, sharing its pieces.
+    ///
+    void insert(size_t pos, const Rope & rope);
+
+    ///
+    /// \brief  Removes \p size bytes at \p pos.
+    ///
+    void erase(size_t pos, size_t size);
+
+    ///
+    /// \brief  Replaces \p size bytes at \p pos with a copy of \p data.
+    ///
+    void overwrite(size_t pos, const void * data, size_t size);
+
+    ///
+    /// \brief  Copies \p size bytes at \p from to \p to, which is a position
+    ///         in the rope before the copy is made.
+    ///
+    void duplicate(size_t from, size_t size, size_t to);
+
+    /// \p size bytes at \p pos, sharing pieces with this rope
+    Rope substr(size_t pos, size_t size) const;
+
+    ///
+    /// \brief  Appends the pieces in order, for gather writes.
+    ///
+    void pieces(std::vector<io::Piece> &) const;
+
+    ///
+    /// \brief  Writes the rope with a single gather write.
+    ///
+    bool write(io::Destination &) const;
+
+    ///
+    /// \brief  Appends the bytes of the rope to \p dst.
+    ///
+    void flatten(std::vector<uint8_t> & dst) const;
+
+private:
+    struct Node;
+    typedef std::shared_ptr<const Node> NodePtr;
+
+    explicit Rope(const NodePtr & root) : _root(root) {}
+
+    static NodePtr make(const NodePtr & left, const NodePtr & right, const Node & piece);
+    static NodePtr make(const NodePtr & left, const NodePtr & right,
+        const std::shared_ptr<const void> & owner, const uint8_t * data, size_t length, uint32_t priority);
+    static NodePtr leaf(const std::shared_ptr<const void> & owner, const uint8_t * data, size_t length);
+    static void split(NodePtr node, size_t pos, NodePtr & left, NodePtr & right);
+    static NodePtr merge(const NodePtr & left, const NodePtr & right);
+    static void pieces(const Node *, std::vector<io::Piece> &);
+
+    NodePtr     _root;
+};
+
+} // namespace runtime
+
+} // namespace fuzzer
+
+#endif
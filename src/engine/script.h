@@ -3,6 +3,8 @@
 
 #include "bytecode.h"
 #include "template.h"
+#include "input.h"
+#include <map>
 #include <vector>
 #include <memory>
 
@@ -10,6 +12,17 @@ namespace fuzzer {
 
 namespace bytecode {
 
+///
+/// \struct Response
+/// \brief  Message read from the target by read("name"), the named fields
+///         are captured for the templates.
+///
+struct Response
+{
+    std::shared_ptr<io::Input>      input;
+    std::map<std::string, size_t>   fields;     //< field name, id in input
+};
+
 ///
 /// \class  Script
 ///
@@ -40,6 +53,7 @@ struct Script
 
     std::vector<std::shared_ptr<bytecode::Method> >             _methods;
     std::map<std::string, std::shared_ptr<runtime::Template> >  _templates;
+    std::map<std::string, Response>                             _responses;
 };
 
 } // namespace bytecode
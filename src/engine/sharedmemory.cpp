@@ -0,0 +1,80 @@
+#include "sharedmemory.h"
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+#ifdef WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace fuzzer {
+
+namespace execution {
+
+static std::string UniqueName()
+{
+    static unsigned long counter = 0;
+    std::stringstream ss;
+#ifdef WIN32
+    ss << "Local\\fuzzengine-" << GetCurrentProcessId() << "-" << counter++;
+#else
+    ss << "/fuzzengine-" << getpid() << "-" << counter++;
+#endif
+    return ss.str();
+}
+
+SharedMemory::SharedMemory(size_t size) : _name(UniqueName()), _map(nullptr), _size(size)
+{
+#ifdef WIN32
+    const uint64_t size64 = size;
+    _handle = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+        static_cast<DWORD>(size64 >> 32), static_cast<DWORD>(size64), _name.c_str());
+    if (!_handle) {
+        throw std::runtime_error("Failed to create shared memory.");
+    }
+    _map = static_cast<uint8_t *>(MapViewOfFile(_handle, FILE_MAP_ALL_ACCESS, 0, 0, size));
+    if (!_map) {
+        CloseHandle(_handle);
+        throw std::runtime_error("Failed to map shared memory.");
+    }
+#else
+    _fd = shm_open(_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (_fd < 0) {
+        throw std::runtime_error("Failed to create shared memory.");
+    }
+    if (ftruncate(_fd, size) != 0) {
+        close(_fd);
+        shm_unlink(_name.c_str());
+        throw std::runtime_error("Failed to size shared memory.");
+    }
+    void * map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+    if (map == MAP_FAILED) {
+        close(_fd);
+        shm_unlink(_name.c_str());
+        throw std::runtime_error("Failed to map shared memory.");
+    }
+    _map = static_cast<uint8_t *>(map);
+#endif
+    memset(_map, 0, size);
+}
+
+SharedMemory::~SharedMemory()
+{
+#ifdef WIN32
+    UnmapViewOfFile(_map);
+    CloseHandle(_handle);
+#else
+    munmap(_map, _size);
+    close(_fd);
+    shm_unlink(_name.c_str());
+#endif
+}
+
+} // namespace execution
+
+} // namespace fuzzer
@@ -0,0 +1,52 @@
+#ifndef _SHAREDMEMORY_H_
+#define _SHAREDMEMORY_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+namespace fuzzer {
+
+namespace execution {
+
+///
+/// \class  SharedMemory
+/// \brief  Uniquely named, zero filled shared memory that a launched target
+///         opens by name.
+///
+class SharedMemory
+{
+public:
+    ///
+    /// \brief  Creates and maps \p size bytes. Throws a std::runtime_error
+    ///         if the mapping can't be created.
+    ///
+    explicit SharedMemory(size_t size);
+    ~SharedMemory();
+
+    /// name of the mapping, as passed to the target
+    const std::string & name() const { return _name; }
+
+    uint8_t * data() { return _map; }
+    const uint8_t * data() const { return _map; }
+    size_t size() const { return _size; }
+
+private:
+    SharedMemory(const SharedMemory &);
+    SharedMemory & operator=(const SharedMemory &);
+
+    std::string     _name;
+    uint8_t *       _map;
+    size_t          _size;
+#ifdef WIN32
+    void *          _handle;
+#else
+    int             _fd;
+#endif
+};
+
+} // namespace execution
+
+} // namespace fuzzer
+
+#endif
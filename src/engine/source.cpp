@@ -24,6 +24,11 @@ void Source::read_little_endian()
     _big_endian = false;
 }
 
+size_t Source::receive(void * dst, size_t min, size_t)
+{
+    return read(dst, min) ? min : 0;
+}
+
 uint8_t Source::readU8(void)
 {
     uint8_t value;
@@ -35,34 +40,26 @@ uint8_t Source::readU8(void)
 
 uint16_t Source::readU16()
 {
-    uint16_t value;
-    if (!read(&value, sizeof(value))) {
-        throw io::IoException("Failed to read U16 from source.");   
-    }
-    return _big_endian ? be_to_host16(value) : le_to_host16(value);
+    return _big_endian ? EndianReader<ORDER_BIG_ENDIAN>(*this).readU16() :
+        EndianReader<ORDER_LITTLE_ENDIAN>(*this).readU16();
 }
 
 uint32_t Source::readU24()
 {
-    throw io::IoException("Failed to read U24 from source.");   
+    return _big_endian ? EndianReader<ORDER_BIG_ENDIAN>(*this).readU24() :
+        EndianReader<ORDER_LITTLE_ENDIAN>(*this).readU24();
 }
 
 uint32_t Source::readU32()
 {
-    uint32_t value;
-    if (!read(&value, sizeof(value))) {
-        throw io::IoException("Failed to read U32 from source.");   
-    }
-    return _big_endian ? be_to_host32(value) : le_to_host32(value);
+    return _big_endian ? EndianReader<ORDER_BIG_ENDIAN>(*this).readU32() :
+        EndianReader<ORDER_LITTLE_ENDIAN>(*this).readU32();
 }
 
 uint64_t Source::readU64()
 {
-    uint64_t value;
-    if (!read(&value, sizeof(value))) {
-        throw io::IoException("Failed to read U64 from source.");   
-    }
-    return _big_endian ? be_to_host64(value) : le_to_host64(value);
+    return _big_endian ? EndianReader<ORDER_BIG_ENDIAN>(*this).readU64() :
+        EndianReader<ORDER_LITTLE_ENDIAN>(*this).readU64();
 }
 
 } // namespace runtime
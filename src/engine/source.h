@@ -2,6 +2,9 @@
 #define _SOURCE_H_
 
 #include <stdint.h>
+#include <stddef.h>
+#include "endian.h"
+#include "ioerror.h"
 
 namespace fuzzer {
 
@@ -23,6 +26,7 @@ public:
 
     void read_big_endian();
     void read_little_endian();
+    bool is_big_endian() const { return _big_endian; }
 
     uint8_t readU8();
     uint16_t readU16();
@@ -35,12 +39,80 @@ public:
     ///
     virtual bool read(void * dst, size_t count) = 0;
 
+    ///
+    /// \brief  Reads at least \p min and at most \p max bytes, sources that
+    ///         can tell how much is pending read ahead. The default reads
+    ///         exactly \p min bytes.
+    ///
+    /// \return The number of bytes read, zero on failure.
+    ///
+    virtual size_t receive(void * dst, size_t min, size_t max);
+
 protected:
     bool _big_endian;
 };
 
+///
+/// \class  EndianReader
+/// \brief  Reads integers from a source in a byte order that is fixed at
+///         compile time, ignoring the runtime setting of the source.
+///
+template<ByteOrder Order>
+class EndianReader
+{
+public:
+    explicit EndianReader(Source & src) : _src(src)
+    {
+    }
+
+    uint8_t readU8()
+    {
+        uint8_t value;
+        get(&value, sizeof(value), "Failed to read U8 from source.");
+        return value;
+    }
+
+    uint16_t readU16()
+    {
+        uint16_t value;
+        get(&value, sizeof(value), "Failed to read U16 from source.");
+        return Endian<Order>::convert16(value);
+    }
+
+    uint32_t readU24()
+    {
+        uint8_t bytes[3];
+        get(bytes, sizeof(bytes), "Failed to read U24 from source.");
+        return Endian<Order>::load24(bytes);
+    }
+
+    uint32_t readU32()
+    {
+        uint32_t value;
+        get(&value, sizeof(value), "Failed to read U32 from source.");
+        return Endian<Order>::convert32(value);
+    }
+
+    uint64_t readU64()
+    {
+        uint64_t value;
+        get(&value, sizeof(value), "Failed to read U64 from source.");
+        return Endian<Order>::convert64(value);
+    }
+
+protected:
+    void get(void * data, size_t count, const char * error)
+    {
+        if (!_src.read(data, count)) {
+            throw IoException(error);
+        }
+    }
+
+    Source & _src;
+};
+
 } // namespace io
 
 } // namespace fuzzer
 
-#endif
\ No newline at end of file
+#endif
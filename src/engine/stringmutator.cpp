@@ -1,4 +1,6 @@
 #include "stringmutator.h"
+#include "utf8.h"
+#include <cstring>
 
 namespace fuzzer {
 
@@ -25,7 +27,7 @@ static const char * bad[] = {
     "OR%201=1",
 };
 
-static size_t CommonSizes[] = {
+static const size_t CommonSizes[] = {
     128,
     256,
     512,
@@ -38,58 +40,366 @@ static size_t CommonSizes[] = {
     100000
 };
 
-StringMutator::StringMutator(const char * str) : _index(0)
+static const char * RepeatedStrings[] = {
+    "%s",
+    "%d",
+    "%p",
+    "\\n",
+    "A",
+    "B",
+    "<",
+    ">",
+    "%",
+    "\r\n"
+};
+
+///////////////////////////////////////////////////////////////////////////////
+//                                  StringEntry                              //
+///////////////////////////////////////////////////////////////////////////////
+
+void StringEntry::write(Buffer & buffer) const
 {
-    /// mutate the original string
-    if (str) {
-        _db.push_back(str);
+    const size_t total = length();
+    if (!total) {
+        return;
     }
+    uint8_t * dst = buffer.allocate(total);
+    memcpy(dst, data, size);
+    /// double the written part until the string is complete
+    size_t written = size;
+    while(written < total) {
+        size_t count = written < (total - written) ? written : (total - written);
+        memcpy(dst + written, dst, count);
+        written += count;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//                                  StringDictionary                         //
+///////////////////////////////////////////////////////////////////////////////
 
+const StringDictionary & StringDictionary::instance()
+{
+    /// created on first use, immutable afterwards
+    static const StringDictionary dictionary;
+    return dictionary;
+}
+
+StringDictionary::StringDictionary()
+{
     /// known bad strings
     for(size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); ++i) {
-        _db.push_back(bad[i]);
+        repeat(bad[i], 1);
     }
-    #if 0
     /// misc strings
     for(size_t i = 0; i < sizeof(CommonSizes)/sizeof(CommonSizes[0]); ++i) {
-        size_t size = CommonSizes[i];
-        repeat("%s", size);
-        repeat("%d", size);
-        repeat("%p", size);
-        repeat("\\n", size);
-        repeat("A", size);
-        repeat("B", size);
-        repeat("<", size);
-        repeat(">", size);
-        repeat("%", size);
-        repeat("\r\n", size);
+        for(size_t j = 0; j < sizeof(RepeatedStrings) / sizeof(RepeatedStrings[0]); ++j) {
+            repeat(RepeatedStrings[j], CommonSizes[i]);
+        }
     }
-    #endif
 }
 
-void StringMutator::repeat(const char * s, size_t count)
+void StringDictionary::repeat(const char * s, size_t count)
+{
+    StringEntry entry;
+    entry.data      = s;
+    entry.size      = strlen(s);
+    entry.repeat    = count;
+    _entries.push_back(entry);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//                                  StringMutator                            //
+///////////////////////////////////////////////////////////////////////////////
+
+StringMutator::StringMutator(const char * str) :
+    _initial(str ? str : ""),
+    _hasInitial(str != nullptr),
+    _index(0)
+{
+}
+
+size_t StringMutator::count() const
+{
+    const size_t tokens = _dictionary ? _dictionary->size() : 0;
+    return StringDictionary::instance().size() + (_hasInitial ? 1 : 0) + tokens * 2;
+}
+
+void StringMutator::dictionary(const std::shared_ptr<const Dictionary> & dictionary)
+{
+    _dictionary = dictionary;
+}
+
+bool StringMutator::mutate()
 {
-    std::string str;
-    for(size_t i = 0; i < count; ++i) {
-        str += s;
+    if (finished()) {
+        return false;
     }
-    _db.push_back(str);
+    ++_index;
+    return !finished();
 }
 
-bool StringMutator::NextString(std::string & str)
+bool StringMutator::finished()
 {
-    if (_index < _db.size()) {
-        str = _db[_index++];
-        return true;
+    return _index >= count();
+}
+
+void StringMutator::reset()
+{
+    _index = 0;
+}
+
+StringEntry StringMutator::current() const
+{
+    size_t index = _index;
+    if (_hasInitial) {
+        if (index == 0 || index >= count()) {
+            /// the unmodified string
+            StringEntry entry;
+            entry.data      = _initial.c_str();
+            entry.size      = _initial.size();
+            entry.repeat    = 1;
+            return entry;
+        }
+        --index;
     }
-    return false;
+    const StringDictionary & dictionary = StringDictionary::instance();
+    if (index < dictionary.size()) {
+        return dictionary[index];
+    }
+    index -= dictionary.size();
+
+    StringEntry entry;
+    entry.data      = "";
+    entry.size      = 0;
+    entry.repeat    = 1;
+    const size_t tokens = _dictionary ? _dictionary->size() : 0;
+    if (index < tokens) {
+        /// the token instead of the string
+        entry.data  = reinterpret_cast<const char *>(_dictionary->data(index));
+        entry.size  = _dictionary->length(index);
+    } else if (index < tokens * 2) {
+        /// the token after the string
+        index -= tokens;
+        _scratch.assign(_initial);
+        _scratch.append(reinterpret_cast<const char *>(_dictionary->data(index)), _dictionary->length(index));
+        entry.data  = _scratch.data();
+        entry.size  = _scratch.size();
+    }
+    return entry;
 }
 
-bool StringMutator::HasMore()
+///////////////////////////////////////////////////////////////////////////////
+//                                  StringRepresentation                     //
+///////////////////////////////////////////////////////////////////////////////
+
+void StringRepresentation::prefix(Buffer & buffer, size_t length) const
 {
-    return _index < _db.size();
+    /// the length is known up front, so the data follows the header directly
+    switch(_representation) {
+    case PASCAL8:   buffer.writeU8(static_cast<uint8_t>(length)); break;
+    case PASCAL16:  buffer.writeU16(static_cast<uint16_t>(length)); break;
+    case PASCAL32:  buffer.writeU32(static_cast<uint32_t>(length)); break;
+    case PASCAL64:  buffer.writeU64(static_cast<uint64_t>(length)); break;
+    default:        break;
+    }
 }
 
+void StringRepresentation::suffix(Buffer & buffer) const
+{
+    switch(_representation) {
+    case CSTRING:
+        /// the NULL terminator
+        buffer.writeU8(0);
+        break;
+    case LINE:
+        buffer.write("\r\n", 2);
+        break;
+    default:
+        break;
+    }
 }
 
-}
\ No newline at end of file
+///////////////////////////////////////////////////////////////////////////////
+//                                  Utf8StringMutator                        //
+///////////////////////////////////////////////////////////////////////////////
+
+/// characters that mean something to parsers, used for the overlong forms
+static const uint32_t SignificantCharacters[] = {
+    0x00, 0x0a, 0x0d, '"', '%', '\'', '.', '/', '<', '>', '\\'
+};
+
+Utf8StringMutator::Utf8StringMutator(Representation representation, const char * Initial) :
+    StringRepresentation(representation),
+    _initial(Initial ? Initial : ""),
+    _split(0),
+    _index(0)
+{
+    const uint8_t * data = reinterpret_cast<const uint8_t *>(_initial.c_str());
+    const size_t size = _initial.size();
+
+    /// split at the character boundary closest to the middle, within the
+    /// valid part of the string
+    _split = io::utf8_validate(data, size);
+    if (_split > size / 2) {
+        _split = size / 2;
+        while(_split > 0 && (data[_split] & 0xc0) == 0x80) {
+            --_split;
+        }
+    }
+    _placements = size ? PLACEMENT_COUNT : 1;
+
+    /// overlong encodings
+    for(size_t i = 0; i < sizeof(SignificantCharacters) / sizeof(SignificantCharacters[0]); ++i) {
+        overlong(SignificantCharacters[i], 4);
+    }
+    overlong(0x00, io::Utf8MaxSequence);
+    overlong('/', io::Utf8MaxSequence);
+    overlong(0x20ac, 4);
+    /// surrogates, alone and as a CESU-8 encoded pair
+    add(0xd800);
+    add(0xdbff);
+    add(0xdc00);
+    add(0xdfff);
+    {
+        uint8_t pair[8];
+        size_t size = io::utf8_encode(0xd83d, pair);
+        size += io::utf8_encode(0xde00, pair + size);
+        add(pair, size);
+    }
+    /// beyond U+10FFFF
+    add(0x110000);
+    add(0x1fffff);
+    add(0x3ffffff);
+    add(0x7fffffff);
+    /// noncharacters and byte order marks
+    add(0xfffe);
+    add(0xffff);
+    add(0xfeff);
+    add(0xfdd0);
+    add(0x10ffff);
+    /// truncated sequences
+    uint8_t bytes[io::Utf8MaxSequence];
+    truncated(bytes, io::utf8_encode(0xe9, bytes));
+    truncated(bytes, io::utf8_encode(0x20ac, bytes));
+    truncated(bytes, io::utf8_encode(0x1f600, bytes));
+    /// and the first multibyte character of the initial string
+    for(size_t i = 0; i < _split; ++i) {
+        const size_t length = io::utf8_sequence_length(data[i]);
+        if (length > 1) {
+            truncated(data + i, length);
+            break;
+        }
+    }
+    /// bytes that never appear in valid UTF-8
+    static const uint8_t Invalid[] = { 0x80, 0xbf, 0xc0, 0xc1, 0xf5, 0xf8, 0xfc, 0xfe, 0xff };
+    for(size_t i = 0; i < sizeof(Invalid); ++i) {
+        add(&Invalid[i], 1);
+    }
+}
+
+void Utf8StringMutator::add(const uint8_t * bytes, size_t size)
+{
+    Sequence sequence;
+    memcpy(sequence.bytes, bytes, size);
+    sequence.size = static_cast<uint8_t>(size);
+    _sequences.push_back(sequence);
+}
+
+void Utf8StringMutator::add(uint32_t codepoint)
+{
+    uint8_t bytes[io::Utf8MaxSequence];
+    add(bytes, io::utf8_encode(codepoint, bytes));
+}
+
+void Utf8StringMutator::overlong(uint32_t codepoint, size_t longest)
+{
+    uint8_t bytes[io::Utf8MaxSequence];
+    uint8_t shortest[io::Utf8MaxSequence];
+    const size_t minimum = io::utf8_encode(codepoint, shortest);
+    for(size_t length = minimum + 1; length <= longest; ++length) {
+        add(bytes, io::utf8_encode_long(codepoint, length, bytes));
+    }
+}
+
+void Utf8StringMutator::truncated(const uint8_t * bytes, size_t size)
+{
+    for(size_t length = 1; length < size; ++length) {
+        add(bytes, length);
+    }
+}
+
+size_t Utf8StringMutator::count() const
+{
+    return 1 + _sequences.size() * _placements;
+}
+
+bool Utf8StringMutator::mutate()
+{
+    if (finished()) {
+        return false;
+    }
+    ++_index;
+    return !finished();
+}
+
+bool Utf8StringMutator::finished()
+{
+    return _index >= count();
+}
+
+void Utf8StringMutator::reset()
+{
+    _index = 0;
+}
+
+bool Utf8StringMutator::current(const Sequence *& sequence, Placement & placement) const
+{
+    if (_index == 0 || _index >= count()) {
+        return false;
+    }
+    const size_t index = _index - 1;
+    sequence    = &_sequences[index / _placements];
+    placement   = static_cast<Placement>(index % _placements);
+    return true;
+}
+
+size_t Utf8StringMutator::length() const
+{
+    const Sequence * sequence;
+    Placement placement;
+    if (!current(sequence, placement)) {
+        return _initial.size();
+    }
+    return sequence->size + (placement == REPLACE ? 0 : _initial.size());
+}
+
+void Utf8StringMutator::evaluate(Buffer & buffer)
+{
+    prefix(buffer, length());
+    const Sequence * sequence;
+    Placement placement;
+    if (!current(sequence, placement)) {
+        buffer.write(_initial.c_str(), _initial.size());
+    } else {
+        switch(placement) {
+        case REPLACE:
+            buffer.write(sequence->bytes, sequence->size);
+            break;
+        case APPEND:
+            buffer.write(_initial.c_str(), _initial.size());
+            buffer.write(sequence->bytes, sequence->size);
+            break;
+        default:
+            buffer.write(_initial.c_str(), _split);
+            buffer.write(sequence->bytes, sequence->size);
+            buffer.write(_initial.c_str() + _split, _initial.size() - _split);
+            break;
+        }
+    }
+    suffix(buffer);
+}
+
+}
+
+}
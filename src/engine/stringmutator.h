@@ -2,34 +2,99 @@
 #define _STRINGMUTATOR_H_
 
 #include "mutator.h"
+#include "buffer.h"
+#include "dictionary.h"
+#include <string>
+#include <vector>
 
 namespace fuzzer {
 
 namespace runtime {
 
-class StringMutator : public Mutator
+///
+/// \class  StringEntry
+/// \brief  View of a dictionary string, \p data repeated \p repeat times.
+///         Long strings are never stored, they are generated directly into
+///         the output buffer when written.
+///
+struct StringEntry
+{
+    const char *    data;
+    size_t          size;       //< size of data in bytes
+    size_t          repeat;     //< number of times data is repeated
+
+    /// total length in bytes
+    size_t length() const { return size * repeat; }
+
+    /// write the string to the buffer
+    void write(Buffer &) const;
+};
+
+///
+/// \class  StringDictionary
+/// \brief  Process wide and immutable dictionary of known bad strings,
+///         shared by all string mutators.
+///
+class StringDictionary
 {
 public:
-    StringMutator(const char * str);
+    static const StringDictionary & instance();
 
-protected:
-    bool NextString(std::string &);
-    bool HasMore();
+    size_t size() const { return _entries.size(); }
+    const StringEntry & operator[](size_t index) const { return _entries[index]; }
 
 private:
+    StringDictionary();
     void repeat(const char *, size_t count);
 
+    std::vector<StringEntry>    _entries;
+};
+
+///
+/// \class  StringMutator
+/// \brief  Base for string mutators. The first mutation is the initial
+///         string, followed by the entries of the StringDictionary and,
+///         with a dictionary, each token and the initial string followed by
+///         each token.
+///
+class StringMutator : public Mutator
+{
+public:
+    StringMutator(const char * str);
+
+    virtual bool mutate();
+    virtual bool finished();
+    virtual void reset();
+
+    /// number of mutations
+    size_t count() const;
+    /// index of the current mutation
+    size_t position() const { return _index; }
+    /// jump to a mutation, seeking past the end finishes the mutator
+    void seek(size_t index) { _index = index; }
+
+    virtual void dictionary(const std::shared_ptr<const Dictionary> &);
+
+protected:
+    /// the current string
+    StringEntry current() const;
+
 protected:
-    std::string                 _initial;
-    std::vector<std::string>    _db;
-    size_t                      _index;
+    std::string                         _initial;
+    bool                                _hasInitial;
+    size_t                              _index;
+    std::shared_ptr<const Dictionary>   _dictionary;
+    mutable std::string                 _scratch;   //< initial string and token
 };
 
 ///
-/// \class  AsciiStringMutator
-/// \brief  Mutator for ASCII strings
+/// \class  StringRepresentation
+/// \brief  How a string is framed in the output. The PASCAL representations
+///         prefix the string with its length, using the byte order of the
+///         buffer. The prefix is truncated to its width, so long strings also
+///         produce wrapped lengths.
 ///
-class AsciiStringMutator : public StringMutator
+class StringRepresentation
 {
 public:
     enum Representation {
@@ -38,54 +103,99 @@ public:
         PASCAL8,
         PASCAL16,
         PASCAL32,
-        PASCAL64
+        PASCAL64,
+        RAW             //< no framing at all
     };
 
-    AsciiStringMutator(Representation representation, const char * Initial) :
-        StringMutator(Initial),
+protected:
+    StringRepresentation(Representation representation) :
         _representation(representation)
     {
-        NextString(_current);
     }
 
-    virtual bool mutate()
-    {
-        return NextString(_current);
-    }
+    /// writes whatever precedes a string of \p length bytes
+    void prefix(Buffer &, size_t length) const;
+    /// writes whatever follows the string
+    void suffix(Buffer &) const;
 
-    virtual bool finished() { return !HasMore(); }
+    Representation  _representation;
+};
 
-    virtual void reset() { _index = 0; }
+///
+/// \class  AsciiStringMutator
+/// \brief  Mutator for ASCII strings
+///
+class AsciiStringMutator : public StringMutator, public StringRepresentation
+{
+public:
+    AsciiStringMutator(Representation representation, const char * Initial) :
+        StringMutator(Initial),
+        StringRepresentation(representation)
+    {
+    }
 
     virtual void evaluate(Buffer & buffer)
     {
-        switch(_representation) {
-        case CSTRING:
-            /// write the string plus the NULL terminator
-            buffer.write(_current.c_str(), _current.size() + 1);
-            break;
-        case LINE:
-            buffer.write(_current.c_str(), _current.size() + 1);
-            buffer.write("\r\n", 2);
-            break;
-        default:
-            break;
-        }
+        const StringEntry str = current();
+        prefix(buffer, str.length());
+        str.write(buffer);
+        suffix(buffer);
     }
-    
-protected:
-    Representation  _representation;
-    std::string     _current;
 };
 
 ///
 /// \class  Utf8StringMutator
-/// \brief  Mutator for UTF-8 strings
+/// \brief  Mutator for UTF-8 strings. Overlong encodings, surrogates,
+///         values beyond U+10FFFF, noncharacters, truncated sequences and
+///         stray bytes are placed instead of, after and in the middle of the
+///         initial string. The middle is always a character boundary.
 ///
-class Utf8StringMutator : public Mutator
+class Utf8StringMutator : public Mutator, public StringRepresentation
 {
 public:
+    Utf8StringMutator(Representation representation, const char * Initial);
+
+    virtual bool mutate();
+    virtual bool finished();
+    virtual void reset();
+    virtual void evaluate(Buffer &);
+
+    /// number of mutations
+    size_t count() const;
+    /// index of the current mutation
+    size_t position() const { return _index; }
+    /// jump to a mutation, seeking past the end finishes the mutator
+    void seek(size_t index) { _index = index; }
+
+    /// length of the current string, excluding prefix and suffix
+    size_t length() const;
+
+protected:
+    enum Placement {
+        REPLACE,
+        APPEND,
+        INSERT,
+        PLACEMENT_COUNT
+    };
+
+    struct Sequence {
+        uint8_t     bytes[8];
+        uint8_t     size;
+    };
+
+    void add(const uint8_t * bytes, size_t size);
+    void add(uint32_t codepoint);
+    void overlong(uint32_t codepoint, size_t longest);
+    void truncated(const uint8_t * bytes, size_t size);
+
+    /// the current sequence and where it goes, false for the initial string
+    bool current(const Sequence *& sequence, Placement & placement) const;
 
+    std::string             _initial;
+    size_t                  _split;     //< character boundary in the middle
+    size_t                  _placements;
+    std::vector<Sequence>   _sequences;
+    size_t                  _index;
 };
 
 } // namespace runtime
@@ -0,0 +1,171 @@
+#include "structuremutator.h"
+#include <algorithm>
+
+namespace fuzzer {
+
+namespace runtime {
+
+const size_t StructureMutator::RepeatCounts[] = {
+    2, 16, 256, 4096
+};
+
+const size_t StructureMutator::RepeatCountsCount = sizeof(RepeatCounts) / sizeof(RepeatCounts[0]);
+
+StructureMutator::StructureMutator(const std::shared_ptr<Template> & base) :
+    _base(base.get()),
+    _owner(base),
+    _index(0),
+    _built(~static_cast<size_t>(0))
+{
+}
+
+StructureMutator::StructureMutator(const Template & base) :
+    _base(&base),
+    _index(0),
+    _built(~static_cast<size_t>(0))
+{
+}
+
+void StructureMutator::donor(const std::shared_ptr<Template> & tp)
+{
+    _donors.push_back(tp);
+    _built = ~static_cast<size_t>(0);
+}
+
+size_t StructureMutator::count() const
+{
+    const size_t items = _base->items().size();
+    const size_t pairs = items ? items * (items - 1) / 2 : 0;
+    size_t count = items * 2 + pairs + items * RepeatCountsCount;
+    for(size_t i = 0; i < _donors.size(); ++i) {
+        count += (items + 1) * _donors[i]->items().size();
+    }
+    return count;
+}
+
+bool StructureMutator::mutate()
+{
+    if (finished()) {
+        return false;
+    }
+    ++_index;
+    return !finished();
+}
+
+bool StructureMutator::finished()
+{
+    return _index >= count();
+}
+
+void StructureMutator::reset()
+{
+    _index = 0;
+}
+
+StructureMutator::Operation StructureMutator::decode(size_t index, size_t & first, size_t & second) const
+{
+    const size_t items = _base->items().size();
+    first = second = 0;
+    if (index < items) {
+        first = index;
+        return DROP;
+    }
+    index -= items;
+    if (index < items) {
+        first = index;
+        return DUPLICATE;
+    }
+    index -= items;
+    for(size_t i = 0; i + 1 < items; ++i) {
+        /// pairs (i, j) with j > i
+        if (index < items - 1 - i) {
+            first   = i;
+            second  = i + 1 + index;
+            return SWAP;
+        }
+        index -= items - 1 - i;
+    }
+    if (index < items * RepeatCountsCount) {
+        first   = index / RepeatCountsCount;
+        second  = index % RepeatCountsCount;
+        return REPEAT;
+    }
+    index -= items * RepeatCountsCount;
+    for(size_t i = 0; i < _donors.size(); ++i) {
+        /// every head of the base with every tail of the donor
+        const size_t tails = _donors[i]->items().size();
+        if (index < (items + 1) * tails) {
+            first   = i;
+            second  = index;
+            return SPLICE;
+        }
+        index -= (items + 1) * tails;
+    }
+    return DONE;
+}
+
+StructureMutator::Operation StructureMutator::operation() const
+{
+    size_t first, second;
+    return decode(_index, first, second);
+}
+
+void StructureMutator::build()
+{
+    const std::vector<Item> & base = _base->items();
+    size_t first, second;
+    const Operation op = decode(_index, first, second);
+
+    /// clear() keeps the capacity, variants don't allocate once it has grown
+    _items.clear();
+    switch(op) {
+    case DROP:
+        _items.insert(_items.end(), base.begin(), base.begin() + first);
+        _items.insert(_items.end(), base.begin() + first + 1, base.end());
+        break;
+    case DUPLICATE:
+        _items.insert(_items.end(), base.begin(), base.begin() + first + 1);
+        _items.insert(_items.end(), base.begin() + first, base.end());
+        break;
+    case SWAP:
+        _items.assign(base.begin(), base.end());
+        std::swap(_items[first], _items[second]);
+        break;
+    case REPEAT:
+        _items.insert(_items.end(), base.begin(), base.begin() + first);
+        _items.insert(_items.end(), RepeatCounts[second], base[first]);
+        _items.insert(_items.end(), base.begin() + first + 1, base.end());
+        break;
+    case SPLICE:
+        {
+            const std::vector<Item> & donor = _donors[first]->items();
+            const size_t head = second / donor.size();
+            const size_t tail = second % donor.size();
+            _items.insert(_items.end(), base.begin(), base.begin() + head);
+            _items.insert(_items.end(), donor.begin() + tail, donor.end());
+            break;
+        }
+    default:
+        _items.assign(base.begin(), base.end());
+        break;
+    }
+    _built = _index;
+}
+
+const std::vector<Item> & StructureMutator::items()
+{
+    if (_built != _index) {
+        build();
+    }
+    return _items;
+}
+
+void StructureMutator::evaluate(Buffer & buffer)
+{
+    const std::vector<Item> & items = this->items();
+    GenerateItems(items.data(), items.size(), _base->is_big_endian(), buffer);
+}
+
+} // namespace runtime
+
+} // namespace fuzzer
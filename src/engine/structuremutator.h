@@ -0,0 +1,111 @@
+#ifndef _STRUCTUREMUTATOR_H_
+#define _STRUCTUREMUTATOR_H_
+
+#include "mutator.h"
+#include "template.h"
+#include "templateitem.h"
+#include <memory>
+#include <vector>
+
+namespace fuzzer {
+
+namespace runtime {
+
+///
+/// \class  StructureMutator
+/// \brief  Mutates the item list of a template instead of the values in it.
+///         Walks every dropped item, duplicated item, swapped pair, item
+///         repeated RepeatCounts times and splice with the donor templates.
+///
+///         Spliced items are written in the byte order of the base.
+///         The items of a variant are shallow copies of the base items in a
+///         vector that is reused between variants, the base template is never
+///         changed. Mutators in the items keep their own state, so structure
+///         and value mutations stack.
+///
+///         The generator adds one to a template declared with the structure
+///         modifier, see Template::structure().
+///
+class StructureMutator : public Mutator
+{
+public:
+    enum Operation {
+        DROP,           //< remove an item
+        DUPLICATE,      //< write an item twice
+        SWAP,           //< swap two items
+        REPEAT,         //< repeat an item RepeatCounts times
+        SPLICE,         //< head of the base followed by the tail of a donor
+        DONE
+    };
+
+    /// number of times an item is repeated
+    static const size_t RepeatCounts[];
+    static const size_t RepeatCountsCount;
+
+    ///
+    /// \brief  Constructor
+    ///
+    /// \param [in] base    The template to mutate, it is kept alive but never
+    ///                     modified.
+    ///
+    explicit StructureMutator(const std::shared_ptr<Template> & base);
+
+    ///
+    /// \brief  Constructor for the mutator of Template::structure(), the
+    ///         template owns the mutator and outlives it.
+    ///
+    explicit StructureMutator(const Template & base);
+
+    ///
+    /// \brief  Adds a template to splice items from.
+    ///
+    void donor(const std::shared_ptr<Template> &);
+
+    virtual bool mutate();
+    virtual bool finished();
+    virtual void reset();
+
+    ///
+    /// \brief  Generates the current variant, the base template once done.
+    ///
+    virtual void evaluate(Buffer &);
+
+    /// number of mutations
+    size_t count() const;
+
+    /// index of the current mutation
+    size_t position() const { return _index; }
+
+    /// jump to a mutation, seeking past the end finishes the mutator
+    void seek(size_t index) { _index = index; }
+
+    /// operation of the current mutation
+    Operation operation() const;
+
+    ///
+    /// \brief  Items of the current variant, valid until the mutator moves.
+    ///
+    const std::vector<Item> & items();
+
+protected:
+    ///
+    /// \brief  Splits a mutation index into an operation and its operands.
+    ///
+    Operation decode(size_t index, size_t & first, size_t & second) const;
+
+    /// fills _items with the current variant
+    void build();
+
+    const Template *                            _base;
+    std::shared_ptr<Template>                   _owner;     //< keeps the base alive, if shared
+    std::vector<std::shared_ptr<Template> >     _donors;
+    std::vector<Item>                           _items;     //< reused for every variant
+    size_t                                      _index;     //< current mutation
+    size_t                                      _built;     //< mutation in _items
+};
+
+} // namespace runtime
+
+} // namespace fuzzer
+
+#endif
@@ -5,8 +5,19 @@
 
 #ifdef WIN32
 #include <ws2tcpip.h>
+#else
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netdb.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <errno.h>
 #endif
 
+#include <chrono>
+#include <climits>
+#include <cstring>
 #include <limits>
 
 using namespace std;
@@ -15,6 +26,89 @@ namespace fuzzer {
 
 namespace network {
 
+#ifdef WIN32
+static const int SendFlags = 0;
+#else
+/// a peer that closed the connection fails the send instead of raising SIGPIPE
+static const int SendFlags = MSG_NOSIGNAL;
+#endif
+
+static void CloseSocket(Socket_t sock)
+{
+#ifdef WIN32
+    closesocket(sock);
+#else
+    close(sock);
+#endif
+}
+
+static bool SetNonBlocking(Socket_t sock)
+{
+#ifdef WIN32
+    unsigned long mode = 1;
+    return ioctlsocket(sock, FIONBIO, &mode) == 0;
+#else
+    return fcntl(sock, F_SETFL, fcntl(sock, F_GETFL) | O_NONBLOCK) == 0;
+#endif
+}
+
+/// true if the last call failed only because it would have blocked
+static bool WouldBlock()
+{
+#ifdef WIN32
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EWOULDBLOCK || errno == EAGAIN;
+#endif
+}
+
+/// waits at most \p TimeOut ms for \p sock to become readable
+static bool WaitReadable(Socket_t sock, size_t TimeOut)
+{
+#ifdef WIN32
+    fd_set set;
+    FD_ZERO(&set);
+    FD_SET(sock, &set);
+    timeval tv;
+    tv.tv_sec   = static_cast<long>(TimeOut / 1000);
+    tv.tv_usec  = static_cast<long>((TimeOut % 1000) * 1000);
+    return select(0, &set, NULL, NULL, &tv) > 0;
+#else
+    pollfd fd;
+    fd.fd       = sock;
+    fd.events   = POLLIN;
+    fd.revents  = 0;
+    return poll(&fd, 1, static_cast<int>(TimeOut)) > 0;
+#endif
+}
+
+/// waits at most \p TimeOut ms for \p sock to accept more data
+static bool WaitWritable(Socket_t sock, size_t TimeOut)
+{
+#ifdef WIN32
+    fd_set set;
+    FD_ZERO(&set);
+    FD_SET(sock, &set);
+    timeval tv;
+    tv.tv_sec   = static_cast<long>(TimeOut / 1000);
+    tv.tv_usec  = static_cast<long>((TimeOut % 1000) * 1000);
+    return select(0, NULL, &set, NULL, &tv) > 0;
+#else
+    pollfd fd;
+    fd.fd       = sock;
+    fd.events   = POLLOUT;
+    fd.revents  = 0;
+    return poll(&fd, 1, static_cast<int>(TimeOut)) > 0;
+#endif
+}
+
+/// ms since \p start
+static size_t Elapsed(const chrono::steady_clock::time_point & start)
+{
+    return static_cast<size_t>(
+        chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count());
+}
+
 ///
 /// \brief  Binds the TCP server to the port on the interface
 ///
@@ -32,31 +126,35 @@ TcpServer::TcpServer(const std::string & Interface, uint16_t port)
     }
 
     _sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+#ifdef WIN32
     if (_sock == INVALID_SOCKET) {
+#else
+    if (_sock < 0) {
+#endif
         freeaddrinfo(result);
         throw std::runtime_error("Failed to create socket.");
     }
-#ifdef WIN32
-    unsigned long mode = 1;
-    if (ioctlsocket(_sock, FIONBIO, &mode) != 0) {
+    if (!SetNonBlocking(_sock)) {
         freeaddrinfo(result);
-        closesocket(_sock);
+        CloseSocket(_sock);
         throw std::runtime_error("Failed to set non-blocking mode.");
     }
-#else
-#error "Support for non-blocking sockets not supported"
+#ifndef WIN32
+    /// the port is bound again while the connections of a previous run linger
+    int reuse = 1;
+    setsockopt(_sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
 #endif
 
     if (bind(_sock, result->ai_addr, (int)result->ai_addrlen) < 0) {
         freeaddrinfo(result);
-        closesocket(_sock);
+        CloseSocket(_sock);
         throw std::runtime_error("Failed to bind.");
     }
 
     freeaddrinfo(result);
 
     if (listen(_sock, SOMAXCONN) < 0) {
-        closesocket(_sock);
+        CloseSocket(_sock);
         throw std::runtime_error("Failed to listen.");
     }
 }
@@ -66,24 +164,12 @@ TcpServer::TcpServer(const std::string & Interface, uint16_t port)
 ///
 TcpServer::~TcpServer()
 {
-#ifdef WIN32
-    closesocket(_sock);
-#else
-    close(_sock);
-#endif
+    CloseSocket(_sock);
 }
 
 std::shared_ptr<TcpSocket> TcpServer::Accept(size_t TimeOut)
 {
-    fd_set set;
-    FD_ZERO(&set);
-    FD_SET(_sock, &set);
-
-    timeval tv;
-    tv.tv_sec   = 0;
-    tv.tv_usec  = TimeOut * 1000;
-
-    if (select(0, &set, NULL, NULL, &tv) < 0) {
+    if (!WaitReadable(_sock, TimeOut)) {
         return nullptr;
     }
 
@@ -91,6 +177,13 @@ std::shared_ptr<TcpSocket> TcpServer::Accept(size_t TimeOut)
     if (sock == ((Socket_t) -1)) {
         return nullptr;
     }
+#ifndef WIN32
+    /// unlike Windows, the listening socket's mode isn't inherited
+    if (!SetNonBlocking(sock)) {
+        close(sock);
+        return nullptr;
+    }
+#endif
     return make_shared<TcpSocket>(sock);
 }
 
@@ -110,11 +203,7 @@ TcpSocket::TcpSocket(Socket_t sock) : _sock(sock), _timeout(2000)
 ///
 TcpSocket::~TcpSocket()
 {
-#ifdef WIN32
-    closesocket(_sock);
-#else
-    close(_sock);
-#endif
+    CloseSocket(_sock);
 }
 
 ///
@@ -122,24 +211,23 @@ TcpSocket::~TcpSocket()
 ///
 bool TcpSocket::write(const void * Source, size_t count)
 {
+    const chrono::steady_clock::time_point start = chrono::steady_clock::now();
     const char * ptr = static_cast<const char*>(Source);
     
     while(count > 0) {
         int len = (count > INT_MAX ? INT_MAX : count);
-        int res = send(_sock, ptr, len, 0);
+        int res = send(_sock, ptr, len, SendFlags);
         if (res < 0) {
-#ifdef WIN32
-            int err = WSAGetLastError();
-            if (err == WSAEWOULDBLOCK) {
-                continue;
-            }
-            return false;
-#else
-            if (errno == EWOULDBLOCK || errno == EAGAIN) {
+            if (WouldBlock()) {
+                /// the peer's window is full, fails once it stays full for the timeout
+                const size_t elapsed = Elapsed(start);
+                if (elapsed > _timeout) {
+                    return false;
+                }
+                WaitWritable(_sock, _timeout - elapsed);
                 continue;
             }
             return false;
-#endif
         } else {
             if (static_cast<size_t>(res) > count) { /// sanity test
                 return false;
@@ -151,23 +239,103 @@ bool TcpSocket::write(const void * Source, size_t count)
     return true;
 }
 
+///
+/// \brief  Gather write to the remote peer, without copying the pieces.
+///
+bool TcpSocket::writev(const io::Piece * pieces, size_t count)
+{
+    static const size_t MaxBuffers = 64;
+    const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    size_t index = 0, offset = 0;   //< first unsent byte
+    while(index < count) {
+#ifdef WIN32
+        WSABUF buffers[MaxBuffers];
+#else
+        struct iovec buffers[MaxBuffers];
+#endif
+        size_t n = 0;
+        for(size_t i = index; i < count && n < MaxBuffers; ++i) {
+            const size_t skip = (i == index) ? offset : 0;
+            if (pieces[i].length == skip) {
+                continue;
+            }
+            const char * base = static_cast<const char *>(pieces[i].base) + skip;
+            size_t length = pieces[i].length - skip;
+#ifdef WIN32
+            buffers[n].buf = const_cast<char *>(base);
+            buffers[n].len = static_cast<ULONG>(length > ULONG_MAX ? ULONG_MAX : length);
+#else
+            buffers[n].iov_base = const_cast<char *>(base);
+            buffers[n].iov_len  = length;
+#endif
+            ++n;
+        }
+        if (!n) {
+            break;
+        }
+        size_t sent;
+#ifdef WIN32
+        DWORD bytes = 0;
+        if (WSASend(_sock, buffers, static_cast<DWORD>(n), &bytes, 0, NULL, NULL) != 0) {
+            if (WouldBlock()) {
+                const size_t elapsed = Elapsed(start);
+                if (elapsed > _timeout) {
+                    return false;
+                }
+                WaitWritable(_sock, _timeout - elapsed);
+                continue;
+            }
+            return false;
+        }
+        sent = bytes;
+#else
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov     = buffers;
+        msg.msg_iovlen  = n;
+        ssize_t res = sendmsg(_sock, &msg, SendFlags);
+        if (res < 0) {
+            if (WouldBlock()) {
+                const size_t elapsed = Elapsed(start);
+                if (elapsed > _timeout) {
+                    return false;
+                }
+                WaitWritable(_sock, _timeout - elapsed);
+                continue;
+            }
+            return false;
+        }
+        sent = static_cast<size_t>(res);
+#endif
+        /// skip the pieces that were sent
+        while(index < count && sent >= (pieces[index].length - offset)) {
+            sent -= pieces[index].length - offset;
+            offset = 0;
+            ++index;
+        }
+        offset += sent;
+    }
+    return true;
+}
+
 ///
 /// \brief  Read data from the remote peer.
 ///
 bool TcpSocket::read(void * Dst, size_t count)
 {
-    DWORD start = GetTickCount();
+    const chrono::steady_clock::time_point start = chrono::steady_clock::now();
     char * ptr = static_cast<char*>(Dst);
     while(count) {
         int res = recv(_sock, ptr, count, 0);
         if (res == 0) {
             return false;
         } else if (res < 0) {
-            int err = WSAGetLastError();
-            if (err == WSAEWOULDBLOCK) {
-                if ((GetTickCount() - start) > _timeout) {
+            if (WouldBlock()) {
+                const size_t elapsed = Elapsed(start);
+                if (elapsed > _timeout) {
                     throw io::IoException("Read operation timed out.");
                 }
+                WaitReadable(_sock, _timeout - elapsed);
                 continue;
             }
             return false;
@@ -179,6 +347,47 @@ bool TcpSocket::read(void * Dst, size_t count)
     return true;
 }
 
+size_t TcpSocket::receive(void * Dst, size_t min, size_t max)
+{
+    const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    char * ptr = static_cast<char*>(Dst);
+    size_t received = 0;
+    while(received < min) {
+        int res = recv(_sock, ptr + received, static_cast<int>(max - received), 0);
+        if (res == 0) {
+            return 0;
+        } else if (res < 0) {
+            if (WouldBlock()) {
+                const size_t elapsed = Elapsed(start);
+                if (elapsed > _timeout) {
+                    throw io::IoException("Read operation timed out.");
+                }
+                WaitReadable(_sock, _timeout - elapsed);
+                continue;
+            }
+            return 0;
+        } else {
+            received += res;
+        }
+    }
+    return received;
+}
+
+void TcpSocket::discard()
+{
+    char buffer[4096];
+    /// the socket is non-blocking, recv fails once nothing is pending
+    while(recv(_sock, buffer, sizeof(buffer), 0) > 0) {
+    }
+}
+
+bool TcpSocket::connected()
+{
+    char byte;
+    const int res = recv(_sock, &byte, 1, MSG_PEEK);
+    return res > 0 || (res < 0 && WouldBlock());
+}
+
 } // namespace network
 
 } // namespace fuzzer
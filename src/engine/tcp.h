@@ -40,15 +40,40 @@ public:
     ~TcpSocket();
 
     ///
-    /// \brief   Write data to the remote peer.
+    /// \brief   Write data to the remote peer. Waits while the peer's window
+    ///          is full, and fails if it stays full for the timeout.
     ///
     virtual bool write(const void * Source, size_t count);
 
+    ///
+    /// \brief  Gather write to the remote peer, without copying the pieces.
+    ///         Waits like write().
+    ///
+    virtual bool writev(const io::Piece * pieces, size_t count);
+
     ///
     /// \brief  Read data from the remote peer.
     ///
     virtual bool read(void * Dst, size_t count);
 
+    ///
+    /// \brief  Reads at least \p min bytes, and whatever else is already
+    ///         pending up to \p max.
+    ///
+    virtual size_t receive(void * Dst, size_t min, size_t max);
+
+    ///
+    /// \brief  Discards whatever has been received but not read, without
+    ///         waiting for more.
+    ///
+    void discard();
+
+    ///
+    /// \brief  Checks without waiting that the peer hasn't closed the
+    ///         connection, pending data isn't consumed.
+    ///
+    bool connected();
+
 private:
     Socket_t _sock;
     size_t      _timeout;
@@ -1,9 +1,12 @@
 #include "template.h"
+#include "templateitem.h"
 #include "buffer.h"
 #include "integermutator.h"
 #include "lazytemplate.h"
+#include "structuremutator.h"
 #include <vector>
 #include <map>
+#include <memory>
 
 using namespace std;
 
@@ -13,42 +16,11 @@ namespace runtime {
 
 using namespace fuzzer::parser;
 
-///
-/// \class  Item
-/// \brief  Template item
-///
-struct Item {
-    enum {
-        BYTE,
-        WORD,
-        DWORD,
-        QWORD,
-        FLOAT,
-        DOUBLE,
-        BUFFER,
-        LAZY
-    } type;
-
-    union {
-        uint8_t             byte;
-        uint16_t            word;
-        uint32_t            dword;
-        uint64_t            qword;
-        float               spf;
-        double              dpf;
-        LazyEvaluation *    lazy;
-        struct {
-            size_t  count;
-            void *  data;
-        } buffer;
-    } u;
-};
-
 void reset(Item & item)
 {
     if (item.type == Item::BUFFER) {
-        delete item.u.buffer.data;
-        item.u.buffer.data;
+        delete [] static_cast<uint8_t *>(item.u.buffer.data);
+        item.u.buffer.data  = nullptr;
         item.u.buffer.count = 0;
     }
 }
@@ -58,8 +30,39 @@ void reset(Item & item)
 ///
 class Template::Implementation {
 public:
-    vector<Item>    _items;
-    bool            _big_endian;
+    vector<Item>                 _items;
+    bool                         _big_endian;
+    unique_ptr<StructureMutator> _structure;    //< writes the items when set
+};
+
+///
+/// \brief  Restores the byte order of a buffer when going out of scope.
+///
+class ByteOrderScope {
+public:
+    ByteOrderScope(Buffer & buffer, bool big_endian) :
+        _buffer(buffer), _previous(buffer.is_big_endian())
+    {
+        set(big_endian);
+    }
+
+    ~ByteOrderScope()
+    {
+        set(_previous);
+    }
+
+private:
+    void set(bool big_endian)
+    {
+        if (big_endian) {
+            _buffer.write_big_endian();
+        } else {
+            _buffer.write_little_endian();
+        }
+    }
+
+    Buffer &    _buffer;
+    bool        _previous;
 };
 
 Template::Template()
@@ -125,6 +128,25 @@ size_t Template::u16(uint16_t word, size_t pos)
     }
 }
 
+size_t Template::u24(uint32_t dword, size_t pos)
+{
+    if (pos == ~0L) { // add new item
+        Item item;
+        item.type       = Item::WORD24;
+        item.u.dword    = dword;
+        _impl->_items.push_back(item);
+        return _impl->_items.size() - 1;
+    } else { // replace current item
+        if (pos >= _impl->_items.size()) {
+            throw std::runtime_error("Invalid position specified.");
+        }
+        reset(_impl->_items[pos]);
+        _impl->_items[pos].type     = Item::WORD24;
+        _impl->_items[pos].u.dword  = dword;
+        return pos;
+    }
+}
+
 size_t Template::u32(uint32_t dword, size_t pos)
 {
     if (pos == ~0L) { // add new item
@@ -163,14 +185,12 @@ size_t Template::u64(uint64_t qword, size_t pos)
     }
 }
 
-size_t Template::_array(const void * data, size_t size, size_t pos)
+size_t Template::f32(float spf, size_t pos)
 {
     if (pos == ~0L) { // add new item
         Item item;
-        item.type           = Item::BUFFER;
-        item.u.buffer.count = size;
-        item.u.buffer.data  = new (std::nothrow) uint8_t[size];
-        memcpy(item.u.buffer.data, data, size);
+        item.type       = Item::FLOAT;
+        item.u.spf      = spf;
         _impl->_items.push_back(item);
         return _impl->_items.size() - 1;
     } else { // replace current item
@@ -178,12 +198,50 @@ size_t Template::_array(const void * data, size_t size, size_t pos)
             throw std::runtime_error("Invalid position specified.");
         }
         reset(_impl->_items[pos]);
+        _impl->_items[pos].type     = Item::FLOAT;
+        _impl->_items[pos].u.spf    = spf;
+        return pos;
+    }
+}
+
+size_t Template::f64(double dpf, size_t pos)
+{
+    if (pos == ~0L) { // add new item
         Item item;
-        item.type           = Item::BUFFER;
-        item.u.buffer.count = size;
-        item.u.buffer.data  = new (std::nothrow) uint8_t[size];
-        memcpy(item.u.buffer.data, data, size);
+        item.type       = Item::DOUBLE;
+        item.u.dpf      = dpf;
         _impl->_items.push_back(item);
+        return _impl->_items.size() - 1;
+    } else { // replace current item
+        if (pos >= _impl->_items.size()) {
+            throw std::runtime_error("Invalid position specified.");
+        }
+        reset(_impl->_items[pos]);
+        _impl->_items[pos].type     = Item::DOUBLE;
+        _impl->_items[pos].u.dpf    = dpf;
+        return pos;
+    }
+}
+
+size_t Template::_array(const void * data, size_t width, size_t count, size_t pos)
+{
+    Item item;
+    item.type           = Item::BUFFER;
+    item.u.buffer.count = count;
+    item.u.buffer.width = width;
+    item.u.buffer.data  = new uint8_t[width * count];
+    memcpy(item.u.buffer.data, data, width * count);
+
+    if (pos == ~0L) { // add new item
+        _impl->_items.push_back(item);
+        return _impl->_items.size() - 1;
+    } else { // replace current item
+        if (pos >= _impl->_items.size()) {
+            reset(item);
+            throw std::runtime_error("Invalid position specified.");
+        }
+        reset(_impl->_items[pos]);
+        _impl->_items[pos] = item;
         return pos;
     }
 }
@@ -209,6 +267,12 @@ size_t Template::lazy(LazyEvaluation * evaluator, size_t pos)
     }
 }
 
+Template & Template::structure(StructureMutator * mutator)
+{
+    _impl->_structure.reset(mutator);
+    return *this;
+}
+
 std::vector<Mutator *> Template::GetMutators() const
 {
     std::vector<Mutator *> mutators;
@@ -219,6 +283,9 @@ std::vector<Mutator *> Template::GetMutators() const
             }
         }
     }
+    if (_impl->_structure) {
+        mutators.push_back(_impl->_structure.get());
+    }
     return mutators;
 }
 
@@ -230,13 +297,52 @@ void Template::generate(std::vector<uint8_t> & data)
 
 void Template::generate(Buffer & dst)
 {
-    for(size_t i = 0, count = _impl->_items.size(); i < count; ++i) {
-        const Item & item = _impl->_items[i];
+    if (_impl->_structure) {
+        /// the base items once the mutator is finished
+        _impl->_structure->evaluate(dst);
+        return;
+    }
+    GenerateItems(_impl->_items.data(), _impl->_items.size(), _impl->_big_endian, dst);
+}
+
+const std::vector<Item> & Template::items() const
+{
+    return _impl->_items;
+}
+
+bool Template::is_big_endian() const
+{
+    return _impl->_big_endian;
+}
+
+template<io::ByteOrder Order>
+static void GenerateItems(const Item * items, size_t count, Buffer & dst)
+{
+    io::EndianWriter<Order> writer(dst);
+    for(size_t i = 0; i < count; ++i) {
+        const Item & item = items[i];
         switch(item.type) {
-        case Item::BYTE:    dst.writeU8(item.u.byte); break;
-        case Item::WORD:    dst.writeU16(item.u.word); break;
-        case Item::DWORD:   dst.writeU32(item.u.dword); break;
-        case Item::BUFFER:  dst.write(item.u.buffer.data, item.u.buffer.count); break;
+        case Item::BYTE:    writer.writeU8(item.u.byte); break;
+        case Item::WORD:    writer.writeU16(item.u.word); break;
+        case Item::WORD24:  writer.writeU24(item.u.dword); break;
+        case Item::DWORD:   writer.writeU32(item.u.dword); break;
+        case Item::QWORD:   writer.writeU64(item.u.qword); break;
+        case Item::FLOAT:   writer.writeU32(item.u.dword); break;   //< IEEE 754 bit pattern
+        case Item::DOUBLE:  writer.writeU64(item.u.qword); break;
+        case Item::BUFFER:
+            {
+                const size_t size = item.u.buffer.width * item.u.buffer.count;
+                if (!size) {
+                    break;
+                }
+                switch(item.u.buffer.width) {
+                case 2:     io::convert_array16<Order>(dst.allocate(size), item.u.buffer.data, item.u.buffer.count); break;
+                case 4:     io::convert_array32<Order>(dst.allocate(size), item.u.buffer.data, item.u.buffer.count); break;
+                case 8:     io::convert_array64<Order>(dst.allocate(size), item.u.buffer.data, item.u.buffer.count); break;
+                default:    dst.write(item.u.buffer.data, size); break;
+                }
+                break;
+            }
         case Item::LAZY:    if (item.u.lazy) item.u.lazy->evaluate(dst); break;
         default:
             break;
@@ -244,6 +350,17 @@ void Template::generate(Buffer & dst)
     }
 }
 
+void GenerateItems(const Item * items, size_t count, bool big_endian, Buffer & dst)
+{
+    /// lazy evaluators write through the buffer, so it follows the template
+    ByteOrderScope scope(dst, big_endian);
+    if (big_endian) {
+        GenerateItems<io::ORDER_BIG_ENDIAN>(items, count, dst);
+    } else {
+        GenerateItems<io::ORDER_LITTLE_ENDIAN>(items, count, dst);
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 //                      Create template from syntax tree                     //
 ///////////////////////////////////////////////////////////////////////////////
@@ -259,6 +376,10 @@ size_t UpdateWithConstant(shared_ptr<Template> tp,
         case parser::UNSIGNED16:    mutator = new UnsignedMutator<uint16_t>(constant->u.u16); break;
         case parser::UNSIGNED32:    mutator = new UnsignedMutator<uint32_t>(constant->u.u32); break;
         case parser::UNSIGNED64:    mutator = new UnsignedMutator<uint64_t>(constant->u.u64); break;
+        case parser::SIGNED8:       mutator = new SignedMutator<int8_t>(constant->u.i8); break;
+        case parser::SIGNED16:      mutator = new SignedMutator<int16_t>(constant->u.i16); break;
+        case parser::SIGNED32:      mutator = new SignedMutator<int32_t>(constant->u.i32); break;
+        case parser::SIGNED64:      mutator = new SignedMutator<int64_t>(constant->u.i64); break;
         default:
             throw std::runtime_error("Mutator not available for constan type.");
         }
@@ -270,6 +391,10 @@ size_t UpdateWithConstant(shared_ptr<Template> tp,
         case parser::UNSIGNED16:    return tp->u16(constant->u.u16);
         case parser::UNSIGNED32:    return tp->u32(constant->u.u32);
         case parser::UNSIGNED64:    return tp->u64(constant->u.u64);
+        case parser::SIGNED8:       return tp->u8(constant->u.u8);
+        case parser::SIGNED16:      return tp->u16(constant->u.u16);
+        case parser::SIGNED32:      return tp->u32(constant->u.u32);
+        case parser::SIGNED64:      return tp->u64(constant->u.u64);
         default:
             throw std::runtime_error("Constant type not supported.");
         }
@@ -12,6 +12,9 @@ namespace fuzzer {
 
 namespace runtime {
 
+struct Item;
+class StructureMutator;
+
 ///
 /// \class  Template
 ///
@@ -31,15 +34,26 @@ public:
     size_t u24(uint32_t, size_t pos = ~0L);
     size_t u32(uint32_t, size_t pos = ~0L);
     size_t u64(uint64_t, size_t pos = ~0L);
+    size_t f32(float, size_t pos = ~0L);
+    size_t f64(double, size_t pos = ~0L);
 
     /// add a lazy evaluator
     size_t lazy(LazyEvaluation *, size_t pos = ~0L);
 
+    /// add an array, elements wider than a byte are written in the
+    /// byte order of the template.
     template<class T>
     size_t array(const T * data, size_t count, size_t pos = ~0L) {
-        return _array(data, sizeof(T) * count);
+        return _array(data, sizeof(T), count, pos);
     };
 
+    ///
+    /// \brief  Generates the template through \p mutator, a mutator of the
+    ///         item list that is registered after the mutators of the items.
+    ///         The template takes ownership of the mutator.
+    ///
+    Template & structure(StructureMutator * mutator);
+
     ///
     /// \brief  Get the registered mutators
     ///
@@ -51,8 +65,16 @@ public:
     void generate(std::vector<uint8_t> &);
     void generate(Buffer &);
 
+    ///
+    /// \brief  The items of the template, see templateitem.h. The items
+    ///         stay owned by the template.
+    ///
+    const std::vector<Item> & items() const;
+
+    bool is_big_endian() const;
+
 protected:
-    size_t _array(const void *, size_t, size_t pos = ~0L);
+    size_t _array(const void *, size_t width, size_t count, size_t pos = ~0L);
     
 protected:
     class Implementation;
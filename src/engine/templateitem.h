@@ -0,0 +1,54 @@
+#ifndef _TEMPLATEITEM_H_
+#define _TEMPLATEITEM_H_
+
+#include "lazy.h"
+#include <stdint.h>
+
+namespace fuzzer {
+
+namespace runtime {
+
+///
+/// \class  Item
+/// \brief  Template item. Items are plain values, buffers and lazy
+///         evaluators are owned by the template that created them.
+///
+struct Item {
+    enum {
+        BYTE,
+        WORD,
+        WORD24,
+        DWORD,
+        QWORD,
+        FLOAT,
+        DOUBLE,
+        BUFFER,
+        LAZY
+    } type;
+
+    union {
+        uint8_t             byte;
+        uint16_t            word;
+        uint32_t            dword;
+        uint64_t            qword;
+        float               spf;
+        double              dpf;
+        LazyEvaluation *    lazy;
+        struct {
+            size_t  count;      //< number of elements
+            size_t  width;      //< size of each element in bytes
+            void *  data;
+        } buffer;
+    } u;
+};
+
+///
+/// \brief  Generates \p count items in the given byte order.
+///
+void GenerateItems(const Item * items, size_t count, bool big_endian, Buffer & dst);
+
+} // namespace runtime
+
+} // namespace fuzzer
+
+#endif
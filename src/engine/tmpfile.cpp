@@ -2,14 +2,76 @@
 #ifdef WIN32
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
+#else
+#include <sys/uio.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <unistd.h>
 #endif
 #include <stdexcept>
 #include <sstream>
 
 namespace fuzzer {
 
+#ifndef WIN32
+/// writes all pieces, retrying short writes
+static bool WritePieces(int fd, const io::Piece * pieces, size_t count)
+{
+    static const size_t MaxBuffers = 64;
+    size_t index = 0, offset = 0;   //< first unwritten byte
+    while(index < count) {
+        struct iovec buffers[MaxBuffers];
+        size_t n = 0;
+        for(size_t i = index; i < count && n < MaxBuffers; ++i) {
+            const size_t skip = (i == index) ? offset : 0;
+            if (pieces[i].length == skip) {
+                continue;
+            }
+            buffers[n].iov_base = const_cast<char *>(static_cast<const char *>(pieces[i].base) + skip);
+            buffers[n].iov_len  = pieces[i].length - skip;
+            ++n;
+        }
+        if (!n) {
+            break;
+        }
+        ssize_t res = writev(fd, buffers, static_cast<int>(n));
+        if (res < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        /// skip the pieces that were written
+        size_t written = static_cast<size_t>(res);
+        while(index < count && written >= (pieces[index].length - offset)) {
+            written -= pieces[index].length - offset;
+            offset = 0;
+            ++index;
+        }
+        offset += written;
+    }
+    return true;
+}
+#endif
+
 TmpFile::TmpFile(const std::vector<uint8_t> & payload,
-    const char * Template)
+    const char * /* Template */)
+{
+    io::Piece piece;
+    piece.base      = payload.data();
+    piece.length    = payload.size();
+    create(&piece, 1);
+}
+
+TmpFile::TmpFile(const runtime::Rope & payload,
+    const char * /* Template */)
+{
+    std::vector<io::Piece> pieces;
+    payload.pieces(pieces);
+    create(pieces.data(), pieces.size());
+}
+
+void TmpFile::create(const io::Piece * pieces, size_t count)
 {
 #ifdef WIN32
     char path[MAX_PATH+1];
@@ -25,29 +87,47 @@ TmpFile::TmpFile(const std::vector<uint8_t> & payload,
     _filename = filename;
 
     // now create the file
-    FILE * file = fopen(_filename.c_str(), "w");
+    FILE * file = fopen(_filename.c_str(), "wb");
     if (!file) {
         throw std::runtime_error("Failed to open file for writing.");
     }
 
-    if (fwrite(&payload[0],payload.size(), 1, file) != 1) {
-        fclose(file);
-        DeleteFileA(_filename.c_str());
-        throw std::runtime_error("Failed to write file.");
+    for(size_t i = 0; i < count; ++i) {
+        if (pieces[i].length && fwrite(pieces[i].base, pieces[i].length, 1, file) != 1) {
+            fclose(file);
+            DeleteFileA(_filename.c_str());
+            throw std::runtime_error("Failed to write file.");
+        }
     }
     fclose(file);
 #else
-#error "Support not implemented"
+    const char * directory = getenv("TMPDIR");
+    std::string name = std::string(directory && *directory ? directory : "/tmp") + "/fuzXXXXXX";
+    const int fd = mkstemp(&name[0]);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to generate temporary name.");
+    }
+
+    _filename = name;
+
+    const bool written = WritePieces(fd, pieces, count);
+    if (close(fd) != 0 || !written) {
+        unlink(_filename.c_str());
+        _filename.clear();
+        throw std::runtime_error("Failed to write file.");
+    }
 #endif
 }
 
 TmpFile::~TmpFile()
 {
-#ifdef WIN32
     if (!_filename.empty()) {
+#ifdef WIN32
         DeleteFileA(_filename.c_str());
-    }
+#else
+        unlink(_filename.c_str());
 #endif
+    }
 }
 
 }
\ No newline at end of file
@@ -2,7 +2,9 @@
 #define _TMPFILE_H_
 
 #include <vector>
+#include <string>
 #include <stdint.h>
+#include "rope.h"
 
 namespace fuzzer {
 
@@ -15,11 +17,19 @@ public:
     TmpFile(const std::vector<uint8_t> & payload,
         const char * Template);
 
+    ///
+    /// \brief  Writes the pieces of the rope, without flattening it first.
+    ///
+    TmpFile(const runtime::Rope & payload,
+        const char * Template);
+
     virtual ~TmpFile();
 
     const std::string & filename() const { return _filename; }
 
 protected:
+    void create(const io::Piece * pieces, size_t count);
+
     std::string     _filename;
 };
 
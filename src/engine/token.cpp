@@ -46,6 +46,12 @@ static struct {
     { "u24", T_KEYWORD_U24},
     { "u32", T_KEYWORD_U32},
     { "u64", T_KEYWORD_U64},
+    { "s8", T_KEYWORD_S8},
+    { "s16", T_KEYWORD_S16},
+    { "s32", T_KEYWORD_S32},
+    { "s64", T_KEYWORD_S64},
+    { "float", T_TYPE_FLOAT},
+    { "double", T_TYPE_DOUBLE},
     { "byte", T_KEYWORD_BYTE},
     { "word", T_KEYWORD_WORD},
     { "dword", T_KEYWORD_DWORD},
@@ -53,11 +59,16 @@ static struct {
     { "array", T_KEYWORD_ARRAY},
     { "function", T_FUNCTION},
     { "template", T_TEMPLATE},
+    { "response", T_RESPONSE},
     { "return", T_RETURN },
     { "var", T_VAR },
     { "cstring", T_KEYWORD_CSTRING },
     { "pascalstring", T_KEYWORD_PASCAL_STRING },
-    { "line", T_KEYWORD_LINE }
+    { "line", T_KEYWORD_LINE },
+    { "utf8", T_KEYWORD_UTF8 },
+    { "uri", T_KEYWORD_URI },
+    { "plugin", T_KEYWORD_PLUGIN },
+    { "structure", T_KEYWORD_STRUCTURE }
 };
 
 bool Tokenizer::GetChar(char & c)
@@ -210,6 +221,15 @@ Symbol_t Tokenizer::GetSym()
                     GetChar(c);
                     value += c;
                 }
+                else if ((c == 'e' || c == 'E') && value.find_first_of("eE") == std::string::npos) {
+                    /** exponent with an optional sign */
+                    GetChar(c);
+                    value += c;
+                    if (Peek(c) && (c == '-' || c == '+')) {
+                        GetChar(c);
+                        value += c;
+                    }
+                }
                 else if (c == 'f') {
                     GetChar(c);
                     break;
@@ -218,7 +238,7 @@ Symbol_t Tokenizer::GetSym()
                     break;
                 }
             }
-            /** convert to float */
+            /** convert to double */
             {
                 std::stringstream ss;
                 ss << value;
@@ -296,6 +316,7 @@ const char * Tokenizer::GetTokenString(Symbol_t sym)
     case T_KEYWORD_TRUE:            return stringify(T_KEYWORD_TRUE);
     case T_KEYWORD_FALSE:           return stringify(T_KEYWORD_FALSE);
     case T_TYPE_FLOAT:              return stringify(T_TYPE_FLOAT);
+    case T_TYPE_DOUBLE:             return stringify(T_TYPE_DOUBLE);
     case T_INTEGER:                 return stringify(T_TYPE_INTEGER);
     case T_REAL:                    return stringify(T_REAL);
     case T_ASSIGN:                  return stringify(T_ASSIGN);
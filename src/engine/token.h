@@ -20,6 +20,10 @@ typedef enum {
     T_KEYWORD_CSTRING,
     T_KEYWORD_PASCAL_STRING,
     T_KEYWORD_LINE,
+    T_KEYWORD_UTF8,
+    T_KEYWORD_URI,
+    T_KEYWORD_PLUGIN,
+    T_KEYWORD_STRUCTURE,
 
     /** keywords */
     T_KEYWORD_U8,
@@ -37,6 +41,7 @@ typedef enum {
     T_OUTPUT,       // "<<"
     T_INPUT,
     T_TEMPLATE,
+    T_RESPONSE,
     T_FUNCTION,
     T_VAR,
 
@@ -52,6 +57,7 @@ typedef enum {
     T_KEYWORD_FALSE,
     /** types */
     T_TYPE_FLOAT,
+    T_TYPE_DOUBLE,
     T_TYPE_BOOL,
     T_INTEGER,
     T_REAL,
@@ -121,8 +127,8 @@ public:
     Symbol_t    Peek();
 
     SymbolTable::SymIndex       SymIndex() const            { return u.m_SymbolIndex; }
-    float                       RealValue() const           { return u.m_RealValue; }
-    int                         IntValue() const            { return u.m_IntValue; }
+    double                      RealValue() const           { return u.m_RealValue; }
+    uint64_t                    IntValue() const            { return u.m_IntValue; }
     SymbolTable &               SymbolTable()               { return m_SymbolTable; }
     const PositionInfo &        Position() const            { return m_Position; }
 
@@ -157,8 +163,8 @@ protected:
 
     union {
         SymbolTable::SymIndex           m_SymbolIndex;
-        float                           m_RealValue;
-        int                             m_IntValue;
+        double                          m_RealValue;
+        uint64_t                        m_IntValue;
     } u;
 };
 
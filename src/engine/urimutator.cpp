@@ -0,0 +1,376 @@
+#include "urimutator.h"
+#include "utf8.h"
+#include <cstring>
+
+namespace fuzzer {
+
+namespace runtime {
+
+static const char * SchemeStrings[] = {
+    "file",
+    "javascript",
+    "HTTP",
+    "http:",
+    "1http"
+};
+
+static const char * UserInfoStrings[] = {
+    ":",
+    "@",
+    "user:%00",
+    "user:pass:extra",
+    "%40%3a"
+};
+
+static const char * HostStrings[] = {
+    "localhost",
+    "127.0.0.1",
+    "0x7f000001",
+    "2130706433",
+    "[::1]",
+    "[::ffff:127.0.0.1]",
+    "[",
+    "host%00.example",
+    "a..b"
+};
+
+static const char * PortStrings[] = {
+    "0",
+    "65535",
+    "65536",
+    "-1",
+    "4294967297",
+    "99999999999999999999",
+    "0x50",
+    "80:80"
+};
+
+static const char * SegmentStrings[] = {
+    ".",
+    "..",
+    "%2e%2e",
+    "%2e%2e%2f%2e%2e%2f%2e%2e%2f%2e%2e%2fetc%2fpasswd",
+    "../../../../../../../../etc/passwd",
+    "..\\..\\..\\..\\..\\..\\boot.ini",
+    "....//....//....//etc/passwd",
+    "%00",
+    "%",
+    ";"
+};
+
+static const char * QueryStrings[] = {
+    "%00",
+    "%",
+    "%zz",
+    "&",
+    "=",
+    "[]",
+    "'",
+    "%u0000"
+};
+
+static const char * FragmentStrings[] = {
+    "%00",
+    "#",
+    "%"
+};
+
+static const struct {
+    const char **   strings;
+    size_t          count;
+} Replacements[UriMutator::COMPONENT_COUNT] = {
+    { SchemeStrings,    sizeof(SchemeStrings) / sizeof(SchemeStrings[0]) },
+    { UserInfoStrings,  sizeof(UserInfoStrings) / sizeof(UserInfoStrings[0]) },
+    { HostStrings,      sizeof(HostStrings) / sizeof(HostStrings[0]) },
+    { PortStrings,      sizeof(PortStrings) / sizeof(PortStrings[0]) },
+    { SegmentStrings,   sizeof(SegmentStrings) / sizeof(SegmentStrings[0]) },
+    { QueryStrings,     sizeof(QueryStrings) / sizeof(QueryStrings[0]) },
+    { QueryStrings,     sizeof(QueryStrings) / sizeof(QueryStrings[0]) },
+    { FragmentStrings,  sizeof(FragmentStrings) / sizeof(FragmentStrings[0]) }
+};
+
+static const char HexDigits[] = "0123456789ABCDEF";
+
+UriMutator::UriMutator(Representation representation, const char * Initial) :
+    StringRepresentation(representation),
+    _initial(Initial ? Initial : ""),
+    _count(1),
+    _index(0),
+    _slice(0),
+    _operation(0)
+{
+    parse();
+    for(size_t i = 0; i < _slices.size(); ++i) {
+        _count += operations(_slices[i]);
+    }
+}
+
+///
+/// \brief  Splits the initial string into components, roughly following
+///         RFC 3986: scheme ":" [ "//" authority ] path [ "?" query ] [ "#" fragment ]
+///
+void UriMutator::parse()
+{
+    const std::string & uri = _initial;
+    const size_t end = uri.size();
+    size_t pos = 0;
+
+    /// the scheme is only present if ':' comes before any delimiter
+    size_t colon = uri.find_first_of(":/?#");
+    if (colon != std::string::npos && colon > 0 && uri[colon] == ':') {
+        add(0, colon, SCHEME);
+        pos = colon + 1;
+    }
+    if (uri.compare(pos, 2, "//") == 0) {
+        size_t authority = pos + 2;
+        pos = uri.find_first_of("/?#", authority);
+        if (pos == std::string::npos) {
+            pos = end;
+        }
+        parseAuthority(authority, pos);
+    }
+
+    /// path segments
+    size_t path = uri.find_first_of("?#", pos);
+    if (path == std::string::npos) {
+        path = end;
+    }
+    if (pos < path) {
+        size_t segment = (uri[pos] == '/') ? pos + 1 : pos;
+        for(;;) {
+            size_t slash = uri.find('/', segment);
+            if (slash == std::string::npos || slash > path) {
+                slash = path;
+            }
+            add(segment, slash, SEGMENT);
+            if (slash == path) {
+                break;
+            }
+            segment = slash + 1;
+        }
+    }
+    pos = path;
+
+    /// query pairs
+    if (pos < end && uri[pos] == '?') {
+        size_t query = uri.find('#', pos);
+        if (query == std::string::npos) {
+            query = end;
+        }
+        size_t pair = pos + 1;
+        while(pair <= query) {
+            size_t amp = uri.find('&', pair);
+            if (amp == std::string::npos || amp > query) {
+                amp = query;
+            }
+            size_t equal = uri.find('=', pair);
+            if (equal != std::string::npos && equal < amp) {
+                add(pair, equal, QUERY_KEY);
+                add(equal + 1, amp, QUERY_VALUE);
+            } else {
+                add(pair, amp, QUERY_KEY);
+            }
+            pair = amp + 1;
+        }
+        pos = query;
+    }
+
+    /// fragment
+    if (pos < end && uri[pos] == '#') {
+        add(pos + 1, end, FRAGMENT);
+    }
+}
+
+void UriMutator::parseAuthority(size_t begin, size_t end)
+{
+    const std::string & uri = _initial;
+    size_t at = uri.rfind('@', end - 1);
+    if (end > begin && at != std::string::npos && at >= begin) {
+        add(begin, at, USERINFO);
+        begin = at + 1;
+    }
+    /// the port follows the last ':', unless it is inside an IPv6 literal
+    size_t host = end;
+    for(size_t i = end; i > begin; --i) {
+        if (uri[i - 1] == ']') {
+            break;
+        } else if (uri[i - 1] == ':') {
+            host = i - 1;
+            break;
+        }
+    }
+    add(begin, host, HOST);
+    if (host < end) {
+        add(host + 1, end, PORT);
+    }
+}
+
+void UriMutator::add(size_t begin, size_t end, Component component)
+{
+    Slice slice;
+    slice.offset    = begin;
+    slice.size      = end - begin;
+    slice.component = component;
+    _slices.push_back(slice);
+}
+
+size_t UriMutator::operations(const Slice & slice)
+{
+    return OPERATION_COUNT + Replacements[slice.component].count;
+}
+
+bool UriMutator::mutate()
+{
+    if (finished()) {
+        return false;
+    }
+    if (++_index > 1) {
+        if (++_operation >= operations(_slices[_slice])) {
+            ++_slice;
+            _operation = 0;
+        }
+    }
+    return !finished();
+}
+
+bool UriMutator::finished()
+{
+    return _index >= _count;
+}
+
+void UriMutator::reset()
+{
+    _index      = 0;
+    _slice      = 0;
+    _operation  = 0;
+}
+
+void UriMutator::seek(size_t index)
+{
+    _index      = index;
+    _slice      = 0;
+    _operation  = index ? index - 1 : 0;
+    while(_slice < _slices.size() && _operation >= operations(_slices[_slice])) {
+        _operation -= operations(_slices[_slice]);
+        ++_slice;
+    }
+}
+
+static size_t PercentUtf8Length(uint8_t c)
+{
+    /// each byte of the overlong sequence is written as %XX
+    return (c < 0x80 ? 2 : 3) * 3;
+}
+
+size_t UriMutator::mutatedLength() const
+{
+    const Slice & slice = _slices[_slice];
+    const size_t size = slice.size ? slice.size : 1;
+    switch(_operation) {
+    case EMPTY:             return 0;
+    case DUPLICATE:         return slice.size * 2;
+    case OVERLONG:          return ((OverlongSize + size - 1) / size) * size;
+    case OVERLONG_MAX:      return ((OverlongMaxSize + size - 1) / size) * size;
+    case PERCENT:           return slice.size * 3;
+    case PERCENT_DOUBLE:    return slice.size * 5;
+    case PERCENT_UTF8:
+        {
+            size_t length = 0;
+            for(size_t i = 0; i < slice.size; ++i) {
+                length += PercentUtf8Length(static_cast<uint8_t>(_initial[slice.offset + i]));
+            }
+            return length;
+        }
+    default:
+        return strlen(Replacements[slice.component].strings[_operation - OPERATION_COUNT]);
+    }
+}
+
+size_t UriMutator::length() const
+{
+    if (_index == 0 || _index >= _count) {
+        return _initial.size();
+    }
+    return _initial.size() - _slices[_slice].size + mutatedLength();
+}
+
+void UriMutator::writeMutated(Buffer & buffer) const
+{
+    const Slice & slice = _slices[_slice];
+    const uint8_t * data = reinterpret_cast<const uint8_t *>(_initial.c_str()) + slice.offset;
+    switch(_operation) {
+    case EMPTY:
+        break;
+    case DUPLICATE:
+        buffer.write(data, slice.size);
+        buffer.write(data, slice.size);
+        break;
+    case OVERLONG:
+    case OVERLONG_MAX:
+        {
+            /// repeat the component, or 'A' if it is empty
+            StringEntry entry;
+            entry.data      = slice.size ? reinterpret_cast<const char *>(data) : "A";
+            entry.size      = slice.size ? slice.size : 1;
+            entry.repeat    = mutatedLength() / entry.size;
+            entry.write(buffer);
+        }
+        break;
+    case PERCENT:
+    case PERCENT_DOUBLE:
+        {
+            const bool twice = (_operation == PERCENT_DOUBLE);
+            uint8_t * dst = buffer.allocate(slice.size * (twice ? 5 : 3));
+            for(size_t i = 0; i < slice.size; ++i) {
+                *dst++ = '%';
+                if (twice) {
+                    *dst++ = '2';
+                    *dst++ = '5';
+                }
+                *dst++ = HexDigits[data[i] >> 4];
+                *dst++ = HexDigits[data[i] & 0x0f];
+            }
+        }
+        break;
+    case PERCENT_UTF8:
+        {
+            uint8_t * dst = buffer.allocate(mutatedLength());
+            for(size_t i = 0; i < slice.size; ++i) {
+                uint8_t bytes[io::Utf8MaxSequence];
+                const size_t count = io::utf8_encode_long(data[i], data[i] < 0x80 ? 2 : 3, bytes);
+                for(size_t j = 0; j < count; ++j) {
+                    *dst++ = '%';
+                    *dst++ = HexDigits[bytes[j] >> 4];
+                    *dst++ = HexDigits[bytes[j] & 0x0f];
+                }
+            }
+        }
+        break;
+    default:
+        {
+            const char * str = Replacements[slice.component].strings[_operation - OPERATION_COUNT];
+            buffer.write(str, strlen(str));
+        }
+        break;
+    }
+}
+
+void UriMutator::evaluate(Buffer & buffer)
+{
+    prefix(buffer, length());
+    if (_index == 0 || finished()) {
+        buffer.write(_initial.c_str(), _initial.size());
+    } else {
+        /// the text before and after the mutated component is unchanged
+        const Slice & slice = _slices[_slice];
+        const size_t end = slice.offset + slice.size;
+        buffer.write(_initial.c_str(), slice.offset);
+        writeMutated(buffer);
+        buffer.write(_initial.c_str() + end, _initial.size() - end);
+    }
+    suffix(buffer);
+}
+
+} // namespace runtime
+
+} // namespace fuzzer
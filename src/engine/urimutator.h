@@ -2,6 +2,9 @@
 #define _URIMUTATOR_H_
 
 #include "mutator.h"
+#include "stringmutator.h"
+#include <string>
+#include <vector>
 
 namespace fuzzer {
 
@@ -9,15 +12,91 @@ namespace runtime {
 
 ///
 /// \class  UriMutator
-/// \brief  Mutator for URI:s
+/// \brief  Mutator for URI:s. The initial URI is split once into component
+///         slices (scheme, userinfo, host, port, path segments, query keys
+///         and values, fragment). Each mutation changes a single component,
+///         the rest of the URI is copied from the initial string as is.
 ///
-class UriMutator : public Mutator
+class UriMutator : public Mutator, public StringRepresentation
 {
+public:
+    enum Component {
+        SCHEME,
+        USERINFO,
+        HOST,
+        PORT,
+        SEGMENT,
+        QUERY_KEY,
+        QUERY_VALUE,
+        FRAGMENT,
+        COMPONENT_COUNT
+    };
 
+    ///
+    /// \brief  Mutations applied to every component, followed by the
+    ///         replacement strings for the component type.
+    ///
+    enum Operation {
+        EMPTY,              //< removed
+        DUPLICATE,          //< written twice
+        OVERLONG,           //< repeated to OverlongSize bytes
+        OVERLONG_MAX,       //< repeated to OverlongMaxSize bytes
+        PERCENT,            //< every byte as %XX
+        PERCENT_DOUBLE,     //< every byte as %25XX
+        PERCENT_UTF8,       //< every byte as an overlong UTF-8 sequence, %C0%AF
+        OPERATION_COUNT
+    };
+
+    static const size_t OverlongSize    = 1024;
+    static const size_t OverlongMaxSize = 0x10000;
+
+    struct Slice {
+        size_t      offset;
+        size_t      size;
+        Component   component;
+    };
+
+    UriMutator(Representation representation, const char * Initial);
+
+    virtual bool mutate();
+    virtual bool finished();
+    virtual void reset();
+    virtual void evaluate(Buffer &);
+
+    /// number of mutations
+    size_t count() const { return _count; }
+    /// index of the current mutation
+    size_t position() const { return _index; }
+    /// jump to a mutation, seeking past the end finishes the mutator
+    void seek(size_t index);
+
+    /// the components of the initial URI
+    const std::vector<Slice> & slices() const { return _slices; }
+
+    /// length of the current URI, excluding prefix and suffix
+    size_t length() const;
+
+protected:
+    void parse();
+    void parseAuthority(size_t begin, size_t end);
+    void add(size_t begin, size_t end, Component);
+
+    /// number of mutations for a slice
+    static size_t operations(const Slice &);
+    /// bytes written for the current mutation of the current slice
+    size_t mutatedLength() const;
+    void writeMutated(Buffer &) const;
+
+    std::string             _initial;
+    std::vector<Slice>      _slices;
+    size_t                  _count;
+    size_t                  _index;
+    size_t                  _slice;         //< slice of the current mutation
+    size_t                  _operation;     //< operation on that slice
 };
 
 } // namespace runtime
 
 } // namespace fuzzer
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,148 @@
+#include "utf8.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HAVE_SSE2_MOVEMASK
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define HAVE_NEON_MAXV
+#endif
+
+namespace fuzzer {
+
+namespace io {
+
+size_t utf8_encode(uint32_t codepoint, uint8_t * dst)
+{
+    size_t length;
+    if (codepoint < 0x80) {
+        length = 1;
+    } else if (codepoint < 0x800) {
+        length = 2;
+    } else if (codepoint < 0x10000) {
+        length = 3;
+    } else if (codepoint < 0x200000) {
+        length = 4;
+    } else if (codepoint < 0x4000000) {
+        length = 5;
+    } else {
+        length = 6;
+    }
+    return utf8_encode_long(codepoint, length, dst);
+}
+
+size_t utf8_encode_long(uint32_t codepoint, size_t length, uint8_t * dst)
+{
+    if (length == 1) {
+        if (codepoint >= 0x80) {
+            return 0;
+        }
+        dst[0] = static_cast<uint8_t>(codepoint);
+        return 1;
+    }
+    if (length < 2 || length > Utf8MaxSequence) {
+        return 0;
+    }
+    /// payload bits: 5 + 6, 4 + 12, 3 + 18, 2 + 24, 1 + 30
+    const size_t bits = (7 - length) + 6 * (length - 1);
+    if (bits < 32 && (codepoint >> bits) != 0) {
+        return 0;
+    }
+    const uint8_t prefix = static_cast<uint8_t>(0xff00 >> length);
+    dst[0] = static_cast<uint8_t>(prefix | (codepoint >> (6 * (length - 1))));
+    for(size_t i = 1; i < length; ++i) {
+        dst[i] = static_cast<uint8_t>(0x80 | ((codepoint >> (6 * (length - 1 - i))) & 0x3f));
+    }
+    return length;
+}
+
+size_t utf8_sequence_length(uint8_t lead)
+{
+    if (lead < 0x80) {
+        return 1;
+    } else if (lead < 0xc2) {
+        return 0;   //< continuation byte or overlong lead
+    } else if (lead < 0xe0) {
+        return 2;
+    } else if (lead < 0xf0) {
+        return 3;
+    } else if (lead < 0xf5) {
+        return 4;
+    }
+    return 0;
+}
+
+///
+/// \brief  Number of leading bytes in \p src that are ASCII, in whole blocks.
+///
+#if defined(HAVE_SSE2_MOVEMASK)
+static size_t ascii_blocks(const uint8_t * src, size_t size)
+{
+    size_t offset = 0;
+    for(; (offset + 16) <= size; offset += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + offset));
+        if (_mm_movemask_epi8(v)) {
+            break;
+        }
+    }
+    return offset;
+}
+#elif defined(HAVE_NEON_MAXV)
+static size_t ascii_blocks(const uint8_t * src, size_t size)
+{
+    size_t offset = 0;
+    for(; (offset + 16) <= size; offset += 16) {
+        if (vmaxvq_u8(vld1q_u8(src + offset)) >= 0x80) {
+            break;
+        }
+    }
+    return offset;
+}
+#else
+static size_t ascii_blocks(const uint8_t *, size_t)
+{
+    return 0;
+}
+#endif
+
+size_t utf8_validate(const uint8_t * src, size_t size)
+{
+    size_t offset = 0;
+    while(offset < size) {
+        offset += ascii_blocks(src + offset, size - offset);
+        if (offset >= size) {
+            break;
+        }
+        const uint8_t lead = src[offset];
+        const size_t length = utf8_sequence_length(lead);
+        if (!length || (offset + length) > size) {
+            return offset;
+        }
+        if (length > 1) {
+            /// the second byte is restricted to reject overlongs, surrogates
+            /// and values above U+10FFFF
+            uint8_t lower = 0x80, upper = 0xbf;
+            switch(lead) {
+            case 0xe0:  lower = 0xa0; break;
+            case 0xed:  upper = 0x9f; break;
+            case 0xf0:  lower = 0x90; break;
+            case 0xf4:  upper = 0x8f; break;
+            default:    break;
+            }
+            if (src[offset + 1] < lower || src[offset + 1] > upper) {
+                return offset;
+            }
+            for(size_t i = 2; i < length; ++i) {
+                if ((src[offset + i] & 0xc0) != 0x80) {
+                    return offset;
+                }
+            }
+        }
+        offset += length;
+    }
+    return size;
+}
+
+} // namespace io
+
+} // namespace fuzzer
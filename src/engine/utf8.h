@@ -0,0 +1,46 @@
+#ifndef _UTF8_H_
+#define _UTF8_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace fuzzer {
+
+namespace io {
+
+/// longest sequence, including the 5 and 6 byte forms removed by RFC 3629
+static const size_t Utf8MaxSequence = 6;
+
+///
+/// \brief  Encodes \p codepoint using the shortest form. Unlike a strict
+///         encoder, surrogates and values up to 0x7fffffff are accepted so
+///         that invalid sequences can be produced. Returns the number of
+///         bytes written to \p dst.
+///
+size_t utf8_encode(uint32_t codepoint, uint8_t * dst);
+
+///
+/// \brief  Encodes \p codepoint using exactly \p length bytes (1-6), which
+///         gives an overlong sequence if the codepoint fits in fewer bytes.
+///         Returns the number of bytes written, or 0 if it doesn't fit.
+///
+size_t utf8_encode_long(uint32_t codepoint, size_t length, uint8_t * dst);
+
+///
+/// \brief  Number of bytes in the sequence started by \p lead, or 0 if
+///         \p lead can't start a valid sequence.
+///
+size_t utf8_sequence_length(uint8_t lead);
+
+///
+/// \brief  Validates \p size bytes according to RFC 3629. Returns the length
+///         of the valid prefix, which is \p size if all of it is valid. ASCII
+///         runs are skipped 16 bytes at a time where the target supports it.
+///
+size_t utf8_validate(const uint8_t * src, size_t size);
+
+} // namespace io
+
+} // namespace fuzzer
+
+#endif
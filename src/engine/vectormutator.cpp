@@ -0,0 +1,50 @@
+#include "vectormutator.h"
+#include <cstring>
+
+namespace fuzzer {
+
+namespace runtime {
+
+///
+/// \brief  Creates the pattern blocks, done once.
+///
+static std::vector<uint8_t> CreatePatterns()
+{
+    std::vector<uint8_t> blocks(PatternBuffer::PATTERN_COUNT * PatternBuffer::BlockSize);
+    uint8_t * block = &blocks[0];
+
+    memset(block + PatternBuffer::ZERO * PatternBuffer::BlockSize, 0x00, PatternBuffer::BlockSize);
+    memset(block + PatternBuffer::ONES * PatternBuffer::BlockSize, 0xff, PatternBuffer::BlockSize);
+    memset(block + PatternBuffer::ASCII * PatternBuffer::BlockSize, 'A', PatternBuffer::BlockSize);
+    memset(block + PatternBuffer::HIGH_BIT * PatternBuffer::BlockSize, 0x80, PatternBuffer::BlockSize);
+    uint8_t * ramp = block + PatternBuffer::RAMP * PatternBuffer::BlockSize;
+    for(size_t i = 0; i < PatternBuffer::BlockSize; ++i) {
+        ramp[i] = static_cast<uint8_t>(i);
+    }
+    return blocks;
+}
+
+const uint8_t * PatternBuffer::get(Pattern pattern)
+{
+    /// initialized once, thread safe and immutable afterwards
+    static const std::vector<uint8_t> blocks = CreatePatterns();
+    if (pattern >= PATTERN_COUNT) {
+        throw std::runtime_error("Invalid pattern.");
+    }
+    return &blocks[pattern * BlockSize];
+}
+
+void PatternBuffer::write(Buffer & buffer, Pattern pattern, size_t size)
+{
+    const uint8_t * block = get(pattern);
+    for(; size >= BlockSize; size -= BlockSize) {
+        buffer.splice(block, BlockSize);
+    }
+    if (size) {
+        buffer.write(block, size);
+    }
+}
+
+} // namespace runtime
+
+} // namespace fuzzer
@@ -2,23 +2,160 @@
 #define _VECTORMUTATOR_H_
 
 #include "mutator.h"
+#include "buffer.h"
+#include <vector>
 
 namespace fuzzer {
 
 namespace runtime {
 
+///
+/// \class  PatternBuffer
+/// \brief  Process wide, immutable buffers with fill patterns. Arrays of any
+///         size are emitted by repeating a pattern block, so no mutation
+///         ever allocates memory of its own for the array contents.
+///
+class PatternBuffer
+{
+public:
+    enum Pattern {
+        ZERO,           //< 0x00 0x00 ...
+        ONES,           //< 0xff 0xff ...
+        ASCII,          //< 'A' 'A' ...
+        HIGH_BIT,       //< 0x80 0x80 ...
+        RAMP,           //< 0x00 0x01 ... 0xff 0x00 ...
+        PATTERN_COUNT
+    };
+
+    /// size of a pattern block, a multiple of 256 so the ramp is continuous
+    static const size_t BlockSize = 64 * 1024;
+
+    ///
+    /// \brief  Returns the pattern block, BlockSize bytes.
+    ///
+    static const uint8_t * get(Pattern);
+
+    ///
+    /// \brief  Writes \p size bytes of the pattern to the buffer. Whole
+    ///         blocks are spliced, so that a buffer with splices only
+    ///         refers to them.
+    ///
+    static void write(Buffer &, Pattern, size_t size);
+};
+
 ///
 /// \class  VectorMutator
-/// \brief  Mutator for vectors with data
+/// \brief  Mutator for vectors with data. Walks boundary and off-by-one
+///         lengths around [lower, upper], and for each length every fill
+///         pattern in the PatternBuffer. A finished mutator writes the lower
+///         bound of zeroes, so the field is always present.
 ///
 template<class T>
 class VectorMutator : public Mutator
 {
+public:
+    ///
+    /// \brief  Constructor
+    ///
+    /// \param [in] lower   Minimum number of elements.
+    /// \param [in] upper   Maximum number of elements.
+    ///
+    VectorMutator(size_t lower, size_t upper) :
+        _lower(lower),
+        _index(0)
+    {
+        if (lower > upper) {
+            throw std::runtime_error("Invalid array bounds.");
+        }
+        /// lengths inside the range
+        add(lower);
+        if (upper - lower >= 2) {
+            add(lower + 1);
+            add(lower + (upper - lower) / 2);
+            add(upper - 1);
+        }
+        add(upper);
+        /// lengths outside the range
+        add(0);
+        if (lower > 0) {
+            add(lower - 1);
+        }
+        add(upper + 1);
+        add(upper * 2);
+        add(upper + 0x10000);
+        add(MaxOverflowBytes / sizeof(T));
+    }
+
+    virtual bool mutate()
+    {
+        if (finished()) {
+            return false;
+        }
+        ++_index;
+        return !finished();
+    }
+
+    virtual bool finished()
+    {
+        return _index >= (_lengths.size() * PatternBuffer::PATTERN_COUNT);
+    }
+
+    virtual void reset()
+    {
+        _index = 0;
+    }
+
+    virtual void evaluate(Buffer & buffer)
+    {
+        PatternBuffer::write(buffer, pattern(), length() * sizeof(T));
+    }
+
+    /// number of mutations
+    size_t count() const { return _lengths.size() * PatternBuffer::PATTERN_COUNT; }
+
+    /// index of the current mutation
+    size_t position() const { return _index; }
+
+    /// jump to a mutation, seeking past the end finishes the mutator
+    void seek(size_t index) { _index = index; }
+
+    /// number of elements in the current mutation, the lower bound when finished
+    size_t length() const
+    {
+        return _index < count() ? _lengths[_index / PatternBuffer::PATTERN_COUNT] : _lower;
+    }
+
+    /// fill pattern of the current mutation, zeroes when finished
+    PatternBuffer::Pattern pattern() const
+    {
+        return _index < count() ?
+            static_cast<PatternBuffer::Pattern>(_index % PatternBuffer::PATTERN_COUNT) : PatternBuffer::ZERO;
+    }
+
+protected:
+    /// upper limit of the largest overflow case
+    static const size_t MaxOverflowBytes = 16 * 1024 * 1024;
+
+    void add(size_t length)
+    {
+        if ((length * sizeof(T)) > MaxOverflowBytes) {
+            return;
+        }
+        for(size_t i = 0; i < _lengths.size(); ++i) {
+            if (_lengths[i] == length) {
+                return;
+            }
+        }
+        _lengths.push_back(length);
+    }
 
+    std::vector<size_t>     _lengths;   //< element counts to test
+    size_t                  _lower;     //< written when finished
+    size_t                  _index;     //< current length and pattern
 };
 
 } // namespace runtime
 
 } // namespace fuzzer
 
-#endif
\ No newline at end of file
+#endif
@@ -117,6 +117,20 @@ bytecode::Value add(const Value & lhs, const Value & rhs)
         v.opaqueValue = make_shared<vector<uint8_t> >();
         v.opaqueValue->insert(v.opaqueValue->end(), lhs.opaqueValue->begin(), lhs.opaqueValue->end());
         v.opaqueValue->insert(v.opaqueValue->end(), rhs.opaqueValue->begin(), rhs.opaqueValue->end());
+        if (lhs.opaqueSplices || rhs.opaqueSplices) {
+            /// the splices of rhs follow the bytes of lhs
+            v.opaqueSplices = make_shared<vector<runtime::Splice> >();
+            if (lhs.opaqueSplices) {
+                *v.opaqueSplices = *lhs.opaqueSplices;
+            }
+            if (rhs.opaqueSplices) {
+                for(size_t i = 0; i < rhs.opaqueSplices->size(); ++i) {
+                    runtime::Splice splice = (*rhs.opaqueSplices)[i];
+                    splice.offset += lhs.opaqueValue->size();
+                    v.opaqueSplices->push_back(splice);
+                }
+            }
+        }
         break;
     }
     return v;
@@ -231,7 +245,14 @@ bytecode::Value SizeOf(const Value & lhs)
 {
     Value v;
     switch(lhs.type) {
-    case Value::OPAQUE: v.u.uValue = lhs.opaqueValue ? lhs.opaqueValue->size() : 0; break;
+    case Value::OPAQUE:
+        v.u.uValue = lhs.opaqueValue ? lhs.opaqueValue->size() : 0;
+        if (lhs.opaqueSplices) {
+            for(size_t i = 0; i < lhs.opaqueSplices->size(); ++i) {
+                v.u.uValue += (*lhs.opaqueSplices)[i].piece.length;
+            }
+        }
+        break;
     case Value::STRING: v.u.uValue = lhs.stringValue ? lhs.stringValue->size() : 0; break;
     default:
         throw std::runtime_error("TypeError: sizeof operator cannot be applied to primitive type.");
@@ -361,8 +382,13 @@ bytecode::Value VirtualMachine::Execute(const Script & script,
                     /// generate template, and push it on the stack
                     Value v;
                     v.opaqueValue   = make_shared<vector<uint8_t> >();
+                    v.opaqueSplices = make_shared<vector<runtime::Splice> >();
                     v.type          = Value::OPAQUE;
-                    tp->second->generate(*v.opaqueValue);
+                    runtime::Buffer buffer(*v.opaqueValue, *v.opaqueSplices);
+                    tp->second->generate(buffer);
+                    if (v.opaqueSplices->empty()) {
+                        v.opaqueSplices.reset();
+                    }
                     push(operandStack, v);
                 } else {
                     throw std::runtime_error("Invalid string index.");
@@ -0,0 +1,203 @@
+#include "warmpool.h"
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+
+using namespace std;
+
+namespace fuzzer {
+
+namespace runtime {
+
+/// weight of a new sample in the averages
+static const double Weight = 0.125;
+
+/// the supervisor polls the launching applications this often, in ms
+static const size_t PollInterval = 5;
+
+static double Elapsed(const chrono::steady_clock::time_point & since)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - since).count();
+}
+
+static void Average(double & average, double sample)
+{
+    average = average > 0 ? average + (sample - average) * Weight : sample;
+}
+
+WarmPool::WarmPool(IApplicationFactory & factory, const std::string & Interface,
+    uint16_t FirstPort, size_t MaxSize, size_t ConnectTimeout) :
+    _connectTimeout(ConnectTimeout),
+    _size(1),
+    _launchLatency(0),
+    _useTime(0),
+    _stopping(false)
+{
+    if (!MaxSize) {
+        throw std::runtime_error("The warm pool needs at least one application.");
+    }
+    for(size_t i = 0; i < MaxSize; ++i) {
+        const uint16_t port = static_cast<uint16_t>(FirstPort + i);
+        unique_ptr<Instance> instance(new Instance());
+        instance->_server.reset(new network::TcpServer(Interface, port));
+        instance->_app.reset(factory.Create(port));
+        if (!instance->_app) {
+            throw std::runtime_error("Failed to create application for the warm pool.");
+        }
+        instance->_state = Instance::IDLE;
+        _instances.push_back(std::move(instance));
+    }
+    _supervisor = std::thread(&WarmPool::Supervise, this);
+}
+
+WarmPool::~WarmPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _work.notify_all();
+    _supervisor.join();
+
+    for(size_t i = 0; i < _instances.size(); ++i) {
+        Instance & instance = *_instances[i];
+        if (instance._state != Instance::IDLE) {
+            instance._app->Terminate();
+            instance._app->Wait();
+        }
+        instance.connection.reset();
+    }
+}
+
+WarmPool::Instance * WarmPool::Take(size_t Timeout)
+{
+    const chrono::steady_clock::time_point deadline =
+        chrono::steady_clock::now() + chrono::milliseconds(Timeout);
+    std::unique_lock<std::mutex> lock(_mutex);
+    for(;;) {
+        for(size_t i = 0; i < _instances.size(); ++i) {
+            Instance & instance = *_instances[i];
+            if (instance._state != Instance::READY) {
+                continue;
+            }
+            instance._state = instance._app->IsAlive() ? Instance::TAKEN : Instance::RETIRED;
+            /// either way the supervisor has an application to replace
+            _work.notify_one();
+            if (instance._state == Instance::TAKEN) {
+                instance._time = chrono::steady_clock::now();
+                return &instance;
+            }
+        }
+        if (_ready.wait_until(lock, deadline) == std::cv_status::timeout) {
+            return nullptr;
+        }
+    }
+}
+
+void WarmPool::Release(Instance * instance)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    Average(_useTime, Elapsed(instance->_time));
+    instance->_state = Instance::RETIRED;
+    Resize();
+    _work.notify_one();
+}
+
+size_t WarmPool::size()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _size;
+}
+
+void WarmPool::Resize()
+{
+    if (_launchLatency > 0 && _useTime > 0) {
+        /// enough launching to replace each application as it is used up,
+        /// and one to spare
+        const double needed = std::ceil(_launchLatency / _useTime) + 1;
+        _size = needed < _instances.size() ? static_cast<size_t>(needed) : _instances.size();
+    }
+}
+
+void WarmPool::Supervise()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while(!_stopping) {
+        bool progress = false;
+        for(size_t i = 0; i < _instances.size() && !_stopping; ++i) {
+            progress |= Step(*_instances[i], lock);
+        }
+        if (!progress && !_stopping) {
+            _work.wait_for(lock, chrono::milliseconds(PollInterval));
+        }
+    }
+}
+
+bool WarmPool::Step(Instance & instance, std::unique_lock<std::mutex> & lock)
+{
+    /// only the supervisor changes the state of IDLE, LAUNCHING and RETIRED
+    /// applications, the lock isn't held while they are launched or waited on
+    switch(instance._state) {
+    case Instance::IDLE:
+        {
+            size_t active = 0;
+            for(size_t i = 0; i < _instances.size(); ++i) {
+                active += _instances[i]->_state == Instance::LAUNCHING || _instances[i]->_state == Instance::READY;
+            }
+            if (active >= _size) {
+                return false;
+            }
+            instance._state = Instance::LAUNCHING;
+            instance._time  = chrono::steady_clock::now();
+            lock.unlock();
+            const bool launched = instance._app->Launch();
+            lock.lock();
+            if (!launched) {
+                std::cout << "Failed to launch application." << std::endl;
+                instance._state = Instance::IDLE;
+                return false;
+            }
+            return true;
+        }
+    case Instance::LAUNCHING:
+        {
+            lock.unlock();
+            shared_ptr<network::TcpSocket> sock = instance._server->Accept(0);
+            const bool alive = instance._app->IsAlive();
+            lock.lock();
+            if (sock) {
+                instance.connection = sock;
+                instance._state     = Instance::READY;
+                Average(_launchLatency, Elapsed(instance._time));
+                Resize();
+                _ready.notify_one();
+                return true;
+            }
+            if (!alive || Elapsed(instance._time) > _connectTimeout) {
+                /// no connection, relaunch it
+                std::cout << "No connection from the application." << std::endl;
+                instance._state = Instance::RETIRED;
+                return true;
+            }
+            return false;
+        }
+    case Instance::RETIRED:
+        {
+            lock.unlock();
+            /// terminated before the connection is closed, so that it
+            /// doesn't connect again in the meantime
+            instance._app->Terminate();
+            instance._app->Wait();
+            instance.connection.reset();
+            lock.lock();
+            instance._state = Instance::IDLE;
+            return true;
+        }
+    default:
+        return false;
+    }
+}
+
+} // namespace runtime
+
+} // namespace fuzzer
@@ -0,0 +1,144 @@
+#ifndef _WARMPOOL_H_
+#define _WARMPOOL_H_
+
+#include "appexec.h"
+#include "tcp.h"
+#include <stdint.h>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fuzzer {
+
+namespace runtime {
+
+///
+/// \class  IApplicationFactory
+/// \brief  Creates the applications of a WarmPool.
+///
+class IApplicationFactory
+{
+public:
+    virtual ~IApplicationFactory()
+    {
+        // empty
+    }
+
+    ///
+    /// \brief  Creates an application that connects to the fuzzer on
+    ///         \p Port, typically passed on its command line.
+    ///
+    virtual execution::IApplicationExecuter * Create(uint16_t Port) = 0;
+};
+
+///
+/// \class  WarmPool
+/// \brief  Applications that are launched and connected before they are
+///         needed. A supervisor thread launches applications in the
+///         background, each listening on a port of its own, so that an
+///         application that is taken from the pool is already connected.
+///         Released applications are terminated and relaunched by the
+///         supervisor too.
+///
+///         The number of applications kept ready follows the average launch
+///         latency divided by the average time that an application is used,
+///         so that the pool refills as fast as the applications are used.
+///
+class WarmPool
+{
+public:
+    ///
+    /// \class  Instance
+    /// \brief  A launched application and its connection.
+    ///
+    class Instance
+    {
+    public:
+        execution::IApplicationExecuter & app() { return *_app; }
+        network::TcpServer & server() { return *_server; }
+
+        /// the connection, moved to the caller by WarmPool::Take, and
+        /// back before Release() so that it is closed after the application
+        std::shared_ptr<network::TcpSocket> connection;
+
+    private:
+        friend class WarmPool;
+
+        enum State {
+            IDLE,
+            LAUNCHING,
+            READY,
+            TAKEN,
+            RETIRED
+        };
+
+        std::unique_ptr<execution::IApplicationExecuter>    _app;
+        std::unique_ptr<network::TcpServer>                 _server;
+        State                                               _state;
+        std::chrono::steady_clock::time_point               _time;  //< of the launch, or when it was taken
+    };
+
+    ///
+    /// \brief  Creates \p MaxSize applications with \p factory, listening on
+    ///         consecutive ports from \p FirstPort, and starts the
+    ///         supervisor. An application that doesn't connect within
+    ///         \p ConnectTimeout ms is relaunched.
+    ///
+    WarmPool(IApplicationFactory & factory, const std::string & Interface,
+        uint16_t FirstPort, size_t MaxSize, size_t ConnectTimeout);
+
+    ///
+    /// \brief  Stops the supervisor and terminates the applications.
+    ///
+    ~WarmPool();
+
+    ///
+    /// \brief  Takes a connected application, waiting at most \p Timeout ms.
+    ///
+    /// \return The application, or nullptr on timeout.
+    ///
+    Instance * Take(size_t Timeout);
+
+    ///
+    /// \brief  Returns an application that is done with, it is terminated
+    ///         and relaunched in the background.
+    ///
+    void Release(Instance *);
+
+    /// number of applications kept ready
+    size_t size();
+
+private:
+    WarmPool(const WarmPool &);
+    WarmPool & operator=(const WarmPool &);
+
+    /// the supervisor thread
+    void Supervise();
+
+    /// advances \p instance, returns true if its state changed
+    bool Step(Instance & instance, std::unique_lock<std::mutex> & lock);
+
+    /// updates the size from the averages
+    void Resize();
+
+    std::vector<std::unique_ptr<Instance> > _instances;
+    size_t                                  _connectTimeout;
+    size_t                                  _size;          //< applications kept ready
+    double                                  _launchLatency; //< average, in ms
+    double                                  _useTime;       //< average, in ms
+    bool                                    _stopping;
+    std::mutex                              _mutex;
+    std::condition_variable                 _ready;         //< an application is ready
+    std::condition_variable                 _work;          //< the supervisor has work
+    std::thread                             _supervisor;
+};
+
+} // namespace runtime
+
+} // namespace fuzzer
+
+#endif
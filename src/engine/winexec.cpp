@@ -8,7 +8,7 @@ namespace fuzzer {
 namespace execution {
 
 
-WindowsExecuter::WindowsExecuter(const std::string & Path) : _path(Path)
+WindowsExecuter::WindowsExecuter(const std::string & Path) : _path(Path), _coverage(nullptr), _comparisons(nullptr)
 {
     ZeroMemory(&this->_pi, sizeof(PROCESS_INFORMATION));
     ZeroMemory(&this->_si, sizeof(STARTUPINFO));
@@ -50,6 +50,16 @@ bool WindowsExecuter::Launch()
     }
 
 
+    /// the child inherits the name of the coverage map
+    if (_coverage) {
+        _coverage->clear();
+        SetEnvironmentVariableA(CoverageMap::EnvironmentVariable, _coverage->name().c_str());
+    }
+    if (_comparisons) {
+        _comparisons->clear();
+        SetEnvironmentVariableA(ComparisonLog::EnvironmentVariable, _comparisons->name().c_str());
+    }
+
     std::stringstream ss;
     ss << _path;
     if (!_cmdline.empty()) {
@@ -73,6 +83,30 @@ bool WindowsExecuter::Launch()
     return true;
 }
 
+void WindowsExecuter::SetCoverageMap(CoverageMap * coverage)
+{
+    _coverage = coverage;
+}
+
+bool WindowsExecuter::GetCoverageChecksum(uint64_t & Checksum)
+{
+    if (!_coverage) {
+        return false;
+    }
+    Checksum = _coverage->checksum();
+    return true;
+}
+
+void WindowsExecuter::SetComparisonLog(ComparisonLog * comparisons)
+{
+    _comparisons = comparisons;
+}
+
+const ComparisonLog * WindowsExecuter::GetComparisonLog()
+{
+    return _comparisons;
+}
+
 bool WindowsExecuter::Terminate()
 {
     if (!_pi.hProcess) {
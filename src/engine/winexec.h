@@ -4,6 +4,8 @@
 #ifdef WIN32
 
 #include "appexec.h"
+#include "coverage.h"
+#include "cmplog.h"
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
 #include <string>
@@ -61,11 +63,35 @@ public:
     ///
     virtual bool IsAlive();
 
+    ///
+    /// \brief  Passes the coverage map to instrumented applications, the
+    ///         map is cleared before each launch.
+    ///
+    void SetCoverageMap(CoverageMap *);
+
+    ///
+    /// \brief  Checksum of the coverage map after the last run
+    ///
+    virtual bool GetCoverageChecksum(uint64_t & Checksum);
+
+    ///
+    /// \brief  Passes the comparison log to instrumented applications, the
+    ///         log is cleared before each launch.
+    ///
+    void SetComparisonLog(ComparisonLog *);
+
+    ///
+    /// \brief  Comparisons logged by the last run
+    ///
+    virtual const ComparisonLog * GetComparisonLog();
+
 private:
     std::string             _path;
     STARTUPINFOA            _si;
     PROCESS_INFORMATION     _pi;
     std::string             _cmdline;
+    CoverageMap *           _coverage;
+    ComparisonLog *         _comparisons;
 };
 
 } // namespace execution
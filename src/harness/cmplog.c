@@ -0,0 +1,134 @@
+/*
+ * SanitizerCoverage trace-cmp callbacks that log comparison operands for
+ * the fuzzer. Build the target with -fsanitize-coverage=trace-cmp and link
+ * this file. The fuzzer passes the name of the log in FUZZENGINE_CMPLOG_SHM,
+ * without it the callbacks do nothing.
+ */
+
+#include "../engine/cmplogtable.h"
+#include <stdlib.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <intrin.h>
+#define RETURN_ADDRESS() ((uintptr_t) _ReturnAddress())
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#define RETURN_ADDRESS() ((uintptr_t) __builtin_return_address(0))
+#endif
+
+static struct fuzzengine_cmplog * table;
+static int attached;
+
+static struct fuzzengine_cmplog * attach(void)
+{
+    const char * name;
+    void * map = NULL;
+
+    if (attached) {
+        return table;
+    }
+    attached = 1;
+    name = getenv("FUZZENGINE_CMPLOG_SHM");
+    if (!name) {
+        return NULL;
+    }
+#ifdef _WIN32
+    {
+        HANDLE handle = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, name);
+        if (handle) {
+            map = MapViewOfFile(handle, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(struct fuzzengine_cmplog));
+        }
+    }
+#else
+    {
+        int fd = shm_open(name, O_RDWR, 0);
+        if (fd >= 0) {
+            map = mmap(NULL, sizeof(struct fuzzengine_cmplog), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            close(fd);
+            if (map == MAP_FAILED) {
+                map = NULL;
+            }
+        }
+    }
+#endif
+    table = (struct fuzzengine_cmplog *) map;
+    return table;
+}
+
+static void log_cmp(uint64_t arg1, uint64_t arg2, uint8_t size, uint8_t flags, uintptr_t site)
+{
+    struct fuzzengine_cmplog * log = attach();
+    uint32_t index;
+    struct fuzzengine_cmp * entry;
+
+    if (!log || arg1 == arg2) {
+        return;
+    }
+#ifdef _WIN32
+    index = (uint32_t) InterlockedIncrement((volatile LONG *) &log->count) - 1;
+#else
+    index = __atomic_fetch_add(&log->count, 1, __ATOMIC_RELAXED);
+#endif
+    if (index >= FUZZENGINE_CMPLOG_ENTRIES) {
+        return;
+    }
+    entry = &log->entries[index];
+    entry->arg1     = arg1;
+    entry->arg2     = arg2;
+    entry->site     = (uint32_t) site;
+    entry->size     = size;
+    entry->flags    = flags;
+}
+
+void __sanitizer_cov_trace_cmp1(uint8_t arg1, uint8_t arg2)
+{
+    log_cmp(arg1, arg2, 1, 0, RETURN_ADDRESS());
+}
+
+void __sanitizer_cov_trace_cmp2(uint16_t arg1, uint16_t arg2)
+{
+    log_cmp(arg1, arg2, 2, 0, RETURN_ADDRESS());
+}
+
+void __sanitizer_cov_trace_cmp4(uint32_t arg1, uint32_t arg2)
+{
+    log_cmp(arg1, arg2, 4, 0, RETURN_ADDRESS());
+}
+
+void __sanitizer_cov_trace_cmp8(uint64_t arg1, uint64_t arg2)
+{
+    log_cmp(arg1, arg2, 8, 0, RETURN_ADDRESS());
+}
+
+void __sanitizer_cov_trace_const_cmp1(uint8_t arg1, uint8_t arg2)
+{
+    log_cmp(arg2, arg1, 1, FUZZENGINE_CMP_CONST, RETURN_ADDRESS());
+}
+
+void __sanitizer_cov_trace_const_cmp2(uint16_t arg1, uint16_t arg2)
+{
+    log_cmp(arg2, arg1, 2, FUZZENGINE_CMP_CONST, RETURN_ADDRESS());
+}
+
+void __sanitizer_cov_trace_const_cmp4(uint32_t arg1, uint32_t arg2)
+{
+    log_cmp(arg2, arg1, 4, FUZZENGINE_CMP_CONST, RETURN_ADDRESS());
+}
+
+void __sanitizer_cov_trace_const_cmp8(uint64_t arg1, uint64_t arg2)
+{
+    log_cmp(arg2, arg1, 8, FUZZENGINE_CMP_CONST, RETURN_ADDRESS());
+}
+
+/* cases[0] is the number of cases, cases[1] the width in bits */
+void __sanitizer_cov_trace_switch(uint64_t value, uint64_t * cases)
+{
+    uint64_t i;
+    for(i = 0; i < cases[0]; ++i) {
+        log_cmp(value, cases[2 + i], (uint8_t) (cases[1] / 8), FUZZENGINE_CMP_CONST, RETURN_ADDRESS());
+    }
+}
@@ -0,0 +1,86 @@
+/*
+ * SanitizerCoverage trace-pc-guard callbacks that count edge hits in the
+ * fuzzer's CoverageMap. Build the target with -fsanitize-coverage=trace-pc-guard
+ * and link this file. The fuzzer passes the name of the map in FUZZENGINE_SHM,
+ * without it the callbacks do nothing.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+/* CoverageMap::MapSize */
+#define FUZZENGINE_MAP_SIZE (1 << 16)
+
+static uint8_t * map;
+static int attached;
+static uint32_t guards;
+
+static uint8_t * attach(void)
+{
+    const char * name;
+    void * memory = NULL;
+
+    if (attached) {
+        return map;
+    }
+    attached = 1;
+    name = getenv("FUZZENGINE_SHM");
+    if (!name) {
+        return NULL;
+    }
+#ifdef _WIN32
+    {
+        HANDLE handle = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, name);
+        if (handle) {
+            memory = MapViewOfFile(handle, FILE_MAP_ALL_ACCESS, 0, 0, FUZZENGINE_MAP_SIZE);
+        }
+    }
+#else
+    {
+        int fd = shm_open(name, O_RDWR, 0);
+        if (fd >= 0) {
+            memory = mmap(NULL, FUZZENGINE_MAP_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            close(fd);
+            if (memory == MAP_FAILED) {
+                memory = NULL;
+            }
+        }
+    }
+#endif
+    map = (uint8_t *) memory;
+    return map;
+}
+
+/* numbers the edges of a module, 0 stays reserved for disabled guards */
+void __sanitizer_cov_trace_pc_guard_init(uint32_t * start, uint32_t * stop)
+{
+    if (start == stop || *start) {
+        return;
+    }
+    for(; start < stop; ++start) {
+        *start = guards++ % (FUZZENGINE_MAP_SIZE - 1) + 1;
+    }
+}
+
+/* counts the hit, saturating so that a hot edge never reads as unreached */
+void __sanitizer_cov_trace_pc_guard(uint32_t * guard)
+{
+    uint8_t * counters;
+
+    if (!*guard) {
+        return;
+    }
+    counters = attach();
+    if (counters && counters[*guard] != 0xff) {
+        ++counters[*guard];
+    }
+}
@@ -0,0 +1,52 @@
+/*
+ * Target side of the shared memory rings, see ring.h. The fuzzer writes to
+ * the to_target ring and reads from to_fuzzer, the harness the other way
+ * around. Reads and writes wait as long as it takes, the fuzzer times out
+ * and kills an unresponsive target.
+ */
+
+#include "ring.h"
+#include "../engine/ringtable.h"
+#include <stdlib.h>
+#include <sys/mman.h>
+
+static struct fuzzengine_rings * rings;
+static int attached;
+
+int fuzzengine_ring_attach(void)
+{
+    const char * name;
+    void * map;
+
+    if (attached) {
+        return rings ? 0 : -1;
+    }
+    attached = 1;
+    name = getenv("FUZZENGINE_RING_FD");
+    if (!name) {
+        return -1;
+    }
+    map = mmap(NULL, sizeof(struct fuzzengine_rings), PROT_READ | PROT_WRITE, MAP_SHARED, atoi(name), 0);
+    if (map == MAP_FAILED) {
+        return -1;
+    }
+    rings = (struct fuzzengine_rings *) map;
+    return 0;
+}
+
+long fuzzengine_ring_read(void * dst, size_t min, size_t max)
+{
+    if (fuzzengine_ring_attach() != 0) {
+        return -1;
+    }
+    return (long) fuzzengine_ring_recv(&rings->to_target, dst, min, max, -1);
+}
+
+int fuzzengine_ring_write(const void * src, size_t size)
+{
+    if (fuzzengine_ring_attach() != 0) {
+        return -1;
+    }
+    fuzzengine_ring_send(&rings->to_fuzzer, src, size, -1);
+    return 0;
+}
@@ -0,0 +1,39 @@
+#ifndef _FUZZENGINE_RING_H_
+#define _FUZZENGINE_RING_H_
+
+/*
+ * Target side of the shared memory rings of io::RingIpc. Link ring.c into
+ * the harness and read the fuzzer's test cases, and write the responses,
+ * with the functions below instead of a socket. Linux only.
+ */
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Maps the rings passed in FUZZENGINE_RING_FD, the other functions do it
+ * on their first call. Returns 0 on success, -1 when the harness wasn't
+ * launched with rings.
+ */
+int fuzzengine_ring_attach(void);
+
+/*
+ * Reads at least min and at most max bytes from the fuzzer, waiting for
+ * them. Returns the number of bytes read, or -1 if not attached.
+ */
+long fuzzengine_ring_read(void * dst, size_t min, size_t max);
+
+/*
+ * Writes size bytes to the fuzzer, waiting while the ring is full. Returns
+ * 0 on success, or -1 if not attached.
+ */
+int fuzzengine_ring_write(const void * src, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,6 +1,7 @@
 #include <gtest\gtest.h>
 #include <fuzzengine\bytecode.h>
 #include <fuzzengine\generator.h>
+#include <cstring>
 #include <sstream>
 
 using namespace fuzzer::parser;
@@ -75,6 +76,133 @@ TEST(ByteCode, ArrayDynamicSize)
     ASSERT_NO_THROW(script = generator.ParseScript(token));
 }
 
+TEST(ByteCode, ArrayFixedSizeGenerate)
+{
+    fuzzer::bytecode::Generator generator;
+    std::stringstream str;
+    str << "template x = [ byte(1), array<word>(8) ];";
+    fuzzer::parser::Tokenizer token(str);
+    std::shared_ptr<fuzzer::bytecode::Script> script;
+    ASSERT_NO_THROW(script = generator.ParseScript(token));
+
+    std::vector<uint8_t> data;
+    script->_templates["x"]->generate(data);
+    ASSERT_EQ(17, data.size());
+    EXPECT_EQ(1, data[0]);
+    EXPECT_EQ(0, data[16]);
+}
+
+TEST(ByteCode, TemplateSignedAndFloat)
+{
+    fuzzer::bytecode::Generator generator;
+    std::stringstream str;
+    str << "template x = [ s16(-2), float(1.5), double(-2) ];";
+    fuzzer::parser::Tokenizer token(str);
+    std::shared_ptr<fuzzer::bytecode::Script> script;
+    ASSERT_NO_THROW(script = generator.ParseScript(token));
+
+    std::vector<uint8_t> data;
+    script->_templates["x"]->generate(data);
+    ASSERT_EQ(14, data.size());
+    EXPECT_EQ(0xff, data[0]);
+    EXPECT_EQ(0xfe, data[1]);
+    EXPECT_EQ(0x3f, data[2]);
+    EXPECT_EQ(0xc0, data[3]);
+    EXPECT_EQ(0xc0, data[6]);
+}
+
+TEST(ByteCode, TemplateDoublePrecision)
+{
+    fuzzer::bytecode::Generator generator;
+    std::stringstream str;
+    str << "template x = [ double(0.1), double(1.0e300), double(-2.5E-3) ];";
+    fuzzer::parser::Tokenizer token(str);
+    std::shared_ptr<fuzzer::bytecode::Script> script;
+    ASSERT_NO_THROW(script = generator.ParseScript(token));
+
+    std::vector<uint8_t> data;
+    script->_templates["x"]->generate(data);
+    ASSERT_EQ(24, data.size());
+    const double expected[] = { 0.1, 1.0e300, -2.5e-3 };
+    for(size_t i = 0; i < 3; ++i) {
+        uint64_t bits = 0;
+        for(size_t j = 0; j < 8; ++j) {
+            bits = (bits << 8) | data[i * 8 + j];
+        }
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        EXPECT_EQ(expected[i], value);
+    }
+}
+
+TEST(ByteCode, TemplateSignedRange)
+{
+    fuzzer::bytecode::Generator generator;
+    std::stringstream str;
+    str << "template x = [ s8(-128), s64(-9223372036854775808), s64(9223372036854775807) ];";
+    fuzzer::parser::Tokenizer token(str);
+    std::shared_ptr<fuzzer::bytecode::Script> script;
+    ASSERT_NO_THROW(script = generator.ParseScript(token));
+
+    std::vector<uint8_t> data;
+    script->_templates["x"]->generate(data);
+    ASSERT_EQ(17, data.size());
+    EXPECT_EQ(0x80, data[0]);
+    EXPECT_EQ(0x80, data[1]);
+    EXPECT_EQ(0x00, data[8]);
+    EXPECT_EQ(0x7f, data[9]);
+    EXPECT_EQ(0xff, data[16]);
+
+    std::stringstream overflow;
+    overflow << "template x = [ s8(-129) ];";
+    fuzzer::parser::Tokenizer overflowToken(overflow);
+    EXPECT_THROW(generator.ParseScript(overflowToken), std::runtime_error);
+}
+
+TEST(ByteCode, TemplatePascalStringAndLine)
+{
+    fuzzer::bytecode::Generator generator;
+    std::stringstream str;
+    str << "template x = [ pascalstring<word>(\"abc\"), line(\"hi\"), utf8(\"z\") ];";
+    fuzzer::parser::Tokenizer token(str);
+    std::shared_ptr<fuzzer::bytecode::Script> script;
+    ASSERT_NO_THROW(script = generator.ParseScript(token));
+
+    std::vector<uint8_t> data;
+    script->_templates["x"]->generate(data);
+    ASSERT_EQ(11, data.size());
+    EXPECT_EQ(0x00, data[0]);
+    EXPECT_EQ(0x03, data[1]);
+    EXPECT_EQ('c', data[4]);
+    EXPECT_EQ('i', data[6]);
+    EXPECT_EQ('\r', data[7]);
+    EXPECT_EQ('\n', data[8]);
+    EXPECT_EQ('z', data[9]);
+    EXPECT_EQ(0, data[10]);
+}
+
+TEST(ByteCode, TemplateFuzzedSigned)
+{
+    fuzzer::bytecode::Generator generator;
+    std::stringstream str;
+    str << "template x = [{ s8, s32(-1), float, double }];";
+    fuzzer::parser::Tokenizer token(str);
+    std::shared_ptr<fuzzer::bytecode::Script> script;
+    ASSERT_NO_THROW(script = generator.ParseScript(token));
+    EXPECT_EQ(4, script->_templates["x"]->GetMutators().size());
+}
+
+TEST(ByteCode, ArrayDynamicSizeMutator)
+{
+    fuzzer::bytecode::Generator generator;
+    std::stringstream str;
+    str << "template x = [{ array<dword>(1-4) }];";
+    fuzzer::parser::Tokenizer token(str);
+    std::shared_ptr<fuzzer::bytecode::Script> script;
+    ASSERT_NO_THROW(script = generator.ParseScript(token));
+    EXPECT_EQ(1, script->_templates["x"]->GetMutators().size());
+}
+
 TEST(ByteCode, PartialFuzzed)
 {
     fuzzer::bytecode::Generator generator;
@@ -0,0 +1,179 @@
+#include <fuzzengine\connpool.h>
+#include <fuzzengine\ioerror.h>
+#include <gtest\gtest.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#ifdef __linux__
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+using namespace fuzzer::network;
+
+#ifdef __linux__
+
+namespace {
+
+/// a plain listening socket on \p port of the loopback interface
+int Listen(uint16_t port)
+{
+    const int sock = socket(AF_INET, SOCK_STREAM, 0);
+    int reuse = 1;
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    sockaddr_in address = sockaddr_in();
+    address.sin_family      = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port        = htons(port);
+    if (bind(sock, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || listen(sock, 8) != 0) {
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+/// accepts a connection within a second
+int Accept(int listener)
+{
+    pollfd fd;
+    fd.fd       = listener;
+    fd.events   = POLLIN;
+    fd.revents  = 0;
+    return poll(&fd, 1, 1000) > 0 ? accept(listener, nullptr, nullptr) : -1;
+}
+
+/// waits until the peer acknowledged the shutdown of \p sock
+bool WaitAcknowledged(int sock)
+{
+    for(size_t i = 0; i < 1000; ++i) {
+        tcp_info info;
+        socklen_t size = sizeof(info);
+        if (getsockopt(sock, IPPROTO_TCP, TCP_INFO, &info, &size) != 0) {
+            return false;
+        }
+        if (info.tcpi_state == TCP_FIN_WAIT2) {
+            return true;
+        }
+        poll(nullptr, 0, 1);
+    }
+    return false;
+}
+
+} // namespace
+
+#endif
+
+TEST(ConnectionPool, TakeAndReplace)
+{
+    TcpServer server("127.0.0.1", 47360);
+    ConnectionPool pool("127.0.0.1", 47360, 2);
+
+    std::shared_ptr<TcpSocket> first = pool.Take(1000);
+    ASSERT_TRUE(first != nullptr);
+    std::shared_ptr<TcpSocket> peer = server.Accept(1000);
+    ASSERT_TRUE(peer != nullptr);
+    char c = 0;
+    ASSERT_TRUE(first->write("x", 1));
+    ASSERT_TRUE(peer->read(&c, 1));
+    EXPECT_EQ('x', c);
+
+    /// the taken connections are replaced
+    for(size_t i = 0; i < 3; ++i) {
+        std::shared_ptr<TcpSocket> next = pool.Take(1000);
+        ASSERT_TRUE(next != nullptr);
+        EXPECT_NE(first, next);
+        EXPECT_TRUE(next->connected());
+    }
+}
+
+#ifdef __linux__
+
+TEST(ConnectionPool, DeadConnection)
+{
+    const int listener = Listen(47361);
+    ASSERT_GE(listener, 0);
+    ConnectionPool pool("127.0.0.1", 47361, 1);
+
+    std::shared_ptr<TcpSocket> first = pool.Take(1000);
+    ASSERT_TRUE(first != nullptr);
+    const int accepted = Accept(listener);
+    ASSERT_GE(accepted, 0);
+    /// the target accepts the replacement and closes it while it waits in
+    /// the pool, the pool's side has seen the close once it is acknowledged
+    const int closed = Accept(listener);
+    ASSERT_GE(closed, 0);
+    ASSERT_EQ(0, shutdown(closed, SHUT_WR));
+    EXPECT_TRUE(WaitAcknowledged(closed));
+
+    std::shared_ptr<TcpSocket> next = pool.Take(1000);
+    ASSERT_TRUE(next != nullptr);
+    EXPECT_TRUE(next->connected());
+    const int peer = Accept(listener);
+    ASSERT_GE(peer, 0);
+    char c = 0;
+    ASSERT_TRUE(next->write("y", 1));
+    pollfd fd;
+    fd.fd       = peer;
+    fd.events   = POLLIN;
+    fd.revents  = 0;
+    ASSERT_EQ(1, poll(&fd, 1, 1000));
+    ASSERT_EQ(1, recv(peer, &c, 1, 0));
+    EXPECT_EQ('y', c);
+    close(peer);
+    close(closed);
+    close(accepted);
+    close(listener);
+}
+
+#endif
+
+TEST(ConnectionPool, RetryRefused)
+{
+    ConnectionPool pool("127.0.0.1", 47362, 2);
+    /// nothing listens yet
+    EXPECT_TRUE(pool.Take(50) == nullptr);
+
+    TcpServer server("127.0.0.1", 47362);
+    std::shared_ptr<TcpSocket> sock = pool.Take(1000);
+    ASSERT_TRUE(sock != nullptr);
+    EXPECT_TRUE(sock->connected());
+}
+
+TEST(ConnectionPool, Threads)
+{
+    ConnectionPool pool("127.0.0.1", 47363, 4);
+    std::shared_ptr<TcpSocket> taken[4];
+    std::vector<std::thread> threads;
+    std::mutex lock;
+    std::condition_variable started;
+    size_t waiting = 0;
+    for(size_t i = 0; i < 4; ++i) {
+        threads.push_back(std::thread([&, i]() {
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                ++waiting;
+            }
+            started.notify_one();
+            taken[i] = pool.Take(2000);
+        }));
+    }
+    /// the threads wait for the target side by side
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        started.wait(guard, [&waiting]() { return waiting == 4; });
+    }
+    TcpServer server("127.0.0.1", 47363);
+    for(size_t i = 0; i < threads.size(); ++i) {
+        threads[i].join();
+    }
+    for(size_t i = 0; i < 4; ++i) {
+        ASSERT_TRUE(taken[i] != nullptr);
+        for(size_t j = 0; j < i; ++j) {
+            EXPECT_NE(taken[i], taken[j]);
+        }
+    }
+}
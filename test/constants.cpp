@@ -149,4 +149,27 @@ TEST(Expression, u64WithValue)
     EXPECT_TRUE(cvar->_hasValue);
     EXPECT_EQ(UNSIGNED64, cvar->_type);
     EXPECT_EQ(10, cvar->u.u64);
-}
\ No newline at end of file
+}
+TEST(Expression, s16WithNegativeValue)
+{
+    std::stringstream str;
+    str << "s16(-10)";
+    fuzzer::parser::Tokenizer token(str);
+    fuzzer::parser::Parser parser;
+    std::shared_ptr<fuzzer::parser::Expression> exp;
+    ASSERT_NO_THROW(exp = parser.ParseExpression(token));
+    ASSERT_EQ(fuzzer::parser::Expression::EXP_CONSTANT, exp->GetType());
+    Constant * cvar = reinterpret_cast<Constant *>(exp.get());
+    EXPECT_TRUE(cvar->_hasValue);
+    EXPECT_EQ(SIGNED16, cvar->_type);
+    EXPECT_EQ(-10, cvar->u.i16);
+}
+
+TEST(Expression, s8OutOfRange)
+{
+    std::stringstream str;
+    str << "s8(-129)";
+    fuzzer::parser::Tokenizer token(str);
+    fuzzer::parser::Parser parser;
+    EXPECT_THROW(parser.ParseExpression(token), std::runtime_error);
+}
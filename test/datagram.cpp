@@ -0,0 +1,117 @@
+#ifdef __linux__
+
+#include <fuzzengine\datagram.h>
+#include <gtest\gtest.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <string>
+
+using namespace fuzzer::network;
+
+namespace {
+
+/// UDP socket on the loopback interface, standing in for the target
+class Peer
+{
+public:
+    Peer()
+    {
+        _sock = socket(AF_INET, SOCK_DGRAM, 0);
+        sockaddr_in address = sockaddr_in();
+        address.sin_family      = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(_sock, reinterpret_cast<sockaddr *>(&address), sizeof(address));
+        socklen_t length = sizeof(address);
+        getsockname(_sock, reinterpret_cast<sockaddr *>(&address), &length);
+        _port = ntohs(address.sin_port);
+    }
+
+    ~Peer() { close(_sock); }
+
+    uint16_t port() const { return _port; }
+
+    /// receives a datagram and remembers its sender
+    std::string receive()
+    {
+        char data[256];
+        _length = sizeof(_from);
+        const ssize_t res = recvfrom(_sock, data, sizeof(data), 0, reinterpret_cast<sockaddr *>(&_from), &_length);
+        return std::string(data, res > 0 ? res : 0);
+    }
+
+    void reply(const std::string & data)
+    {
+        sendto(_sock, data.data(), data.size(), 0, reinterpret_cast<sockaddr *>(&_from), _length);
+    }
+
+private:
+    int             _sock;
+    uint16_t        _port;
+    sockaddr_in     _from;
+    socklen_t       _length;
+};
+
+} // namespace
+
+TEST(Datagram, Socket)
+{
+    Peer peer;
+    DatagramSocket sock("127.0.0.1", peer.port());
+
+    /// the writes up to the flush are one datagram
+    sock.writeU8('a');
+    ASSERT_TRUE(sock.write("bcd", 3));
+    ASSERT_TRUE(sock.flush());
+    EXPECT_EQ("abcd", peer.receive());
+
+    /// a read sends the pending datagram, and continues into the next datagram
+    ASSERT_TRUE(sock.write("ping", 4));
+    sock.SetTimeout(1);
+    EXPECT_THROW(sock.readU8(), fuzzer::io::IoException);
+    EXPECT_EQ("ping", peer.receive());
+    peer.reply("12");
+    peer.reply("345");
+    char data[4] = { 0 };
+    ASSERT_TRUE(sock.read(data, 3));
+    EXPECT_EQ(std::string("123"), data);
+    EXPECT_EQ(2, sock.receive(data, 1, sizeof(data)));
+    EXPECT_EQ('4', data[0]);
+    EXPECT_EQ('5', data[1]);
+}
+
+TEST(Datagram, Batch)
+{
+    Peer peer;
+    DatagramSocket sock("127.0.0.1", peer.port());
+    DatagramBatch batch(sock, 3);
+
+    const char * cases[] = { "first", "", "third" };
+    for(size_t i = 0; i < 3; ++i) {
+        ASSERT_TRUE(batch.write(cases[i], strlen(cases[i])));
+        ASSERT_TRUE(batch.flush());
+    }
+    EXPECT_TRUE(batch.full());
+    EXPECT_FALSE(batch.flush());
+    char data;
+    EXPECT_FALSE(batch.read(&data, 1));
+
+    EXPECT_EQ(3, batch.send());
+    for(size_t i = 0; i < 3; ++i) {
+        const std::string request = peer.receive();
+        EXPECT_EQ(cases[i], request);
+        peer.reply("re:" + request);
+    }
+    EXPECT_EQ(3, batch.collect(1000));
+    size_t size;
+    const uint8_t * response = batch.response(0, size);
+    EXPECT_EQ("re:first", std::string(reinterpret_cast<const char *>(response), size));
+    response = batch.response(1, size);
+    EXPECT_EQ("re:", std::string(reinterpret_cast<const char *>(response), size));
+
+    batch.clear();
+    EXPECT_EQ(0, batch.size());
+    EXPECT_EQ(0, batch.responses());
+}
+
+#endif // __linux__
@@ -0,0 +1,116 @@
+#include <gtest\gtest.h>
+#include <fuzzengine\dictionary.h>
+#include <fuzzengine\script.h>
+#include <fuzzengine\integermutator.h>
+#include <fuzzengine\stringmutator.h>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+
+using namespace fuzzer::runtime;
+using namespace std;
+
+static void WriteText(const char * filename, const char * text)
+{
+    FILE * file = fopen(filename, "wb");
+    fwrite(text, strlen(text), 1, file);
+    fclose(file);
+}
+
+static string Token(const Dictionary & dictionary, size_t index)
+{
+    return string(reinterpret_cast<const char *>(dictionary.data(index)), dictionary.length(index));
+}
+
+TEST(Dictionary, LoadAflFormat)
+{
+    WriteText("dictionary_afl.txt",
+        "# comment\r\n"
+        "\n"
+        "kw1=\"GET\"\n"
+        "  header_host@2 = \"Host: \"  \n"
+        "\"\\x00\\x01\\\\\\\"\"\n"
+        "kw1_again=\"GET\"\n");
+    Dictionary dictionary;
+    dictionary.load("dictionary_afl.txt");
+    remove("dictionary_afl.txt");
+
+    ASSERT_EQ(3, dictionary.size());
+    EXPECT_EQ("GET", Token(dictionary, 0));
+    EXPECT_EQ("Host: ", Token(dictionary, 1));
+    EXPECT_EQ(string("\x00\x01\\\"", 4), Token(dictionary, 2));
+    EXPECT_FALSE(dictionary.add("GET", 3));
+}
+
+TEST(Dictionary, MalformedEntry)
+{
+    WriteText("dictionary_bad.txt", "ok=\"a\"\nbad=\"\\q\"\n");
+    Dictionary dictionary;
+    try {
+        dictionary.load("dictionary_bad.txt");
+        FAIL();
+    } catch(std::runtime_error & err) {
+        EXPECT_NE(string::npos, string(err.what()).find("line 2"));
+    }
+    remove("dictionary_bad.txt");
+    EXPECT_FALSE(dictionary.add(string(Dictionary::MaxTokenSize + 1, 'a').data(), Dictionary::MaxTokenSize + 1));
+}
+
+TEST(Dictionary, SaveAndMap)
+{
+    Dictionary dictionary;
+    EXPECT_TRUE(dictionary.add("RIFF", 4));
+    EXPECT_TRUE(dictionary.add("\x89PNG", 4));
+    dictionary.save("dictionary_table.bin");
+    {
+        Dictionary mapped;
+        mapped.load("dictionary_table.bin");
+        ASSERT_EQ(2, mapped.size());
+        EXPECT_EQ("RIFF", Token(mapped, 0));
+        EXPECT_EQ("\x89PNG", Token(mapped, 1));
+        /// adding copies the mapped table
+        EXPECT_FALSE(mapped.add("RIFF", 4));
+        EXPECT_TRUE(mapped.add("IHDR", 4));
+        EXPECT_EQ(3, mapped.size());
+        EXPECT_EQ("\x89PNG", Token(mapped, 1));
+    }
+    remove("dictionary_table.bin");
+}
+
+TEST(Dictionary, Harvest)
+{
+    fuzzer::bytecode::Script script;
+    shared_ptr<fuzzer::bytecode::Method> method = make_shared<fuzzer::bytecode::Method>();
+    method->constant_strings.push_back("USER");
+    script._methods.push_back(method);
+    shared_ptr<Template> tp = make_shared<Template>();
+    tp->u8(1);
+    tp->u32(0xcafebabe);
+    tp->array("abc", 3);
+    script._templates["t"] = tp;
+
+    Dictionary dictionary;
+    dictionary.harvest(script);
+    ASSERT_EQ(3, dictionary.size());
+    EXPECT_EQ("USER", Token(dictionary, 0));
+    EXPECT_EQ("\xca\xfe\xba\xbe", Token(dictionary, 1));
+    EXPECT_EQ("abc", Token(dictionary, 2));
+}
+
+TEST(Dictionary, AttachNull)
+{
+    UnsignedMutator<uint32_t> integer(1);
+    FloatMutator<double> real(1.0);
+    AsciiStringMutator string(StringRepresentation::CSTRING, "abc");
+    fuzzer::bytecode::Script script;
+    shared_ptr<Template> tp = make_shared<Template>();
+    tp->lazy(&integer);
+    tp->lazy(&real);
+    tp->lazy(&string);
+    script._templates["t"] = tp;
+
+    const size_t count = integer.count();
+    EXPECT_NO_THROW(AttachDictionary(script, nullptr));
+    EXPECT_EQ(count, integer.count());
+}
@@ -0,0 +1,210 @@
+#ifndef _FAKEAPP_H_
+#define _FAKEAPP_H_
+
+#include <fuzzengine\appexec.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace fuzzer {
+
+namespace test {
+
+///
+/// \class  FakeApp
+/// \brief  Application that connects to the fuzzer on the loopback
+///         interface, and answers every byte with the number of bytes it
+///         received before on the connection, followed by a byte that a
+///         script doesn't read. It connects again when the fuzzer closes the
+///         connection, and runs until it is terminated.
+///
+///         The application waits on a pipe, so that Terminate() wakes it at
+///         once, and retries its connect until the fuzzer listens.
+///
+class FakeApp : public execution::IApplicationExecuter
+{
+public:
+    /// launches and running applications, shared by several of them
+    struct Totals {
+        Totals() : launches(0), running(0) {}
+
+        std::atomic<size_t> launches;
+        std::atomic<size_t> running;
+    };
+
+    ///
+    /// \brief  Constructor
+    ///
+    /// \param [in] port    The port the fuzzer listens on.
+    /// \param [in] totals  Counts the launches of this application too.
+    ///
+    explicit FakeApp(uint16_t port, Totals * totals = nullptr) :
+        _port(port), _totals(totals), _connect(true), _delay(0), _snapshots(false),
+        _alive(false), _launches(0), _sessions(0), _restores(0)
+    {
+        _wake[0] = _wake[1] = -1;
+    }
+
+    ~FakeApp() { Terminate(); }
+
+    /// the application never connects
+    FakeApp & silent() { _connect = false; return *this; }
+
+    /// the application connects \p delay ms after it is launched
+    FakeApp & delay(size_t delay) { _delay = delay; return *this; }
+
+    /// snapshots succeed, the state isn't restored and the connection stays as it is
+    FakeApp & snapshots() { _snapshots = true; return *this; }
+
+    virtual bool Launch()
+    {
+        Terminate();
+        if (pipe(_wake) != 0) {
+            return false;
+        }
+        ++_launches;
+        if (_totals) {
+            ++_totals->launches;
+            ++_totals->running;
+        }
+        _alive = true;
+        _thread = std::thread(&FakeApp::Serve, this);
+        return true;
+    }
+
+    virtual bool Terminate()
+    {
+        _alive = false;
+        if (_thread.joinable()) {
+            const char wake = 0;
+            if (write(_wake[1], &wake, 1) != 1) {
+                return false;
+            }
+            _thread.join();
+            close(_wake[0]);
+            close(_wake[1]);
+            _wake[0] = _wake[1] = -1;
+            if (_totals) {
+                --_totals->running;
+            }
+        }
+        return true;
+    }
+
+    virtual bool GetStatusCode(int & StatusCode, execution::TerminationReason & Reason)
+    {
+        StatusCode  = 0;
+        Reason      = execution::Term_Normal;
+        return true;
+    }
+
+    /// the application only exits when it is terminated
+    virtual bool Wait(int = -1) { return !_alive; }
+
+    virtual bool IsAlive() { return _alive; }
+
+    virtual void SetCommandLine(const std::string &) {}
+
+    virtual bool Snapshot() { return _snapshots; }
+    virtual bool Restore() { _restores += _snapshots; return _snapshots; }
+
+    size_t launches() const { return _launches; }
+    size_t restores() const { return _restores; }
+
+    /// connections that received a test case
+    size_t sessions() const { return _sessions; }
+
+    /// bytes received on each connection the fuzzer closed
+    std::vector<size_t> received()
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        return _received;
+    }
+
+private:
+    /// waits at most \p TimeOut ms for \p sock, true if terminated meanwhile
+    bool WaitFor(int sock, int TimeOut)
+    {
+        pollfd fds[2];
+        fds[0].fd       = _wake[0];
+        fds[0].events   = POLLIN;
+        fds[0].revents  = 0;
+        fds[1].fd       = sock;
+        fds[1].events   = POLLIN;
+        fds[1].revents  = 0;
+        poll(fds, sock < 0 ? 1 : 2, TimeOut);
+        return fds[0].revents != 0;
+    }
+
+    void Serve()
+    {
+        if (_delay && WaitFor(-1, static_cast<int>(_delay))) {
+            return;
+        }
+        if (!_connect) {
+            WaitFor(-1, -1);
+            return;
+        }
+        for(;;) {
+            const int sock = socket(AF_INET, SOCK_STREAM, 0);
+            sockaddr_in address = sockaddr_in();
+            address.sin_family      = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            address.sin_port        = htons(_port);
+            if (connect(sock, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0) {
+                /// the fuzzer doesn't listen yet
+                close(sock);
+                if (WaitFor(-1, 5)) {
+                    return;
+                }
+                continue;
+            }
+            uint8_t count = 0;
+            size_t received = 0;
+            for(;;) {
+                if (WaitFor(sock, -1)) {
+                    close(sock);
+                    return;
+                }
+                uint8_t byte;
+                if (recv(sock, &byte, 1, 0) <= 0) {
+                    /// closed by the fuzzer
+                    std::lock_guard<std::mutex> lock(_lock);
+                    _received.push_back(received);
+                    break;
+                }
+                if (!received++) {
+                    ++_sessions;
+                }
+                const uint8_t reply[] = { count++, 0xee };
+                send(sock, reply, sizeof(reply), MSG_NOSIGNAL);
+            }
+            close(sock);
+        }
+    }
+
+    uint16_t            _port;
+    Totals *            _totals;
+    bool                _connect;
+    size_t              _delay;
+    bool                _snapshots;
+    std::atomic<bool>   _alive;
+    std::atomic<size_t> _launches;
+    std::atomic<size_t> _sessions;
+    size_t              _restores;
+    int                 _wake[2];   //< written by Terminate()
+    std::mutex          _lock;
+    std::vector<size_t> _received;
+    std::thread         _thread;
+};
+
+} // namespace test
+
+} // namespace fuzzer
+
+#endif
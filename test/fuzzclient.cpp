@@ -0,0 +1,200 @@
+#ifdef __linux__
+
+#include <fuzzengine\fuzzclient.h>
+#include <fuzzengine\generator.h>
+#include <gtest\gtest.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace fuzzer;
+
+namespace {
+
+///
+/// \brief  Server that listens on the loopback interface and answers every
+///         byte with a 0. With crash() it closes the connection on the first
+///         byte instead, and exits with an access violation.
+///
+class FakeServer : public execution::IApplicationExecuter
+{
+public:
+    explicit FakeServer(uint16_t port) :
+        _port(port), _crash(false), _alive(false), _crashed(false), _launches(0)
+    {
+        _wake[0] = _wake[1] = -1;
+    }
+
+    ~FakeServer() { Terminate(); }
+
+    FakeServer & crash() { _crash = true; return *this; }
+
+    virtual bool Launch()
+    {
+        Terminate();
+        const int sock = socket(AF_INET, SOCK_STREAM, 0);
+        int reuse = 1;
+        setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        sockaddr_in address = sockaddr_in();
+        address.sin_family      = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port        = htons(_port);
+        if (bind(sock, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 ||
+            listen(sock, 8) != 0 || pipe(_wake) != 0)
+        {
+            close(sock);
+            return false;
+        }
+        ++_launches;
+        _alive      = true;
+        _crashed    = false;
+        _thread     = std::thread(&FakeServer::Serve, this, sock);
+        return true;
+    }
+
+    virtual bool Terminate()
+    {
+        if (_thread.joinable()) {
+            const char wake = 0;
+            if (write(_wake[1], &wake, 1) != 1) {
+                return false;
+            }
+            _thread.join();
+            close(_wake[0]);
+            close(_wake[1]);
+            _wake[0] = _wake[1] = -1;
+        }
+        _alive = false;
+        return true;
+    }
+
+    virtual bool GetStatusCode(int & StatusCode, execution::TerminationReason & Reason)
+    {
+        StatusCode  = _crashed ? 139 : 0;
+        Reason      = _crashed ? execution::Term_SegmentationFault : execution::Term_Normal;
+        return !_alive;
+    }
+
+    virtual bool Wait(int = -1) { return !_alive; }
+
+    virtual bool IsAlive() { return _alive; }
+
+    virtual void SetCommandLine(const std::string &) {}
+
+    size_t launches() const { return _launches; }
+
+private:
+    void Serve(int listener)
+    {
+        std::vector<pollfd> fds(2);
+        fds[0].fd       = _wake[0];
+        fds[0].events   = POLLIN;
+        fds[1].fd       = listener;
+        fds[1].events   = POLLIN;
+        while(_alive) {
+            for(size_t i = 0; i < fds.size(); ++i) {
+                fds[i].revents = 0;
+            }
+            poll(&fds[0], fds.size(), -1);
+            if (fds[0].revents) {
+                break;
+            }
+            if (fds[1].revents) {
+                pollfd fd;
+                fd.fd       = accept(listener, nullptr, nullptr);
+                fd.events   = POLLIN;
+                fd.revents  = 0;
+                fds.push_back(fd);
+            }
+            for(size_t i = 2; i < fds.size(); ++i) {
+                if (!fds[i].revents) {
+                    continue;
+                }
+                uint8_t byte;
+                if (recv(fds[i].fd, &byte, 1, 0) > 0 && !_crash) {
+                    const uint8_t reply = 0;
+                    send(fds[i].fd, &reply, 1, MSG_NOSIGNAL);
+                    continue;
+                }
+                if (_crash) {
+                    /// dead before the script sees the connection close
+                    _crashed    = true;
+                    _alive      = false;
+                }
+                close(fds[i].fd);
+                fds.erase(fds.begin() + i--);
+            }
+        }
+        for(size_t i = 1; i < fds.size(); ++i) {
+            close(fds[i].fd);
+        }
+    }
+
+    uint16_t            _port;
+    bool                _crash;
+    std::atomic<bool>   _alive;
+    std::atomic<bool>   _crashed;
+    size_t              _launches;
+    int                 _wake[2];   //< written by Terminate()
+    std::thread         _thread;
+};
+
+std::shared_ptr<bytecode::Script> Parse()
+{
+    std::stringstream str;
+    str << "template t = [ {byte(0)} ]; function main() { out(t); in8(); }";
+    parser::Tokenizer token(str);
+    bytecode::Generator generator;
+    return generator.ParseScript(token);
+}
+
+} // namespace
+
+TEST(FuzzClient, StopsServer)
+{
+    FakeServer app(47380);
+    network::ConnectionPool pool("127.0.0.1", 47380, 2);
+    runtime::ServerTarget target(app, pool);
+    std::shared_ptr<bytecode::Script> script = Parse();
+
+    /// keeps it running while the workers start
+    target.Join();
+    std::vector<std::thread> workers;
+    for(size_t i = 0; i < 2; ++i) {
+        workers.push_back(std::thread([&target, &script, i]() {
+            runtime::FuzzClient client(target);
+            client.RunHavoc(*script, 1000, 1, i, 5);
+        }));
+    }
+    for(size_t i = 0; i < workers.size(); ++i) {
+        workers[i].join();
+    }
+    EXPECT_EQ(1, app.launches());
+    EXPECT_TRUE(app.IsAlive());
+    /// stopped once the last one leaves
+    target.Leave();
+    EXPECT_FALSE(app.IsAlive());
+}
+
+TEST(FuzzClient, ReportsCrash)
+{
+    FakeServer app(47381);
+    app.crash();
+    network::ConnectionPool pool("127.0.0.1", 47381, 1);
+    runtime::ServerTarget target(app, pool);
+    runtime::FuzzClient client(target);
+
+    testing::internal::CaptureStdout();
+    client.RunHavoc(*Parse(), 1000, 1, 0, 2);
+    const std::string output = testing::internal::GetCapturedStdout();
+    EXPECT_NE(std::string::npos, output.find("App exited with 139, access violation")) << output;
+    EXPECT_EQ(2, app.launches());
+    EXPECT_FALSE(app.IsAlive());
+}
+
+#endif // __linux__
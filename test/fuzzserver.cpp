@@ -0,0 +1,136 @@
+#ifdef __linux__
+
+#include <fuzzengine\fuzzserver.h>
+#include <fuzzengine\generator.h>
+#include <fuzzengine\structuremutator.h>
+#include <gtest\gtest.h>
+#include <set>
+#include <sstream>
+#include "fakeapp.h"
+
+using namespace fuzzer;
+
+namespace {
+
+using test::FakeApp;
+
+/// records the bytes read by the script
+class Server : public runtime::FuzzServer
+{
+public:
+    Server(network::TcpServer & network, execution::IApplicationExecuter & app) :
+        runtime::FuzzServer(network, app)
+    {
+    }
+
+    std::vector<uint64_t> _read;
+
+protected:
+    virtual bytecode::Value Call(bytecode::VirtualMachine & vm, const std::string & name,
+        const std::vector<bytecode::Value> & arguments)
+    {
+        bytecode::Value value = runtime::FuzzServer::Call(vm, name, arguments);
+        if (name == "in8") {
+            _read.push_back(value.u.uValue);
+        }
+        return value;
+    }
+};
+
+std::shared_ptr<bytecode::Script> Parse(const char * main = "out(t); in8();",
+    const char * templates = "template t = [ {byte(0)} ];")
+{
+    std::stringstream str;
+    str << templates << " function main() { " << main << " }";
+    parser::Tokenizer token(str);
+    bytecode::Generator generator;
+    return generator.ParseScript(token);
+}
+
+/// runs 5 test cases, returns what the script read
+std::vector<uint64_t> RunCases(FakeApp & app, uint16_t port,
+    runtime::FuzzServer::Persistence persistence, size_t MaxCases = 0,
+    std::shared_ptr<bytecode::Script> script = Parse())
+{
+    network::TcpServer network("127.0.0.1", port);
+    Server server(network, app);
+    server.SetPersistence(persistence, MaxCases);
+    server.RunHavoc(*script, 1000, 1, 0, 5);
+    return server._read;
+}
+
+} // namespace
+
+TEST(FuzzServer, Relaunch)
+{
+    FakeApp app(47311);
+    const uint64_t expected[] = { 0, 0, 0, 0, 0 };
+    EXPECT_EQ(std::vector<uint64_t>(expected, expected + 5), RunCases(app, 47311, runtime::FuzzServer::RELAUNCH));
+    EXPECT_EQ(5, app.launches());
+    EXPECT_EQ(5, app.sessions());
+}
+
+TEST(FuzzServer, Reconnect)
+{
+    FakeApp app(47312);
+    const uint64_t expected[] = { 0, 0, 0, 0, 0 };
+    EXPECT_EQ(std::vector<uint64_t>(expected, expected + 5), RunCases(app, 47312, runtime::FuzzServer::RECONNECT));
+    EXPECT_EQ(1, app.launches());
+    EXPECT_EQ(5, app.sessions());
+}
+
+TEST(FuzzServer, Session)
+{
+    FakeApp app(47313);
+    /// the byte left unread by a case isn't read by the next one
+    const uint64_t expected[] = { 0, 1, 2, 3, 4 };
+    EXPECT_EQ(std::vector<uint64_t>(expected, expected + 5), RunCases(app, 47313, runtime::FuzzServer::SESSION));
+    EXPECT_EQ(1, app.launches());
+    EXPECT_EQ(1, app.sessions());
+}
+
+TEST(FuzzServer, MaxCases)
+{
+    FakeApp app(47314);
+    const uint64_t expected[] = { 0, 1, 0, 1, 0 };
+    EXPECT_EQ(std::vector<uint64_t>(expected, expected + 5), RunCases(app, 47314, runtime::FuzzServer::SESSION, 2));
+    EXPECT_EQ(3, app.launches());
+    EXPECT_EQ(3, app.sessions());
+}
+
+TEST(FuzzServer, Snapshot)
+{
+    FakeApp app(47315);
+    app.snapshots();
+    /// the reads before snapshot() are replayed, the byte left unread by
+    /// the last one is dropped on restore
+    const uint64_t expected[] = { 0, 0xee, 1, 0, 0xee, 2, 0, 0xee, 3, 0, 0xee, 4, 0, 0xee, 5 };
+    EXPECT_EQ(std::vector<uint64_t>(expected, expected + 15), RunCases(app, 47315, runtime::FuzzServer::RELAUNCH, 0,
+        Parse("out(t); in8(); in8(); snapshot(); out(t); in8();")));
+    EXPECT_EQ(1, app.launches());
+    EXPECT_EQ(5, app.restores());
+}
+
+TEST(FuzzServer, Structure)
+{
+    FakeApp app(47316);
+    {
+        network::TcpServer network("127.0.0.1", 47316);
+        Server server(network, app);
+        server.SetPersistence(runtime::FuzzServer::RECONNECT);
+        server.Run(*Parse("out(s); in8();", "template s = structure [ byte(1), byte(2), byte(3) ];"), 1000);
+    }
+    /// every item level variant reaches the target: dropped, duplicated or
+    /// swapped items, and the items repeated 2, 16, 256 and 4096 times
+    const size_t repeats = runtime::StructureMutator::RepeatCountsCount;
+    EXPECT_EQ(3 + 3 + 3 + 3 * repeats, app.sessions());
+    const std::vector<size_t> received = app.received();
+    const std::set<size_t> lengths(received.begin(), received.end());
+    EXPECT_EQ(1, lengths.count(2));
+    EXPECT_EQ(1, lengths.count(3));
+    EXPECT_EQ(1, lengths.count(4));
+    EXPECT_EQ(1, lengths.count(18));
+    EXPECT_EQ(1, lengths.count(258));
+}
+
+#endif
@@ -0,0 +1,166 @@
+#include <gtest\gtest.h>
+#include <fuzzengine\havoc.h>
+#include <fuzzengine\integermutator.h>
+#include <fuzzengine\stringmutator.h>
+#include <memory>
+#include <set>
+
+using namespace fuzzer::runtime;
+using namespace std;
+
+TEST(Xoshiro256, Deterministic)
+{
+    Xoshiro256 a(42), b(42), c(43);
+    bool differs = false;
+    for(size_t i = 0; i < 100; ++i) {
+        const uint64_t value = a.next();
+        EXPECT_EQ(value, b.next());
+        differs |= (value != c.next());
+    }
+    EXPECT_TRUE(differs);
+    for(size_t i = 0; i < 1000; ++i) {
+        EXPECT_LT(a.below(7), 7);
+    }
+}
+
+TEST(HavocScheduler, CasesAreReproducible)
+{
+    UnsignedMutator<uint8_t> first(1);
+    UnsignedMutator<uint16_t> second(2);
+    AsciiStringMutator third(StringRepresentation::CSTRING, "abc");
+    shared_ptr<Template> a = make_shared<Template>();
+    a->lazy(&first);
+    a->lazy(&second);
+    shared_ptr<Template> b = make_shared<Template>();
+    b->lazy(&third);
+    fuzzer::bytecode::Script script;
+    script._templates["a"] = a;
+    script._templates["b"] = b;
+
+    HavocScheduler worker(script, 0x1234, 3);
+    vector<vector<uint8_t> > generated;
+    vector<uint64_t> ids;
+    set<string> names;
+    for(size_t i = 0; i < 32; ++i) {
+        const uint64_t id = worker.next();
+        EXPECT_EQ(HavocScheduler::CaseId(3, i), id);
+        EXPECT_EQ(id, worker.current());
+        names.insert(worker.name());
+        vector<uint8_t> data;
+        script._templates[worker.name()]->generate(data);
+        generated.push_back(data);
+        ids.push_back(id);
+    }
+    EXPECT_EQ(2, names.size());
+
+    /// another scheduler with the same master seed regenerates any case
+    HavocScheduler replay(script, 0x1234);
+    for(size_t i = ids.size(); i-- > 0;) {
+        ASSERT_TRUE(replay.apply(ids[i]));
+        vector<uint8_t> data;
+        script._templates[replay.name()]->generate(data);
+        EXPECT_EQ(generated[i], data);
+    }
+    EXPECT_NE(string::npos, replay.describe().find("seed=0x1234"));
+
+    /// unpicked mutators write their initial value
+    HavocScheduler other(script, 99);
+    for(size_t i = 0; i < 16; ++i) {
+        other.next();
+        if (other.name() == "b") {
+            EXPECT_TRUE(first.finished());
+            EXPECT_EQ(1, first.current());
+        }
+    }
+}
+
+namespace {
+
+/// mutator that can only step, like a plugin mutator
+class SteppingMutator : public Mutator
+{
+public:
+    SteppingMutator() : _step(0) {}
+
+    virtual bool mutate() { return ++_step < 16; }
+    virtual bool finished() { return _step >= 16; }
+    virtual void reset() { _step = 0; }
+    virtual void evaluate(Buffer & buffer) { buffer.writeU8(static_cast<uint8_t>(_step)); }
+
+private:
+    size_t  _step;
+};
+
+} // namespace
+
+TEST(HavocScheduler, UnseekableMutatorsAreReset)
+{
+    SteppingMutator stepping;
+    UnsignedMutator<uint8_t> first(1);
+    UnsignedMutator<uint8_t> second(2);
+    shared_ptr<Template> a = make_shared<Template>();
+    a->lazy(&stepping);
+    a->lazy(&first);
+    shared_ptr<Template> b = make_shared<Template>();
+    b->lazy(&second);
+    fuzzer::bytecode::Script script;
+    script._templates["a"] = a;
+    script._templates["b"] = b;
+
+    HavocScheduler worker(script, 7);
+    vector<vector<uint8_t> > generated;
+    vector<uint64_t> ids;
+    for(size_t i = 0; i < 64; ++i) {
+        ids.push_back(worker.next());
+        vector<uint8_t> data;
+        a->generate(data);
+        generated.push_back(data);
+    }
+
+    /// template a is the same whatever the previous case left behind
+    HavocScheduler replay(script, 7);
+    for(size_t i = ids.size(); i-- > 0;) {
+        ASSERT_TRUE(replay.apply(ids[i]));
+        vector<uint8_t> data;
+        a->generate(data);
+        EXPECT_EQ(generated[i], data);
+    }
+}
+
+TEST(HavocScheduler, PromotedCases)
+{
+    UnsignedMutator<uint16_t> first(1);
+    UnsignedMutator<uint32_t> second(2);
+    shared_ptr<Template> a = make_shared<Template>();
+    a->lazy(&first);
+    a->lazy(&second);
+    fuzzer::bytecode::Script script;
+    script._templates["a"] = a;
+
+    HavocScheduler scheduler(script, 99);
+    scheduler.next();
+    const string promoted = scheduler.describe();
+    const string mutations = promoted.substr(promoted.find("mutations=") + 10);
+    scheduler.promote();
+    EXPECT_EQ(1, scheduler.promoted());
+
+    /// some of the following cases start with the mutations of the promoted case
+    size_t derived = 0;
+    for(size_t i = 0; i < 64; ++i) {
+        const uint64_t id = scheduler.next();
+        EXPECT_EQ(HavocScheduler::CaseId(0, i + 1), id);
+        const string description = scheduler.describe();
+        if (description.find(", parent=0x0,") != string::npos) {
+            ++derived;
+            EXPECT_EQ(mutations, description.substr(description.find("mutations=") + 10, mutations.size()));
+        }
+    }
+    EXPECT_GT(derived, 8);
+    EXPECT_LT(derived, 56);
+
+    scheduler.park();
+    vector<uint8_t> data;
+    a->generate(data);
+    const uint8_t initial[] = { 0, 1, 0, 0, 0, 2 };
+    EXPECT_EQ(vector<uint8_t>(initial, initial + sizeof(initial)), data);
+}
@@ -2,6 +2,13 @@
 #include <fuzzengine\parser.h>
 #include <fuzzengine\input.h>
 #include <fuzzengine\arraysource.h>
+#include <fuzzengine\bufferedsource.h>
+#include <fuzzengine\fuzzer.h>
+#include <fuzzengine\generator.h>
+#include <fuzzengine\ioerror.h>
+#include <fuzzengine\lazycapture.h>
+#include <fuzzengine\template.h>
+#include <cstring>
 #include <sstream>
 
 using namespace fuzzer::parser;
@@ -23,6 +30,7 @@ TEST(Output, inputConst)
     ASSERT_NO_THROW(stmt = ParseStatement("[u32, u8] >> $variable;"));
     ASSERT_EQ(Statement::STMT_IN, stmt->GetType());
 }
+#endif
 
 TEST(Input, VariableArray)
 {
@@ -45,6 +53,11 @@ TEST(Input, VariableArray)
     ASSERT_TRUE(item != NULL);
     EXPECT_EQ(fuzzer::io::InputItem::BYTE, item->type);
     EXPECT_EQ(10, item->u.byte);
+
+    item = input.get(payload);
+    ASSERT_TRUE(item != NULL);
+    ASSERT_EQ(10, item->u.varray.count);
+    EXPECT_EQ(0, memcmp(data + 1, item->u.varray.data, 10));
 }
 
 TEST(Input, InvalidVariableArray)
@@ -64,4 +77,230 @@ TEST(Input, InvalidVariableArray)
     /// now try to actually read the packet
     EXPECT_FALSE(input.read(source));
 }
-#endif
\ No newline at end of file
+
+TEST(Input, ArrayLongerThanMax)
+{
+    const uint8_t data[] = { 0x03, 0x01, 0x02, 0x03 };
+
+    fuzzer::io::ArraySource source(data, sizeof(data));
+    fuzzer::io::Input input;
+    size_t lengthField = input.u8();
+    input.varray(lengthField, 2);
+    EXPECT_FALSE(input.read(source));
+    EXPECT_THROW(input.varray(7, 2), std::runtime_error);
+}
+
+TEST(Input, ByteOrder)
+{
+    const uint8_t data[] = {
+        0x01, 0x02,                     // u16
+        0x01, 0x02, 0x03,               // u24
+        0x01, 0x02, 0x03, 0x04,         // u32
+        0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08
+    };
+
+    fuzzer::io::Input input;
+    size_t word     = input.u16();
+    size_t word24   = input.u24();
+    size_t dword    = input.u32();
+    size_t qword    = input.u64();
+
+    fuzzer::io::ArraySource big(data, sizeof(data));
+    ASSERT_TRUE(input.read(big));
+    EXPECT_EQ(0x0102, input.get(word)->u.word);
+    EXPECT_EQ(0x010203, input.get(word24)->u.dword);
+    EXPECT_EQ(0x01020304, input.get(dword)->u.dword);
+    EXPECT_EQ(0x0102030405060708ULL, input.get(qword)->u.qword);
+
+    fuzzer::io::ArraySource little(data, sizeof(data));
+    little.read_little_endian();
+    ASSERT_TRUE(input.read(little));
+    EXPECT_EQ(0x0201, input.get(word)->u.word);
+    EXPECT_EQ(0x030201, input.get(word24)->u.dword);
+    EXPECT_EQ(0x04030201, input.get(dword)->u.dword);
+    EXPECT_EQ(0x0807060504030201ULL, input.get(qword)->u.qword);
+}
+
+TEST(Input, BufferedMessages)
+{
+    const uint8_t data[] = {
+        0x00, 0x03, 'a', 'b', 'c',      // first message
+        0x00, 0x02, 'd', 'e',           // second message
+        0x00, 0x04, 'f'                 // truncated
+    };
+
+    fuzzer::io::ArraySource array(data, sizeof(data));
+    /// a small buffer, so that it has to grow and compact
+    fuzzer::io::BufferedSource source(array, 4);
+    fuzzer::io::Input input;
+    size_t length   = input.u16(false);
+    size_t payload  = input.varray(length, 16);
+
+    ASSERT_TRUE(input.read(source));
+    const fuzzer::io::InputItem * item = input.get(payload);
+    ASSERT_EQ(3, item->u.varray.count);
+    EXPECT_EQ(0, memcmp("abc", item->u.varray.data, 3));
+
+    ASSERT_TRUE(input.read(source));
+    ASSERT_EQ(2, item->u.varray.count);
+    /// a view into the receive buffer, not a copy
+    EXPECT_EQ(source.data(), item->u.varray.data + 2);
+    EXPECT_EQ(0, memcmp("de", item->u.varray.data, 2));
+
+    EXPECT_FALSE(input.read(source));
+}
+
+TEST(Input, LazyCapture)
+{
+    const uint8_t data[] = {
+        0x12, 0x34,                     // sequence number
+        0x04, 'c', 'o', 'o', 'k'        // cookie
+    };
+
+    std::shared_ptr<fuzzer::io::Input> input = std::make_shared<fuzzer::io::Input>();
+    size_t sequence = input->u16();
+    size_t length   = input->u8(false);
+    size_t cookie   = input->varray(length, 16);
+    EXPECT_THROW(fuzzer::runtime::LazyCapture capture(input, length), std::runtime_error);
+    EXPECT_THROW(fuzzer::runtime::LazyCapture capture(input, cookie), std::runtime_error);
+    input->retain(true);
+
+    fuzzer::runtime::Template message;
+    message.u8(0xff);
+    message.lazy(new fuzzer::runtime::LazyCapture(input, cookie));
+    message.lazy(new fuzzer::runtime::LazyCapture(input, sequence));
+
+    /// nothing has been read yet
+    std::vector<uint8_t> generated;
+    message.little_endian().generate(generated);
+    ASSERT_EQ(3, generated.size());
+    EXPECT_EQ(0, generated[1]);
+
+    fuzzer::io::ArraySource source(data, sizeof(data));
+    ASSERT_TRUE(input->read(source));
+    generated.clear();
+    message.generate(generated);
+    const uint8_t expected[] = { 0xff, 'c', 'o', 'o', 'k', 0x34, 0x12 };
+    EXPECT_EQ(std::vector<uint8_t>(expected, expected + sizeof(expected)), generated);
+}
+
+TEST(Input, RetainedArrays)
+{
+    const uint8_t data[] = {
+        0x00, 0x03, 'a', 'b', 'c',
+        0x00, 0x02, 'd', 'e'
+    };
+
+    fuzzer::io::ArraySource array(data, sizeof(data));
+    fuzzer::io::BufferedSource source(array, 4);
+    fuzzer::io::Input input;
+    size_t length   = input.u16(false);
+    size_t payload  = input.varray(length, 16);
+    input.retain(true);
+
+    ASSERT_TRUE(input.read(source));
+    const fuzzer::io::InputItem * item = input.get(payload);
+    ASSERT_EQ(3, item->u.varray.count);
+    /// the receive buffer moves on, the copy doesn't
+    ASSERT_TRUE(source.require(4));
+    EXPECT_EQ(0, memcmp("abc", item->u.varray.data, 3));
+
+    ASSERT_TRUE(input.read(source));
+    ASSERT_EQ(2, item->u.varray.count);
+    EXPECT_EQ(0, memcmp("de", item->u.varray.data, 2));
+}
+
+namespace {
+
+/// target that answers every read with the next message
+class Responder : public fuzzer::io::Ipc
+{
+public:
+    Responder(const uint8_t * data, size_t size) : _data(data, data + size), _offset(0) {}
+
+    virtual bool write(const void *, size_t) { return true; }
+
+    virtual bool read(void * dst, size_t count)
+    {
+        if (_data.size() - _offset < count) {
+            return false;
+        }
+        memcpy(dst, &_data[_offset], count);
+        _offset += count;
+        return true;
+    }
+
+    std::vector<uint8_t>    _data;
+    size_t                  _offset;
+};
+
+class Runner : public fuzzer::Fuzzer
+{
+public:
+    Runner(fuzzer::io::Ipc * ipc) { Attach(ipc); }
+
+    void Read(const std::string & name)
+    {
+        std::vector<fuzzer::bytecode::Value> arguments(1);
+        arguments[0].type           = fuzzer::bytecode::Value::STRING;
+        arguments[0].stringValue    = std::make_shared<std::string>(name);
+        Call(_vm, "read", arguments);
+    }
+};
+
+} // namespace
+
+TEST(Input, ScriptResponse)
+{
+    std::stringstream str;
+    str << "response login = [ u8 length, array(length, 8) token, u8 ];"
+           "template reply = [ byte(1), login.token, login.length ];";
+    fuzzer::parser::Tokenizer token(str);
+    fuzzer::bytecode::Generator generator;
+    std::shared_ptr<fuzzer::bytecode::Script> script;
+    ASSERT_NO_THROW(script = generator.ParseScript(token));
+
+    const uint8_t data[] = {
+        0x03, 'a', 'b', 'c', 0xff,
+        0x02, 'd', 'e', 0xff,
+        0x09
+    };
+    Responder responder(data, sizeof(data));
+    Runner runner(&responder);
+    runner.Compile(*script);
+
+    fuzzer::runtime::Template & reply = *script->_templates["reply"];
+    runner.Read("login");
+    std::vector<uint8_t> generated;
+    reply.generate(generated);
+    const uint8_t first[] = { 0x01, 'a', 'b', 'c', 0x03 };
+    EXPECT_EQ(std::vector<uint8_t>(first, first + sizeof(first)), generated);
+
+    runner.Read("login");
+    generated.clear();
+    reply.generate(generated);
+    const uint8_t second[] = { 0x01, 'd', 'e', 0x02 };
+    EXPECT_EQ(std::vector<uint8_t>(second, second + sizeof(second)), generated);
+
+    /// longer than the maximum
+    EXPECT_THROW(runner.Read("login"), fuzzer::io::IoException);
+    EXPECT_THROW(runner.Read("logout"), std::runtime_error);
+}
+
+TEST(Input, ScriptResponseErrors)
+{
+    const char * scripts[] = {
+        "template x = [ login.token ];",
+        "response login = [ u8 ]; template x = [ login.token ];",
+        "response login = [ array(length, 8) token ];",
+        "response login = [ u8 a, u8 a ];",
+        "response login = [ u8 ]; response login = [ u8 ];"
+    };
+    for(size_t i = 0; i < sizeof(scripts) / sizeof(scripts[0]); ++i) {
+        std::stringstream str;
+        str << scripts[i];
+        fuzzer::parser::Tokenizer token(str);
+        fuzzer::bytecode::Generator generator;
+        EXPECT_THROW(generator.ParseScript(token), std::runtime_error) << scripts[i];
+    }
+}
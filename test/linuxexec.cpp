@@ -0,0 +1,183 @@
+#ifdef __linux__
+
+#include <fuzzengine\linuxexec.h>
+#include <gtest\gtest.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace fuzzer::execution;
+
+namespace {
+
+/// a shell that counts the lines it reads, through two fifos
+class Counter
+{
+public:
+    Counter() : _app("/bin/sh")
+    {
+        snprintf(_in, sizeof(_in), "/tmp/linuxexec.%d.in", static_cast<int>(getpid()));
+        snprintf(_out, sizeof(_out), "/tmp/linuxexec.%d.out", static_cast<int>(getpid()));
+        mkfifo(_in, 0600);
+        mkfifo(_out, 0600);
+        _app.SetCommandLine(std::string("-c \"exec <") + _in + " >" + _out +
+            "; i=0; while read l; do i=$((i+1)); echo $i; done\"");
+    }
+
+    ~Counter()
+    {
+        close(_write);
+        close(_read);
+        unlink(_in);
+        unlink(_out);
+    }
+
+    bool Launch()
+    {
+        if (!_app.Launch()) {
+            return false;
+        }
+        _write  = open(_in, O_WRONLY);
+        _read   = open(_out, O_RDONLY);
+        return _write >= 0 && _read >= 0;
+    }
+
+    /// sends a line, returns the count
+    int Next()
+    {
+        char line[16] = { 0 };
+        if (write(_write, "x\n", 2) != 2 || read(_read, line, sizeof(line) - 1) <= 0) {
+            return -1;
+        }
+        return atoi(line);
+    }
+
+    LinuxExecuter & app() { return _app; }
+
+private:
+    LinuxExecuter   _app;
+    char            _in[64];
+    char            _out[64];
+    int             _write;
+    int             _read;
+};
+
+} // namespace
+
+TEST(LinuxExecuter, StatusCode)
+{
+    LinuxExecuter app("/bin/sh");
+    int code;
+    TerminationReason reason;
+    app.SetCommandLine("-c \"exit 3\"");
+    ASSERT_TRUE(app.Launch());
+    EXPECT_TRUE(app.Wait(5000));
+    EXPECT_FALSE(app.IsAlive());
+    ASSERT_TRUE(app.GetStatusCode(code, reason));
+    EXPECT_EQ(3, code);
+    EXPECT_EQ(Term_Normal, reason);
+    EXPECT_STREQ("normal exit", DescribeTermination(reason));
+
+    app.SetCommandLine("-c \"kill -SEGV $$\"");
+    ASSERT_TRUE(app.Launch());
+    EXPECT_TRUE(app.Wait());
+    ASSERT_TRUE(app.GetStatusCode(code, reason));
+    EXPECT_EQ(128 + 11, code);
+    EXPECT_EQ(Term_SegmentationFault, reason);
+    EXPECT_STREQ("access violation", DescribeTermination(reason));
+    EXPECT_FALSE(app.Restore());
+}
+
+TEST(LinuxExecuter, SnapshotAndRestore)
+{
+    Counter counter;
+    ASSERT_TRUE(counter.Launch());
+    EXPECT_EQ(1, counter.Next());
+    EXPECT_EQ(2, counter.Next());
+
+    /// the shell is blocked in read(), it continues from there
+    ASSERT_TRUE(counter.app().Snapshot());
+    EXPECT_EQ(3, counter.Next());
+    EXPECT_EQ(4, counter.Next());
+    ASSERT_TRUE(counter.app().Restore());
+    EXPECT_LT(0, counter.app().restored());
+    EXPECT_EQ(3, counter.Next());
+    ASSERT_TRUE(counter.app().Restore());
+    EXPECT_EQ(3, counter.Next());
+    EXPECT_EQ(4, counter.Next());
+
+    EXPECT_TRUE(counter.app().Terminate());
+    EXPECT_TRUE(counter.app().Wait());
+    EXPECT_FALSE(counter.app().Snapshot());
+}
+
+TEST(LinuxExecuter, MultipleThreads)
+{
+    if (access("/usr/bin/python3", X_OK) != 0) {
+        return;
+    }
+    char ready[64];
+    snprintf(ready, sizeof(ready), "/tmp/linuxexec.%d.ready", static_cast<int>(getpid()));
+    mkfifo(ready, 0600);
+    LinuxExecuter app("/usr/bin/python3");
+    app.SetCommandLine(std::string("-c \"import threading, time; "
+        "threading.Thread(target=time.sleep, args=(30,), daemon=True).start(); "
+        "f = open('") + ready + "', 'w'); time.sleep(30)\"");
+    ASSERT_TRUE(app.Launch());
+    /// opened once the second thread runs
+    const int fd = open(ready, O_RDONLY);
+    unlink(ready);
+    ASSERT_LE(0, fd);
+
+    /// only the leader would be stopped
+    EXPECT_FALSE(app.Snapshot());
+    EXPECT_FALSE(app.Restore());
+    EXPECT_TRUE(app.IsAlive());
+    EXPECT_TRUE(app.Terminate());
+    EXPECT_TRUE(app.Wait());
+    close(fd);
+}
+
+/// exit code of \p app, -1 if it didn't exit
+static int ExitCode(LinuxExecuter & app, const std::string & cmd)
+{
+    int code;
+    TerminationReason reason;
+    app.SetCommandLine(cmd);
+    if (!app.Launch() || !app.Wait(5000) || !app.GetStatusCode(code, reason)) {
+        return -1;
+    }
+    return code;
+}
+
+TEST(LinuxExecuter, CoverageAndComparisons)
+{
+    CoverageMap coverage;
+    ComparisonLog comparisons;
+    LinuxExecuter app("/bin/sh");
+    uint64_t checksum;
+    EXPECT_FALSE(app.GetCoverageChecksum(checksum));
+    EXPECT_EQ(nullptr, app.GetComparisonLog());
+
+    /// the variables of the fuzzer itself aren't passed on
+    setenv(CoverageMap::EnvironmentVariable, "stale", 1);
+    setenv(ComparisonLog::EnvironmentVariable, "stale", 1);
+    EXPECT_EQ(0, ExitCode(app, "-c \"test -z $FUZZENGINE_SHM$FUZZENGINE_CMPLOG_SHM\""));
+    unsetenv(CoverageMap::EnvironmentVariable);
+    unsetenv(ComparisonLog::EnvironmentVariable);
+
+    app.SetCoverageMap(&coverage);
+    app.SetComparisonLog(&comparisons);
+    coverage.data()[1] = 1;
+    EXPECT_EQ(0, ExitCode(app, "-c \"test $FUZZENGINE_SHM = " + coverage.name() +
+        " && test $FUZZENGINE_CMPLOG_SHM = " + comparisons.name() + "\""));
+    /// cleared by the launch
+    EXPECT_EQ(0, coverage.data()[1]);
+    ASSERT_TRUE(app.GetCoverageChecksum(checksum));
+    EXPECT_EQ(coverage.checksum(), checksum);
+    EXPECT_EQ(&comparisons, app.GetComparisonLog());
+}
+
+#endif // __linux__
@@ -1,7 +1,23 @@
 #include <gtest\gtest.h>
 #include <fuzzengine\integermutator.h>
+#include <fuzzengine\vectormutator.h>
+#include <fuzzengine\stringmutator.h>
+#include <fuzzengine\utf8.h>
+#include <fuzzengine\urimutator.h>
+#include <fuzzengine\filemutator.h>
+#include <fuzzengine\coverage.h>
+#include <fuzzengine\dictionary.h>
+#include <fuzzengine\inputtostate.h>
+#include <cstdio>
 #include <fuzzengine\template.h>
 #include <sstream>
+#include <set>
+#include <algorithm>
+#ifdef __linux__
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 using namespace fuzzer::runtime;
 using namespace std;
@@ -14,4 +30,879 @@ TEST(IntegerMutator, Integer1)
 
     vector<uint8_t> result;
     tp.generate(result);
-}
\ No newline at end of file
+}
+
+template<class M, class T>
+static std::set<T> Collect(M & mutator)
+{
+    std::set<T> values;
+    do {
+        values.insert(mutator.current());
+    } while(mutator.mutate());
+    return values;
+}
+
+TEST(IntegerMutator, FiniteDword)
+{
+    UnsignedMutator<uint32_t> mutator(100);
+    EXPECT_LT(mutator.count(), 256);
+
+    std::set<uint32_t> values = Collect<UnsignedMutator<uint32_t>, uint32_t>(mutator);
+    EXPECT_TRUE(mutator.finished());
+    EXPECT_EQ(mutator.count(), values.size());
+    EXPECT_EQ(1, values.count(100));
+    EXPECT_EQ(1, values.count(101));
+    EXPECT_EQ(1, values.count(0));
+    EXPECT_EQ(1, values.count(0xffffffff));
+    EXPECT_EQ(1, values.count(0x7fffffff));
+    EXPECT_EQ(1, values.count(0x80000000));
+    EXPECT_EQ(1, values.count(0xffff));
+    EXPECT_EQ(1, values.count(0x10000));
+    EXPECT_EQ(1, values.count(0x10001));
+    EXPECT_EQ(1, values.count(0xffff0000));
+}
+
+TEST(IntegerMutator, Range)
+{
+    UnsignedMutator<uint8_t> mutator(10, 5, 20);
+    std::set<uint8_t> values = Collect<UnsignedMutator<uint8_t>, uint8_t>(mutator);
+    EXPECT_EQ(1, values.count(4));
+    EXPECT_EQ(1, values.count(5));
+    EXPECT_EQ(1, values.count(20));
+    EXPECT_EQ(1, values.count(21));
+}
+
+TEST(IntegerMutator, Signed)
+{
+    SignedMutator<int16_t> mutator(-2);
+    std::set<int16_t> values = Collect<SignedMutator<int16_t>, int16_t>(mutator);
+    EXPECT_EQ(1, values.count(-2));
+    EXPECT_EQ(1, values.count(2));
+    EXPECT_EQ(1, values.count(-1));
+    EXPECT_EQ(1, values.count(-32768));
+    EXPECT_EQ(1, values.count(32767));
+    EXPECT_EQ(1, values.count(-256));
+}
+
+TEST(IntegerMutator, SeekAndOutput)
+{
+    Template tp;
+    UnsignedMutator<uint16_t> mutator(0x1234);
+    tp.lazy(&mutator);
+
+    vector<uint8_t> result;
+    tp.generate(result);
+    ASSERT_EQ(2, result.size());
+    EXPECT_EQ(0x12, result[0]);
+    EXPECT_EQ(0x34, result[1]);
+
+    mutator.seek(mutator.count() - 1);
+    EXPECT_FALSE(mutator.finished());
+    EXPECT_FALSE(mutator.mutate());
+    EXPECT_TRUE(mutator.finished());
+    mutator.reset();
+    EXPECT_EQ(0x1234, mutator.current());
+}
+
+TEST(FloatMutator, SpecialValues)
+{
+    FloatMutator<float> mutator(1.5f);
+    std::set<uint32_t> values = Collect<FloatMutator<float>, uint32_t>(mutator);
+    EXPECT_EQ(1, values.count(0x3fc00000));     // 1.5
+    EXPECT_EQ(1, values.count(0x00000000));     // +0
+    EXPECT_EQ(1, values.count(0x80000000));     // -0
+    EXPECT_EQ(1, values.count(0x7f800000));     // +inf
+    EXPECT_EQ(1, values.count(0xff800000));     // -inf
+    EXPECT_EQ(1, values.count(0x00000001));     // smallest denormal
+    EXPECT_EQ(1, values.count(0x7f7fffff));     // max
+
+    Template tp;
+    FloatMutator<double> dbl(0);
+    tp.lazy(&dbl);
+    vector<uint8_t> result;
+    tp.generate(result);
+    EXPECT_EQ(8, result.size());
+}
+
+TEST(VectorMutator, BoundaryLengths)
+{
+    VectorMutator<uint8_t> mutator(4, 8);
+    std::set<size_t> lengths;
+    size_t count = 0;
+    do {
+        vector<uint8_t> result;
+        Buffer buffer(result);
+        mutator.evaluate(buffer);
+        EXPECT_EQ(mutator.length(), result.size());
+        lengths.insert(result.size());
+        ++count;
+    } while(mutator.mutate());
+
+    EXPECT_TRUE(mutator.finished());
+    EXPECT_EQ(count, lengths.size() * PatternBuffer::PATTERN_COUNT);
+    EXPECT_EQ(1, lengths.count(0));
+    EXPECT_EQ(1, lengths.count(3));
+    EXPECT_EQ(1, lengths.count(4));
+    EXPECT_EQ(1, lengths.count(8));
+    EXPECT_EQ(1, lengths.count(9));
+}
+
+TEST(VectorMutator, FixedLength)
+{
+    /// the only length in range comes first, then the lengths outside
+    VectorMutator<uint8_t> mutator(5, 5);
+    vector<size_t> lengths;
+    do {
+        if (lengths.empty() || lengths.back() != mutator.length()) {
+            lengths.push_back(mutator.length());
+        }
+    } while(mutator.mutate());
+    ASSERT_LE(4, lengths.size());
+    EXPECT_EQ(5, lengths[0]);
+    EXPECT_EQ(0, lengths[1]);
+    EXPECT_EQ(4, lengths[2]);
+    EXPECT_EQ(6, lengths[3]);
+}
+
+TEST(VectorMutator, WordPatterns)
+{
+    VectorMutator<uint16_t> mutator(300, 300);
+    Template tp;
+    tp.lazy(&mutator);
+
+    /// first length is the lower bound, walk all patterns for it
+    vector<uint8_t> zero, ones, ascii, high, ramp;
+    tp.generate(zero);  mutator.mutate();
+    tp.generate(ones);  mutator.mutate();
+    tp.generate(ascii); mutator.mutate();
+    tp.generate(high);  mutator.mutate();
+    tp.generate(ramp);
+
+    ASSERT_EQ(600, zero.size());
+    ASSERT_EQ(600, ramp.size());
+    EXPECT_EQ(0x00, zero[599]);
+    EXPECT_EQ(0xff, ones[599]);
+    EXPECT_EQ('A', ascii[599]);
+    EXPECT_EQ(0x80, high[599]);
+    EXPECT_EQ(599 & 0xff, ramp[599]);
+}
+
+TEST(VectorMutator, Reset)
+{
+    VectorMutator<uint32_t> mutator(0, 16);
+    while(mutator.mutate()) {
+    }
+    EXPECT_TRUE(mutator.finished());
+    mutator.reset();
+    EXPECT_FALSE(mutator.finished());
+    EXPECT_EQ(0, mutator.length());
+}
+
+TEST(VectorMutator, FinishedWritesLowerBound)
+{
+    VectorMutator<uint16_t> mutator(3, 5);
+    while(mutator.mutate()) {
+    }
+    vector<uint8_t> result;
+    Buffer buffer(result);
+    mutator.evaluate(buffer);
+    ASSERT_EQ(6, result.size());
+    for(size_t i = 0; i < result.size(); ++i) {
+        EXPECT_EQ(0, result[i]);
+    }
+}
+
+TEST(VectorMutator, SplicedBlocks)
+{
+    VectorMutator<uint8_t> mutator(0, 100000);
+    while(mutator.length() < 2 * PatternBuffer::BlockSize) {
+        ASSERT_TRUE(mutator.mutate());
+    }
+    vector<uint8_t> result;
+    vector<Splice> splices;
+    Buffer buffer(result, splices);
+    mutator.evaluate(buffer);
+
+    /// whole blocks refer to the shared pattern, the rest is copied
+    const size_t length = mutator.length();
+    EXPECT_EQ(length % PatternBuffer::BlockSize, result.size());
+    ASSERT_EQ(length / PatternBuffer::BlockSize, splices.size());
+    for(size_t i = 0; i < splices.size(); ++i) {
+        EXPECT_EQ(PatternBuffer::get(mutator.pattern()), splices[i].piece.base);
+    }
+    vector<fuzzer::io::Piece> pieces;
+    Buffer::pieces(result, splices, pieces);
+    size_t total = 0;
+    for(size_t i = 0; i < pieces.size(); ++i) {
+        total += pieces[i].length;
+    }
+    EXPECT_EQ(length, total);
+}
+
+TEST(VectorMutator, InvalidBounds)
+{
+    EXPECT_THROW(VectorMutator<uint8_t>(10, 5), std::runtime_error);
+}
+
+TEST(StringMutator, InitialStringFirst)
+{
+    AsciiStringMutator mutator(AsciiStringMutator::CSTRING, "hello");
+    vector<uint8_t> result;
+    Buffer buffer(result);
+    mutator.evaluate(buffer);
+    ASSERT_EQ(6, result.size());
+    EXPECT_EQ(0, memcmp(&result[0], "hello", 6));
+}
+
+TEST(StringMutator, GeneratedStrings)
+{
+    AsciiStringMutator mutator(AsciiStringMutator::CSTRING, "");
+    size_t count = 0, longest = 0;
+    do {
+        vector<uint8_t> result;
+        Buffer buffer(result);
+        mutator.evaluate(buffer);
+        ASSERT_FALSE(result.empty());
+        EXPECT_EQ(0, result.back());
+        if (result.size() - 1 == 100000) {
+            /// the repeated "A" string
+            if (result[0] == 'A') {
+                EXPECT_EQ('A', result[99999]);
+            }
+        }
+        longest = std::max(longest, result.size() - 1);
+        ++count;
+    } while(mutator.mutate());
+
+    EXPECT_TRUE(mutator.finished());
+    EXPECT_EQ(mutator.count(), count);
+    EXPECT_EQ(StringDictionary::instance().size() + 1, count);
+    /// "%s" repeated 100000 times
+    EXPECT_EQ(200000, longest);
+}
+
+TEST(StringMutator, RepeatedEntry)
+{
+    StringEntry entry = { "ab", 2, 7 };
+    vector<uint8_t> result;
+    Buffer buffer(result);
+    entry.write(buffer);
+    ASSERT_EQ(14, result.size());
+    EXPECT_EQ(0, memcmp(&result[0], "ababababababab", 14));
+}
+
+TEST(StringMutator, SharedDictionary)
+{
+    EXPECT_EQ(&StringDictionary::instance(), &StringDictionary::instance());
+    AsciiStringMutator first(AsciiStringMutator::LINE, "x");
+    AsciiStringMutator second(AsciiStringMutator::LINE, nullptr);
+    EXPECT_EQ(first.count(), second.count() + 1);
+    while(first.mutate()) {
+    }
+    first.reset();
+    EXPECT_FALSE(first.finished());
+    EXPECT_EQ(0, first.position());
+}
+
+TEST(StringMutator, PascalPrefix)
+{
+    AsciiStringMutator mutator(AsciiStringMutator::PASCAL32, "abc");
+    vector<uint8_t> result;
+    Buffer buffer(result);
+    buffer.write_little_endian();
+    mutator.evaluate(buffer);
+    ASSERT_EQ(7, result.size());
+    EXPECT_EQ(3, result[0]);
+    EXPECT_EQ(0, result[3]);
+    EXPECT_EQ('a', result[4]);
+
+    /// the prefix always matches the data that follows it
+    while(mutator.mutate()) {
+        vector<uint8_t> data;
+        Buffer out(data);
+        mutator.evaluate(out);
+        ASSERT_GE(data.size(), 4);
+        uint32_t length = data[0] << 24 | data[1] << 16 | data[2] << 8 | data[3];
+        EXPECT_EQ(data.size() - 4, length);
+    }
+}
+
+TEST(StringMutator, LineWithoutTerminator)
+{
+    AsciiStringMutator mutator(AsciiStringMutator::LINE, "GET");
+    vector<uint8_t> result;
+    Buffer buffer(result);
+    mutator.evaluate(buffer);
+    ASSERT_EQ(5, result.size());
+    EXPECT_EQ(0, memcmp(&result[0], "GET\r\n", 5));
+}
+
+TEST(Utf8, Encode)
+{
+    uint8_t bytes[6];
+    ASSERT_EQ(3, fuzzer::io::utf8_encode(0x20ac, bytes));
+    EXPECT_EQ(0, memcmp(bytes, "\xe2\x82\xac", 3));
+    ASSERT_EQ(2, fuzzer::io::utf8_encode_long('/', 2, bytes));
+    EXPECT_EQ(0xc0, bytes[0]);
+    EXPECT_EQ(0xaf, bytes[1]);
+    EXPECT_EQ(6, fuzzer::io::utf8_encode(0x7fffffff, bytes));
+    EXPECT_EQ(0, fuzzer::io::utf8_encode_long(0x800, 2, bytes));
+}
+
+TEST(Utf8, Validate)
+{
+    const char valid[] = "plain ascii text that is longer than one block \xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80";
+    EXPECT_EQ(sizeof(valid) - 1, fuzzer::io::utf8_validate(reinterpret_cast<const uint8_t *>(valid), sizeof(valid) - 1));
+    const uint8_t surrogate[] = { 'a', 0xed, 0xa0, 0x80 };
+    EXPECT_EQ(1, fuzzer::io::utf8_validate(surrogate, sizeof(surrogate)));
+    const uint8_t overlong[] = { 0xe0, 0x80, 0xaf };
+    EXPECT_EQ(0, fuzzer::io::utf8_validate(overlong, sizeof(overlong)));
+    const uint8_t truncated[] = { 'a', 'b', 0xe2, 0x82 };
+    EXPECT_EQ(2, fuzzer::io::utf8_validate(truncated, sizeof(truncated)));
+}
+
+TEST(Utf8StringMutator, Placements)
+{
+    /// four characters in five bytes, the middle boundary is before the two
+    /// byte character
+    Utf8StringMutator mutator(Utf8StringMutator::PASCAL8, "a\xc3\xa9" "bc");
+    const std::string tail("\xc3\xa9" "bc");
+    size_t count = 0, invalid = 0, inserted = 0;
+    do {
+        vector<uint8_t> result;
+        Buffer buffer(result);
+        mutator.evaluate(buffer);
+        ASSERT_EQ(mutator.length(), result.size() - 1);
+        EXPECT_EQ(mutator.length(), result[0]);
+        if (fuzzer::io::utf8_validate(&result[1], result.size() - 1) != result.size() - 1) {
+            ++invalid;
+        }
+        if (result.size() > 6 && result[1] == 'a' &&
+            std::string(result.end() - tail.size(), result.end()) == tail) {
+            ++inserted;
+        }
+        ++count;
+    } while(mutator.mutate());
+    EXPECT_EQ(mutator.count(), count);
+    /// one of the three placements of every sequence is in the middle
+    EXPECT_EQ(count - 1, 3 * inserted);
+    /// everything but the initial string and the noncharacters is invalid
+    EXPECT_EQ(count - 1 - 5 * 3, invalid);
+}
+
+TEST(Utf8StringMutator, EmptyInitialString)
+{
+    Utf8StringMutator mutator(Utf8StringMutator::CSTRING, nullptr);
+    vector<uint8_t> result;
+    Buffer buffer(result);
+    mutator.evaluate(buffer);
+    ASSERT_EQ(1, result.size());
+    mutator.mutate();
+    result.clear();
+    mutator.evaluate(buffer);
+    /// "\0" as two bytes
+    ASSERT_EQ(3, result.size());
+    EXPECT_EQ(0xc0, result[0]);
+    EXPECT_EQ(0x80, result[1]);
+}
+
+static string Component(const UriMutator & mutator, size_t index)
+{
+    const UriMutator::Slice & slice = mutator.slices()[index];
+    return string("http://user@example.com:8080/a/b?x=1&y#top").substr(slice.offset, slice.size);
+}
+
+TEST(UriMutator, Components)
+{
+    UriMutator mutator(UriMutator::RAW, "http://user@example.com:8080/a/b?x=1&y#top");
+    const vector<UriMutator::Slice> & slices = mutator.slices();
+    ASSERT_EQ(10, slices.size());
+    EXPECT_EQ(UriMutator::SCHEME, slices[0].component);
+    EXPECT_EQ("http", Component(mutator, 0));
+    EXPECT_EQ("user", Component(mutator, 1));
+    EXPECT_EQ("example.com", Component(mutator, 2));
+    EXPECT_EQ(UriMutator::PORT, slices[3].component);
+    EXPECT_EQ("8080", Component(mutator, 3));
+    EXPECT_EQ("a", Component(mutator, 4));
+    EXPECT_EQ("b", Component(mutator, 5));
+    EXPECT_EQ("x", Component(mutator, 6));
+    EXPECT_EQ(UriMutator::QUERY_VALUE, slices[7].component);
+    EXPECT_EQ("1", Component(mutator, 7));
+    EXPECT_EQ("y", Component(mutator, 8));
+    EXPECT_EQ(UriMutator::FRAGMENT, slices[9].component);
+    EXPECT_EQ("top", Component(mutator, 9));
+}
+
+TEST(UriMutator, Ipv6Host)
+{
+    UriMutator mutator(UriMutator::RAW, "http://[::1]/");
+    ASSERT_EQ(3, mutator.slices().size());
+    EXPECT_EQ(UriMutator::HOST, mutator.slices()[1].component);
+    EXPECT_EQ(5, mutator.slices()[1].size);
+    EXPECT_EQ(UriMutator::SEGMENT, mutator.slices()[2].component);
+}
+
+TEST(UriMutator, SingleComponentChanged)
+{
+    UriMutator mutator(UriMutator::RAW, "/dir/file?q=v");
+    set<string> results;
+    size_t count = 0;
+    do {
+        vector<uint8_t> result;
+        Buffer buffer(result);
+        mutator.evaluate(buffer);
+        ASSERT_EQ(mutator.length(), result.size());
+        results.insert(string(result.begin(), result.end()));
+        ++count;
+    } while(mutator.mutate());
+    EXPECT_EQ(mutator.count(), count);
+
+    EXPECT_EQ(1, results.count("/dir/file?q=v"));
+    EXPECT_EQ(1, results.count("/../file?q=v"));
+    EXPECT_EQ(1, results.count("/dir/%66%69%6C%65?q=v"));
+    EXPECT_EQ(1, results.count("/dir/file?q=%2576"));
+    EXPECT_EQ(1, results.count("/dir/file?=v"));
+    EXPECT_EQ(1, results.count("/%C1%A4%C1%A9%C1%B2/file?q=v"));
+}
+
+TEST(UriMutator, SeekMatchesMutate)
+{
+    UriMutator walked(UriMutator::PASCAL16, "http://host:1/p?a=b");
+    UriMutator seeked(UriMutator::PASCAL16, "http://host:1/p?a=b");
+    for(size_t i = 0; i < walked.count(); i += 7) {
+        while(walked.position() < i) {
+            walked.mutate();
+        }
+        seeked.seek(i);
+        vector<uint8_t> a, b;
+        Buffer first(a), second(b);
+        walked.evaluate(first);
+        seeked.evaluate(second);
+        EXPECT_EQ(a, b);
+        EXPECT_EQ(walked.length() + 2, a.size());
+    }
+}
+
+///
+/// \brief  Seed file that is removed at the end of the test, after the
+///         mutators that map it are gone.
+///
+struct SeedFile
+{
+    SeedFile(const char * filename, const vector<uint8_t> & data) : name(filename)
+    {
+        FILE * file = fopen(name, "wb");
+        fwrite(data.data(), data.size(), 1, file);
+        fclose(file);
+    }
+
+    ~SeedFile()
+    {
+        remove(name);
+    }
+
+    const char * name;
+};
+
+TEST(FileMutator, DeterministicStages)
+{
+    vector<uint8_t> seed;
+    seed.push_back(0x10);
+    seed.push_back(0x20);
+    seed.push_back(0xff);
+    seed.push_back(0xff);
+    SeedFile file("filemutator_stages.bin", seed);
+    FileMutator mutator(file.name);
+
+    std::set<int> phases;
+    std::set<vector<uint8_t> > variants;
+    size_t count = 0;
+    do {
+        vector<uint8_t> result;
+        Buffer buffer(result);
+        mutator.evaluate(buffer);
+        EXPECT_EQ(mutator.batchStride(), result.size());
+        phases.insert(mutator.phase());
+        variants.insert(result);
+        ++count;
+    } while(mutator.mutate());
+
+    /// every stage but the dictionary stages
+    EXPECT_EQ(FileMutator::DONE - 2, phases.size());
+    /// skipped variants keep duplicates low
+    EXPECT_GT(variants.size(), count * 9 / 10);
+    /// single bit flip, +2 on a big endian word and an interesting dword
+    vector<uint8_t> flip(seed), arith(seed), interest(seed);
+    flip[0] = 0x90;
+    arith[2] = 0x00; arith[3] = 0x01;
+    interest[0] = 0x7f; interest[1] = 0xff; interest[2] = 0xff; interest[3] = 0xff;
+    EXPECT_EQ(1, variants.count(flip));
+    EXPECT_EQ(1, variants.count(arith));
+    EXPECT_EQ(1, variants.count(interest));
+}
+
+TEST(FileMutator, StateRestore)
+{
+    vector<uint8_t> seed(64, 0x41);
+    SeedFile file("filemutator_state.bin", seed);
+    FileMutator mutator(file.name);
+    FileMutator resumed(file.name);
+
+    for(size_t i = 0; i < 1000; ++i) {
+        mutator.mutate();
+    }
+    string state;
+    ASSERT_TRUE(mutator.state(state));
+    ASSERT_TRUE(resumed.restore(state));
+    EXPECT_EQ(mutator.phase(), resumed.phase());
+    EXPECT_EQ(mutator.offset(), resumed.offset());
+    EXPECT_EQ(mutator.step(), resumed.step());
+    EXPECT_FALSE(resumed.restore("file: \"x\",unknown, offset=1"));
+}
+
+TEST(FileMutator, BatchMatchesEvaluate)
+{
+    vector<uint8_t> seed;
+    for(size_t i = 0; i < 6; ++i) {
+        seed.push_back(static_cast<uint8_t>(i * 37));
+    }
+    SeedFile file("filemutator_batch.bin", seed);
+    FileMutator single(file.name);
+    FileMutator batched(file.name);
+
+    vector<uint8_t> batch;
+    size_t total = 0;
+    while(!batched.finished()) {
+        const size_t stride = batched.batchStride();
+        const size_t produced = batched.batch(batch, 16);
+        ASSERT_GT(produced, 0);
+        ASSERT_EQ(produced * stride, batch.size());
+        for(size_t i = 0; i < produced; ++i) {
+            vector<uint8_t> result;
+            Buffer buffer(result);
+            single.evaluate(buffer);
+            single.mutate();
+            ASSERT_EQ(stride, result.size());
+            EXPECT_TRUE(std::equal(result.begin(), result.end(), batch.begin() + i * stride));
+        }
+        total += produced;
+    }
+    EXPECT_TRUE(single.finished());
+}
+
+TEST(FileMutator, EffectorMapSkipsInertBytes)
+{
+    /// only the first block changes the coverage
+    vector<uint8_t> seed(64, 0x41);
+    SeedFile file("filemutator_effector.bin", seed);
+    FileMutator reference(file.name);
+    FileMutator mutator(file.name);
+
+    const size_t block = FileMutator::EffectorBlock;
+    mutator.baseline(1);
+    size_t arith = 0, referenceArith = 0;
+    do {
+        if (mutator.phase() == FileMutator::BIT_INVERSE) {
+            mutator.coverage(mutator.offset() < block ? 2 : 1);
+        }
+        if (mutator.phase() == FileMutator::ARITH8) {
+            EXPECT_LT(mutator.offset(), block);
+            ++arith;
+        }
+    } while(mutator.mutate());
+    do {
+        if (reference.phase() == FileMutator::ARITH8) {
+            ++referenceArith;
+        }
+    } while(reference.mutate());
+
+    EXPECT_GT(arith, 0);
+    EXPECT_EQ(referenceArith, arith * 8);
+    EXPECT_TRUE(mutator.effective(0, 1));
+    EXPECT_TRUE(mutator.effective(7, 2));
+    EXPECT_FALSE(mutator.effective(8, 4));
+}
+
+TEST(CoverageMap, Checksum)
+{
+    fuzzer::execution::CoverageMap map;
+    EXPECT_FALSE(map.name().empty());
+    const uint64_t empty = map.checksum();
+    map.data()[100] = 1;
+    const uint64_t one = map.checksum();
+    EXPECT_NE(empty, one);
+    map.data()[100] = 2;
+    EXPECT_NE(one, map.checksum());
+    map.clear();
+    EXPECT_EQ(empty, map.checksum());
+}
+
+#ifdef __linux__
+
+extern "C" {
+void __sanitizer_cov_trace_pc_guard_init(uint32_t * start, uint32_t * stop);
+void __sanitizer_cov_trace_pc_guard(uint32_t * guard);
+}
+
+TEST(CoverageMap, Harness)
+{
+    fuzzer::execution::CoverageMap map;
+    const pid_t pid = fork();
+    if (pid == 0) {
+        /// an instrumented target with three edges, one of them disabled
+        setenv(fuzzer::execution::CoverageMap::EnvironmentVariable, map.name().c_str(), 1);
+        uint32_t guards[3] = { 0, 0, 0 };
+        __sanitizer_cov_trace_pc_guard_init(guards, guards + 3);
+        guards[2] = 0;
+        __sanitizer_cov_trace_pc_guard(&guards[0]);
+        for(size_t i = 0; i < 300; ++i) {
+            __sanitizer_cov_trace_pc_guard(&guards[1]);
+            __sanitizer_cov_trace_pc_guard(&guards[2]);
+        }
+        _exit(guards[0] == 1 && guards[1] == 2 ? 0 : 1);
+    }
+    ASSERT_GT(pid, 0);
+    int status;
+    ASSERT_EQ(pid, waitpid(pid, &status, 0));
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    EXPECT_EQ(0, map.data()[0]);
+    EXPECT_EQ(1, map.data()[1]);
+    EXPECT_EQ(0xff, map.data()[2]);
+    EXPECT_EQ(0, map.data()[3]);
+}
+
+#endif
+
+TEST(FileMutator, RopeVariantMatchesEvaluate)
+{
+    vector<uint8_t> seed;
+    for(size_t i = 0; i < 5; ++i) {
+        seed.push_back(static_cast<uint8_t>(0x11 * i));
+    }
+    SeedFile file("filemutator_rope.bin", seed);
+    FileMutator mutator(file.name);
+    do {
+        vector<uint8_t> expected, result;
+        Buffer buffer(expected);
+        mutator.evaluate(buffer);
+        Rope rope;
+        ASSERT_TRUE(mutator.variant(rope));
+        rope.flatten(result);
+        ASSERT_EQ(expected, result);
+    } while(mutator.mutate());
+    Rope done;
+    EXPECT_FALSE(mutator.variant(done));
+}
+
+TEST(FileMutator, SampledCoversEveryOffset)
+{
+    vector<uint8_t> seed;
+    for(size_t i = 0; i < 37; ++i) {
+        seed.push_back(static_cast<uint8_t>(i * 13));
+    }
+    SeedFile file("filemutator_sampled.bin", seed);
+    FileMutator walked(file.name);
+    FileMutator sampled(file.name);
+    sampled.sample(4, 1234);
+
+    typedef std::pair<int, std::pair<size_t, size_t> > Variant;
+    std::set<Variant> expected, result;
+    do {
+        expected.insert(Variant(walked.phase(), std::make_pair(walked.offset(), walked.step())));
+    } while(walked.mutate());
+
+    vector<size_t> order;
+    double progress = 0;
+    do {
+        if (order.empty() || order.back() != sampled.sampleOffset()) {
+            order.push_back(sampled.sampleOffset());
+        }
+        EXPECT_LE(progress, sampled.progress());
+        progress = sampled.progress();
+        result.insert(Variant(sampled.phase(), std::make_pair(sampled.offset(), sampled.step())));
+    } while(sampled.mutate());
+
+    /// one offset in each region first, then every offset exactly once
+    ASSERT_EQ(seed.size(), order.size());
+    EXPECT_LT(order[0], 10);
+    EXPECT_TRUE(order[1] >= 10 && order[1] < 19);
+    EXPECT_TRUE(order[2] >= 19 && order[2] < 28);
+    EXPECT_TRUE(order[3] >= 28 && order[3] < 37);
+    EXPECT_EQ(seed.size(), std::set<size_t>(order.begin(), order.end()).size());
+    EXPECT_EQ(expected, result);
+    EXPECT_EQ(1.0, sampled.progress());
+}
+
+TEST(FileMutator, SampledWorkersAndRestore)
+{
+    vector<uint8_t> seed(100, 0x41);
+    SeedFile file("filemutator_workers.bin", seed);
+    FileMutator first(file.name);
+    FileMutator second(file.name);
+    first.sample(8, 99, 0, 2);
+    second.sample(8, 99, 1, 2);
+
+    std::set<size_t> offsets;
+    size_t count = 0;
+    string state;
+    for(size_t i = 0; !second.finished(); ++i) {
+        offsets.insert(second.sampleOffset());
+        if (i == 5000) {
+            ASSERT_TRUE(second.state(state));
+        }
+        second.mutate();
+    }
+    do {
+        EXPECT_EQ(0, offsets.count(first.sampleOffset()));
+        ++count;
+    } while(first.mutate());
+    std::set<size_t> firstOffsets;
+    first.reset();
+    do {
+        firstOffsets.insert(first.sampleOffset());
+    } while(first.mutate());
+    EXPECT_EQ(seed.size(), offsets.size() + firstOffsets.size());
+
+    /// a checkpoint continues with the same variants
+    FileMutator resumed(file.name);
+    FileMutator reference(file.name);
+    reference.sample(8, 99, 1, 2);
+    for(size_t i = 0; i < 5000; ++i) {
+        reference.mutate();
+    }
+    ASSERT_TRUE(resumed.restore(state));
+    EXPECT_TRUE(resumed.sampled());
+    EXPECT_EQ(reference.progress(), resumed.progress());
+    do {
+        ASSERT_EQ(reference.sampleOffset(), resumed.sampleOffset());
+        ASSERT_EQ(reference.phase(), resumed.phase());
+        ASSERT_EQ(reference.offset(), resumed.offset());
+        ASSERT_EQ(reference.step(), resumed.step());
+        resumed.mutate();
+    } while(reference.mutate());
+    EXPECT_TRUE(resumed.finished());
+    EXPECT_GT(count, 0);
+}
+
+TEST(Dictionary, MutatorsUseTokens)
+{
+    shared_ptr<Dictionary> dictionary = make_shared<Dictionary>();
+    dictionary->add("\x12\x34", 2);
+    dictionary->add("KEY", 3);
+
+    UnsignedMutator<uint16_t> number(0);
+    const size_t before = number.count();
+    number.dictionary(dictionary);
+    ASSERT_EQ(before + 2, number.count());
+    number.seek(before);
+    EXPECT_EQ(0x3412, number.current());
+    number.seek(before + 1);
+    EXPECT_EQ(0x1234, number.current());
+
+    AsciiStringMutator str(StringRepresentation::RAW, "abc");
+    const size_t strings = str.count();
+    str.dictionary(dictionary);
+    ASSERT_EQ(strings + 4, str.count());
+    vector<string> results;
+    for(size_t i = strings; i < str.count(); ++i) {
+        str.seek(i);
+        vector<uint8_t> dst;
+        Buffer buffer(dst);
+        str.evaluate(buffer);
+        results.push_back(string(dst.begin(), dst.end()));
+    }
+    EXPECT_EQ("\x12\x34", results[0]);
+    EXPECT_EQ("KEY", results[1]);
+    EXPECT_EQ("abc\x12\x34", results[2]);
+    EXPECT_EQ("abcKEY", results[3]);
+}
+
+TEST(FileMutator, DictionaryStages)
+{
+    vector<uint8_t> seed(4, 0x41);
+    SeedFile file("filemutator_dictionary.bin", seed);
+    shared_ptr<Dictionary> dictionary = make_shared<Dictionary>();
+    dictionary->add("AA", 2);
+    dictionary->add("xyz", 3);
+    FileMutator mutator(file.name);
+    FileMutator batched(file.name);
+    mutator.dictionary(dictionary);
+    batched.dictionary(dictionary);
+
+    std::set<string> overwritten, inserted;
+    do {
+        vector<uint8_t> dst;
+        Buffer buffer(dst);
+        mutator.evaluate(buffer);
+        ASSERT_EQ(mutator.batchStride(), dst.size());
+        if (mutator.phase() == FileMutator::DICT_OVERWRITE) {
+            overwritten.insert(string(dst.begin(), dst.end()));
+        } else if (mutator.phase() == FileMutator::DICT_INSERT) {
+            inserted.insert(string(dst.begin(), dst.end()));
+        }
+    } while(mutator.mutate());
+
+    /// "AA" never changes the seed and "xyz" only fits twice
+    EXPECT_EQ(2, overwritten.size());
+    EXPECT_EQ(1, overwritten.count("xyzA"));
+    EXPECT_EQ(1, overwritten.count("Axyz"));
+    EXPECT_EQ(1, inserted.count("AAAAAA"));
+    EXPECT_EQ(1, inserted.count("AAAAxyz"));
+    EXPECT_EQ(1, inserted.count("xyzAAAA"));
+
+    /// batches follow the size changes of the inserted tokens
+    ASSERT_TRUE(batched.resume(FileMutator::DICT_OVERWRITE, 0));
+    ASSERT_TRUE(mutator.resume(FileMutator::DICT_OVERWRITE, 0));
+    vector<uint8_t> batch;
+    while(!batched.finished()) {
+        const size_t stride = batched.batchStride();
+        const size_t produced = batched.batch(batch, 8);
+        ASSERT_GT(produced, 0);
+        for(size_t i = 0; i < produced; ++i) {
+            vector<uint8_t> dst;
+            Buffer buffer(dst);
+            mutator.evaluate(buffer);
+            mutator.mutate();
+            ASSERT_EQ(stride, dst.size());
+            EXPECT_TRUE(std::equal(dst.begin(), dst.end(), batch.begin() + i * stride));
+        }
+    }
+}
+
+TEST(InputToStateMutator, ReplacesOperandsInBothByteOrders)
+{
+    const uint8_t payload[] = {'M', 'Z', 0x00, 0x00, 0x10, 0x20, 0x30, 0x40, 0x40, 0x30, 0x20, 0x10};
+    InputToStateMutator mutator(payload, sizeof(payload));
+    EXPECT_TRUE(mutator.finished());
+
+    /// the target compared the dword with a checksum and the magic with "PK"
+    mutator.add(0x40302010, 0xcafebabe, 4);
+    mutator.add(0x5a4d, 0x4b50, 2);
+    mutator.add(0x5a4d, 0x4b50, 2);
+    mutator.add(7, 7, 4);
+    ASSERT_EQ(3, mutator.count());
+
+    std::set<vector<uint8_t> > variants;
+    do {
+        vector<uint8_t> dst;
+        Buffer buffer(dst);
+        mutator.evaluate(buffer);
+        ASSERT_EQ(sizeof(payload), dst.size());
+        variants.insert(dst);
+        string state;
+        EXPECT_TRUE(mutator.state(state));
+    } while(mutator.mutate());
+
+    vector<uint8_t> little(payload, payload + sizeof(payload)), big(little), magic(little);
+    little[4] = 0xbe; little[5] = 0xba; little[6] = 0xfe; little[7] = 0xca;
+    big[8] = 0xca; big[9] = 0xfe; big[10] = 0xba; big[11] = 0xbe;
+    magic[0] = 'P'; magic[1] = 'K';
+    EXPECT_EQ(1, variants.count(little));
+    EXPECT_EQ(1, variants.count(big));
+    EXPECT_EQ(1, variants.count(magic));
+
+    fuzzer::execution::ComparisonLog log;
+    EXPECT_EQ(0, log.size());
+    mutator.add(log);
+    EXPECT_EQ(3, mutator.count());
+}
@@ -0,0 +1,89 @@
+#include <fuzzengine\novelty.h>
+#include <gtest\gtest.h>
+#include <cstring>
+#include <string>
+
+using namespace fuzzer::runtime;
+
+TEST(ResponseNovelty, HashBytes)
+{
+    uint8_t data[200];
+    for(size_t i = 0; i < sizeof(data); ++i) {
+        data[i] = static_cast<uint8_t>(i * 7 + 1);
+    }
+    /// the same value on every target, with and without SIMD
+    EXPECT_EQ(0x0d833d82e4ac7658ULL, HashBytes(data, 32));
+    EXPECT_EQ(0x39491e770fec54b0ULL, HashBytes(data, 200));
+    EXPECT_NE(HashBytes(data, 33), HashBytes(data, 32));
+
+    uint8_t other[200];
+    memcpy(other, data, sizeof(data));
+    other[150] ^= 1;
+    EXPECT_NE(HashBytes(data, 200), HashBytes(other, 200));
+}
+
+static void Exchange(ResponseNovelty & novelty, const std::string & banner, const std::string & reply)
+{
+    novelty.begin();
+    novelty.received(reinterpret_cast<const uint8_t *>(banner.data()), banner.size());
+    novelty.sent();
+    novelty.sent();
+    novelty.received(reinterpret_cast<const uint8_t *>(reply.data()), reply.size());
+}
+
+TEST(ResponseNovelty, MasksVolatileBytes)
+{
+    ResponseNovelty novelty;
+    /// the banner has a timestamp
+    Exchange(novelty, "220 ready 12:00:01\r\n", "250 OK\r\n");
+    novelty.calibrate();
+    Exchange(novelty, "220 ready 12:00:02\r\n", "250 OK\r\n");
+    novelty.calibrate();
+
+    Exchange(novelty, "220 ready 12:00:03\r\n", "250 OK\r\n");
+    EXPECT_FALSE(novelty.end());
+    Exchange(novelty, "220 ready 12:00:04\r\n", "500 Syntax error\r\n");
+    EXPECT_TRUE(novelty.end());
+    Exchange(novelty, "220 ready 12:00:05\r\n", "500 Syntax error\r\n");
+    EXPECT_FALSE(novelty.end());
+    /// the same bytes split differently between the messages
+    Exchange(novelty, "220 ready 12:00:06\r\n250 ", "OK\r\n");
+    EXPECT_TRUE(novelty.end());
+}
+
+TEST(ResponseNovelty, LongerResponse)
+{
+    ResponseNovelty novelty;
+    Exchange(novelty, "220 ready\r\n", "250 OK\r\n");
+    novelty.calibrate();
+    Exchange(novelty, "220 ready\r\n", "250 OK\r\n");
+    novelty.calibrate();
+
+    /// a banner appended to the calibrated response
+    Exchange(novelty, "220 ready\r\n", "250 OK\r\nAddressSanitizer: SEGV\r\n");
+    EXPECT_TRUE(novelty.end());
+    Exchange(novelty, "220 ready\r\n", "250 OK\r\n");
+    EXPECT_FALSE(novelty.end());
+    Exchange(novelty, "220 ready\r\n", "250 OK\r");
+    EXPECT_TRUE(novelty.end());
+}
+
+TEST(ResponseNovelty, VariableLength)
+{
+    ResponseNovelty novelty;
+    /// the banner has a counter of varying width
+    Exchange(novelty, "220 ready 9\r\n", "250 OK\r\n");
+    novelty.calibrate();
+    Exchange(novelty, "220 ready 10\r\n", "250 OK\r\n");
+    novelty.calibrate();
+
+    Exchange(novelty, "220 ready 11\r\n", "250 OK\r\n");
+    EXPECT_FALSE(novelty.end());
+    Exchange(novelty, "220 ready 7\r\n", "250 OK\r\n");
+    EXPECT_FALSE(novelty.end());
+    /// past the longest calibrated length
+    Exchange(novelty, "220 ready 12\r\nX", "250 OK\r\n");
+    EXPECT_TRUE(novelty.end());
+    Exchange(novelty, "220 ready 13\r\n", "500 Syntax error\r\n");
+    EXPECT_TRUE(novelty.end());
+}
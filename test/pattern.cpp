@@ -0,0 +1,120 @@
+#include <fuzzengine\pattern.h>
+#include <gtest\gtest.h>
+#include <fuzzengine\fuzzer.h>
+#include <fuzzengine\ioerror.h>
+#include <cstring>
+
+using fuzzer::runtime::Pattern;
+
+static const size_t npos = Pattern::npos;
+static const uint32_t Start = Pattern::Start;
+
+static size_t Find(const Pattern & pattern, const char * str)
+{
+    uint32_t state = Pattern::Start;
+    return pattern.scan(reinterpret_cast<const uint8_t *>(str), strlen(str), state);
+}
+
+TEST(Pattern, Literal)
+{
+    Pattern pattern("ab+c", Pattern::LITERAL);
+    EXPECT_EQ(7, Find(pattern, "xxxab+cab+c"));
+    EXPECT_EQ(npos, Find(pattern, "abbc"));
+
+    /// a match across chunks, and a partial match that fails
+    uint32_t state = Pattern::Start;
+    const uint8_t first[] = { 'a', 'b', 'a', 'b' };
+    const uint8_t second[] = { '+', 'c' };
+    EXPECT_EQ(npos, pattern.scan(first, sizeof(first), state));
+    EXPECT_NE(Start, state);
+    EXPECT_EQ(2, pattern.scan(second, sizeof(second), state));
+    EXPECT_EQ(Start, state);
+}
+
+TEST(Pattern, Regex)
+{
+    EXPECT_EQ(8, Find(Pattern("ab+c", Pattern::REGEX), "xxabbbbc"));
+    EXPECT_EQ(15, Find(Pattern("[0-9]+ OK\\r\\n", Pattern::REGEX), "status 200 OK\r\n"));
+    EXPECT_EQ(5, Find(Pattern("(GET|POST) ", Pattern::REGEX), "POST /"));
+    EXPECT_EQ(3, Find(Pattern("a.c", Pattern::REGEX), "a\nc"));
+    EXPECT_EQ(4, Find(Pattern("[^a-z]\\x41?\\d", Pattern::REGEX), "ab-1"));
+    EXPECT_EQ(npos, Find(Pattern("\\w\\s\\w", Pattern::REGEX), "a-b"));
+}
+
+TEST(Pattern, Malformed)
+{
+    EXPECT_THROW(Pattern("", Pattern::LITERAL), std::runtime_error);
+    EXPECT_THROW(Pattern("a*", Pattern::REGEX), std::runtime_error);
+    EXPECT_THROW(Pattern("(ab", Pattern::REGEX), std::runtime_error);
+    EXPECT_THROW(Pattern("ab)", Pattern::REGEX), std::runtime_error);
+    EXPECT_THROW(Pattern("a||b", Pattern::REGEX), std::runtime_error);
+    EXPECT_THROW(Pattern("*a", Pattern::REGEX), std::runtime_error);
+    EXPECT_THROW(Pattern("[a-", Pattern::REGEX), std::runtime_error);
+    EXPECT_THROW(Pattern("\\xZZ", Pattern::REGEX), std::runtime_error);
+}
+
+namespace {
+
+/// responds with a fixed byte string, a few bytes at a time
+class Responder : public fuzzer::io::Ipc
+{
+public:
+    Responder(const char * data) : _data(data), _offset(0) {}
+
+    virtual bool write(const void *, size_t) { return true; }
+
+    virtual bool read(void * dst, size_t count)
+    {
+        return receive(dst, count, count) == count;
+    }
+
+    virtual size_t receive(void * dst, size_t min, size_t max)
+    {
+        const size_t remaining = _data.size() - _offset;
+        const size_t count = std::min(remaining, std::max<size_t>(min, std::min<size_t>(max, 3)));
+        if (count < min) {
+            return 0;
+        }
+        memcpy(dst, _data.data() + _offset, count);
+        _offset += count;
+        return count;
+    }
+
+private:
+    std::string _data;
+    size_t      _offset;
+};
+
+class Runner : public fuzzer::Fuzzer
+{
+public:
+    Runner(fuzzer::io::Ipc * ipc) { Attach(ipc); }
+
+    fuzzer::bytecode::Value Run(const std::string & name, const std::string & argument)
+    {
+        std::vector<fuzzer::bytecode::Value> arguments(1);
+        arguments[0].type           = fuzzer::bytecode::Value::STRING;
+        arguments[0].stringValue    = std::make_shared<std::string>(argument);
+        return Call(_vm, name, arguments);
+    }
+
+    fuzzer::bytecode::Value Read(const std::string & name)
+    {
+        return Call(_vm, name, std::vector<fuzzer::bytecode::Value>());
+    }
+};
+
+} // namespace
+
+TEST(Pattern, ExpectAndMatch)
+{
+    Responder responder("220 ready\r\n250-size 1024\r\n250 OK\r\n!");
+    Runner runner(&responder);
+
+    EXPECT_EQ("220 ready\r\n", *runner.Run("expect", "\r\n").stringValue);
+    EXPECT_EQ("250-size 1024\r\n250 ", *runner.Run("match", "250 ").stringValue);
+    EXPECT_EQ("OK\r\n", *runner.Run("match", "[A-Z]+\\r\\n").stringValue);
+    /// the buffered bytes are still read in order
+    EXPECT_EQ('!', runner.Read("in8").u.uValue);
+    EXPECT_THROW(runner.Run("expect", "\r\n"), fuzzer::io::IoException);
+}
@@ -0,0 +1,129 @@
+#include <fuzzengine\plugin.h>
+#include <gtest\gtest.h>
+#include <fuzzengine\generator.h>
+#include <cstring>
+#include <sstream>
+
+using namespace fuzzer::runtime;
+
+namespace {
+
+struct Inverter
+{
+    const uint8_t * seed;
+    size_t          size;
+    size_t          offset;     //< next byte to invert
+    size_t          calls;
+};
+
+void * InverterCreate(const uint8_t * seed, size_t size, uint64_t)
+{
+    Inverter * state = new Inverter();
+    state->seed = seed;
+    state->size = size;
+    return state;
+}
+
+void InverterDestroy(void * state)
+{
+    delete static_cast<Inverter *>(state);
+}
+
+/// one variant per byte, with the byte inverted
+size_t InverterProduce(void * ptr, uint8_t * arena, size_t capacity, size_t * sizes, size_t count)
+{
+    Inverter * state = static_cast<Inverter *>(ptr);
+    ++state->calls;
+    size_t produced = 0;
+    for(; produced < count && state->offset < state->size && capacity >= state->size; ++produced) {
+        memcpy(arena, state->seed, state->size);
+        arena[state->offset++] ^= 0xff;
+        sizes[produced] = state->size;
+        arena += state->size;
+        capacity -= state->size;
+    }
+    return produced;
+}
+
+const fuzzengine_mutator Mutators[] = {
+    { "test.inverter", FUZZENGINE_PLUGIN_FIELD | FUZZENGINE_PLUGIN_FILE, InverterCreate, InverterDestroy, InverterProduce },
+    { "test.files", FUZZENGINE_PLUGIN_FILE, InverterCreate, InverterDestroy, InverterProduce }
+};
+
+void Register()
+{
+    if (!PluginRegistry::instance().find("test.inverter", FUZZENGINE_PLUGIN_FIELD)) {
+        PluginRegistry::instance().add(Mutators, 2);
+    }
+}
+
+} // namespace
+
+TEST(Plugin, Registry)
+{
+    Register();
+    EXPECT_EQ(&Mutators[0], PluginRegistry::instance().find("test.inverter", FUZZENGINE_PLUGIN_FIELD));
+    EXPECT_EQ(&Mutators[1], PluginRegistry::instance().find("test.files", FUZZENGINE_PLUGIN_FILE));
+    EXPECT_EQ(nullptr, PluginRegistry::instance().find("test.files", FUZZENGINE_PLUGIN_FIELD));
+    EXPECT_EQ(nullptr, PluginRegistry::instance().find("test.missing", FUZZENGINE_PLUGIN_FILE));
+    EXPECT_THROW(PluginRegistry::instance().add(Mutators, 1), std::runtime_error);
+    EXPECT_THROW(PluginRegistry::instance().load("/nonexistent/plugin.so"), std::runtime_error);
+}
+
+TEST(Plugin, Batches)
+{
+    const uint8_t seed[] = { 1, 2, 3, 4, 5 };
+    /// room for two variants per batch
+    PluginMutator mutator(Mutators[0], seed, sizeof(seed), std::shared_ptr<const void>(), 0, 4, 12);
+
+    std::vector<uint8_t> data;
+    fuzzer::runtime::Buffer buffer(data);
+    mutator.evaluate(buffer);
+    EXPECT_EQ(std::vector<uint8_t>(seed, seed + 5), data);
+    EXPECT_EQ(0, mutator.position());
+
+    for(size_t i = 0; i < 5; ++i) {
+        ASSERT_TRUE(mutator.mutate());
+        EXPECT_EQ(i + 1, mutator.position());
+        data.clear();
+        mutator.evaluate(buffer);
+        ASSERT_EQ(5, data.size());
+        EXPECT_EQ(seed[i] ^ 0xff, data[i]);
+    }
+    EXPECT_FALSE(mutator.mutate());
+    EXPECT_TRUE(mutator.finished());
+
+    mutator.reset();
+    EXPECT_FALSE(mutator.finished());
+    ASSERT_EQ(2, mutator.next());
+    size_t size;
+    const uint8_t * variant = mutator.variant(1, size);
+    ASSERT_EQ(5, size);
+    EXPECT_EQ(seed[1] ^ 0xff, variant[1]);
+    EXPECT_EQ("plugin: test.inverter, rng=0, variant=2", mutator.state(1));
+    EXPECT_EQ(2, mutator.next());
+    EXPECT_EQ(1, mutator.next());
+    EXPECT_EQ(0, mutator.next());
+}
+
+TEST(Plugin, TemplateField)
+{
+    Register();
+    fuzzer::bytecode::Generator generator;
+    std::stringstream str;
+    str << "template x = [ byte(1), plugin(\"test.inverter\", \"ab\") ];";
+    fuzzer::parser::Tokenizer token(str);
+    std::shared_ptr<fuzzer::bytecode::Script> script;
+    ASSERT_NO_THROW(script = generator.ParseScript(token));
+
+    std::vector<uint8_t> data;
+    script->_templates["x"]->generate(data);
+    ASSERT_EQ(3, data.size());
+    EXPECT_EQ('a', data[1]);
+    EXPECT_EQ('b', data[2]);
+
+    std::stringstream files;
+    files << "template x = [ plugin(\"test.files\") ];";
+    fuzzer::parser::Tokenizer files_token(files);
+    EXPECT_THROW(generator.ParseScript(files_token), std::runtime_error);
+}
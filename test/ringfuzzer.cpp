@@ -0,0 +1,172 @@
+#ifdef __linux__
+
+#include <fuzzengine\ringfuzzer.h>
+#include <fuzzengine\generator.h>
+#include <gtest\gtest.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <sstream>
+#include "../src/harness/ring.h"
+
+using namespace fuzzer;
+
+namespace {
+
+///
+/// \brief  Forks a target that attaches with the harness client, and
+///         answers every byte with 0x5a. With crash() it aborts on the
+///         first byte instead.
+///
+class ForkedTarget : public execution::IApplicationExecuter
+{
+public:
+    explicit ForkedTarget(const io::RingIpc & ring) :
+        _ring(ring), _crash(false), _pid(-1), _status(0), _exited(false), _launches(0)
+    {
+    }
+
+    ~ForkedTarget() { Terminate(); Wait(); }
+
+    ForkedTarget & crash() { _crash = true; return *this; }
+
+    virtual bool Launch()
+    {
+        const pid_t pid = fork();
+        if (pid < 0) {
+            return false;
+        } else if (pid == 0) {
+            setenv(io::RingIpc::EnvironmentVariable, _ring.name().c_str(), 1);
+            uint8_t buffer[256];
+            for(;;) {
+                const long count = fuzzengine_ring_read(buffer, 1, sizeof(buffer));
+                if (count <= 0) {
+                    _exit(1);
+                }
+                if (_crash) {
+                    abort();
+                }
+                for(long i = 0; i < count; ++i) {
+                    buffer[i] = 0x5a;
+                }
+                fuzzengine_ring_write(buffer, static_cast<size_t>(count));
+            }
+        }
+        _pid    = pid;
+        _exited = false;
+        ++_launches;
+        return true;
+    }
+
+    virtual bool Terminate()
+    {
+        return IsAlive() && kill(_pid, SIGKILL) == 0;
+    }
+
+    virtual bool GetStatusCode(int & StatusCode, execution::TerminationReason & Reason)
+    {
+        if (IsAlive() || _pid <= 0) {
+            return false;
+        }
+        StatusCode  = WIFSIGNALED(_status) ? 128 + WTERMSIG(_status) : WEXITSTATUS(_status);
+        Reason      = WIFSIGNALED(_status) ? execution::Term_Other : execution::Term_Normal;
+        return true;
+    }
+
+    virtual bool Wait(int = -1)
+    {
+        if (_pid > 0 && !_exited) {
+            _exited = waitpid(_pid, &_status, 0) == _pid;
+        }
+        return true;
+    }
+
+    virtual bool IsAlive()
+    {
+        if (_pid <= 0 || _exited) {
+            return false;
+        }
+        _exited = waitpid(_pid, &_status, WNOHANG) == _pid;
+        return !_exited;
+    }
+
+    virtual void SetCommandLine(const std::string &) {}
+
+    size_t launches() const { return _launches; }
+
+private:
+    const io::RingIpc & _ring;
+    bool                _crash;
+    pid_t               _pid;
+    int                 _status;
+    bool                _exited;
+    size_t              _launches;
+};
+
+/// records the bytes read by the script
+class Recorder : public runtime::RingFuzzer
+{
+public:
+    Recorder(io::RingIpc & ring, execution::IApplicationExecuter & app) :
+        runtime::RingFuzzer(ring, &app)
+    {
+    }
+
+    std::vector<uint64_t> _read;
+
+protected:
+    virtual bytecode::Value Call(bytecode::VirtualMachine & vm, const std::string & name,
+        const std::vector<bytecode::Value> & arguments)
+    {
+        bytecode::Value value = runtime::RingFuzzer::Call(vm, name, arguments);
+        if (name == "in8") {
+            _read.push_back(value.u.uValue);
+        }
+        return value;
+    }
+};
+
+std::shared_ptr<bytecode::Script> Parse()
+{
+    std::stringstream str;
+    str << "template t = [ {byte(0)} ]; function main() { out(t); in8(); }";
+    parser::Tokenizer token(str);
+    bytecode::Generator generator;
+    return generator.ParseScript(token);
+}
+
+} // namespace
+
+TEST(RingFuzzer, Harness)
+{
+    io::RingIpc ring;
+    ForkedTarget app(ring);
+    Recorder recorder(ring, app);
+
+    testing::internal::CaptureStdout();
+    recorder.RunHavoc(*Parse(), 1, 0, 5);
+    const std::string output = testing::internal::GetCapturedStdout();
+    EXPECT_EQ(std::string::npos, output.find("Caught")) << output;
+    EXPECT_EQ(std::vector<uint64_t>(5, 0x5a), recorder._read);
+    /// the target runs all the cases
+    EXPECT_EQ(1, app.launches());
+    EXPECT_TRUE(app.IsAlive());
+}
+
+TEST(RingFuzzer, Crash)
+{
+    io::RingIpc ring;
+    ring.SetTimeout(200);
+    ForkedTarget app(ring);
+    app.crash();
+    Recorder recorder(ring, app);
+
+    testing::internal::CaptureStdout();
+    recorder.RunHavoc(*Parse(), 1, 0, 2);
+    const std::string output = testing::internal::GetCapturedStdout();
+    EXPECT_NE(std::string::npos, output.find("App exited with 134, abnormal termination")) << output;
+    EXPECT_EQ(2, app.launches());
+}
+
+#endif // __linux__
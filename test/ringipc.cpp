@@ -0,0 +1,162 @@
+#ifdef __linux__
+
+#include <fuzzengine\ringipc.h>
+#include <fuzzengine\ioerror.h>
+#include <fuzzengine\linuxexec.h>
+#include <gtest\gtest.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+#include "../src/harness/ring.h"
+
+using namespace fuzzer::io;
+
+namespace {
+
+/// forks a target that attaches with the harness client, and echoes \p size bytes
+pid_t Echo(const RingIpc & ring, size_t size)
+{
+    const pid_t pid = fork();
+    if (pid == 0) {
+        setenv(RingIpc::EnvironmentVariable, ring.name().c_str(), 1);
+        uint8_t buffer[1000];
+        for(size_t echoed = 0; echoed < size;) {
+            const long count = fuzzengine_ring_read(buffer, 1, sizeof(buffer));
+            if (count <= 0 || fuzzengine_ring_write(buffer, static_cast<size_t>(count)) != 0) {
+                _exit(1);
+            }
+            echoed += static_cast<size_t>(count);
+        }
+        _exit(0);
+    }
+    return pid;
+}
+
+/// exit code of a forked child running \p function
+int Fork(int (*function)())
+{
+    const pid_t pid = fork();
+    if (pid == 0) {
+        _exit(function());
+    }
+    int status;
+    if (pid < 0 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status)) {
+        return -1;
+    }
+    return WEXITSTATUS(status);
+}
+
+int AttachWithoutRing()
+{
+    unsetenv(RingIpc::EnvironmentVariable);
+    uint8_t byte = 0;
+    return fuzzengine_ring_attach() == -1 && fuzzengine_ring_read(&byte, 1, 1) == -1 &&
+        fuzzengine_ring_write(&byte, 1) == -1 ? 0 : 1;
+}
+
+} // namespace
+
+TEST(RingIpc, Echo)
+{
+    RingIpc ring;
+    /// more than fits in a ring, so that both sides wrap around and wait
+    std::vector<uint8_t> data(3 * FUZZENGINE_RING_SIZE + 123);
+    for(size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<uint8_t>(i * 7);
+    }
+    const pid_t pid = Echo(ring, data.size());
+    ASSERT_GT(pid, 0);
+
+    std::vector<uint8_t> received(data.size());
+    size_t written = 0, read = 0;
+    while(read < data.size()) {
+        /// the echo is read as it arrives, the target would block otherwise
+        const size_t count = data.size() - written < 5000 ? data.size() - written : 5000;
+        EXPECT_TRUE(ring.write(&data[written], count));
+        written += count;
+        read += ring.receive(&received[read], written - read, received.size() - read);
+    }
+    EXPECT_TRUE(received == data);
+
+    int status;
+    ASSERT_EQ(pid, waitpid(pid, &status, 0));
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+TEST(RingIpc, TimeOut)
+{
+    RingIpc ring;
+    ring.SetTimeout(10);
+    uint8_t byte;
+    EXPECT_THROW(ring.read(&byte, 1), IoException);
+
+    /// nobody reads, the write fails once the ring is full
+    std::vector<uint8_t> data(FUZZENGINE_RING_SIZE + 1);
+    EXPECT_FALSE(ring.write(&data[0], data.size()));
+
+    /// clear() empties the ring again
+    ring.clear();
+    EXPECT_TRUE(ring.write(&data[0], FUZZENGINE_RING_SIZE));
+}
+
+TEST(RingIpc, Discard)
+{
+    RingIpc ring;
+    ring.SetTimeout(10);
+    const pid_t pid = Echo(ring, 3);
+    ASSERT_GT(pid, 0);
+    EXPECT_TRUE(ring.write("abc", 3));
+    /// echoed once the target exits
+    int status;
+    ASSERT_EQ(pid, waitpid(pid, &status, 0));
+    ring.discard();
+    uint8_t byte;
+    EXPECT_THROW(ring.read(&byte, 1), IoException);
+}
+
+TEST(RingIpc, HarnessWithoutRing)
+{
+    EXPECT_EQ(0, Fork(AttachWithoutRing));
+}
+
+TEST(RingIpc, Executer)
+{
+    RingIpc ring;
+    fuzzer::execution::LinuxExecuter app("/bin/sh");
+    app.SetRing(&ring);
+    app.SetCommandLine("-c \"test $FUZZENGINE_RING_FD = " + ring.name() +
+        " && test -e /proc/$$/fd/" + ring.name() + "\"");
+    int code = -1;
+    fuzzer::execution::TerminationReason reason;
+    ASSERT_TRUE(app.Launch());
+    ASSERT_TRUE(app.Wait());
+    ASSERT_TRUE(app.GetStatusCode(code, reason));
+    EXPECT_EQ(0, code);
+    /// passed to the child only
+    EXPECT_TRUE(getenv(RingIpc::EnvironmentVariable) == nullptr);
+
+    /// a ring connects a single application
+    fuzzer::execution::LinuxExecuter other("/bin/sh");
+    EXPECT_THROW(other.SetRing(&ring), std::runtime_error);
+
+    /// and only that application inherits it
+    other.SetCommandLine("-c \"test ! -e /proc/$$/fd/" + ring.name() + "\"");
+    ASSERT_TRUE(other.Launch());
+    ASSERT_TRUE(other.Wait());
+    ASSERT_TRUE(other.GetStatusCode(code, reason));
+    EXPECT_EQ(0, code);
+
+    /// without a ring the variable isn't passed, not even the fuzzer's own
+    app.SetRing(nullptr);
+    setenv(RingIpc::EnvironmentVariable, "7", 1);
+    app.SetCommandLine("-c \"test -z $FUZZENGINE_RING_FD\"");
+    ASSERT_TRUE(app.Launch());
+    ASSERT_TRUE(app.Wait());
+    ASSERT_TRUE(app.GetStatusCode(code, reason));
+    EXPECT_EQ(0, code);
+    unsetenv(RingIpc::EnvironmentVariable);
+    EXPECT_NO_THROW(other.SetRing(&ring));
+}
+
+#endif
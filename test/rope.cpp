@@ -0,0 +1,118 @@
+#include <gtest\gtest.h>
+#include <fuzzengine\rope.h>
+#include <fuzzengine\buffer.h>
+#include <fuzzengine\tmpfile.h>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <cstring>
+
+using namespace fuzzer::runtime;
+using namespace std;
+
+static string Flatten(const Rope & rope)
+{
+    vector<uint8_t> data;
+    rope.flatten(data);
+    return string(data.begin(), data.end());
+}
+
+static Rope FromString(const char * str)
+{
+    return Rope(reinterpret_cast<const uint8_t *>(str), strlen(str));
+}
+
+TEST(Rope, InsertEraseDuplicate)
+{
+    Rope rope = FromString("0123456789");
+    rope.insert(5, "abc", 3);
+    EXPECT_EQ("01234abc56789", Flatten(rope));
+    rope.erase(0, 2);
+    EXPECT_EQ("234abc56789", Flatten(rope));
+    rope.duplicate(3, 3, 0);
+    EXPECT_EQ("abc234abc56789", Flatten(rope));
+    rope.overwrite(13, "X", 1);
+    EXPECT_EQ("abc234abc5678X", Flatten(rope));
+    EXPECT_EQ('X', rope.at(13));
+    EXPECT_EQ(14, rope.size());
+    EXPECT_THROW(rope.erase(10, 5), std::out_of_range);
+}
+
+TEST(Rope, CopiesShareAndStayUnchanged)
+{
+    const Rope seed = FromString("hello world");
+    Rope copy = seed;
+    copy.erase(5, 6);
+    copy.insert(0, seed.substr(6, 5));
+    EXPECT_EQ("worldhello", Flatten(copy));
+    EXPECT_EQ("hello world", Flatten(seed));
+    EXPECT_EQ(1, seed.count());
+}
+
+TEST(Rope, PiecesReferenceTheSeed)
+{
+    const char * text = "abcdefghij";
+    Rope rope = FromString(text);
+    rope.erase(4, 1);
+    vector<fuzzer::io::Piece> pieces;
+    rope.pieces(pieces);
+    ASSERT_EQ(2, pieces.size());
+    EXPECT_EQ(text, pieces[0].base);
+    EXPECT_EQ(4, pieces[0].length);
+    EXPECT_EQ(text + 5, pieces[1].base);
+
+    vector<uint8_t> out;
+    Buffer buffer(out);
+    EXPECT_TRUE(rope.write(buffer));
+    EXPECT_EQ("abcdfghij", string(out.begin(), out.end()));
+}
+
+TEST(Rope, ManyEdits)
+{
+    /// a reference string receives the same edits
+    string reference(4096, 'x');
+    for(size_t i = 0; i < reference.size(); ++i) {
+        reference[i] = static_cast<char>('a' + i % 26);
+    }
+    const string seed = reference;
+    Rope rope(reinterpret_cast<const uint8_t *>(seed.data()), seed.size());
+
+    uint32_t state = 1;
+    for(size_t i = 0; i < 2000; ++i) {
+        state = state * 1103515245 + 12345;
+        const size_t pos = (state >> 8) % (reference.size() + 1);
+        if (i & 1) {
+            const size_t size = (pos < reference.size()) ? 1 + (state >> 4) % (reference.size() - pos) % 16 : 0;
+            rope.erase(pos, size);
+            reference.erase(pos, size);
+        } else {
+            rope.insert(pos, "+-", 2);
+            reference.insert(pos, "+-");
+        }
+    }
+    EXPECT_EQ(reference.size(), rope.size());
+    EXPECT_EQ(reference, Flatten(rope));
+}
+
+TEST(Rope, TmpFile)
+{
+    /// more pieces than are written at once
+    string reference;
+    Rope rope;
+    for(size_t i = 0; i < 200; ++i) {
+        const string piece(1 + i % 7, static_cast<char>('a' + i % 26));
+        rope.insert(0, piece.data(), piece.size());
+        reference.insert(0, piece);
+    }
+    string name;
+    {
+        fuzzer::TmpFile file(rope, "");
+        name = file.filename();
+        ASSERT_FALSE(name.empty());
+        ifstream stream(name.c_str(), ios::binary);
+        ASSERT_TRUE(stream.good());
+        EXPECT_EQ(reference, string(istreambuf_iterator<char>(stream), istreambuf_iterator<char>()));
+    }
+    /// removed with the instance
+    EXPECT_FALSE(ifstream(name.c_str()).good());
+}
@@ -0,0 +1,84 @@
+#ifdef __linux__
+
+#include <fuzzengine\tcp.h>
+#include <gtest\gtest.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <chrono>
+#include <ctime>
+#include <thread>
+#include <vector>
+
+using namespace fuzzer::network;
+
+namespace {
+
+/// connects a plain socket to \p port on the loopback interface
+int Connect(uint16_t port)
+{
+    const int sock = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address = sockaddr_in();
+    address.sin_family      = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port        = htons(port);
+    if (connect(sock, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0) {
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+} // namespace
+
+TEST(TcpSocket, WriteWaitsForWindow)
+{
+    TcpServer server("127.0.0.1", 47370);
+    const int peer = Connect(47370);
+    ASSERT_GE(peer, 0);
+    std::shared_ptr<TcpSocket> sock = server.Accept(1000);
+    ASSERT_TRUE(sock != nullptr);
+
+    /// the peer reads slowly, the writes wait for it
+    std::vector<uint8_t> data(8 * 1024 * 1024, 0x5a);
+    size_t received = 0;
+    std::thread reader([peer, &received, &data]() {
+        std::vector<uint8_t> buffer(64 * 1024);
+        while(received < data.size()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            const ssize_t res = recv(peer, &buffer[0], buffer.size(), 0);
+            if (res <= 0) {
+                break;
+            }
+            received += static_cast<size_t>(res);
+        }
+    });
+    EXPECT_TRUE(sock->write(&data[0], data.size() / 2));
+    fuzzer::io::Piece pieces[2] = { { &data[0], data.size() / 4 }, { &data[0], data.size() / 4 } };
+    EXPECT_TRUE(sock->writev(pieces, 2));
+    reader.join();
+    EXPECT_EQ(data.size(), received);
+    close(peer);
+}
+
+TEST(TcpSocket, WriteTimeOut)
+{
+    TcpServer server("127.0.0.1", 47371);
+    const int peer = Connect(47371);
+    ASSERT_GE(peer, 0);
+    std::shared_ptr<TcpSocket> sock = server.Accept(1000);
+    ASSERT_TRUE(sock != nullptr);
+
+    /// nobody reads, the write fails once the window stays full, without
+    /// spinning while it waits
+    std::vector<uint8_t> data(64 * 1024 * 1024);
+    const std::clock_t cpu = std::clock();
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    EXPECT_FALSE(sock->write(&data[0], data.size()));
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_GE(elapsed, 1.5);
+    EXPECT_LT(static_cast<double>(std::clock() - cpu) / CLOCKS_PER_SEC, elapsed / 2);
+    close(peer);
+}
+
+#endif
@@ -1,6 +1,10 @@
 #include <fuzzengine\template.h>
 #include <gtest\gtest.h>
 #include <fuzzengine\parser.h>
+#include <fuzzengine\structuremutator.h>
+#include <fuzzengine\generator.h>
+#include <set>
+#include <sstream>
 
 using namespace fuzzer::parser;
 using namespace std;
@@ -83,4 +87,197 @@ TEST(Template, Data)
     EXPECT_EQ(0xAD, dst[1]);
     EXPECT_EQ(0xBE, dst[2]);
     EXPECT_EQ(0xEF, dst[3]);
-}
\ No newline at end of file
+}
+
+TEST(Template, U24_BigEndian)
+{
+    fuzzer::runtime::Template t;
+    EXPECT_EQ(0, t.u24(0x123456));
+
+    vector<uint8_t> dst;
+    EXPECT_NO_THROW(t.generate(dst));
+    ASSERT_EQ(3, dst.size());
+    EXPECT_EQ(0x12, dst[0]);
+    EXPECT_EQ(0x34, dst[1]);
+    EXPECT_EQ(0x56, dst[2]);
+}
+
+TEST(Template, U24_LittleEndian)
+{
+    fuzzer::runtime::Template t;
+    EXPECT_EQ(0, t.u24(0x123456));
+
+    vector<uint8_t> dst;
+    EXPECT_NO_THROW(t.little_endian().generate(dst));
+    ASSERT_EQ(3, dst.size());
+    EXPECT_EQ(0x56, dst[0]);
+    EXPECT_EQ(0x34, dst[1]);
+    EXPECT_EQ(0x12, dst[2]);
+}
+
+TEST(Template, U64_BigEndian)
+{
+    fuzzer::runtime::Template t;
+    EXPECT_EQ(0, t.u64(0x0102030405060708ull));
+
+    vector<uint8_t> dst;
+    EXPECT_NO_THROW(t.generate(dst));
+    ASSERT_EQ(8, dst.size());
+    for(size_t i = 0; i < 8; ++i) {
+        EXPECT_EQ(i + 1, dst[i]);
+    }
+}
+
+TEST(Template, WordArray_BigEndian)
+{
+    /// large enough to cover both the vectorized path and the tail
+    vector<uint16_t> data(37);
+    for(size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<uint16_t>(0x0100 * i + i + 1);
+    }
+    fuzzer::runtime::Template t;
+    EXPECT_EQ(0, t.array<uint16_t>(&data[0], data.size()));
+
+    vector<uint8_t> dst;
+    EXPECT_NO_THROW(t.generate(dst));
+    ASSERT_EQ(data.size() * 2, dst.size());
+    for(size_t i = 0; i < data.size(); ++i) {
+        EXPECT_EQ(data[i] >> 8, dst[i * 2]);
+        EXPECT_EQ(data[i] & 0xff, dst[i * 2 + 1]);
+    }
+}
+
+TEST(Template, DwordArray_LittleEndian)
+{
+    const uint32_t data[] = {0xDEADBEEF, 0x01020304};
+    fuzzer::runtime::Template t;
+    EXPECT_EQ(0, t.array<uint32_t>(data, 2));
+
+    vector<uint8_t> dst;
+    EXPECT_NO_THROW(t.little_endian().generate(dst));
+    ASSERT_EQ(8, dst.size());
+    EXPECT_EQ(0xEF, dst[0]);
+    EXPECT_EQ(0xBE, dst[1]);
+    EXPECT_EQ(0xAD, dst[2]);
+    EXPECT_EQ(0xDE, dst[3]);
+    EXPECT_EQ(0x04, dst[4]);
+    EXPECT_EQ(0x01, dst[7]);
+}
+
+TEST(Template, QwordArray_BigEndian)
+{
+    vector<uint64_t> data(9, 0x0102030405060708ull);
+    fuzzer::runtime::Template t;
+    EXPECT_EQ(0, t.array<uint64_t>(&data[0], data.size()));
+
+    vector<uint8_t> dst;
+    EXPECT_NO_THROW(t.generate(dst));
+    ASSERT_EQ(data.size() * 8, dst.size());
+    for(size_t i = 0; i < dst.size(); ++i) {
+        EXPECT_EQ((i % 8) + 1, dst[i]);
+    }
+}
+
+TEST(StructureMutator, ItemOperations)
+{
+    shared_ptr<fuzzer::runtime::Template> base = make_shared<fuzzer::runtime::Template>();
+    base->u8(1);
+    base->u8(2);
+    base->u8(3);
+    shared_ptr<fuzzer::runtime::Template> donor = make_shared<fuzzer::runtime::Template>();
+    donor->u8(9);
+    donor->u8(8);
+
+    fuzzer::runtime::StructureMutator mutator(base);
+    const size_t repeats = fuzzer::runtime::StructureMutator::RepeatCountsCount;
+    EXPECT_EQ(3 + 3 + 3 + 3 * repeats, mutator.count());
+    mutator.donor(donor);
+    EXPECT_EQ(3 + 3 + 3 + 3 * repeats + 4 * 2, mutator.count());
+
+    set<vector<uint8_t> > variants;
+    size_t count = 0;
+    do {
+        vector<uint8_t> dst;
+        fuzzer::runtime::Buffer buffer(dst);
+        mutator.evaluate(buffer);
+        variants.insert(dst);
+        ++count;
+    } while(mutator.mutate());
+    EXPECT_EQ(mutator.count(), count);
+
+    const uint8_t drop[] = {2, 3}, duplicate[] = {1, 1, 2, 3}, swap[] = {3, 2, 1}, repeat[] = {1, 2, 2, 3}, splice[] = {1, 8};
+    EXPECT_EQ(1, variants.count(vector<uint8_t>(drop, drop + sizeof(drop))));
+    EXPECT_EQ(1, variants.count(vector<uint8_t>(duplicate, duplicate + sizeof(duplicate))));
+    EXPECT_EQ(1, variants.count(vector<uint8_t>(swap, swap + sizeof(swap))));
+    EXPECT_EQ(1, variants.count(vector<uint8_t>(repeat, repeat + sizeof(repeat))));
+    EXPECT_EQ(1, variants.count(vector<uint8_t>(splice, splice + sizeof(splice))));
+
+    /// the base is unchanged
+    vector<uint8_t> dst;
+    base->generate(dst);
+    ASSERT_EQ(3, dst.size());
+    EXPECT_EQ(1, dst[0]);
+    EXPECT_EQ(3, dst[2]);
+    EXPECT_EQ(3, base->items().size());
+
+    mutator.seek(3);
+    EXPECT_EQ(fuzzer::runtime::StructureMutator::DUPLICATE, mutator.operation());
+    EXPECT_EQ(4, mutator.items().size());
+}
+
+TEST(StructureMutator, Script)
+{
+    std::stringstream str;
+    str << "template a = [ byte(9) ]; template t = structure(a) [ byte(1), byte(2), {byte(3)} ];";
+    fuzzer::parser::Tokenizer token(str);
+    fuzzer::bytecode::Generator generator;
+    std::shared_ptr<fuzzer::bytecode::Script> script = generator.ParseScript(token);
+    shared_ptr<fuzzer::runtime::Template> tp = script->_templates["t"];
+
+    /// registered after the mutator of the fuzzed byte, and inert until walked
+    vector<fuzzer::runtime::Mutator *> mutators = tp->GetMutators();
+    ASSERT_EQ(2, mutators.size());
+    EXPECT_TRUE(mutators[1]->finished());
+    EXPECT_TRUE(script->_templates["a"]->GetMutators().empty());
+    const uint8_t base[] = { 1, 2, 3 };
+    vector<uint8_t> dst;
+    tp->generate(dst);
+    EXPECT_EQ(vector<uint8_t>(base, base + 3), dst);
+
+    const size_t repeats = fuzzer::runtime::StructureMutator::RepeatCountsCount;
+    EXPECT_EQ(3 + 3 + 3 + 3 * repeats + 4, mutators[1]->count());
+    set<vector<uint8_t> > variants;
+    mutators[1]->reset();
+    do {
+        dst.clear();
+        tp->generate(dst);
+        variants.insert(dst);
+    } while(mutators[1]->mutate());
+    const uint8_t drop[] = { 1, 3 }, splice[] = { 1, 2, 9 };
+    EXPECT_EQ(1, variants.count(vector<uint8_t>(drop, drop + sizeof(drop))));
+    EXPECT_EQ(1, variants.count(vector<uint8_t>(splice, splice + sizeof(splice))));
+
+    /// the item mutators still apply to the finished variant
+    dst.clear();
+    mutators[0]->mutate();
+    tp->generate(dst);
+    ASSERT_EQ(3, dst.size());
+    EXPECT_NE(3, dst[2]);
+}
+
+TEST(StructureMutator, ScriptErrors)
+{
+    const char * scripts[] = {
+        "template t = structure(a) [ byte(1) ];",
+        "template t = structure(t) [ byte(1) ];",
+        "template a = [ byte(1) ]; template t = structure(a, ) [ byte(1) ];",
+        "template t = structure [ byte(1) ]; template u = structure structure [ byte(1) ];",
+    };
+    for(size_t i = 0; i < sizeof(scripts) / sizeof(scripts[0]); ++i) {
+        std::stringstream str;
+        str << scripts[i];
+        fuzzer::parser::Tokenizer token(str);
+        fuzzer::bytecode::Generator generator;
+        EXPECT_THROW(generator.ParseScript(token), std::runtime_error) << scripts[i];
+    }
+}
@@ -0,0 +1,107 @@
+#ifdef __linux__
+
+#include <fuzzengine\warmpool.h>
+#include <gtest\gtest.h>
+#include "fakeapp.h"
+
+using namespace fuzzer;
+
+namespace {
+
+/// creates applications that connect after \p delay ms, or never
+class FakeFactory : public runtime::IApplicationFactory
+{
+public:
+    FakeFactory(bool connect, size_t delay) : _connect(connect), _delay(delay) {}
+
+    virtual execution::IApplicationExecuter * Create(uint16_t port)
+    {
+        test::FakeApp * app = new test::FakeApp(port, &_totals);
+        app->delay(_delay);
+        if (!_connect) {
+            app->silent();
+        }
+        return app;
+    }
+
+    size_t launches() const { return _totals.launches; }
+    size_t running() const { return _totals.running; }
+
+private:
+    bool                    _connect;
+    size_t                  _delay;
+    test::FakeApp::Totals   _totals;
+};
+
+} // namespace
+
+TEST(WarmPool, TakeAndRelease)
+{
+    FakeFactory factory(true, 0);
+    runtime::WarmPool pool(factory, "127.0.0.1", 47320, 3, 1000);
+
+    runtime::WarmPool::Instance * instance = pool.Take(2000);
+    ASSERT_TRUE(instance != nullptr);
+    EXPECT_TRUE(instance->connection != nullptr);
+    EXPECT_TRUE(instance->app().IsAlive());
+    std::shared_ptr<network::TcpSocket> connection = std::move(instance->connection);
+
+    /// the supervisor launches a replacement while it is taken
+    runtime::WarmPool::Instance * second = pool.Take(2000);
+    ASSERT_TRUE(second != nullptr);
+    EXPECT_NE(instance, second);
+    EXPECT_GE(factory.launches(), 2);
+
+    /// released applications are terminated and launched again
+    instance->connection = connection;
+    connection.reset();
+    pool.Release(instance);
+    pool.Release(second);
+    for(size_t i = 0; i < 5; ++i) {
+        instance = pool.Take(2000);
+        ASSERT_TRUE(instance != nullptr);
+        EXPECT_TRUE(instance->connection != nullptr);
+        pool.Release(instance);
+    }
+    EXPECT_GE(factory.launches(), 7);
+}
+
+TEST(WarmPool, Resize)
+{
+    /// launching takes much longer than the applications are used
+    FakeFactory factory(true, 50);
+    runtime::WarmPool pool(factory, "127.0.0.1", 47330, 4, 1000);
+    EXPECT_EQ(1, pool.size());
+
+    runtime::WarmPool::Instance * instance = pool.Take(2000);
+    ASSERT_TRUE(instance != nullptr);
+    pool.Release(instance);
+    EXPECT_EQ(4, pool.size());
+}
+
+TEST(WarmPool, NoConnection)
+{
+    /// applications that don't connect in time are retired and relaunched
+    FakeFactory factory(false, 0);
+    runtime::WarmPool pool(factory, "127.0.0.1", 47340, 2, 20);
+    EXPECT_TRUE(pool.Take(200) == nullptr);
+    EXPECT_GE(factory.launches(), 2);
+}
+
+TEST(WarmPool, Shutdown)
+{
+    FakeFactory factory(true, 0);
+    {
+        runtime::WarmPool pool(factory, "127.0.0.1", 47350, 3, 1000);
+        /// a taken application is terminated too
+        runtime::WarmPool::Instance * instance = pool.Take(2000);
+        ASSERT_TRUE(instance != nullptr);
+        instance = pool.Take(2000);
+        ASSERT_TRUE(instance != nullptr);
+        pool.Release(instance);
+        EXPECT_GT(factory.running(), 0);
+    }
+    EXPECT_EQ(0, factory.running());
+}
+
+#endif